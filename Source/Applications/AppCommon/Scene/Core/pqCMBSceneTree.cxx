@@ -79,6 +79,7 @@
 #include <vtksys/SystemTools.hxx>
 
 #include <fstream>
+#include <vector>
 
 #define MAX_RANDOM_PLACEMENT_TRY 100
 
@@ -1094,10 +1095,10 @@ void pqCMBSceneTree::addPointsToGlyph(pqCMBSceneNode* node, int count, double* s
   }
 
   int i;
-  vtkIdType numPointsInGlyph = gobj->getNumberOfPoints();
   int numberOfFailedAttempts = 0, maxNumberOfFailedAttempts = count * 100;
   bool constraintPtFound = false;
   bool originalPointRepositioned = false;
+  std::vector<double> newPoints, newScales;
 
   for (i = 0; i < count; i++)
   {
@@ -1146,11 +1147,16 @@ void pqCMBSceneTree::addPointsToGlyph(pqCMBSceneNode* node, int count, double* s
     }
     else
     {
-      gobj->insertNextPoint(sp);
-      gobj->setScale(numPointsInGlyph, scaling);
-      ++numPointsInGlyph;
+      newPoints.insert(newPoints.end(), sp, sp + 3);
+      newScales.insert(newScales.end(), scaling, scaling + 3);
     }
   }
+  // Insert the new glyphs at once
+  if (!newPoints.empty())
+  {
+    gobj->insertNextPoints(
+      static_cast<vtkIdType>(newPoints.size() / 3), &newPoints[0], &newScales[0]);
+  }
 
   //Do not re-position original again if importing points
   if (target && repositionOriginal && (glyphPlaybackOption != 1))
@@ -1282,6 +1288,7 @@ std::vector<pqCMBSceneNode*> pqCMBSceneTree::duplicateNode(pqCMBSceneNode* node,
       new pqCMBGlyphObject(gsource, this->CurrentView, this->CurrentServer, gname.c_str(), false);
     bool constraintPtFound = false;
     int numPointsImported = 0;
+    std::vector<double> newPoints, newScales, newOrientations;
     for (i = 0; i < count; i++)
     {
       if (target)
@@ -1320,16 +1327,23 @@ std::vector<pqCMBSceneNode*> pqCMBSceneTree::duplicateNode(pqCMBSceneNode* node,
       {
         p[0] = p[1] = p[2] = 0.0;
       }
-      gobj->insertNextPoint(sp);
+      newPoints.insert(newPoints.end(), sp, sp + 3);
       numPointsImported++;
       if (gorig != NULL)
       {
         gorig->getScale(i, d);
-        gobj->setScale(i, d);
+        newScales.insert(newScales.end(), d, d + 3);
         gorig->getOrientation(i, d);
-        gobj->setOrientation(i, d);
+        newOrientations.insert(newOrientations.end(), d, d + 3);
       }
     }
+    // Insert the glyphs at once
+    if (numPointsImported > 0)
+    {
+      gobj->insertNextPoints(numPointsImported, &newPoints[0],
+        newScales.empty() ? NULL : &newScales[0],
+        newOrientations.empty() ? NULL : &newOrientations[0]);
+    }
     gobj->copyAttributes(orig);
     name = node->getName();
     name += " Copy";
@@ -1361,7 +1375,7 @@ std::vector<pqCMBSceneNode*> pqCMBSceneTree::duplicateNode(pqCMBSceneNode* node,
   {
     bool hasExplicitColor = node->hasExplicitColor();
     // Stuff needed in the case of glyphs
-    double aveGpoint[3], gpoint[3];
+    double aveGpoint[3];
     pqCMBGlyphObject* ngobj;
     double color[4];
     if (gorig)
@@ -1428,17 +1442,22 @@ std::vector<pqCMBSceneNode*> pqCMBSceneTree::duplicateNode(pqCMBSceneNode* node,
         {
           ngobj = dynamic_cast<pqCMBGlyphObject*>(nobj);
           int j, gcount = ngobj->getNumberOfPoints();
+          std::vector<double> gpoints(3 * gcount), snappedPoints;
           for (j = 0; j < gcount; j++)
           {
             ngobj->getPoint(j, p);
             // calulate the delta between the average point of the
             // entire glyph and the new random point and apply
             // the translation to the glyph point and then snap it
-            gpoint[0] = p[0] + sp[0] - aveGpoint[0];
-            gpoint[1] = p[1] + sp[1] - aveGpoint[1];
-            gpoint[2] = p[2] + sp[2] - aveGpoint[2];
-            target->getClosestPoint(gpoint, p);
-            ngobj->setPoint(j, p);
+            gpoints[3 * j] = p[0] + sp[0] - aveGpoint[0];
+            gpoints[3 * j + 1] = p[1] + sp[1] - aveGpoint[1];
+            gpoints[3 * j + 2] = p[2] + sp[2] - aveGpoint[2];
+          }
+          // snap all of them in one update
+          target->getClosestPoints(gpoints, snappedPoints);
+          for (j = 0; j < gcount; j++)
+          {
+            ngobj->setPoint(j, &snappedPoints[3 * j]);
           }
         }
         else
@@ -4364,7 +4383,7 @@ void pqCMBSceneTree::convertChildrenToGlyphs(
   double pos[3], ori[3], scale[3];
   pqCMBSceneObjectBase::enumSurfaceType stype;
   std::string userType;
-  int gcount = 0;
+  std::vector<double> points, scales, orientations;
   int i, n = static_cast<int>(node->getChildren().size());
   for (i = 0; i < n; i++)
   {
@@ -4399,12 +4418,17 @@ void pqCMBSceneTree::convertChildrenToGlyphs(
     fobj->getPosition(pos);
     fobj->getScale(scale);
     fobj->getOrientation(ori);
-    gobj->insertNextPoint(pos);
-    gobj->setOrientation(gcount, ori);
-    gobj->setScale(gcount, scale);
-    ++gcount;
+    points.insert(points.end(), pos, pos + 3);
+    scales.insert(scales.end(), scale, scale + 3);
+    orientations.insert(orientations.end(), ori, ori + 3);
     this->deleteNode(child, event);
   }
+  // Insert the glyphs at once
+  if (gobj)
+  {
+    gobj->insertNextPoints(
+      static_cast<vtkIdType>(points.size() / 3), &points[0], &scales[0], &orientations[0]);
+  }
 }
 
 void pqCMBSceneTree::unsetTextureMap()
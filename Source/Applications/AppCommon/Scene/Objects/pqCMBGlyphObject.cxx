@@ -199,18 +199,8 @@ pqCMBSceneObjectBase* pqCMBGlyphObject::duplicate(
   this->duplicateInternals(nobj);
   nobj->SurfaceType = this->SurfaceType;
 
-  // Duplicate the points and other information
-  int i, n = this->getNumberOfPoints();
-  double d[3];
-  for (i = 0; i < n; i++)
-  {
-    this->getPoint(i, d);
-    nobj->insertNextPoint(d);
-    this->getScale(i, d);
-    nobj->setScale(i, d);
-    this->getOrientation(i, d);
-    nobj->setOrientation(i, d);
-  }
+  // Duplicate the points and other information (on the server)
+  nobj->SourceProxy->InsertNextGlyphs(this->SourceProxy);
 
   if (updateRep)
   {
@@ -225,6 +215,11 @@ void pqCMBGlyphObject::insertNextPoint(double* p)
   this->SourceProxy->InsertNextPoint(p);
 }
 
+void pqCMBGlyphObject::insertNextPoints(vtkIdType n, double* p, double* s, double* o)
+{
+  this->SourceProxy->InsertNextPoints(n, p, s, o);
+}
+
 vtkIdType pqCMBGlyphObject::getNumberOfPoints()
 {
   return const_cast<vtkSMCMBGlyphPointSourceProxy*>(this->SourceProxy)->GetNumberOfPoints();
@@ -52,6 +52,8 @@ public:
   pqPipelineSource* getGlyphSource() const;
   virtual void clearSelectedPointsColor();
   void insertNextPoint(double* p);
+  // Insert n points (and optionally their scales and orientations) at once
+  void insertNextPoints(vtkIdType n, double* p, double* s = 0, double* o = 0);
   vtkIdType getNumberOfPoints() override;
   void getAveragePoint(double* pa);
   void getPoint(vtkIdType i, double* p) const;
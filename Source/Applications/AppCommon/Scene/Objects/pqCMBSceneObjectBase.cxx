@@ -45,6 +45,8 @@
 #include <vtkSMSourceProxy.h>
 #include <vtkTransform.h>
 
+#include <algorithm>
+
 #include "pqRepresentationHelperFunctions.h"
 #include "vtkDataObject.h"
 
@@ -696,7 +698,7 @@ void pqCMBSceneObjectBase::updatePolyDataStats()
   fproxy->UpdatePropertyInformation();
 }
 
-void pqCMBSceneObjectBase::getClosestPoint(const double p[3], double cp[3])
+vtkSMProxy* pqCMBSceneObjectBase::prepareClosestPointFilter()
 {
   // Do we already have a closest point filter?
   if (!this->ClosestPointFilter)
@@ -713,6 +715,12 @@ void pqCMBSceneObjectBase::getClosestPoint(const double p[3], double cp[3])
   fproxy->GetProperty("Translation")->Copy(rproxy->GetProperty("Position"));
 
   fproxy->GetProperty("Scale")->Copy(rproxy->GetProperty("Scale"));
+  return fproxy;
+}
+
+void pqCMBSceneObjectBase::getClosestPoint(const double p[3], double cp[3])
+{
+  vtkSMProxy* fproxy = this->prepareClosestPointFilter();
 
   QList<QVariant> values;
   values << p[0] << p[1] << p[2];
@@ -728,6 +736,45 @@ void pqCMBSceneObjectBase::getClosestPoint(const double p[3], double cp[3])
   cp[2] = data[2];
 }
 
+void pqCMBSceneObjectBase::getClosestPoints(
+  const std::vector<double>& points, std::vector<double>& closestPoints)
+{
+  closestPoints.resize(points.size());
+  if (points.empty())
+  {
+    return;
+  }
+  vtkSMProxy* fproxy = this->prepareClosestPointFilter();
+
+  vtkSMPropertyHelper(fproxy, "TestPoints")
+    .Set(&points[0], static_cast<unsigned int>(points.size()));
+
+  fproxy->UpdateVTKObjects();
+  vtkSMSourceProxy::SafeDownCast(fproxy)->UpdatePipeline();
+  fproxy->UpdatePropertyInformation();
+  vtkSMDoubleVectorProperty* result =
+    vtkSMDoubleVectorProperty::SafeDownCast(fproxy->GetProperty("ClosestPoints"));
+  bool answered = result && result->GetNumberOfElements() == points.size();
+  if (answered)
+  {
+    std::copy(result->GetElements(), result->GetElements() + points.size(), closestPoints.begin());
+  }
+
+  // Don't answer these again on the next single point update
+  vtkSMPropertyHelper(fproxy, "TestPoints").SetNumberOfElements(0);
+  fproxy->UpdateVTKObjects();
+
+  if (!answered)
+  {
+    // The server didn't answer all of them (an older filter?), so ask for
+    // the points one at a time
+    for (size_t i = 0; i + 2 < points.size(); i += 3)
+    {
+      this->getClosestPoint(&points[i], &closestPoints[i]);
+    }
+  }
+}
+
 void pqCMBSceneObjectBase::setLODMode(int mode, bool updateRep)
 {
   vtkSMIntVectorProperty::SafeDownCast(this->Representation->getProxy()->GetProperty("SuppressLOD"))
@@ -23,6 +23,7 @@
 #include "vtkSmartPointer.h"
 #include <QObject>
 #include <QPointer>
+#include <vector>
 
 class pqPipelineSource;
 class pqDataRepresentation;
@@ -164,6 +165,10 @@ public:
 
   virtual void updateRepresentation();
   void getClosestPoint(const double p[3], double cp[3]);
+  // Closest point to each of the points (x, y, z, x, y, z ...) in one
+  // pipeline update (or one point at a time, if the filter does not answer
+  // all of them).
+  void getClosestPoints(const std::vector<double>& points, std::vector<double>& closestPoints);
   void setLODMode(int mode, bool updateRep = true);
   void zoomOnObject();
 
@@ -191,6 +196,8 @@ protected:
     const char* name, double* v, const int& size, const bool& updateRep);
   void setConstraint(int i, bool mode);
   void updateTransform() const; //will modify Transform and TransformNeedsUpdate
+  // Closest point filter on Source, with the transform of the representation
+  vtkSMProxy* prepareClosestPointFilter();
 
   QPointer<pqPipelineSource> Source;
   QPointer<pqPipelineSource> ClosestPointFilter;
@@ -495,6 +495,12 @@ vtkIdType pqCMBLIDARReaderManager::scanFileNumberOfPoints(pqPipelineSource* read
     {
       pqSMAdaptor::setElementProperty(readerProxy->GetProperty("AbortExecute"), 0);
     }
+    // the pieces (and their bounds) are then read from the index file, if
+    // there is one, instead of scanning the whole file
+    if (readerProxy->GetProperty("UseIndexFile"))
+    {
+      pqSMAdaptor::setElementProperty(readerProxy->GetProperty("UseIndexFile"), 1);
+    }
     readerProxy->UpdateVTKObjects();
     readerProxy->UpdatePipeline();
     if (readerProxy->GetProperty("AbortExecute"))
@@ -626,6 +632,20 @@ int pqCMBLIDARReaderManager::importLIDARData(const char* filename, pqCMBLIDARPie
       pqSMAdaptor::getElementProperty(readerProxy->GetProperty("RealNumberOfOutputPoints")).toInt();
     QList<QVariant> values =
       pqSMAdaptor::getMultipleElementProperty(readerProxy->GetProperty("DataBounds"));
+    // DataBounds are those of every piece read so far; use the bounds of just
+    // this piece if the reader knows them (exact, if from the index file)
+    if (readerProxy->GetProperty("PieceBounds"))
+    {
+      pqSMAdaptor::setElementProperty(readerProxy->GetProperty("PieceIndex"), pieceId);
+      readerProxy->UpdateVTKObjects();
+      readerProxy->UpdatePropertyInformation();
+      QList<QVariant> pieceBounds =
+        pqSMAdaptor::getMultipleElementProperty(readerProxy->GetProperty("PieceBounds"));
+      if (pieceBounds.count() == 6 && pieceBounds[0].toDouble() <= pieceBounds[1].toDouble())
+      {
+        values = pieceBounds;
+      }
+    }
     double bounds[6] = { values[0].toDouble(), values[1].toDouble(), values[2].toDouble(),
       values[3].toDouble(), values[4].toDouble(), values[5].toDouble() };
 
@@ -590,6 +590,10 @@ void pqCMBLIDARTerrainExtractionManager::onProcesssFullData()
   pqSMAdaptor::setElementProperty(
     this->FullProcessTerrainExtractFilter->getProxy()->GetProperty("CacheRefineResultsToDisk"), 1);
 
+  // reuse the refine / extract results of previous runs on the same input
+  pqSMAdaptor::setElementProperty(
+    this->FullProcessTerrainExtractFilter->getProxy()->GetProperty("UseExtractionCache"), 1);
+
   //we ALWAYS store cache driectory as the refineResultsInfo
   pqSMAdaptor::setElementProperty(
     this->FullProcessTerrainExtractFilter->getProxy()->GetProperty("IntermediateResultsPath"),
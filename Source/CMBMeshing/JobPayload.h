@@ -0,0 +1,380 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+
+#ifndef CMBMeshing_JobPayload_h
+#define CMBMeshing_JobPayload_h
+
+#include <cstddef>
+#include <cstring>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+//Versioned binary job contents shared by the mesh workers, for the arrays
+//sent to a worker and the ones it sends back. Every array is a section
+//starting on a 16 byte boundary, so that a worker can use the arrays in
+//place when they already have the type it needs, instead of parsing and
+//copying them out of a stream.
+//
+//Layout, in the byte order of the host:
+//  offset 0   char[8]   magic, "CMBJOB" followed by two nul characters
+//  offset 8   uint32    version of the layout (1)
+//  offset 12  uint32    number of sections
+//  offset 16  one 24 byte entry per section:
+//               uint32  VTK type id of the values (VTK_INT, VTK_DOUBLE, ...)
+//               uint32  number of components
+//               uint64  offset of the values from the start of the payload
+//               uint64  number of tuples
+//  then the values of the sections, each at a multiple of 16 bytes.
+//
+//Contents that don't start with the magic are in the older text / binary
+//stream formats, which the workers still read.
+namespace payload
+{
+
+typedef unsigned int uint32;
+typedef unsigned long long uint64;
+
+static const char Magic[8] = { 'C', 'M', 'B', 'J', 'O', 'B', '\0', '\0' };
+static const uint32 Version = 1;
+static const std::size_t Alignment = 16;
+static const std::size_t HeaderSize = 16;
+static const std::size_t SectionEntrySize = 24;
+
+//the VTK type ids, so that the contents are described the same way as the
+//vtkDataArrays in the stream formats, without the workers linking to VTK
+template <typename T>
+struct TypeId;
+template <>
+struct TypeId<char>
+{
+  static const uint32 value = 2;
+};
+template <>
+struct TypeId<unsigned char>
+{
+  static const uint32 value = 3;
+};
+template <>
+struct TypeId<short>
+{
+  static const uint32 value = 4;
+};
+template <>
+struct TypeId<unsigned short>
+{
+  static const uint32 value = 5;
+};
+template <>
+struct TypeId<int>
+{
+  static const uint32 value = 6;
+};
+template <>
+struct TypeId<unsigned int>
+{
+  static const uint32 value = 7;
+};
+template <>
+struct TypeId<float>
+{
+  static const uint32 value = 10;
+};
+template <>
+struct TypeId<double>
+{
+  static const uint32 value = 11;
+};
+template <>
+struct TypeId<long long>
+{
+  static const uint32 value = 16;
+};
+template <>
+struct TypeId<unsigned long long>
+{
+  static const uint32 value = 17;
+};
+
+inline std::size_t align(std::size_t offset)
+{
+  return (offset + Alignment - 1) & ~(Alignment - 1);
+}
+
+inline bool isPayload(const char* data, std::size_t size)
+{
+  return data && size >= HeaderSize && std::memcmp(data, Magic, sizeof(Magic)) == 0;
+}
+
+//Builds a payload from arrays that are referenced, not copied, until the
+//payload is written out in a single buffer of the final size.
+class Writer
+{
+public:
+  template <typename T>
+  void add(const T* values, uint64 numTuples, uint32 numComponents = 1)
+  {
+    Section s;
+    s.type = TypeId<T>::value;
+    s.numComponents = numComponents;
+    s.numTuples = values ? numTuples : 0;
+    s.values = values;
+    s.numBytes = sizeof(T) * numComponents * s.numTuples;
+    this->Sections.push_back(s);
+  }
+
+  std::size_t size() const
+  {
+    std::size_t offset = align(HeaderSize + SectionEntrySize * this->Sections.size());
+    for (std::size_t i = 0; i < this->Sections.size(); ++i)
+    {
+      offset = align(offset + this->Sections[i].numBytes);
+    }
+    return offset;
+  }
+
+  //dest has to hold size() bytes
+  void write(char* dest) const
+  {
+    std::memset(dest, 0, this->size());
+    std::memcpy(dest, Magic, sizeof(Magic));
+    const uint32 numSections = static_cast<uint32>(this->Sections.size());
+    std::memcpy(dest + 8, &Version, 4);
+    std::memcpy(dest + 12, &numSections, 4);
+
+    std::size_t offset = align(HeaderSize + SectionEntrySize * this->Sections.size());
+    for (std::size_t i = 0; i < this->Sections.size(); ++i)
+    {
+      const Section& s = this->Sections[i];
+      char* entry = dest + HeaderSize + SectionEntrySize * i;
+      const uint64 valuesOffset = offset;
+      std::memcpy(entry, &s.type, 4);
+      std::memcpy(entry + 4, &s.numComponents, 4);
+      std::memcpy(entry + 8, &valuesOffset, 8);
+      std::memcpy(entry + 16, &s.numTuples, 8);
+      if (s.numBytes > 0)
+      {
+        std::memcpy(dest + offset, s.values, s.numBytes);
+      }
+      offset = align(offset + s.numBytes);
+    }
+  }
+
+  std::string str() const
+  {
+    std::string result(this->size(), '\0');
+    if (!result.empty())
+    {
+      this->write(&result[0]);
+    }
+    return result;
+  }
+
+private:
+  struct Section
+  {
+    uint32 type;
+    uint32 numComponents;
+    uint64 numTuples;
+    const void* values;
+    std::size_t numBytes;
+  };
+  std::vector<Section> Sections;
+};
+
+//Reads the sections of a payload in place. The payload memory has to
+//outlive the pointers returned by view().
+class Reader
+{
+public:
+  Reader(const char* data, std::size_t size)
+    : Data(NULL)
+    , NumSections(0)
+  {
+    uint32 version = 0;
+    uint32 numSections = 0;
+    if (!isPayload(data, size))
+    {
+      return;
+    }
+    std::memcpy(&version, data + 8, 4);
+    std::memcpy(&numSections, data + 12, 4);
+    if (version != Version || numSections > (size - HeaderSize) / SectionEntrySize)
+    {
+      return;
+    }
+    //verify that all the sections are inside the payload, dividing the room
+    //left rather than multiplying the counts, which could overflow
+    this->Data = data;
+    for (uint32 i = 0; i < numSections; ++i)
+    {
+      const Entry e = this->entry(i);
+      const uint64 tupleSize = typeSize(e.type) * e.numComponents;
+      if ((typeSize(e.type) == 0 && e.numTuples > 0) || e.offset > size ||
+        (tupleSize > 0 && e.numTuples > (size - e.offset) / tupleSize))
+      {
+        this->Data = NULL;
+        return;
+      }
+    }
+    this->NumSections = numSections;
+  }
+
+  bool valid() const { return this->Data != NULL; }
+
+  uint32 numberOfSections() const { return this->NumSections; }
+
+  //number of values (tuples times components) of section i
+  uint64 numberOfValues(uint32 i) const
+  {
+    if (i >= this->NumSections)
+    {
+      return 0;
+    }
+    const Entry e = this->entry(i);
+    return e.numTuples * e.numComponents;
+  }
+
+  //Point values at the values of section i, if they are stored as T and
+  //suitably aligned; otherwise returns false and read() has to be used.
+  template <typename T>
+  bool view(uint32 i, const T*& values, uint64& numValues) const
+  {
+    values = NULL;
+    numValues = 0;
+    if (i >= this->NumSections)
+    {
+      return false;
+    }
+    const Entry e = this->entry(i);
+    const char* start = this->Data + e.offset;
+    if (e.type != TypeId<T>::value ||
+      reinterpret_cast<std::size_t>(start) % sizeof(T) != 0)
+    {
+      return false;
+    }
+    values = reinterpret_cast<const T*>(start);
+    numValues = e.numTuples * e.numComponents;
+    return true;
+  }
+
+  //Copy the values of section i into result, converting them to T
+  template <typename T>
+  bool read(uint32 i, std::vector<T>& result) const
+  {
+    result.clear();
+    if (i >= this->NumSections)
+    {
+      return false;
+    }
+    const Entry e = this->entry(i);
+    const uint64 n = e.numTuples * e.numComponents;
+    const char* start = this->Data + e.offset;
+    result.resize(static_cast<std::size_t>(n));
+    switch (e.type)
+    {
+      case TypeId<char>::value:
+        return convert<char>(start, n, result);
+      case TypeId<unsigned char>::value:
+        return convert<unsigned char>(start, n, result);
+      case TypeId<short>::value:
+        return convert<short>(start, n, result);
+      case TypeId<unsigned short>::value:
+        return convert<unsigned short>(start, n, result);
+      case TypeId<int>::value:
+        return convert<int>(start, n, result);
+      case TypeId<unsigned int>::value:
+        return convert<unsigned int>(start, n, result);
+      case TypeId<float>::value:
+        return convert<float>(start, n, result);
+      case TypeId<double>::value:
+        return convert<double>(start, n, result);
+      case TypeId<long long>::value:
+        return convert<long long>(start, n, result);
+      case TypeId<unsigned long long>::value:
+        return convert<unsigned long long>(start, n, result);
+    }
+    result.clear();
+    return n == 0;
+  }
+
+private:
+  struct Entry
+  {
+    uint32 type;
+    uint32 numComponents;
+    uint64 offset;
+    uint64 numTuples;
+  };
+
+  Entry entry(uint32 i) const
+  {
+    Entry e;
+    const char* p = this->Data + HeaderSize + SectionEntrySize * i;
+    std::memcpy(&e.type, p, 4);
+    std::memcpy(&e.numComponents, p + 4, 4);
+    std::memcpy(&e.offset, p + 8, 8);
+    std::memcpy(&e.numTuples, p + 16, 8);
+    return e;
+  }
+
+  static uint64 typeSize(uint32 type)
+  {
+    switch (type)
+    {
+      case TypeId<char>::value:
+      case TypeId<unsigned char>::value:
+        return 1;
+      case TypeId<short>::value:
+      case TypeId<unsigned short>::value:
+        return 2;
+      case TypeId<int>::value:
+      case TypeId<unsigned int>::value:
+      case TypeId<float>::value:
+        return 4;
+      case TypeId<double>::value:
+      case TypeId<long long>::value:
+      case TypeId<unsigned long long>::value:
+        return 8;
+    }
+    return 0;
+  }
+
+  //memcpy each value, the section may not be aligned for S
+  template <typename S, typename T>
+  static bool convert(const char* start, uint64 n, std::vector<T>& result)
+  {
+    S value;
+    for (uint64 i = 0; i < n; ++i)
+    {
+      std::memcpy(&value, start + sizeof(S) * i, sizeof(S));
+      result[static_cast<std::size_t>(i)] = static_cast<T>(value);
+    }
+    return true;
+  }
+
+  const char* Data;
+  uint32 NumSections;
+};
+
+//A read only streambuf over memory it doesn't own, to parse the older
+//stream formats without first copying the contents into a string.
+class memory_buffer : public std::streambuf
+{
+public:
+  memory_buffer(const char* data, std::size_t size)
+  {
+    char* begin = const_cast<char*>(data);
+    this->setg(begin, begin, begin + size);
+  }
+};
+}
+
+#endif
@@ -0,0 +1,565 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+
+#include "cmbMeshJobPool.h"
+
+#include "MeshJobReporter.h"
+
+#ifdef CMB_MESH_JOB_POOL_TETGEN
+#include "TetGenWorker.h"
+#endif
+#ifdef CMB_MESH_JOB_POOL_TRIANGLE
+#include "TriangleWorker.h"
+#endif
+
+#include <boost/filesystem.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+//the state of a job, shared by the pool and the thread meshing it
+struct JobState
+{
+  JobState(const remus::proto::Job& job, const remus::proto::JobSubmission& submission)
+    : Job(job)
+    , Submission(submission)
+    , Mesher(NULL)
+    , Status(remus::QUEUED)
+    , Cancelled(false)
+  {
+  }
+
+  remus::proto::Job Job;
+  remus::proto::JobSubmission Submission;
+  cmbMeshJobPool::Mesher Mesher;
+
+  //guarded by the mutex of the pool
+  remus::STATUS_TYPE Status;
+  std::string Message;
+  std::string Result;
+
+  std::atomic<bool> Cancelled;
+};
+
+typedef std::shared_ptr<JobState> JobStatePtr;
+
+//the write time and size of the file a result names, so that a cached
+//result whose file was written over since can be told apart
+struct ResultFile
+{
+  ResultFile()
+    : Exists(false)
+    , Time(0)
+    , Size(0)
+  {
+  }
+
+  bool operator==(const ResultFile& other) const
+  {
+    return this->Exists == other.Exists && this->Time == other.Time && this->Size == other.Size;
+  }
+
+  bool Exists;
+  std::time_t Time;
+  boost::uintmax_t Size;
+};
+
+ResultFile stat_result(const std::string& result)
+{
+  ResultFile file;
+  //a result holding the mesh itself, rather than a path
+  if (result.empty() || result.size() > 4096 ||
+    result.find_first_of(std::string("\0\n", 2)) != std::string::npos)
+  {
+    return file;
+  }
+  boost::system::error_code error;
+  if (boost::filesystem::is_regular_file(result, error))
+  {
+    file.Time = boost::filesystem::last_write_time(result, error);
+    file.Size = error ? 0 : boost::filesystem::file_size(result, error);
+    file.Exists = !error;
+  }
+  return file;
+}
+
+//a result kept to answer the jobs with the same contents
+struct CachedResult
+{
+  unsigned long long Hash;
+  remus::proto::JobSubmission Submission;
+  std::string Result;
+  ResultFile File;
+};
+
+//FNV-1a, over the worker name and every key and content of the submission
+void hash_bytes(unsigned long long& hash, const char* data, std::size_t size)
+{
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+}
+
+unsigned long long hash_submission(const remus::proto::JobSubmission& submission)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  const std::string& name = submission.requirements().workerName();
+  hash_bytes(hash, name.data(), name.size());
+  typedef remus::proto::JobSubmission::const_iterator IteratorType;
+  for (IteratorType i = submission.begin(); i != submission.end(); ++i)
+  {
+    const std::size_t size = i->second.dataSize();
+    hash_bytes(hash, i->first.data(), i->first.size());
+    hash_bytes(hash, reinterpret_cast<const char*>(&size), sizeof(size));
+    hash_bytes(hash, i->second.data(), size);
+  }
+  return hash;
+}
+
+#ifdef CMB_MESH_JOB_POOL_TETGEN
+//TetGen keeps global state as well (exactinit sets up the globals of its
+//predicates), so it also meshes a single job at a time
+std::mutex TetGenMutex;
+
+bool mesh_tetgen(
+  const remus::worker::Job& job, MeshJobReporter& reporter, remus::proto::JobResult& result)
+{
+  std::lock_guard<std::mutex> lock(TetGenMutex);
+  return TetGenWorker::mesh(job, reporter, result);
+}
+#endif
+
+#ifdef CMB_MESH_JOB_POOL_TRIANGLE
+//Triangle keeps global state (exactinit, randomseed), so it meshes a
+//single job at a time
+std::mutex TriangleMutex;
+
+bool mesh_triangle(
+  const remus::worker::Job& job, MeshJobReporter& reporter, remus::proto::JobResult& result)
+{
+  std::lock_guard<std::mutex> lock(TriangleMutex);
+  return TriangleWorker::mesh(job, reporter, result);
+}
+#endif
+
+bool same_submission(const remus::proto::JobSubmission& a, const remus::proto::JobSubmission& b)
+{
+  if (a.requirements().workerName() != b.requirements().workerName() || a.size() != b.size())
+  {
+    return false;
+  }
+  typedef remus::proto::JobSubmission::const_iterator IteratorType;
+  for (IteratorType i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j)
+  {
+    const std::size_t size = i->second.dataSize();
+    if (i->first != j->first || size != j->second.dataSize() ||
+      (size > 0 && std::memcmp(i->second.data(), j->second.data(), size) != 0))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+struct cmbMeshJobPool::Internals
+{
+  mutable std::mutex Mutex;
+  std::condition_variable JobQueued;
+  mutable std::condition_variable JobDone;
+  bool Stopping;
+
+  std::vector<std::thread> Threads;
+  std::map<std::string, Mesher> Meshers;
+  //a failed job is dropped once its status is reported, which jobStatus
+  //and waitForJob do as well
+  mutable std::map<boost::uuids::uuid, JobStatePtr> Jobs;
+  std::deque<JobStatePtr> Queue;
+  boost::uuids::random_generator GenerateId;
+
+  //the most recently used first
+  std::list<CachedResult> Cache;
+  std::size_t CacheSize;
+
+  Internals()
+    : Stopping(false)
+    , CacheSize(16)
+  {
+  }
+
+  static void run(Internals* self) { self->meshQueuedJobs(); }
+
+  void meshQueuedJobs()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    while (true)
+    {
+      while (!this->Stopping && this->Queue.empty())
+      {
+        this->JobQueued.wait(lock);
+      }
+      if (this->Stopping)
+      {
+        return;
+      }
+      JobStatePtr state = this->Queue.front();
+      this->Queue.pop_front();
+      state->Status = remus::IN_PROGRESS;
+
+      lock.unlock();
+      this->mesh(state);
+      lock.lock();
+      this->JobDone.notify_all();
+    }
+  }
+
+  void mesh(const JobStatePtr& state);
+
+  //a result whose file changed since it was cached is dropped
+  bool findCachedResult(const remus::proto::JobSubmission& submission, unsigned long long hash,
+    std::string& result)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    for (std::list<CachedResult>::iterator i = this->Cache.begin(); i != this->Cache.end(); ++i)
+    {
+      if (i->Hash == hash && same_submission(i->Submission, submission))
+      {
+        if (i->File.Exists && !(stat_result(i->Result) == i->File))
+        {
+          this->Cache.erase(i);
+          return false;
+        }
+        result = i->Result;
+        this->Cache.splice(this->Cache.begin(), this->Cache, i);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //the mutex has to be locked
+  void cacheResult(const JobState& state, unsigned long long hash, const ResultFile& file)
+  {
+    if (this->CacheSize == 0)
+    {
+      return;
+    }
+    CachedResult entry;
+    entry.Hash = hash;
+    entry.Submission = state.Submission;
+    entry.Result = state.Result;
+    entry.File = file;
+    this->Cache.push_front(entry);
+    this->trimCache();
+  }
+
+  void trimCache()
+  {
+    while (this->Cache.size() > this->CacheSize)
+    {
+      this->Cache.pop_back();
+    }
+  }
+
+  remus::proto::JobStatus status(const remus::proto::Job& job) const
+  {
+    std::map<boost::uuids::uuid, JobStatePtr>::const_iterator i = this->Jobs.find(job.id());
+    if (i == this->Jobs.end())
+    {
+      return remus::proto::JobStatus(job.id(), remus::INVALID_STATUS);
+    }
+    const JobState& state = *i->second;
+    if (state.Message.empty() || state.Status == remus::QUEUED || state.Status == remus::FINISHED)
+    {
+      return remus::proto::JobStatus(job.id(), state.Status);
+    }
+    //a status with a message is IN_PROGRESS, so failures have to be marked
+    remus::proto::JobStatus status(job.id(), remus::proto::JobProgress(state.Message));
+    if (state.Status == remus::FAILED)
+    {
+      status.markAsFailed();
+    }
+    return status;
+  }
+
+  //the status of a job, forgetting it if it failed
+  remus::proto::JobStatus report(const remus::proto::Job& job) const
+  {
+    const remus::proto::JobStatus status = this->status(job);
+    if (status.failed())
+    {
+      this->Jobs.erase(job.id());
+    }
+    return status;
+  }
+};
+
+namespace
+{
+//keeps the reports of a mesher in the state of its job
+class PoolReporter : public MeshJobReporter
+{
+public:
+  PoolReporter(std::mutex& mutex, JobState& state)
+    : Mutex(mutex)
+    , State(state)
+    , Failed(false)
+  {
+  }
+
+  void progress(const std::string& message) override
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    if (this->State.Status == remus::IN_PROGRESS)
+    {
+      this->State.Message = message;
+    }
+  }
+
+  void failed(const std::string& reason) override
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Failed = true;
+    this->Reason = reason;
+  }
+
+  bool cancelled() const override { return this->State.Cancelled; }
+
+  bool hasFailed() const { return this->Failed; }
+  const std::string& reason() const { return this->Reason; }
+
+private:
+  std::mutex& Mutex;
+  JobState& State;
+  bool Failed;
+  std::string Reason;
+};
+}
+
+void cmbMeshJobPool::Internals::mesh(const JobStatePtr& state)
+{
+  const unsigned long long hash = hash_submission(state->Submission);
+  std::string cached;
+  if (this->findCachedResult(state->Submission, hash, cached))
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    if (state->Status == remus::IN_PROGRESS)
+    {
+      state->Result.swap(cached);
+      state->Status = remus::FINISHED;
+    }
+    return;
+  }
+
+  const remus::worker::Job job(state->Job.id(), state->Submission);
+  PoolReporter reporter(this->Mutex, *state);
+  remus::proto::JobResult result = remus::proto::make_JobResult(job.id(), std::string());
+  bool meshed = false;
+  try
+  {
+    meshed = state->Mesher(job, reporter, result);
+  }
+  catch (...)
+  {
+    reporter.failed("The mesher crashed");
+  }
+  const std::string meshedResult(result.data(), result.dataSize());
+  const ResultFile file = stat_result(meshedResult);
+
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  if (state->Status != remus::IN_PROGRESS)
+  {
+    //terminated while meshing
+    return;
+  }
+  if (meshed && !reporter.hasFailed())
+  {
+    state->Result = meshedResult;
+    state->Status = remus::FINISHED;
+    state->Message.clear();
+    this->cacheResult(*state, hash, file);
+  }
+  else
+  {
+    state->Status = remus::FAILED;
+    state->Message = reporter.reason();
+  }
+}
+
+cmbMeshJobPool::cmbMeshJobPool(unsigned int numberOfThreads)
+  : Internal(new Internals())
+{
+  if (numberOfThreads == 0)
+  {
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (unsigned int i = 0; i < numberOfThreads; ++i)
+  {
+    this->Internal->Threads.push_back(std::thread(&Internals::run, this->Internal));
+  }
+}
+
+cmbMeshJobPool::~cmbMeshJobPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+    this->Internal->Stopping = true;
+    typedef std::map<boost::uuids::uuid, JobStatePtr>::iterator IteratorType;
+    for (IteratorType i = this->Internal->Jobs.begin(); i != this->Internal->Jobs.end(); ++i)
+    {
+      i->second->Cancelled = true;
+    }
+  }
+  this->Internal->JobQueued.notify_all();
+  for (std::size_t i = 0; i < this->Internal->Threads.size(); ++i)
+  {
+    this->Internal->Threads[i].join();
+  }
+  delete this->Internal;
+}
+
+unsigned int cmbMeshJobPool::numberOfThreads() const
+{
+  return static_cast<unsigned int>(this->Internal->Threads.size());
+}
+
+void cmbMeshJobPool::registerMesher(const std::string& workerName, Mesher mesher)
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  this->Internal->Meshers[workerName] = mesher;
+}
+
+void cmbMeshJobPool::registerBuiltinMeshers()
+{
+#ifdef CMB_MESH_JOB_POOL_TETGEN
+  this->registerMesher("CMBMeshTetGenWorker", &mesh_tetgen);
+#endif
+#ifdef CMB_MESH_JOB_POOL_TRIANGLE
+  this->registerMesher("CMBMeshTriangleWorker", &mesh_triangle);
+#endif
+}
+
+bool cmbMeshJobPool::canMesh(const remus::proto::JobRequirements& reqs) const
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  return this->Internal->Meshers.count(reqs.workerName()) > 0;
+}
+
+remus::proto::Job cmbMeshJobPool::submitJob(const remus::proto::JobSubmission& submission)
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  const remus::proto::Job job(this->Internal->GenerateId(), submission.type());
+  JobStatePtr state(new JobState(job, submission));
+  this->Internal->Jobs[job.id()] = state;
+
+  std::map<std::string, Mesher>::const_iterator mesher =
+    this->Internal->Meshers.find(submission.requirements().workerName());
+  if (mesher == this->Internal->Meshers.end())
+  {
+    state->Status = remus::FAILED;
+    state->Message = "No mesher for " + submission.requirements().workerName();
+    return job;
+  }
+  state->Mesher = mesher->second;
+  this->Internal->Queue.push_back(state);
+  this->Internal->JobQueued.notify_one();
+  return job;
+}
+
+remus::proto::JobStatus cmbMeshJobPool::jobStatus(const remus::proto::Job& job) const
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  return this->Internal->report(job);
+}
+
+remus::proto::JobStatus cmbMeshJobPool::waitForJob(const remus::proto::Job& job) const
+{
+  std::unique_lock<std::mutex> lock(this->Internal->Mutex);
+  remus::proto::JobStatus status = this->Internal->status(job);
+  while (status.queued() || status.inProgress())
+  {
+    this->Internal->JobDone.wait(lock);
+    status = this->Internal->status(job);
+  }
+  return this->Internal->report(job);
+}
+
+remus::proto::JobResult cmbMeshJobPool::retrieveResults(const remus::proto::Job& job)
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  std::map<boost::uuids::uuid, JobStatePtr>::iterator i = this->Internal->Jobs.find(job.id());
+  if (i == this->Internal->Jobs.end() || i->second->Status != remus::FINISHED)
+  {
+    if (i != this->Internal->Jobs.end() && i->second->Status == remus::FAILED)
+    {
+      this->Internal->Jobs.erase(i);
+    }
+    return remus::proto::make_JobResult(job.id(), std::string());
+  }
+  const remus::proto::JobResult result = remus::proto::make_JobResult(job.id(), i->second->Result);
+  this->Internal->Jobs.erase(i);
+  return result;
+}
+
+remus::proto::JobStatus cmbMeshJobPool::terminate(const remus::proto::Job& job)
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  std::map<boost::uuids::uuid, JobStatePtr>::iterator i = this->Internal->Jobs.find(job.id());
+  if (i != this->Internal->Jobs.end())
+  {
+    JobState& state = *i->second;
+    if (state.Status == remus::QUEUED || state.Status == remus::IN_PROGRESS)
+    {
+      std::deque<JobStatePtr>& queue = this->Internal->Queue;
+      queue.erase(std::remove(queue.begin(), queue.end(), i->second), queue.end());
+      state.Cancelled = true;
+      state.Status = remus::FAILED;
+      state.Message = "Terminated";
+      this->Internal->JobDone.notify_all();
+    }
+  }
+  return this->Internal->report(job);
+}
+
+void cmbMeshJobPool::setCacheSize(std::size_t numberOfResults)
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  this->Internal->CacheSize = numberOfResults;
+  this->Internal->trimCache();
+}
+
+std::size_t cmbMeshJobPool::cacheSize() const
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  return this->Internal->CacheSize;
+}
+
+void cmbMeshJobPool::clearCache()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  this->Internal->Cache.clear();
+}
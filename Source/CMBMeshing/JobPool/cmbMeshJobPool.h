@@ -0,0 +1,112 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// .NAME cmbMeshJobPool
+// .SECTION Description
+// Runs mesh jobs in process on a pool of threads, without a remus server
+// or worker processes. It takes the same JobSubmission contents as the
+// remus workers, and has the interface of remus::client::Client for
+// submitting jobs, polling their status, fetching their results and
+// terminating them.
+//
+// Each worker name is meshed by a registered Mesher function, the static
+// mesh() of the worker class (TetGenWorker::mesh), which reports its
+// progress to the pool. Several jobs are meshed at once, one per thread, in
+// the order they are submitted. A failed job is forgotten once its status
+// has been reported.
+//
+// The results of the last jobs are kept, and a job with the same worker
+// name and contents as one of them is answered from that cache instead of
+// being meshed again. A result naming a file, like the mesh file of
+// TetGen, is dropped from the cache when that file has changed since.
+// .SECTION Caveats
+// The applications still submit their jobs to a remus server, the pool is
+// only used by code linking CMBMeshJobPool.
+//
+// A terminated job that is already meshing is only stopped at the next
+// step of its mesher, its result is then dropped.
+//
+// TetGen keeps global state as well, so the builtin TetGen mesher meshes
+// one job at a time, next to the jobs of the other meshers.
+//
+// Triangle calls exit() when it fails, which would end the whole
+// application, and keeps global state, so its jobs are left to the remus
+// Triangle worker process. It is only registered by registerBuiltinMeshers
+// when the pool is built with MESH_JOB_POOL_TRIANGLE, and then meshes one
+// job at a time.
+
+#ifndef cmbMeshJobPool_h
+#define cmbMeshJobPool_h
+
+#include <cstddef>
+#include <string>
+
+#include <remus/proto/Job.h>
+#include <remus/proto/JobRequirements.h>
+#include <remus/proto/JobResult.h>
+#include <remus/proto/JobStatus.h>
+#include <remus/proto/JobSubmission.h>
+#include <remus/worker/Job.h>
+
+class MeshJobReporter;
+
+class cmbMeshJobPool
+{
+public:
+  //meshes a job, see TetGenWorker::mesh
+  typedef bool (*Mesher)(
+    const remus::worker::Job& job, MeshJobReporter& reporter, remus::proto::JobResult& result);
+
+  //a numberOfThreads of 0 uses a thread per core
+  explicit cmbMeshJobPool(unsigned int numberOfThreads = 0);
+
+  //terminates the queued jobs, and waits for the running ones
+  ~cmbMeshJobPool();
+
+  unsigned int numberOfThreads() const;
+
+  //mesh the jobs whose requirements have this worker name with mesher
+  void registerMesher(const std::string& workerName, Mesher mesher);
+
+  //register the meshers that were built with the pool and can run in
+  //process (TetGen, and Triangle with MESH_JOB_POOL_TRIANGLE)
+  void registerBuiltinMeshers();
+
+  bool canMesh(const remus::proto::JobRequirements& reqs) const;
+
+  //queue a job. A job without a mesher for its worker name fails
+  remus::proto::Job submitJob(const remus::proto::JobSubmission& submission);
+
+  remus::proto::JobStatus jobStatus(const remus::proto::Job& job) const;
+
+  //wait until the job is finished or failed, and return its status
+  remus::proto::JobStatus waitForJob(const remus::proto::Job& job) const;
+
+  //the result of a finished job, which is then no longer tracked by the
+  //pool. The result is empty if the job isn't finished.
+  remus::proto::JobResult retrieveResults(const remus::proto::Job& job);
+
+  //stop a job, which is failed from then on
+  remus::proto::JobStatus terminate(const remus::proto::Job& job);
+
+  //the number of results kept to answer identical jobs, 0 disables the
+  //cache. Defaults to 16.
+  void setCacheSize(std::size_t numberOfResults);
+  std::size_t cacheSize() const;
+  void clearCache();
+
+private:
+  struct Internals;
+  Internals* Internal;
+
+  cmbMeshJobPool(const cmbMeshJobPool&); // Not implemented.
+  void operator=(const cmbMeshJobPool&); // Not implemented.
+};
+
+#endif
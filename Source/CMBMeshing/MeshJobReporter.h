@@ -0,0 +1,33 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+
+#ifndef CMBMeshing_MeshJobReporter_h
+#define CMBMeshing_MeshJobReporter_h
+
+#include <string>
+
+//Where a mesher reports the progress of the job it is meshing, and learns
+//if it should stop. The remus workers forward the reports to the remus
+//server, the in process cmbMeshJobPool keeps them for its clients.
+class MeshJobReporter
+{
+public:
+  virtual ~MeshJobReporter() {}
+
+  virtual void progress(const std::string& message) = 0;
+
+  //the job can't be meshed, the mesher returns after reporting it
+  virtual void failed(const std::string& reason) = 0;
+
+  //true once the job is terminated, the mesher checks it between its steps
+  virtual bool cancelled() const { return false; }
+};
+
+#endif
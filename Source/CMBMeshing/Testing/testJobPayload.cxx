@@ -0,0 +1,146 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Round trips arrays through payload::Writer and payload::Reader, and checks
+// that the Reader rejects the payloads whose sections don't fit, in
+// particular when the size of a section overflows 64 bits.
+#include "JobPayload.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+  if (!condition)
+  {
+    std::cerr << "Failed: " << what << std::endl;
+    ++failures;
+  }
+}
+
+//overwrite a field of the entry of section i
+void setEntry(std::string& data, std::size_t i, std::size_t field, payload::uint64 value)
+{
+  char* entry = &data[payload::HeaderSize + payload::SectionEntrySize * i];
+  if (field < 8)
+  {
+    const payload::uint32 value32 = static_cast<payload::uint32>(value);
+    std::memcpy(entry + field, &value32, 4);
+  }
+  else
+  {
+    std::memcpy(entry + field, &value, 8);
+  }
+}
+}
+
+int main(int, char* [])
+{
+  std::vector<double> points;
+  for (int i = 0; i < 30; ++i)
+  {
+    points.push_back(0.5 * i);
+  }
+  std::vector<int> cells;
+  for (int i = 0; i < 12; ++i)
+  {
+    cells.push_back(i % 10);
+  }
+  std::vector<unsigned char> flags(7, 3);
+
+  payload::Writer writer;
+  writer.add(&points[0], 10, 3);
+  writer.add(&cells[0], 4, 3);
+  writer.add(&flags[0], 7);
+  writer.add(static_cast<const float*>(NULL), 0);
+  const std::string data = writer.str();
+  check(data.size() == writer.size(), "the written size");
+  check(data.size() % payload::Alignment == 0, "the payload is padded");
+
+  payload::Reader reader(data.data(), data.size());
+  check(reader.valid(), "the payload is read back");
+  check(reader.numberOfSections() == 4, "the number of sections");
+  check(reader.numberOfValues(0) == 30 && reader.numberOfValues(1) == 12 &&
+      reader.numberOfValues(2) == 7 && reader.numberOfValues(3) == 0,
+    "the number of values");
+
+  //in place when the type matches, and copied when it doesn't
+  const double* view = NULL;
+  payload::uint64 numValues = 0;
+  if (reinterpret_cast<std::size_t>(data.data()) % sizeof(double) == 0)
+  {
+    check(reader.view(0, view, numValues) && numValues == 30 &&
+        std::equal(points.begin(), points.end(), view),
+      "the points are used in place");
+  }
+  check(!reader.view(1, view, numValues), "no view of another type");
+  std::vector<int> readCells;
+  check(reader.read(1, readCells) && readCells == cells, "the cells are read back");
+  std::vector<double> readFlags;
+  check(reader.read(2, readFlags) && readFlags.size() == 7 && readFlags[6] == 3.0,
+    "the flags are converted");
+  std::vector<float> empty(1);
+  check(reader.read(3, empty) && empty.empty(), "an empty section");
+  check(!reader.read(4, readCells), "no section past the end");
+
+  //sections that don't fit the payload
+  {
+    std::string bad = data;
+    setEntry(bad, 2, 16, bad.size()); // past the end of the payload
+    check(!payload::Reader(bad.data(), bad.size()).valid(), "a section past the end");
+  }
+  {
+    //8 * 3 * numTuples wraps around to a small number of bytes
+    std::string bad = data;
+    setEntry(bad, 0, 16, (~0ULL / 24) + 2);
+    check(!payload::Reader(bad.data(), bad.size()).valid(), "a section size that overflows");
+  }
+  {
+    std::string bad = data;
+    setEntry(bad, 1, 4, 0xffffffffULL);
+    setEntry(bad, 1, 16, 1ULL << 62);
+    check(!payload::Reader(bad.data(), bad.size()).valid(), "a component count that overflows");
+  }
+  {
+    //counts that each fit a large payload, but whose product wraps to 0
+    //bytes; the Reader only looks at the header, so the size can be faked
+    std::string bad = data;
+    setEntry(bad, 0, 4, 1ULL << 31);
+    setEntry(bad, 0, 16, 1ULL << 33);
+    check(!payload::Reader(bad.data(), static_cast<std::size_t>(1ULL << 40)).valid(),
+      "a section size that wraps to 0");
+  }
+  {
+    std::string bad = data;
+    setEntry(bad, 2, 8, ~0ULL);
+    check(!payload::Reader(bad.data(), bad.size()).valid(), "an offset past the end");
+  }
+  {
+    std::string bad = data;
+    setEntry(bad, 2, 0, 99);
+    check(!payload::Reader(bad.data(), bad.size()).valid(), "an unknown type");
+  }
+  {
+    std::string bad = data;
+    const payload::uint32 numSections = 0xffffffff;
+    std::memcpy(&bad[12], &numSections, 4);
+    check(!payload::Reader(bad.data(), bad.size()).valid(), "too many sections");
+  }
+  check(!payload::Reader(data.data(), payload::HeaderSize - 1).valid(), "a truncated header");
+  check(!payload::Reader("not a payload", 14).valid(), "the older formats");
+
+  return failures == 0 ? 0 : 1;
+}
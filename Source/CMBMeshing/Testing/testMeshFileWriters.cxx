@@ -0,0 +1,256 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Splits a grid of cubes into tetrahedra, and checks the KnownFaces hash
+// table against a std::map of its faces, and the .3dm and .bc files
+// written in chunks, on one thread and on several, against the files
+// written a line at a time with an ofstream.
+#include "KnownFaces.h"
+#include "MeshFileWriters.h"
+
+#include "vtkMultiThreader.h"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+int failures = 0;
+
+void check(bool condition, const std::string& what)
+{
+  if (!condition)
+  {
+    std::cerr << "Failed: " << what << std::endl;
+    ++failures;
+  }
+}
+
+const int lookupTable[4][3] = {
+  { 0, 1, 2 }, { 1, 3, 2 }, { 0, 3, 2 }, { 0, 1, 3 },
+};
+
+const int tetFaceSideTable[4] = { 4, 1, 2, 3 };
+
+//n^3 cubes, each split into the 6 tetrahedra around its diagonal, with a
+//material per layer of cubes (some of them not whole numbers)
+void makeMesh(int n, tetgenio& output)
+{
+  const int np = n + 1;
+  output.numberofpoints = np * np * np;
+  output.pointlist = new REAL[3 * output.numberofpoints];
+  for (int k = 0, i = 0; k < np; ++k)
+  {
+    for (int j = 0; j < np; ++j)
+    {
+      for (int l = 0; l < np; ++l, ++i)
+      {
+        output.pointlist[3 * i] = 0.37 * l - 4.1 + 0.01 * std::sin(0.3 * (j + k));
+        output.pointlist[3 * i + 1] = -123.456 * j + 0.5 * k;
+        output.pointlist[3 * i + 2] = 1024.0 * k / 3.0;
+      }
+    }
+  }
+
+  const int cube[6][4] = { { 0, 1, 3, 7 }, { 0, 3, 2, 7 }, { 0, 2, 6, 7 }, { 0, 6, 4, 7 },
+    { 0, 4, 5, 7 }, { 0, 5, 1, 7 } };
+  output.numberoftetrahedra = 6 * n * n * n;
+  output.numberoftetrahedronattributes = 1;
+  output.tetrahedronlist = new int[4 * output.numberoftetrahedra];
+  output.tetrahedronattributelist = new REAL[output.numberoftetrahedra];
+  int t = 0;
+  for (int k = 0; k < n; ++k)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      for (int l = 0; l < n; ++l)
+      {
+        int corners[8];
+        for (int c = 0; c < 8; ++c)
+        {
+          corners[c] = (l + (c & 1)) + np * ((j + ((c >> 1) & 1)) + np * (k + ((c >> 2) & 1)));
+        }
+        for (int c = 0; c < 6; ++c, ++t)
+        {
+          for (int v = 0; v < 4; ++v)
+          {
+            output.tetrahedronlist[4 * t + v] = corners[cube[c][v]];
+          }
+          output.tetrahedronattributelist[t] = 1 + k % 3 + (k % 2 ? 0.7 : 0.0);
+        }
+      }
+    }
+  }
+}
+
+//faces of every 5th tetrahedron, some of them added twice with other ids,
+//given to both the hash table and the map
+void addFaces(const tetgenio& output, detail::KnownFaces& knownFaces,
+  std::map<detail::Face, detail::Face>& expected)
+{
+  int faceId = 0;
+  for (int i = 0; i < output.numberoftetrahedra; i += 5)
+  {
+    const int* tet = output.tetrahedronlist + 4 * i;
+    for (int f = 0; f < 4; ++f)
+    {
+      if ((i + f) % 3 == 0)
+      {
+        continue;
+      }
+      const int repeats = (i + f) % 7 == 0 ? 2 : 1;
+      for (int r = 0; r < repeats; ++r, ++faceId)
+      {
+        const detail::Face face(tet[lookupTable[f][0]], tet[lookupTable[f][1]],
+          tet[lookupTable[f][2]], faceId, faceId % 11);
+        knownFaces.add(face);
+        expected[face] = face;
+      }
+    }
+  }
+}
+
+void checkKnownFaces(const tetgenio& output, const detail::KnownFaces& knownFaces,
+  const std::map<detail::Face, detail::Face>& expected)
+{
+  check(knownFaces.size() == expected.size(), "the number of known faces");
+  for (int i = 0; i < output.numberoftetrahedra; ++i)
+  {
+    const int* tet = output.tetrahedronlist + 4 * i;
+    for (int f = 0; f < 4; ++f)
+    {
+      const detail::Face face(tet[lookupTable[f][0]], tet[lookupTable[f][1]],
+        tet[lookupTable[f][2]]);
+      std::map<detail::Face, detail::Face>::const_iterator it = expected.find(face);
+      const detail::Face found = knownFaces.get(face);
+      if (it == expected.end())
+      {
+        check(!knownFaces.exists(face) && !found.valid(), "an unknown face isn't found");
+      }
+      else
+      {
+        check(knownFaces.exists(face) && found == face && found.faceId == it->second.faceId &&
+            found.surfaceId == it->second.surfaceId,
+          "a known face is found, with the ids added last");
+      }
+    }
+  }
+}
+
+//the .3dm file, a line at a time
+void write3dmReference(const std::string& path, const tetgenio& output)
+{
+  std::ofstream outputFile(path.c_str(), std::ios::out);
+  outputFile << "MESH3D" << std::endl;
+  for (int i = 0; i < output.numberoftetrahedra; ++i)
+  {
+    const int material_id(static_cast<int>(output.tetrahedronattributelist[i]));
+    outputFile << "E4T \t " << std::setw(8) << 1 + i << " " << std::setw(8)
+               << 1 + output.tetrahedronlist[4 * i] << " " << std::setw(8)
+               << 1 + output.tetrahedronlist[(4 * i) + 1] << " " << std::setw(8)
+               << 1 + output.tetrahedronlist[(4 * i) + 2] << " " << std::setw(8)
+               << 1 + output.tetrahedronlist[(4 * i) + 3] << " " << std::setw(8) << material_id
+               << std::endl;
+  }
+  for (int i = 0; i < output.numberofpoints; ++i)
+  {
+    outputFile << "ND \t " << std::setw(8) << 1 + i << " " << std::fixed << std::setw(12)
+               << output.pointlist[3 * i] << " " << std::setw(12) << output.pointlist[(3 * i) + 1]
+               << " " << std::setw(12) << output.pointlist[(3 * i) + 2] << std::endl;
+  }
+  outputFile << "END" << std::endl;
+}
+
+//the .bc file, a line at a time
+void writeBCReference(
+  const std::string& path, const detail::KnownFaces& knownFaces, const tetgenio& output)
+{
+  std::ofstream outputFile(path.c_str(), std::ios::out);
+  for (int i = 0; i < output.numberoftetrahedra; ++i)
+  {
+    const int* tet = output.tetrahedronlist + 4 * i;
+    for (int f = 0; f < 4; ++f)
+    {
+      const int id1 = tet[lookupTable[f][0]];
+      const int id2 = tet[lookupTable[f][1]];
+      const int id3 = tet[lookupTable[f][2]];
+      const detail::Face faceWithInfo = knownFaces.get(detail::Face(id1, id2, id3));
+      if (faceWithInfo.valid())
+      {
+        outputFile << "FCS " << 1 + i << " " << tetFaceSideTable[f] << " " << faceWithInfo.faceId
+                   << " " << 1 + id1 << " " << 1 + id2 << " " << 1 + id3 << " "
+                   << 1 + faceWithInfo.surfaceId << std::endl;
+      }
+    }
+  }
+}
+
+std::string readFile(const std::string& path)
+{
+  std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+void checkFiles(const std::string& directory, const std::string& name,
+  const tetgenio& output, const detail::KnownFaces& knownFaces)
+{
+  const std::string path3dm = directory + "/meshFileWriters" + name + ".3dm";
+  const std::string pathBC = directory + "/meshFileWriters" + name + ".bc";
+  check(detail::write_3dm_file(path3dm, output), name + ": writing the .3dm file");
+  check(detail::write_bc_file(pathBC, knownFaces, output), name + ": writing the .bc file");
+
+  const std::string reference3dm = directory + "/meshFileWritersReference.3dm";
+  const std::string referenceBC = directory + "/meshFileWritersReference.bc";
+  check(readFile(path3dm) == readFile(reference3dm), name + ": the .3dm file");
+  check(readFile(pathBC) == readFile(referenceBC), name + ": the .bc file");
+}
+}
+
+int main(int argc, char* argv[])
+{
+  const std::string directory = argc > 1 ? argv[1] : ".";
+
+  //more tetrahedra and points than fit in a chunk of the writers
+  tetgenio output;
+  makeMesh(26, output);
+
+  detail::KnownFaces knownFaces;
+  std::map<detail::Face, detail::Face> expected;
+  addFaces(output, knownFaces, expected);
+  checkKnownFaces(output, knownFaces, expected);
+
+  //a table made big enough up front holds the same faces
+  detail::KnownFaces reserved;
+  reserved.reserve(expected.size());
+  std::map<detail::Face, detail::Face> expectedReserved;
+  addFaces(output, reserved, expectedReserved);
+  checkKnownFaces(output, reserved, expected);
+
+  write3dmReference(directory + "/meshFileWritersReference.3dm", output);
+  writeBCReference(directory + "/meshFileWritersReference.bc", knownFaces, output);
+
+  const int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+  checkFiles(directory, "Serial", output, knownFaces);
+
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(4);
+  checkFiles(directory, "Threaded", output, knownFaces);
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+
+  return failures == 0 ? 0 : 1;
+}
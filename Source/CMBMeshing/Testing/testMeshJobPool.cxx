@@ -0,0 +1,223 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Meshes a few cubes with TetGen in a cmbMeshJobPool, and checks that a
+// job with the same contents as an earlier one is answered from the cache
+// as long as its mesh file is unchanged, that jobs meshing the same model
+// write their own files, that queued and running jobs can be terminated,
+// and that inconsistent payloads fail.
+#include "cmbMeshJobPool.h"
+
+#include "JobPayload.h"
+#include "MeshJobReporter.h"
+
+#include <remus/common/MeshIOType.h>
+#include <remus/proto/JobContent.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+  if (!condition)
+  {
+    std::cerr << "Failed: " << what << std::endl;
+    ++failures;
+  }
+}
+
+remus::proto::JobRequirements tetGenRequirements()
+{
+  return remus::proto::make_JobRequirements(
+    remus::common::make_MeshIOType(
+      remus::meshtypes::PiecewiseLinearComplex(), remus::meshtypes::Mesh3D()),
+    "CMBMeshTetGenWorker", "");
+}
+
+remus::proto::JobRequirements blockingRequirements()
+{
+  return remus::proto::make_JobRequirements(
+    remus::common::make_MeshIOType(remus::meshtypes::Edges(), remus::meshtypes::Mesh2D()),
+    "BlockingWorker", "");
+}
+
+enum Defect
+{
+  NoDefect,
+  ExtraClassification, //one more classified cell than there are triangles
+  PointOutOfRange      //a triangle referencing a point past the last one
+};
+
+//the surface of a cube of the given size, one facet marker per side, and a
+//single region inside it
+remus::proto::JobSubmission cubeJob(
+  const std::string& directory, int index, double size, Defect defect = NoDefect)
+{
+  const double points[24] = { 0, 0, 0, size, 0, 0, size, size, 0, 0, size, 0, 0, 0, size, size,
+    0, size, size, size, size, 0, size, size };
+  int cells[48] = { 3, 0, 2, 1, 3, 0, 3, 2, 3, 4, 5, 6, 3, 4, 6, 7, 3, 0, 1, 5, 3, 0, 5, 4, 3, 3,
+    7, 6, 3, 3, 6, 2, 3, 0, 4, 7, 3, 0, 7, 3, 3, 1, 2, 6, 3, 1, 6, 5 };
+  const int classification[13] = { 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 6 };
+  const double region[4] = { 1, size / 2, size / 2, size / 2 };
+  if (defect == PointOutOfRange)
+  {
+    cells[47] = 8;
+  }
+
+  payload::Writer writer;
+  writer.add(points, 8, 3);
+  writer.add(cells, 12, 4);
+  writer.add(classification, defect == ExtraClassification ? 13 : 12);
+  writer.add(region, 1, 4);
+
+  std::ostringstream path;
+  path << directory << "/meshJobPoolCube" << index << ".cmb";
+
+  remus::proto::JobSubmission submission(tetGenRequirements());
+  //no attributes, so tetgen runs with the default flags
+  submission["instance"] = remus::proto::make_JobContent(std::string());
+  submission["model_file_path"] = remus::proto::make_JobContent(path.str());
+  submission["discrete_mesh"] = remus::proto::make_JobContent(writer.str());
+  return submission;
+}
+
+std::string resultOf(const remus::proto::JobResult& result)
+{
+  return std::string(result.data(), result.dataSize());
+}
+
+std::string contentsOf(const std::string& path)
+{
+  std::ifstream file(path.c_str());
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+//fails every job, to tell a cached result from a meshed one
+bool failingMesher(const remus::worker::Job&, MeshJobReporter& reporter, remus::proto::JobResult&)
+{
+  reporter.failed("Not answered from the cache");
+  return false;
+}
+
+std::atomic<int> blockingJobsStarted(0);
+
+//meshes until the job is terminated
+bool blockingMesher(const remus::worker::Job&, MeshJobReporter& reporter, remus::proto::JobResult&)
+{
+  ++blockingJobsStarted;
+  reporter.progress("Blocking");
+  while (!reporter.cancelled())
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  reporter.failed("Terminated");
+  return false;
+}
+
+void waitUntilStarted(int numberOfJobs)
+{
+  while (blockingJobsStarted < numberOfJobs)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+}
+
+int main(int argc, char* argv[])
+{
+  const std::string directory = argc > 1 ? argv[1] : ".";
+
+  cmbMeshJobPool pool(2);
+  pool.registerBuiltinMeshers();
+  check(pool.canMesh(tetGenRequirements()), "TetGen is a builtin mesher");
+  pool.registerMesher("BlockingWorker", &blockingMesher);
+
+  //a few TetGen jobs, queued on both threads (TetGen meshes one at a time)
+  std::vector<remus::proto::JobSubmission> submissions;
+  std::vector<remus::proto::Job> jobs;
+  for (int i = 0; i < 3; ++i)
+  {
+    submissions.push_back(cubeJob(directory, i, 1.0 + i));
+    jobs.push_back(pool.submitJob(submissions.back()));
+  }
+  std::vector<std::string> results;
+  for (std::size_t i = 0; i < jobs.size(); ++i)
+  {
+    check(pool.waitForJob(jobs[i]).finished(), "a TetGen job is meshed");
+    results.push_back(resultOf(pool.retrieveResults(jobs[i])));
+    check(!results.back().empty() && std::ifstream(results.back().c_str()).good(),
+      "a TetGen job writes its mesh");
+  }
+
+  //another job on the model of the first one doesn't write over its mesh
+  const std::string firstMesh = contentsOf(results[0]);
+  remus::proto::Job sameModel = pool.submitJob(cubeJob(directory, 0, 3.0));
+  check(pool.waitForJob(sameModel).finished(), "a job on the same model is meshed");
+  const std::string sameModelResult = resultOf(pool.retrieveResults(sameModel));
+  check(!sameModelResult.empty() && sameModelResult != results[0],
+    "a job on the same model writes its own mesh");
+  check(contentsOf(results[0]) == firstMesh, "the mesh of the first job is kept");
+
+  //inconsistent payloads are rejected before tetgen sees them
+  remus::proto::Job extra = pool.submitJob(cubeJob(directory, 3, 1.0, ExtraClassification));
+  check(pool.waitForJob(extra).failed(), "a job with more classified cells than triangles fails");
+  remus::proto::Job outside = pool.submitJob(cubeJob(directory, 4, 1.0, PointOutOfRange));
+  check(pool.waitForJob(outside).failed(), "a job with a point id past the last point fails");
+
+  //with a mesher that fails, only a job identical to an earlier one
+  //finishes, with the earlier result
+  pool.registerMesher("CMBMeshTetGenWorker", &failingMesher);
+  remus::proto::Job cached = pool.submitJob(cubeJob(directory, 1, 2.0));
+  check(pool.waitForJob(cached).finished(), "an identical job is answered from the cache");
+  check(resultOf(pool.retrieveResults(cached)) == results[1], "the cached result");
+  remus::proto::Job changed = pool.submitJob(cubeJob(directory, 1, 4.0));
+  check(pool.waitForJob(changed).failed(), "a job with other contents is not cached");
+  std::ofstream(results[2].c_str(), std::ios::app) << "written over\n";
+  remus::proto::Job overwritten = pool.submitJob(submissions[2]);
+  check(pool.waitForJob(overwritten).failed(), "a result whose file changed is not cached");
+  pool.clearCache();
+  remus::proto::Job cleared = pool.submitJob(submissions[0]);
+  check(pool.waitForJob(cleared).failed(), "the cache is cleared");
+
+  //block both threads, so that the next job stays queued
+  remus::proto::Job running0 = pool.submitJob(remus::proto::JobSubmission(blockingRequirements()));
+  remus::proto::Job running1 = pool.submitJob(remus::proto::JobSubmission(blockingRequirements()));
+  waitUntilStarted(2);
+  remus::proto::Job queued = pool.submitJob(submissions[2]);
+  check(pool.jobStatus(queued).queued(), "a job waits for a thread");
+
+  check(pool.terminate(queued).failed(), "a queued job is terminated");
+  check(pool.terminate(running0).failed(), "a running job is terminated");
+  check(pool.jobStatus(running0).status() == remus::INVALID_STATUS,
+    "a terminated job is forgotten once reported");
+  check(pool.retrieveResults(queued).dataSize() == 0, "a terminated job has no result");
+
+  //the thread of the terminated job is free again
+  remus::proto::Job next = pool.submitJob(remus::proto::JobSubmission(blockingRequirements()));
+  waitUntilStarted(3);
+  check(pool.jobStatus(next).inProgress(), "a thread is freed by terminate");
+  check(pool.terminate(next).failed() && pool.terminate(running1).failed(),
+    "the other running jobs are terminated");
+  check(blockingJobsStarted == 3, "a terminated queued job is not meshed");
+
+  return failures == 0 ? 0 : 1;
+}
@@ -66,6 +66,9 @@ struct Face
 
   bool valid() const { return (faceId != -1); }
 
+  //a default constructed face, used for the free slots of KnownFaces
+  bool empty() const { return (p1 == -1); }
+
   //comparison operator
   bool operator<(Face b) const
   {
@@ -84,37 +87,99 @@ struct Face
 //class for TetGenWorker
 struct KnownFaces
 {
+  KnownFaces()
+    : Size(0)
+  {
+  }
+
+  //Make room for n faces, so that adding them doesn't grow the table
+  void reserve(std::size_t n)
+  {
+    std::size_t capacity = 16;
+    while (capacity < 2 * n)
+    {
+      capacity *= 2;
+    }
+    if (capacity > this->Table.size())
+    {
+      this->rehash(capacity);
+    }
+  }
 
-  //Insert a face into the vector of known faces. Does zero checks to verify
-  //that the face being added doesn't already exist in the vector
+  //Insert a face into the table of known faces. If the face is already
+  //known it is replaced, so the face added last is the one returned by get
   bool add(Face f)
   {
-    typedef std::vector<Face>::iterator It;
-    It loc = std::lower_bound(this->StoredFaces.begin(), this->StoredFaces.end(), f);
-    //insert the face
-    this->StoredFaces.insert(loc, f);
+    if (2 * (this->Size + 1) > this->Table.size())
+    {
+      this->rehash(this->Table.empty() ? 16 : 2 * this->Table.size());
+    }
+    std::size_t i = this->find(f);
+    if (this->Table[i].empty())
+    {
+      ++this->Size;
+    }
+    this->Table[i] = f;
     return true;
   }
 
   bool exists(Face f) const
-  { //the vector is sorted so we use binary_search for fast exist check
-    return std::binary_search(this->StoredFaces.begin(), this->StoredFaces.end(), f);
+  {
+    return !this->Table.empty() && !this->Table[this->find(f)].empty();
   }
 
   Face get(Face f) const
   {
-    typedef std::vector<Face>::const_iterator cIt;
-    cIt first = std::lower_bound(this->StoredFaces.begin(), this->StoredFaces.end(), f);
-    if (!(first == this->StoredFaces.end()) && (f == *first))
-    { //return first since it has the correct face and surface ids
-      return *first;
+    if (this->Table.empty())
+    {
+      return Face();
     }
-    return Face();
+    //returns an empty, invalid face if f isn't known
+    return this->Table[this->find(f)];
   }
 
+  std::size_t size() const { return this->Size; }
+
 private:
-  //keep a sorted list of faces, basically a map, but faster
-  std::vector<Face> StoredFaces;
+  static std::size_t hash(const Face& f)
+  {
+    const unsigned long long k = 0x9E3779B97F4A7C15ULL;
+    unsigned long long h = static_cast<unsigned int>(f.p1);
+    h = (h * k) ^ static_cast<unsigned int>(f.p2);
+    h = (h * k) ^ static_cast<unsigned int>(f.p3);
+    h *= k;
+    return static_cast<std::size_t>(h ^ (h >> 32));
+  }
+
+  //the slot holding f, or the empty slot where it belongs
+  std::size_t find(const Face& f) const
+  {
+    const std::size_t mask = this->Table.size() - 1;
+    std::size_t i = hash(f) & mask;
+    while (!this->Table[i].empty() && !(this->Table[i] == f))
+    {
+      i = (i + 1) & mask;
+    }
+    return i;
+  }
+
+  void rehash(std::size_t capacity)
+  {
+    std::vector<Face> old(capacity);
+    old.swap(this->Table);
+    for (std::size_t i = 0; i < old.size(); ++i)
+    {
+      if (!old[i].empty())
+      {
+        this->Table[this->find(old[i])] = old[i];
+      }
+    }
+  }
+
+  //open addressing hash table with linear probing, whose size is a power
+  //of two and is kept at most half full
+  std::vector<Face> Table;
+  std::size_t Size;
 };
 };
 
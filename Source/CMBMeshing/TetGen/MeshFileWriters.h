@@ -0,0 +1,232 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+
+#ifndef TetGen_MeshFileWriters_h
+#define TetGen_MeshFileWriters_h
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "KnownFaces.h"
+#include "tetgen.h"
+
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
+
+//writers of the .3dm and .bc files of a TetGen mesh, kept apart from
+//TetGenWorker so that they can be tested on their own
+namespace detail
+{
+
+//Formats items [0, numberOfItems) of a file in chunks on several threads,
+//and writes the chunks to the stream in order. The Formatter is called as
+//formatter(begin, end, buffer) to append the lines of items [begin, end) to
+//buffer, and has to be safe to call from several threads at once.
+template <typename Formatter>
+struct parallel_writer
+{
+  const Formatter* formatter;
+  int numberOfItems;
+  int itemsPerChunk;
+  int firstChunk;
+  std::vector<std::string> chunks;
+
+  static VTK_THREAD_RETURN_TYPE format(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    parallel_writer* self = static_cast<parallel_writer*>(info->UserData);
+    const int numChunks = static_cast<int>(self->chunks.size());
+    for (int c = info->ThreadID; c < numChunks; c += info->NumberOfThreads)
+    {
+      const int begin = (self->firstChunk + c) * self->itemsPerChunk;
+      const int end = std::min(begin + self->itemsPerChunk, self->numberOfItems);
+      self->chunks[c].clear();
+      if (begin < end)
+      {
+        (*self->formatter)(begin, end, self->chunks[c]);
+      }
+    }
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  bool write(std::ostream& stream)
+  {
+    vtkNew<vtkMultiThreader> threader;
+    const int numThreads = threader->GetNumberOfThreads();
+    const int totalChunks = (this->numberOfItems + this->itemsPerChunk - 1) / this->itemsPerChunk;
+    //only a few chunks per thread are held in memory at once
+    this->chunks.resize(std::max(1, std::min(totalChunks, 4 * numThreads)));
+    threader->SetNumberOfThreads(std::min(numThreads, static_cast<int>(this->chunks.size())));
+    threader->SetSingleMethod(parallel_writer::format, this);
+    for (this->firstChunk = 0; this->firstChunk < totalChunks && stream.good();
+         this->firstChunk += static_cast<int>(this->chunks.size()))
+    {
+      threader->SingleMethodExecute();
+      for (std::size_t c = 0; c < this->chunks.size(); ++c)
+      {
+        stream.write(this->chunks[c].data(), this->chunks[c].size());
+      }
+    }
+    return stream.good();
+  }
+};
+
+template <typename Formatter>
+inline bool write_in_parallel(std::ostream& stream, const Formatter& formatter, int numberOfItems)
+{
+  parallel_writer<Formatter> writer;
+  writer.formatter = &formatter;
+  writer.numberOfItems = numberOfItems;
+  writer.itemsPerChunk = 16384;
+  writer.firstChunk = 0;
+  return writer.write(stream);
+}
+
+//3dm is a 1 based file format, so we need to add 1 to every
+//index we write out
+struct format_3dm_elements
+{
+  const tetgenio* output;
+
+  void operator()(int begin, int end, std::string& buffer) const
+  {
+    char line[128];
+    for (int i = begin; i < end; ++i)
+    {
+      //important to note that coming out of tetgen we need to convert the
+      //tetra attribute to an integer value, and we want to find the 'floor'
+      //secondly we need to make sure that material_id is written out in
+      //its natural form, and we don't force it into 1 base form
+      const int material_id(static_cast<int>(output->tetrahedronattributelist[i]));
+      const int* tet = output->tetrahedronlist + 4 * i;
+      const int length = snprintf(line, sizeof(line), "E4T \t %8d %8d %8d %8d %8d %8d\n", 1 + i,
+        1 + tet[0], 1 + tet[1], 1 + tet[2], 1 + tet[3], material_id);
+      buffer.append(line, length);
+    }
+  }
+};
+
+struct format_3dm_nodes
+{
+  const tetgenio* output;
+
+  void operator()(int begin, int end, std::string& buffer) const
+  {
+    char line[256];
+    for (int i = begin; i < end; ++i)
+    {
+      const REAL* point = output->pointlist + 3 * i;
+      const int length = snprintf(line, sizeof(line), "ND \t %8d %12.6f %12.6f %12.6f\n", 1 + i,
+        static_cast<double>(point[0]), static_cast<double>(point[1]),
+        static_cast<double>(point[2]));
+      buffer.append(line, length);
+    }
+  }
+};
+
+inline bool write_3dm_file(const std::string path, const tetgenio& output)
+{
+  std::ofstream outputFile(path.c_str(), std::ios::out);
+
+  bool fileWritten = false;                    //holds if we wrote the file properly
+  const bool can_write = outputFile.is_open(); //verify file is open
+
+  if (can_write)
+  {
+    outputFile << "MESH3D\n";
+
+    format_3dm_elements elements;
+    elements.output = &output;
+    write_in_parallel(outputFile, elements, output.numberoftetrahedra);
+
+    format_3dm_nodes nodes;
+    nodes.output = &output;
+    write_in_parallel(outputFile, nodes, output.numberofpoints);
+
+    outputFile << "END" << std::endl;
+
+    //verify that the writes were good
+    fileWritten = outputFile.good();
+    outputFile.close();
+  }
+
+  return (can_write && fileWritten);
+}
+
+//Looks up the 4 faces of each tetrahedron in the known faces, and formats
+//the ones found
+struct format_bc_faces
+{
+  const detail::KnownFaces* knownFaces;
+  const tetgenio* output;
+
+  void operator()(int begin, int end, std::string& buffer) const
+  {
+    const int lookupTable[4][3] = {
+      { 0, 1, 2 }, { 1, 3, 2 }, { 0, 3, 2 }, { 0, 1, 3 },
+    };
+
+    const int tetFaceSideTable[4] = { 4, 1, 2, 3 };
+
+    char line[128];
+    for (int i = begin; i < end; ++i)
+    {
+      const int* tet = output->tetrahedronlist + 4 * i;
+      for (int lt_index = 0; lt_index < 4; ++lt_index)
+      {
+        const int id1 = tet[lookupTable[lt_index][0]];
+        const int id2 = tet[lookupTable[lt_index][1]];
+        const int id3 = tet[lookupTable[lt_index][2]];
+
+        //query to see if this face is valid
+        const detail::Face faceWithInfo = knownFaces->get(detail::Face(id1, id2, id3));
+
+        //now that we have a valid face, write it out
+        if (faceWithInfo.valid())
+        {
+          //the face is sorted, so we need to print the original order that
+          //is contained in the tetrahedronlist so that ModelBuilder can
+          //map this file back to the shell it has stored in memory
+          const int length = snprintf(line, sizeof(line), "FCS %d %d %d %d %d %d %d\n", 1 + i,
+            tetFaceSideTable[lt_index], faceWithInfo.faceId, 1 + id1, 1 + id2, 1 + id3,
+            1 + faceWithInfo.surfaceId);
+          buffer.append(line, length);
+        }
+      }
+    }
+  }
+};
+
+inline bool write_bc_file(
+  const std::string path, const detail::KnownFaces& knownFaces, const tetgenio& output)
+{
+  std::ofstream outputFile(path.c_str(), std::ios::out);
+
+  bool fileWritten = false;                    //holds if we wrote the file properly
+  const bool can_write = outputFile.is_open(); //verify file is open
+
+  if (can_write)
+  {
+    format_bc_faces faces;
+    faces.knownFaces = &knownFaces;
+    faces.output = &output;
+    write_in_parallel(outputFile, faces, output.numberoftetrahedra);
+
+    fileWritten = outputFile.good();
+    outputFile.close();
+  }
+  return (can_write && fileWritten);
+}
+}
+
+#endif
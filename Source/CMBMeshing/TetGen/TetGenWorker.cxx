@@ -12,7 +12,6 @@
 #include <algorithm>
 #include <cstdlib>
 #include <fstream>
-#include <iomanip>
 #include <iostream>
 #include <sstream>
 
@@ -28,8 +27,12 @@
 #define BOOST_FILESYSTEM_VERSION 3
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/uuid/uuid_io.hpp>
 
+#include "JobPayload.h"
 #include "KnownFaces.h"
+#include "MeshFileWriters.h"
+#include "MeshJobReporter.h"
 #include "VTKConverters.h"
 
 namespace detail
@@ -49,19 +52,33 @@ struct tetgen_wrapper
   //this is only needed to write out the bc file
   detail::KnownFaces knownFaces;
 
-  void setPoints(const std::vector<REAL>& p)
+  //take the contents of p, so that we can reference it
+  void setPoints(std::vector<REAL>& p)
   {
-    points = p;                            //copy p to points so we can reference it
-    input.numberofpoints = (p.size() / 3); //stored as flat double
-    input.pointlist = &(points[0]);        //this doesn't work since points isn't kept
+    points.swap(p);
+    setPoints(points.empty() ? NULL : &(points[0]), points.size());
   }
 
-  void setClassification(const std::vector<int>& c)
+  //reference p directly, it has to outlive the wrapper
+  void setPoints(const REAL* p, std::size_t size)
   {
+    input.numberofpoints = static_cast<int>(size / 3); //stored as flat double
+    input.pointlist = const_cast<REAL*>(p);
+  }
 
-    cellClassification = c; //copy c so we can reference it
-    input.numberoffacets = c.size();
-    input.facetmarkerlist = &(cellClassification[0]);
+  //take the contents of c, so that we can reference it
+  void setClassification(std::vector<int>& c)
+  {
+    cellClassification.swap(c);
+    setClassification(
+      cellClassification.empty() ? NULL : &(cellClassification[0]), cellClassification.size());
+  }
+
+  //reference c directly, it has to outlive the wrapper
+  void setClassification(const int* c, std::size_t size)
+  {
+    input.numberoffacets = static_cast<int>(size);
+    input.facetmarkerlist = const_cast<int*>(c);
   }
 
   void parse_behavior(const std::string& commandline_flags)
@@ -90,7 +107,18 @@ struct tetgen_wrapper
     , output(other.output)
     , points(other.points)
     , cellClassification(other.cellClassification)
+    , knownFaces(other.knownFaces)
   {
+    //point at our own copies of the lists that other owns
+    if (!other.points.empty() && other.input.pointlist == &(other.points[0]))
+    {
+      this->input.pointlist = &(this->points[0]);
+    }
+    if (!other.cellClassification.empty() &&
+      other.input.facetmarkerlist == &(other.cellClassification[0]))
+    {
+      this->input.facetmarkerlist = &(this->cellClassification[0]);
+    }
   }
 
   tetgen_wrapper& operator=(tetgen_wrapper other)
@@ -100,6 +128,7 @@ struct tetgen_wrapper
     std::swap(output, other.output);
     std::swap(points, other.points);
     std::swap(cellClassification, other.cellClassification);
+    std::swap(knownFaces, other.knownFaces);
     return *this;
   }
 
@@ -190,36 +219,116 @@ std::string make_tetgenFlags(const remus::proto::JobContent& rawInstance)
   return buffer.str();
 }
 
-detail::tetgen_wrapper make_tetgenInput(const remus::proto::JobContent& discreteMesh)
+//The discrete mesh holds, in order, the points, the cell connections, the
+//classification of each cell and the region info. It is either a binary
+//payload (see JobPayload.h) with one section per array, whose arrays are
+//used in place when they already are of the type tetgen needs, or a stream
+//of serialized vtkDataArrays (see VTKConverters.h). The points and the
+//classification may reference discreteMesh, so it has to outlive the
+//wrapper. Returns false, before building any facet, when the cell
+//connections don't hold one triangle per classified cell, or reference
+//points that don't exist.
+bool make_tetgenInput(const remus::proto::JobContent& discreteMesh, tetgen_wrapper& wrapper)
 {
-  std::istringstream serializedDiscreteMesh;
-  { //copy discreteMesh into the stringstream
-    const std::string discreteMeshStr(discreteMesh.data(), discreteMesh.dataSize());
-    serializedDiscreteMesh.str(discreteMeshStr);
-  } //release discreteMeshStr
-
-  //construct the tetgen wrapper now input
-  tetgen_wrapper wrapper;
   tetgenio& input = wrapper.input; //reference our wrappers input data-structure
 
-  //read in a vtkDataArray and convert to a REAL vector
-  wrapper.setPoints(readAndConvert_vtkDataArray<REAL>(serializedDiscreteMesh));
+  std::vector<int> cellsConnectionsStorage;
+  const int* cellsConnections = NULL;
+  std::size_t numConnections = 0;
+  std::vector<REAL> regionInfo;
+
+  const payload::Reader reader(discreteMesh.data(), discreteMesh.dataSize());
+  if (reader.valid())
+  {
+    const REAL* values = NULL;
+    const int* ids = NULL;
+    payload::uint64 size = 0;
+    if (reader.view(0, values, size))
+    {
+      wrapper.setPoints(values, static_cast<std::size_t>(size));
+    }
+    else
+    {
+      std::vector<REAL> points;
+      reader.read(0, points);
+      wrapper.setPoints(points);
+    }
+
+    if (reader.view(1, cellsConnections, size))
+    {
+      numConnections = static_cast<std::size_t>(size);
+    }
+    else
+    {
+      reader.read(1, cellsConnectionsStorage);
+    }
 
-  //read in a vtkDataArray and convert to an int vector
-  std::vector<int> cellsConnections = readAndConvert_vtkDataArray<int>(serializedDiscreteMesh);
+    if (reader.view(2, ids, size))
+    {
+      wrapper.setClassification(ids, static_cast<std::size_t>(size));
+    }
+    else
+    {
+      std::vector<int> classification;
+      reader.read(2, classification);
+      wrapper.setClassification(classification);
+    }
 
-  //read in a vtkDataArray and convert to an int vector
-  wrapper.setClassification(readAndConvert_vtkDataArray<int>(serializedDiscreteMesh));
+    reader.read(3, regionInfo);
+  }
+  else
+  {
+    //parse the stream in place, without copying it into a string
+    payload::memory_buffer buffer(discreteMesh.data(), discreteMesh.dataSize());
+    std::istream serializedDiscreteMesh(&buffer);
 
-  //read in a vtkDataArray and convert to an REAL vector
-  std::vector<REAL> regionInfo = readAndConvert_vtkDataArray<REAL>(serializedDiscreteMesh);
+    //read in a vtkDataArray and convert to a REAL vector
+    std::vector<REAL> points = readAndConvert_vtkDataArray<REAL>(serializedDiscreteMesh);
+    wrapper.setPoints(points);
 
-  const std::size_t numCells = input.numberoffacets;
-  input.facetlist = new tetgenio::facet[input.numberoffacets];
+    //read in a vtkDataArray and convert to an int vector
+    cellsConnectionsStorage = readAndConvert_vtkDataArray<int>(serializedDiscreteMesh);
+
+    //read in a vtkDataArray and convert to an int vector
+    std::vector<int> classification = readAndConvert_vtkDataArray<int>(serializedDiscreteMesh);
+    wrapper.setClassification(classification);
+
+    //read in a vtkDataArray and convert to an REAL vector
+    regionInfo = readAndConvert_vtkDataArray<REAL>(serializedDiscreteMesh);
+  }
+  if (!cellsConnections && !cellsConnectionsStorage.empty())
+  {
+    cellsConnections = &cellsConnectionsStorage[0];
+    numConnections = cellsConnectionsStorage.size();
+  }
 
   //cellsConnections is a pure vtk cell array of triangles, so it is:
   // 3, x, y, z, 3, x2, y2, z2, 3, x3, y3, z3, etc
   //which means each cell has length 4 ( x,y,z plus cell type id)
+  const std::size_t numCells = input.numberoffacets;
+  if (numConnections != 4 * numCells)
+  {
+    return false;
+  }
+  for (std::size_t cellIndex = 0; cellIndex < numConnections; cellIndex += 4)
+  {
+    if (cellsConnections[cellIndex] != 3)
+    {
+      return false;
+    }
+    for (int j = 1; j < 4; ++j)
+    {
+      const int id = cellsConnections[cellIndex + j];
+      if (id < 0 || id >= input.numberofpoints)
+      {
+        return false;
+      }
+    }
+  }
+
+  input.facetlist = new tetgenio::facet[input.numberoffacets];
+  wrapper.knownFaces.reserve(numCells);
+
   for (std::size_t i = 0, cellIndex = 0; i < numCells; i++, cellIndex += 4)
   {
     tetgenio::facet& f = input.facetlist[i];
@@ -233,7 +342,7 @@ detail::tetgen_wrapper make_tetgenInput(const remus::proto::JobContent& discrete
 
     //construct a face to be stored in the known face list
     detail::Face face(cellsConnections[cellIndex + 1], cellsConnections[cellIndex + 2],
-      cellsConnections[cellIndex + 3], wrapper.cellClassification[i], i);
+      cellsConnections[cellIndex + 3], input.facetmarkerlist[i], i);
     wrapper.knownFaces.add(face);
 
     //add the points of the face to the polygon
@@ -259,102 +368,7 @@ detail::tetgen_wrapper make_tetgenInput(const remus::proto::JobContent& discrete
 
   input.numberofedges = 0;
 
-  return wrapper;
-}
-
-//3dm is a 1 based file format, so we need to add 1 to every
-//index we write out
-bool write_3dm_file(const std::string path, const tetgenio& output)
-{
-  std::ofstream outputFile(path.c_str(), std::ios::out);
-
-  bool fileWritten = false;                    //holds if we wrote the file properly
-  const bool can_write = outputFile.is_open(); //verify file is open
-
-  if (can_write)
-  {
-    outputFile << "MESH3D" << std::endl;
-    for (int i = 0; i < output.numberoftetrahedra; ++i)
-    {
-      //important to note that coming out of tetgen we need to convert the
-      //tetra attribute to an integer value, and we want to find the 'floor'
-      //secondly we need to make sure that material_id is written out in
-      //its natural form, and we don't force it into 1 base form
-      const int material_id(static_cast<int>(output.tetrahedronattributelist[i]));
-      outputFile << "E4T \t " << setw(8) << 1 + i << " " << setw(8)
-                 << 1 + output.tetrahedronlist[4 * i] << " " << setw(8)
-                 << 1 + output.tetrahedronlist[(4 * i) + 1] << " " << setw(8)
-                 << 1 + output.tetrahedronlist[(4 * i) + 2] << " " << setw(8)
-                 << 1 + output.tetrahedronlist[(4 * i) + 3] << " " << setw(8) << material_id
-                 << std::endl;
-    }
-
-    for (int i = 0; i < output.numberofpoints; ++i)
-    {
-      outputFile << "ND \t " << setw(8) << 1 + i << " " << std::fixed << setw(12)
-                 << output.pointlist[3 * i] << " " << setw(12) << output.pointlist[(3 * i) + 1]
-                 << " " << setw(12) << output.pointlist[(3 * i) + 2] << std::endl;
-    }
-
-    outputFile << "END" << std::endl;
-
-    //verify that the writes were good
-    fileWritten = outputFile.good();
-    outputFile.close();
-  }
-
-  return (can_write && fileWritten);
-}
-
-bool write_bc_file(
-  const std::string path, const detail::KnownFaces& knownFaces, const tetgenio& output)
-{
-  std::ofstream outputFile(path.c_str(), std::ios::out);
-
-  bool fileWritten = false;                    //holds if we wrote the file properly
-  const bool can_write = outputFile.is_open(); //verify file is open
-
-  const int lookupTable[4][3] = {
-    { 0, 1, 2 }, { 1, 3, 2 }, { 0, 3, 2 }, { 0, 1, 3 },
-  };
-
-  const int tetFaceSideTable[4] = { 4, 1, 2, 3 };
-
-  if (can_write)
-  {
-    for (int i = 0; i < output.numberoftetrahedra; ++i)
-    {
-      const int offset = 4 * i;
-      for (int lt_index = 0; lt_index < 4; ++lt_index)
-      {
-        const int offset_index_1 = offset + lookupTable[lt_index][0];
-        const int offset_index_2 = offset + lookupTable[lt_index][1];
-        const int offset_index_3 = offset + lookupTable[lt_index][2];
-
-        const detail::Face faceToFind(output.tetrahedronlist[offset_index_1],
-          output.tetrahedronlist[offset_index_2], output.tetrahedronlist[offset_index_3]);
-
-        //query to see if this face is valid
-        const detail::Face faceWithInfo = knownFaces.get(faceToFind);
-
-        //now that we have a valid face, write it out
-        if (faceWithInfo.valid())
-        {
-          //the face is sorted, so we need to print the original order that
-          //is contained in the tetrahedronlist so that ModelBuilder can
-          //map this file back to the shell it has stored in memory
-          outputFile << "FCS " << 1 + i << " " << tetFaceSideTable[lt_index] << " "
-                     << faceWithInfo.faceId << " " << 1 + output.tetrahedronlist[offset_index_1]
-                     << " " << 1 + output.tetrahedronlist[offset_index_2] << " "
-                     << 1 + output.tetrahedronlist[offset_index_3] << " "
-                     << 1 + faceWithInfo.surfaceId << std::endl;
-        }
-      }
-    }
-    fileWritten = outputFile.good();
-    outputFile.close();
-  }
-  return (can_write && fileWritten);
+  return true;
 }
 
 bool get_value(
@@ -370,7 +384,10 @@ bool get_value(
   return true;
 }
 
-std::string make_outputFile(const std::string& input, const std::string newExt)
+//the output file of a job, named after the input and the job so that
+//jobs meshing the same model don't write over each other's files
+std::string make_outputFile(
+  const std::string& input, const std::string& jobId, const std::string newExt)
 {
   //remove from the inputPath the extension and the period
   const boost::filesystem::path inputPath = boost::filesystem::absolute(input);
@@ -381,7 +398,7 @@ std::string make_outputFile(const std::string& input, const std::string newExt)
 
   //construct the new output path
 
-  boost::filesystem::path outputFile = directory_to_use /= input_name += "_output";
+  boost::filesystem::path outputFile = directory_to_use /= input_name += "_output_" + jobId;
 
   //we use replace_extension instead of append newExt the following reason.
   //replace_extension handles the use case of newExt having or not having
@@ -391,24 +408,37 @@ std::string make_outputFile(const std::string& input, const std::string newExt)
   return outputFile.string();
 }
 
-void send_jobFailedStatus(
-  remus::worker::Worker* const w, const remus::worker::Job& j, const std::string& reason)
+//forwards the reports of the mesher to the remus server
+class worker_reporter : public MeshJobReporter
 {
-  const remus::proto::JobProgress failure_message(reason);
-  remus::proto::JobStatus status(j.id(), failure_message);
-  //create a status with a message marks us as IN_PROGRESS, so we need to move
-  //to a FAILED state.
-  status.markAsFailed();
-  w->updateStatus(status);
-}
+public:
+  worker_reporter(remus::worker::Worker* const w, const remus::worker::Job& j)
+    : worker(w)
+    , job(j)
+  {
+  }
 
-void send_jobProgress(
-  remus::worker::Worker* const w, const remus::worker::Job& j, const std::string& progress)
-{
-  const remus::proto::JobProgress progress_message(progress);
-  remus::proto::JobStatus status(j.id(), progress_message);
-  w->updateStatus(status);
-}
+  void progress(const std::string& message) override
+  {
+    const remus::proto::JobProgress progress_message(message);
+    remus::proto::JobStatus status(job.id(), progress_message);
+    worker->updateStatus(status);
+  }
+
+  void failed(const std::string& reason) override
+  {
+    const remus::proto::JobProgress failure_message(reason);
+    remus::proto::JobStatus status(job.id(), failure_message);
+    //create a status with a message marks us as IN_PROGRESS, so we need to move
+    //to a FAILED state.
+    status.markAsFailed();
+    worker->updateStatus(status);
+  }
+
+private:
+  remus::worker::Worker* const worker;
+  const remus::worker::Job& job;
+};
 }
 
 TetGenWorker::TetGenWorker(
@@ -425,10 +455,23 @@ TetGenWorker::TetGenWorker(
 void TetGenWorker::meshJob()
 {
   remus::worker::Job j = this->getJob();
+  detail::worker_reporter reporter(this, j);
+  remus::proto::JobResult result = remus::proto::make_JobResult(j.id(), std::string());
+  if (TetGenWorker::mesh(j, reporter, result))
+  {
+    //return the results
+    reporter.progress("Sending Results");
+    this->returnResult(result);
+  }
+}
+
+bool TetGenWorker::mesh(
+  const remus::worker::Job& j, MeshJobReporter& reporter, remus::proto::JobResult& result)
+{
   if (!j.valid())
   {
-    detail::send_jobFailedStatus(this, j, "Invalid Job Given to Worker");
-    return;
+    reporter.failed("Invalid Job Given to Worker");
+    return false;
   }
 
   const remus::proto::JobSubmission& submission = j.submission();
@@ -443,45 +486,61 @@ void TetGenWorker::meshJob()
   valid = detail::get_value(submission, "instance", rawInstance);
   valid = valid && detail::get_value(submission, "model_file_path", modelFilePath);
   valid = valid && detail::get_value(submission, "discrete_mesh", discreteMeshData);
-  if (!j.valid())
+  if (!valid)
   {
-    detail::send_jobFailedStatus(this, j, "Invalid Job Submission to Worker");
-    return;
+    reporter.failed("Invalid Job Submission to Worker");
+    return false;
   }
-  detail::send_jobProgress(this, j, "Parsed Job Submission");
+  reporter.progress("Parsed Job Submission");
 
   // 1. Convert the discrete mesh data to the data form that tetgen requires.
   //    this info includes all the points, the cell connections, what
   //    region each cell is part of, the region ids and a point inside each region
-  detail::send_jobProgress(this, j, "Constructing TetGen Input Mesh");
-  detail::tetgen_wrapper tetInfo = detail::make_tetgenInput(discreteMeshData);
+  reporter.progress("Constructing TetGen Input Mesh");
+  detail::tetgen_wrapper tetInfo;
+  if (!detail::make_tetgenInput(discreteMeshData, tetInfo))
+  {
+    reporter.failed("Inconsistent Discrete Mesh Given to Worker");
+    return false;
+  }
 
   //2. Parse the attribute collection to build the tetgen command line arguments
-  detail::send_jobProgress(this, j, "Constructing TetGen Control Flags");
+  reporter.progress("Constructing TetGen Control Flags");
   const std::string tetoptions = detail::make_tetgenFlags(rawInstance);
   std::cout << "tetoptions: " << tetoptions << std::endl;
   tetInfo.parse_behavior(tetoptions);
 
-  detail::send_jobProgress(this, j, "Starting TetGen");
+  if (reporter.cancelled())
+  {
+    reporter.failed("TetGen job terminated");
+    return false;
+  }
+  reporter.progress("Starting TetGen");
   //finally call tetgen
   bool mesher_ran = tetInfo.tetrahedralize();
   if (!mesher_ran)
   {
-    detail::send_jobFailedStatus(this, j, "TetGen crashed while meshing");
-    return;
+    reporter.failed("TetGen crashed while meshing");
+    return false;
   }
-  detail::send_jobProgress(this, j, "TetGen Finished");
+  reporter.progress("TetGen Finished");
 
   //inspect the output of tetgen, if it doesn't have any tets and points
   //we know that tetgen failed to mesh, but didn't crash
   if (tetInfo.output.numberofpoints == 0 && tetInfo.output.numberoftetrahedra == 0)
   {
-    detail::send_jobFailedStatus(this, j, "TetGen failed to create a mesh");
-    return;
+    reporter.failed("TetGen failed to create a mesh");
+    return false;
+  }
+  if (reporter.cancelled())
+  {
+    reporter.failed("TetGen job terminated");
+    return false;
   }
 
   //add all output generates triangles to the known face list
   //this is needed so that we can write out a correct bc file
+  tetInfo.knownFaces.reserve(tetInfo.knownFaces.size() + tetInfo.output.numberoftrifaces);
   for (int i = 0; i < tetInfo.output.numberoftrifaces; i++)
   {
     if (tetInfo.output.trifacemarkerlist[i] < 0)
@@ -496,12 +555,14 @@ void TetGenWorker::meshJob()
   //now take the tetInfo.output and write out a 3dm and bc file.
   //for now we use the information in modelFilePath to create an output
   //file, whose path we will send back as our results
-  detail::send_jobProgress(this, j, "Generate Output Mesh File");
+  reporter.progress("Generate Output Mesh File");
   const std::string inputFilepath(modelFilePath.data(), modelFilePath.dataSize());
 
-  const std::string output3DMFileName = detail::make_outputFile(inputFilepath, "3dm");
+  const std::string jobId = boost::uuids::to_string(j.id());
+
+  const std::string output3DMFileName = detail::make_outputFile(inputFilepath, jobId, "3dm");
 
-  const std::string outputBCFileName = detail::make_outputFile(inputFilepath, "bc");
+  const std::string outputBCFileName = detail::make_outputFile(inputFilepath, jobId, "bc");
 
   //write out first the 3dm file, and than the bc file
   bool didWrite = detail::write_3dm_file(output3DMFileName, tetInfo.output);
@@ -509,17 +570,14 @@ void TetGenWorker::meshJob()
     didWrite && detail::write_bc_file(outputBCFileName, tetInfo.knownFaces, tetInfo.output);
   if (!didWrite)
   {
-    detail::send_jobFailedStatus(this, j, "Failed to save generated mesh to file");
-    return;
+    reporter.failed("Failed to save generated mesh to file");
+    return false;
   }
 
   //we send back as a string instead of a remus::common::FileHandle on purpose
   //in the future FileHandle will support reading and transmitting the contents
   //of the file, and for this worker we want to send back the exact path, not
   //the file contents
-  remus::proto::JobResult result = remus::proto::make_JobResult(j.id(), output3DMFileName);
-
-  //return the results
-  detail::send_jobProgress(this, j, "Sending Results");
-  this->returnResult(result);
+  result = remus::proto::make_JobResult(j.id(), output3DMFileName);
+  return true;
 }
@@ -13,6 +13,7 @@
 
 #include <set>
 
+#include <remus/proto/JobResult.h>
 #include <remus/worker/Job.h>
 #include <remus/worker/ServerConnection.h>
 #include <remus/worker/Worker.h>
@@ -20,6 +21,8 @@
 // for TetGen itself
 #include "tetgen.h"
 
+class MeshJobReporter;
+
 class TetGenWorker : public remus::worker::Worker
 {
 public:
@@ -29,5 +32,11 @@ public:
   //will get a tetgen job from the remus server
   //and call tetgen
   void meshJob();
+
+  //mesh a job with tetgen, reporting to reporter. Returns false if the
+  //job failed (the reporter is told why), else fills result. Used by
+  //meshJob, and by cmbMeshJobPool to mesh in process.
+  static bool mesh(
+    const remus::worker::Job& job, MeshJobReporter& reporter, remus::proto::JobResult& result);
 };
 #endif
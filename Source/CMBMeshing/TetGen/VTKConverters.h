@@ -42,7 +42,7 @@ inline bool writeToStream(std::ostream& buffer, ValueType* begin, ValueType* end
 
 template <typename VTKType, typename DesiredType>
 std::vector<DesiredType> makeAndConvertDataArryFromStream(
-  VTKType, DesiredType, std::istringstream& buffer, vtkIdType numTuples, vtkIdType numComponents)
+  VTKType, DesiredType, std::istream& buffer, vtkIdType numTuples, vtkIdType numComponents)
 {
   typedef typename std::vector<DesiredType>::iterator DIteratorType;
   typedef typename std::vector<VTKType>::iterator VIteratorType;
@@ -83,7 +83,7 @@ std::vector<DesiredType> makeAndConvertDataArryFromStream(
 }
 
 template <typename T>
-std::vector<T> readAndConvert_vtkDataArray(std::istringstream& buffer)
+std::vector<T> readAndConvert_vtkDataArray(std::istream& buffer)
 {
   int vtkDataType;
   vtkIdType numTuples, numComponents;
@@ -0,0 +1,26 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+
+#include "TriangleWorker.h"
+
+int main(int argc, char* argv[])
+{
+  remus::worker::ServerConnection connection;
+  if (argc >= 2)
+  {
+    //let the server connection handle parsing the command arguments
+    connection = remus::worker::make_ServerConnection(std::string(argv[1]));
+  }
+  //the triangle worker is hardcoded to only hand 2D meshes output, and
+  //input of RAW_EDGES
+  TriangleWorker worker(connection);
+  worker.meshJob();
+  return 1;
+}
@@ -12,7 +12,10 @@
 // Remus worker that uses triangle for meshing
 
 #include "TriangleWorker.h"
+#include "JobPayload.h"
+#include "MeshJobReporter.h"
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -20,8 +23,26 @@
 namespace
 {
 
+//the sections of a binary job, the parameters come first as
+//  int: MinAngleOn, MaxAreaOn, PreserveBoundaries, PreserveEdgesAndNodes,
+//       NumberOfPoints, NumberOfSegments, NumberOfHoles, NumberOfRegions,
+//       NumberOfNodes
+//  double: MaxArea, MinAngle
+//followed by the lists, which may be empty
+enum JobSections
+{
+  IntParameters = 0,
+  DoubleParameters,
+  Points,
+  Segments,
+  Holes,
+  Regions,
+  SegmentMarkers,
+  PointAttributes
+};
+
 template <typename T>
-bool AllocFromStream(std::stringstream& buffer, T*& dest, int numElements)
+bool AllocFromStream(std::istream& buffer, T*& dest, int numElements)
 {
   if (numElements <= 0)
   {
@@ -45,19 +66,61 @@ bool AllocFromStream(std::stringstream& buffer, T*& dest, int numElements)
   return valid;
 }
 
+//Reference the values of a section of the payload when they are stored as
+//T, otherwise allocate dest and convert them
 template <typename T>
-bool WriteToStream(std::stringstream& buffer, T* src, int numElements)
+bool AllocFromPayload(const payload::Reader& reader, payload::uint32 section, T*& dest,
+  int numElements, std::set<void*>& borrowed)
 {
-  if (numElements <= 0 || src == NULL)
+  if (numElements <= 0)
   {
     return true;
   }
-  //now we fill it from the buffer
-  char* csrc = reinterpret_cast<char*>(src);
-  const std::streamsize size = sizeof(T) * numElements;
-  buffer.write(csrc, size);
-  buffer << std::endl;
-  return !buffer.bad();
+
+  const T* values = NULL;
+  payload::uint64 size = 0;
+  if (reader.view(section, values, size) && size >= static_cast<payload::uint64>(numElements))
+  {
+    dest = const_cast<T*>(values);
+    borrowed.insert(dest);
+    return true;
+  }
+
+  std::vector<T> converted;
+  if (!reader.read(section, converted) || converted.size() < static_cast<std::size_t>(numElements))
+  {
+    return false;
+  }
+  dest = static_cast<T*>(std::malloc(sizeof(T) * numElements));
+  std::memcpy(dest, &converted[0], sizeof(T) * numElements);
+  return true;
+}
+
+//a list used in place belongs to the job content, so it must not be freed
+template <typename T>
+void ForgetBorrowed(const std::set<void*>& borrowed, T*& list)
+{
+  if (list && borrowed.count(list) > 0)
+  {
+    list = NULL;
+  }
+}
+
+template <typename T>
+std::size_t StreamSize(const T* src, int numElements)
+{
+  return (numElements <= 0 || src == NULL) ? 0 : sizeof(T) * numElements + 1;
+}
+
+template <typename T>
+void WriteToBuffer(std::string& buffer, const T* src, int numElements)
+{
+  if (numElements <= 0 || src == NULL)
+  {
+    return;
+  }
+  buffer.append(reinterpret_cast<const char*>(src), sizeof(T) * numElements);
+  buffer.push_back('\n');
 }
 
 void release_triangle_data(triangulateio* data)
@@ -81,10 +144,77 @@ void release_triangle_data(triangulateio* data)
 }
 }
 
-triangleParameters::triangleParameters(remus::worker::Job& job)
+triangleParameters::triangleParameters(const remus::worker::Job& job)
+  : Content(job.submission().find("data")->second)
+  , BinaryPayload(false)
 {
-  const remus::proto::JobContent& content = job.submission().find("data")->second;
-  std::stringstream buffer(std::string(content.data(), content.dataSize()));
+  //first we init the input and output data structures to be empty
+  std::memset(&this->in, 0, sizeof(triangulateio));
+  std::memset(&this->out, 0, sizeof(triangulateio));
+
+  const payload::Reader reader(this->Content.data(), this->Content.dataSize());
+  this->BinaryPayload = reader.valid();
+  if (this->BinaryPayload)
+  {
+    std::vector<int> ints;
+    std::vector<double> doubles;
+    reader.read(IntParameters, ints);
+    reader.read(DoubleParameters, doubles);
+    ints.resize(9, 0);
+    doubles.resize(2, 0.0);
+    MinAngleOn = ints[0] != 0;
+    MaxAreaOn = ints[1] != 0;
+    PreserveBoundaries = ints[2] != 0;
+    PreserveEdgesAndNodes = ints[3] != 0;
+    NumberOfPoints = ints[4];
+    NumberOfSegments = ints[5];
+    NumberOfHoles = ints[6];
+    NumberOfRegions = ints[7];
+    NumberOfNodes = ints[8];
+    MaxArea = doubles[0];
+    MinAngle = doubles[1];
+
+    std::set<void*>& borrowed = this->BorrowedLists;
+    triangulateio& i = this->in;
+    bool complete = true;
+    complete &= AllocFromPayload(reader, Points, i.pointlist, this->NumberOfPoints * 2, borrowed);
+    complete &=
+      AllocFromPayload(reader, Segments, i.segmentlist, this->NumberOfSegments * 2, borrowed);
+    complete &= AllocFromPayload(reader, Holes, i.holelist, this->NumberOfHoles * 2, borrowed);
+    complete &=
+      AllocFromPayload(reader, Regions, i.regionlist, this->NumberOfRegions * 4, borrowed);
+    if (this->PreserveEdgesAndNodes)
+    {
+      i.numberofpointattributes = 1;
+      complete &= AllocFromPayload(
+        reader, SegmentMarkers, i.segmentmarkerlist, this->NumberOfSegments, borrowed);
+      complete &= AllocFromPayload(reader, PointAttributes, i.pointattributelist,
+        this->NumberOfPoints * i.numberofpointattributes, borrowed);
+    }
+    if (!complete)
+    {
+      //a job that is missing some of its lists can't be meshed
+      this->NumberOfPoints = 0;
+    }
+  }
+  else
+  {
+    this->readStream();
+  }
+
+  //make sure the input variable has all the right number of elements
+  this->in.numberofsegments = this->NumberOfSegments;
+  this->in.numberofpoints = this->NumberOfPoints;
+  this->in.numberofholes = this->NumberOfHoles;
+  this->in.numberofregions = this->NumberOfRegions;
+  this->in.numberoftriangleattributes = this->NumberOfRegions > 0;
+}
+
+void triangleParameters::readStream()
+{
+  //parse the job data in place, without copying it into a string
+  payload::memory_buffer memory(this->Content.data(), this->Content.dataSize());
+  std::istream buffer(&memory);
 
   buffer >> MinAngleOn;
   buffer >> MaxAreaOn;
@@ -98,10 +228,6 @@ triangleParameters::triangleParameters(remus::worker::Job& job)
   buffer >> MaxArea;
   buffer >> MinAngle;
 
-  //first we init the input and output data structures to be empty
-  std::memset(&this->in, 0, sizeof(triangulateio));
-  std::memset(&this->out, 0, sizeof(triangulateio));
-
   //allocate the point list
   //copy from the string into the pointlist
   AllocFromStream(buffer, this->in.pointlist, this->NumberOfPoints * 2);
@@ -126,13 +252,6 @@ triangleParameters::triangleParameters(remus::worker::Job& job)
     AllocFromStream(
       buffer, this->in.pointattributelist, this->NumberOfPoints * this->in.numberofpointattributes);
   }
-
-  //make sure the input variable has all the right number of elements
-  this->in.numberofsegments = this->NumberOfSegments;
-  this->in.numberofpoints = this->NumberOfPoints;
-  this->in.numberofholes = this->NumberOfHoles;
-  this->in.numberofregions = this->NumberOfRegions;
-  this->in.numberoftriangleattributes = this->NumberOfRegions > 0;
 }
 
 triangleParameters::~triangleParameters()
@@ -177,33 +296,61 @@ triangleParameters::~triangleParameters()
     this->out.pointattributelist = NULL;
   }
 
+  ForgetBorrowed(this->BorrowedLists, this->in.pointlist);
+  ForgetBorrowed(this->BorrowedLists, this->in.segmentlist);
+  ForgetBorrowed(this->BorrowedLists, this->in.segmentmarkerlist);
+  ForgetBorrowed(this->BorrowedLists, this->in.holelist);
+  ForgetBorrowed(this->BorrowedLists, this->in.regionlist);
+  ForgetBorrowed(this->BorrowedLists, this->in.pointattributelist);
+
   release_triangle_data(&this->in);
   release_triangle_data(&this->out);
 }
 
 remus::proto::JobResult triangleParameters::results(const remus::worker::Job& job)
 {
-  std::stringstream buffer;
-  buffer << this->out.numberofpoints << std::endl;
-  buffer << this->out.numberofsegments << std::endl;
-  buffer << this->out.numberoftriangles << std::endl;
-
-  WriteToStream(buffer, this->out.pointlist, this->out.numberofpoints * 2);
-  WriteToStream(buffer, this->out.segmentlist, this->out.numberofsegments * 2);
-  WriteToStream(buffer, this->out.trianglelist, this->out.numberoftriangles * 3);
+  const triangulateio& o = this->out;
+  const REAL* pointAttributes = this->PreserveEdgesAndNodes ? o.pointattributelist : NULL;
+  const int* segmentMarkers = this->PreserveEdgesAndNodes ? o.segmentmarkerlist : NULL;
+  const REAL* triangleAttributes = this->NumberOfRegions > 0 ? o.triangleattributelist : NULL;
 
-  if (this->PreserveEdgesAndNodes)
+  if (this->BinaryPayload)
   {
-    WriteToStream(buffer, this->out.pointattributelist, this->out.numberofpoints);
-    WriteToStream(buffer, this->out.segmentmarkerlist, this->out.numberofsegments);
+    //the counts, followed by the lists which are empty when not generated
+    const int counts[3] = { o.numberofpoints, o.numberofsegments, o.numberoftriangles };
+    payload::Writer writer;
+    writer.add(counts, 3);
+    writer.add(o.pointlist, o.numberofpoints, 2);
+    writer.add(o.segmentlist, o.numberofsegments, 2);
+    writer.add(o.trianglelist, o.numberoftriangles, 3);
+    writer.add(pointAttributes, o.numberofpoints);
+    writer.add(segmentMarkers, o.numberofsegments);
+    writer.add(triangleAttributes, o.numberoftriangles);
+    return remus::proto::make_JobResult(job.id(), writer.str());
   }
 
-  if (this->NumberOfRegions > 0)
-  {
-    WriteToStream(buffer, this->out.triangleattributelist, this->out.numberoftriangles);
-  }
-  buffer << std::endl;
-  return remus::proto::make_JobResult(job.id(), buffer.str());
+  std::stringstream counts;
+  counts << o.numberofpoints << std::endl;
+  counts << o.numberofsegments << std::endl;
+  counts << o.numberoftriangles << std::endl;
+
+  //size the buffer up front so that the lists are copied only once
+  std::string buffer = counts.str();
+  buffer.reserve(buffer.size() + StreamSize(o.pointlist, o.numberofpoints * 2) +
+    StreamSize(o.segmentlist, o.numberofsegments * 2) +
+    StreamSize(o.trianglelist, o.numberoftriangles * 3) +
+    StreamSize(pointAttributes, o.numberofpoints) +
+    StreamSize(segmentMarkers, o.numberofsegments) +
+    StreamSize(triangleAttributes, o.numberoftriangles) + 1);
+
+  WriteToBuffer(buffer, o.pointlist, o.numberofpoints * 2);
+  WriteToBuffer(buffer, o.segmentlist, o.numberofsegments * 2);
+  WriteToBuffer(buffer, o.trianglelist, o.numberoftriangles * 3);
+  WriteToBuffer(buffer, pointAttributes, o.numberofpoints);
+  WriteToBuffer(buffer, segmentMarkers, o.numberofsegments);
+  WriteToBuffer(buffer, triangleAttributes, o.numberoftriangles);
+  buffer.push_back('\n');
+  return remus::proto::make_JobResult(job.id(), buffer);
 }
 
 TriangleWorker::TriangleWorker(remus::worker::ServerConnection const& connection)
@@ -219,8 +366,7 @@ TriangleWorker::~TriangleWorker()
 {
 }
 
-bool TriangleWorker::buildTriangleArguments(
-  const triangleParameters& params, std::string& options) const
+bool TriangleWorker::buildTriangleArguments(const triangleParameters& params, std::string& options)
 {
   bool valid = true;
   double value = 0;
@@ -264,10 +410,53 @@ bool TriangleWorker::buildTriangleArguments(
   return valid;
 }
 
+namespace
+{
+//forwards the reports of the mesher to the remus server
+class WorkerReporter : public MeshJobReporter
+{
+public:
+  WorkerReporter(remus::worker::Worker* w, const remus::worker::Job& job)
+    : Worker(w)
+    , Job(job)
+  {
+  }
+
+  void progress(const std::string& message) override
+  {
+    remus::proto::JobStatus status(this->Job.id(), remus::proto::JobProgress(message));
+    this->Worker->updateStatus(status);
+  }
+
+  void failed(const std::string& reason) override
+  {
+    remus::proto::JobStatus status(this->Job.id(), remus::proto::JobProgress(reason));
+    status.markAsFailed();
+    this->Worker->updateStatus(status);
+  }
+
+private:
+  remus::worker::Worker* Worker;
+  const remus::worker::Job& Job;
+};
+}
+
 void TriangleWorker::meshJob()
 {
   remus::worker::Job job = this->getJob();
+  WorkerReporter reporter(this, job);
+  remus::proto::JobResult results = remus::proto::make_JobResult(job.id(), std::string());
+  if (TriangleWorker::mesh(job, reporter, results))
+  {
+    //send the data back to the server
+    this->returnResult(results);
+  }
+  return;
+}
 
+bool TriangleWorker::mesh(
+  const remus::worker::Job& job, MeshJobReporter& reporter, remus::proto::JobResult& results)
+{
   //extract the parameters of the job to launch, including the raw edges
   triangleParameters parms(job);
 
@@ -275,32 +464,27 @@ void TriangleWorker::meshJob()
 
   std::string options;
   canLaunchTriangle = parms.valid();
-  canLaunchTriangle = canLaunchTriangle && this->buildTriangleArguments(parms, options);
+  canLaunchTriangle = canLaunchTriangle && TriangleWorker::buildTriangleArguments(parms, options);
   if (!canLaunchTriangle)
   {
-    this->jobFailed(job);
-    return;
+    reporter.failed("Invalid Triangle Job");
+    return false;
+  }
+  if (reporter.cancelled())
+  {
+    reporter.failed("Triangle job terminated");
+    return false;
   }
 
   //the default triangle operation really can't fail. If it hits
   //a point where it can't mesh or fails it will just call exit which will
   //kill this worker, which will cause the remus server to mark the job
-  //as failed.
+  //as failed. (In process, in cmbMeshJobPool, it kills the application.)
   triangulate(const_cast<char*>(options.c_str()), &parms.in, &parms.out,
     static_cast<struct triangulateio*>(NULL));
 
-  //send the data back to the server
-  remus::proto::JobResult results = parms.results(job);
-  this->returnResult(results);
-
-  return;
-}
-
-void TriangleWorker::jobFailed(const remus::worker::Job& job)
-{
-  remus::proto::JobStatus status(job.id(), remus::FAILED);
-  this->updateStatus(status);
-  return;
+  results = parms.results(job);
+  return true;
 }
 
 //undef triangle defines
@@ -312,18 +496,3 @@ void TriangleWorker::jobFailed(const remus::worker::Job& job)
 #ifdef DUMP_DEBUG_DATA
 #undef DUMP_DEBUG_DATA
 #endif
-
-int main(int argc, char* argv[])
-{
-  remus::worker::ServerConnection connection;
-  if (argc >= 2)
-  {
-    //let the server connection handle parsing the command arguments
-    connection = remus::worker::make_ServerConnection(std::string(argv[1]));
-  }
-  //the triangle worker is hardcoded to only hand 2D meshes output, and
-  //input of RAW_EDGES
-  TriangleWorker worker(connection);
-  worker.meshJob();
-  return 1;
-}
@@ -17,6 +17,7 @@
 #include <set>
 
 #include "cmbSystemConfig.h"
+#include <remus/proto/JobContent.h>
 #include <remus/proto/JobResult.h>
 #include <remus/worker/Job.h>
 #include <remus/worker/ServerConnection.h>
@@ -44,6 +45,8 @@ extern "C" {
 #undef TRIANGLE_REAL
 // END for Triangle
 
+class MeshJobReporter;
+
 //simple struct that holds all the arguments to the triangle process
 //in the future this needs to be standarized as the json structure
 //of the mesh job type
@@ -66,14 +69,23 @@ struct triangleParameters
   struct triangulateio in;
   struct triangulateio out;
 
+  //the job data, which the lists of in can reference when it is a
+  //binary payload (see JobPayload.h), and the lists that do so
+  remus::proto::JobContent Content;
+  bool BinaryPayload;
+  std::set<void*> BorrowedLists;
+
   //convert the job details into the paramters needed for triangle meshing
-  triangleParameters(remus::worker::Job& job);
+  triangleParameters(const remus::worker::Job& job);
   ~triangleParameters();
 
   bool valid() const { return this->NumberOfPoints >= 3 && this->NumberOfSegments >= 3; }
 
+  //read the job data in the older stream format
+  void readStream();
+
   //pass in the results by reference to avoid a copy when sending to
-  //the server
+  //the server. The results are a binary payload when the job was one.
   remus::proto::JobResult results(const remus::worker::Job& job);
 };
 
@@ -87,9 +99,13 @@ public:
   //and will call triangle inside a its own thread to mesh the job
   void meshJob();
 
-protected:
-  bool buildTriangleArguments(const triangleParameters& params, std::string& options) const;
+  //mesh a job with triangle, reporting to reporter. Returns false if the
+  //job failed (the reporter is told why), else fills results. Used by
+  //meshJob, and by cmbMeshJobPool to mesh in process.
+  static bool mesh(
+    const remus::worker::Job& job, MeshJobReporter& reporter, remus::proto::JobResult& results);
 
-  void jobFailed(const remus::worker::Job& job);
+protected:
+  static bool buildTriangleArguments(const triangleParameters& params, std::string& options);
 };
 #endif
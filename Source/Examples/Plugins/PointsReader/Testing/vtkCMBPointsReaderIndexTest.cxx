@@ -0,0 +1,169 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Checks the .cmbidx index of vtkCMBPointsReader: it is written by the
+// first scan of a .pts file (and rewritten with the bounds of the pieces
+// read in full), used instead of a scan while the file is unchanged, and
+// rebuilt once the file has changed.
+#include "vtkCMBPointsReader.h"
+#include "vtkSmartPointer.h"
+#include <vtksys/SystemTools.hxx>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+  if (!condition)
+  {
+    cerr << "Failed: " << what << "\n";
+    ++failures;
+  }
+}
+
+bool WriteFile(const std::string& fileName, const std::vector<int>& numberOfPoints)
+{
+  FILE* fp = fopen(fileName.c_str(), "w");
+  if (!fp)
+  {
+    return false;
+  }
+  for (size_t piece = 0; piece < numberOfPoints.size(); piece++)
+  {
+    fprintf(fp, "%d\n", numberOfPoints[piece]);
+    for (int i = 0; i < numberOfPoints[piece]; i++)
+    {
+      fprintf(fp, "%d.5 %d.25 %d.125 %d %d %d %d\n", i, static_cast<int>(piece), i % 17, i % 100,
+        i % 256, (2 * i) % 256, (3 * i) % 256);
+    }
+  }
+  return fclose(fp) == 0;
+}
+
+vtkSmartPointer<vtkCMBPointsReader> NewReader(const std::string& fileName)
+{
+  vtkSmartPointer<vtkCMBPointsReader> reader = vtkSmartPointer<vtkCMBPointsReader>::New();
+  reader->SetFileName(fileName.c_str());
+  reader->ReadFileInfo();
+  return reader;
+}
+
+// the lines of the index file
+std::vector<std::string> ReadLines(const std::string& fileName)
+{
+  std::vector<std::string> lines;
+  std::ifstream file(fileName.c_str());
+  std::string line;
+  while (std::getline(file, line))
+  {
+    lines.push_back(line);
+  }
+  return lines;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 2)
+  {
+    cerr << "usage:  vtkCMBPointsReaderIndexTest outputPath\n";
+    return -1;
+  }
+  std::string fileName = std::string(argv[1]) + "/PointsReaderIndexTest.pts";
+  std::string indexFileName = fileName + ".cmbidx";
+  vtksys::SystemTools::RemoveFile(indexFileName.c_str());
+
+  std::vector<int> numberOfPoints;
+  numberOfPoints.push_back(200);
+  numberOfPoints.push_back(300);
+  if (!WriteFile(fileName, numberOfPoints))
+  {
+    cerr << "Could not write " << fileName << "\n";
+    return 1;
+  }
+
+  // built by the first scan
+  vtkSmartPointer<vtkCMBPointsReader> reader = NewReader(fileName);
+  check(reader->GetKnownNumberOfPieces() == 2 && reader->GetNumberOfPointsInPiece(1) == 300,
+    "the pieces are found by the scan");
+  std::vector<std::string> lines = ReadLines(indexFileName);
+  check(lines.size() == 6 && lines[0] == "CMBPointsIndex 1" && lines[3] == "2",
+    "the index is written by the scan");
+
+  // rewritten with the bounds of the pieces read in full
+  reader->Update();
+  reader->SetPieceIndex(1);
+  double bounds[6];
+  for (int i = 0; i < 6; i++)
+  {
+    bounds[i] = reader->GetPieceBounds()[i];
+  }
+  check(bounds[0] == 0.5 && bounds[1] == 299.5 && bounds[2] == 1.25 && bounds[3] == 1.25,
+    "the bounds of a piece read in full");
+
+  vtkSmartPointer<vtkCMBPointsReader> indexed = NewReader(fileName);
+  indexed->SetPieceIndex(1);
+  bool sameBounds = true;
+  for (int i = 0; i < 6; i++)
+  {
+    sameBounds = sameBounds && indexed->GetPieceBounds()[i] == bounds[i];
+  }
+  check(sameBounds, "the bounds of the pieces read in full are kept in the index");
+
+  // used instead of a scan: a (made up) number of points in the index is
+  // taken as is while the file is unchanged
+  lines = ReadLines(indexFileName);
+  if (lines.size() == 6)
+  {
+    std::istringstream piece(lines[5]);
+    long startOffset, pointsOffset, count;
+    piece >> startOffset >> pointsOffset >> count;
+    std::ostringstream tampered;
+    tampered << startOffset << " " << pointsOffset << " " << 299 << " 0";
+    lines[5] = tampered.str();
+    std::ofstream index(indexFileName.c_str());
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+      index << lines[i] << "\n";
+    }
+  }
+  indexed = NewReader(fileName);
+  check(indexed->GetKnownNumberOfPieces() == 2 && indexed->GetNumberOfPointsInPiece(1) == 299,
+    "the index is used while the file is unchanged");
+
+  // rebuilt once the file has changed
+  numberOfPoints.push_back(50);
+  WriteFile(fileName, numberOfPoints);
+  indexed = NewReader(fileName);
+  check(indexed->GetKnownNumberOfPieces() == 3 && indexed->GetNumberOfPointsInPiece(1) == 300 &&
+      indexed->GetNumberOfPointsInPiece(2) == 50,
+    "a stale index is not used");
+  lines = ReadLines(indexFileName);
+  check(lines.size() == 7 && lines[3] == "3", "a stale index is rebuilt");
+
+  // no index, if not wanted
+  vtksys::SystemTools::RemoveFile(indexFileName.c_str());
+  reader = vtkSmartPointer<vtkCMBPointsReader>::New();
+  reader->SetFileName(fileName.c_str());
+  reader->UseIndexFileOff();
+  reader->ReadFileInfo();
+  check(reader->GetKnownNumberOfPieces() == 3 &&
+      !vtksys::SystemTools::FileExists(indexFileName.c_str(), true),
+    "no index is written when UseIndexFile is off");
+
+  return failures == 0 ? 0 : 1;
+}
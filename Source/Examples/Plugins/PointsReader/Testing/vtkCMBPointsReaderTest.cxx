@@ -0,0 +1,193 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Writes an ASCII .pts file of two pieces, where a band of lines of the
+// first piece has no intensity or color, and reads it with
+// vtkCMBPointsReader (from the memory mapped file, in several chunks).  The
+// points, intensities and colors are checked against reading the file line
+// by line with sscanf, as the reader did before it was parallelized: a line
+// without intensity or color keeps the values of the line before it.
+#include "vtkCMBPointsReader.h"
+#include "vtkDataArray.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkMultiThreader.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct ExpectedPoints
+{
+  std::vector<double> Points;
+  std::vector<float> Intensity;
+  std::vector<double> RGB;
+  std::vector<int> Piece;
+};
+
+bool WriteFile(const std::string& fileName, const int* numberOfPoints, int numberOfPieces)
+{
+  FILE* fp = fopen(fileName.c_str(), "w");
+  if (!fp)
+  {
+    return false;
+  }
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+  for (int piece = 0; piece < numberOfPieces; piece++)
+  {
+    fprintf(fp, "%d\n", numberOfPoints[piece]);
+    for (int i = 0; i < numberOfPoints[piece]; i++)
+    {
+      double values[7];
+      for (int j = 0; j < 7; j++)
+      {
+        values[j] = random->GetRangeValue(-1000.0, 1000.0);
+        random->Next();
+      }
+      // the middle of the first piece (across the chunk boundaries) has
+      // only a few lines with intensity and color
+      bool band = piece == 0 && i > numberOfPoints[piece] / 5 &&
+        i < 4 * (numberOfPoints[piece] / 5) && i % 5000 != 0;
+      if (band)
+      {
+        fprintf(fp, "%.6f %.6f %.6f\n", values[0], values[1], values[2]);
+      }
+      else
+      {
+        fprintf(fp, "%.6f %.6f %.6f %d %d %d %d\n", values[0], values[1], values[2],
+          static_cast<int>(values[3]), static_cast<int>(values[4] + 1000.0) % 256,
+          static_cast<int>(values[5] + 1000.0) % 256, static_cast<int>(values[6] + 1000.0) % 256);
+      }
+    }
+  }
+  return fclose(fp) == 0;
+}
+
+// the points of every onRatio-th line, as the serial reader parsed them
+void ReadExpected(const std::string& fileName, int onRatio, ExpectedPoints& expected)
+{
+  std::ifstream fin(fileName.c_str());
+  char buffer[2048];
+  for (int piece = 0; fin.getline(buffer, 2048); piece++)
+  {
+    long numPts = atol(buffer);
+    float intensity = 0;
+    double rgb[3] = { 0, 0, 0 };
+    double pt[3];
+    for (long i = 0; i < numPts; i++)
+    {
+      fin.getline(buffer, 2048);
+      if (i % onRatio == 0)
+      {
+        sscanf(buffer, "%lf %lf %lf %f %lf %lf %lf", pt, pt + 1, pt + 2, &intensity, rgb,
+          rgb + 1, rgb + 2);
+        expected.Points.insert(expected.Points.end(), pt, pt + 3);
+        expected.Intensity.push_back(intensity);
+        expected.RGB.insert(expected.RGB.end(), rgb, rgb + 3);
+        expected.Piece.push_back(piece);
+      }
+    }
+  }
+}
+
+int Compare(vtkPolyData* output, const ExpectedPoints& expected, const char* what)
+{
+  vtkIdType numberOfPoints = static_cast<vtkIdType>(expected.Piece.size());
+  vtkDataArray* intensity = output->GetPointData()->GetArray("Intensity");
+  vtkDataArray* color = output->GetPointData()->GetArray("Color");
+  vtkDataArray* piece = output->GetPointData()->GetArray("PieceIndex");
+  if (output->GetNumberOfPoints() != numberOfPoints || !intensity || !color || !piece)
+  {
+    cerr << what << ": read " << output->GetNumberOfPoints() << " points instead of "
+         << numberOfPoints << " (or the point data is missing)\n";
+    return 1;
+  }
+  for (vtkIdType i = 0; i < numberOfPoints; i++)
+  {
+    double pt[3];
+    output->GetPoint(i, pt);
+    bool same = pt[0] == expected.Points[3 * i] && pt[1] == expected.Points[3 * i + 1] &&
+      pt[2] == expected.Points[3 * i + 2] &&
+      static_cast<float>(intensity->GetComponent(i, 0)) == expected.Intensity[i] &&
+      piece->GetComponent(i, 0) == expected.Piece[i];
+    for (int j = 0; j < 3; j++)
+    {
+      same = same &&
+        color->GetComponent(i, j) == static_cast<unsigned char>(expected.RGB[3 * i + j]);
+    }
+    if (!same)
+    {
+      cerr << what << ": point " << i << " differs from the line by line read\n";
+      return 1;
+    }
+  }
+  return 0;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 3)
+  {
+    cerr << "usage:  vtkCMBPointsReaderTest outputPath [numberOfThreads]\n";
+    return -1;
+  }
+  std::string fileName = std::string(argv[1]) + "/PointsReaderTest.pts";
+  int numberOfThreads = argc > 2 ? atoi(argv[2]) : 4;
+
+  // the first piece is several MB, so that it is read in several chunks
+  const int numberOfPoints[2] = { 100000, 1000 };
+  if (!WriteFile(fileName, numberOfPoints, 2))
+  {
+    cerr << "Could not write " << fileName << "\n";
+    return 1;
+  }
+
+  int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+  int result = 0;
+
+  // every point of both pieces
+  vtkSmartPointer<vtkCMBPointsReader> reader = vtkSmartPointer<vtkCMBPointsReader>::New();
+  reader->SetFileName(fileName.c_str());
+  reader->UseIndexFileOff();
+  reader->OutputDataTypeIsDoubleOn();
+  reader->Update();
+  ExpectedPoints expected;
+  ReadExpected(fileName, 1, expected);
+  result |= Compare(reader->GetOutput(), expected, "All the points");
+
+  // every 3rd point of the first piece
+  reader = vtkSmartPointer<vtkCMBPointsReader>::New();
+  reader->SetFileName(fileName.c_str());
+  reader->UseIndexFileOff();
+  reader->OutputDataTypeIsDoubleOn();
+  reader->ReadFileInfo();
+  reader->AddRequestedPieceForRead(0, 3);
+  reader->Update();
+  ExpectedPoints expectedOnRatio;
+  ReadExpected(fileName, 3, expectedOnRatio);
+  expectedOnRatio.Points.resize(3 * ((numberOfPoints[0] + 2) / 3));
+  expectedOnRatio.Intensity.resize((numberOfPoints[0] + 2) / 3);
+  expectedOnRatio.RGB.resize(3 * ((numberOfPoints[0] + 2) / 3));
+  expectedOnRatio.Piece.resize((numberOfPoints[0] + 2) / 3);
+  result |= Compare(reader->GetOutput(), expectedOnRatio, "Every 3rd point");
+
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+  return result;
+}
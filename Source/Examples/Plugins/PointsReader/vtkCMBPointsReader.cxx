@@ -16,6 +16,8 @@
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
@@ -26,9 +28,414 @@
 #include <sys/types.h>
 #include <vtksys/SystemTools.hxx>
 
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 //#define LIDAR_PREVIEW_PIECE_NUM_POINTS 10000
 #define LIDAR_BINARY_POINT_SIZE sizeof(double) * 3
 
+namespace
+{
+// Read only memory mapping of the whole file.  If the file can't be mapped
+// (or is empty) Data() is null and the reader falls back to streaming.
+class PointsFileMap
+{
+public:
+  PointsFileMap()
+    : Data(0)
+    , Size(0)
+  {
+#ifdef _WIN32
+    this->File = INVALID_HANDLE_VALUE;
+    this->Mapping = 0;
+#endif
+  }
+  ~PointsFileMap() { this->Close(); }
+
+  bool Open(const char* fileName)
+  {
+    this->Close();
+#ifdef _WIN32
+    this->File = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+      FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    LARGE_INTEGER size;
+    if (this->File == INVALID_HANDLE_VALUE || !GetFileSizeEx(this->File, &size) ||
+      size.QuadPart == 0)
+    {
+      this->Close();
+      return false;
+    }
+    this->Mapping = CreateFileMappingA(this->File, 0, PAGE_READONLY, 0, 0, 0);
+    void* data = this->Mapping ? MapViewOfFile(this->Mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+    if (!data)
+    {
+      this->Close();
+      return false;
+    }
+    this->Size = static_cast<vtkTypeUInt64>(size.QuadPart);
+#else
+    int fd = open(fileName, O_RDONLY);
+    struct stat fs;
+    if (fd < 0 || fstat(fd, &fs) != 0 || fs.st_size == 0)
+    {
+      if (fd >= 0)
+      {
+        close(fd);
+      }
+      return false;
+    }
+    void* data = mmap(0, static_cast<size_t>(fs.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+      return false;
+    }
+    this->Size = static_cast<vtkTypeUInt64>(fs.st_size);
+#ifdef MADV_SEQUENTIAL
+    madvise(data, static_cast<size_t>(this->Size), MADV_SEQUENTIAL);
+#endif
+#endif
+    this->Data = static_cast<const char*>(data);
+    return true;
+  }
+
+  void Close()
+  {
+#ifdef _WIN32
+    if (this->Data)
+    {
+      UnmapViewOfFile(this->Data);
+    }
+    if (this->Mapping)
+    {
+      CloseHandle(this->Mapping);
+    }
+    if (this->File != INVALID_HANDLE_VALUE)
+    {
+      CloseHandle(this->File);
+    }
+    this->File = INVALID_HANDLE_VALUE;
+    this->Mapping = 0;
+#else
+    if (this->Data)
+    {
+      munmap(const_cast<char*>(this->Data), static_cast<size_t>(this->Size));
+    }
+#endif
+    this->Data = 0;
+    this->Size = 0;
+  }
+
+  const char* GetData() const { return this->Data; }
+  vtkTypeUInt64 GetSize() const { return this->Size; }
+
+private:
+  const char* Data;
+  vtkTypeUInt64 Size;
+#ifdef _WIN32
+  HANDLE File;
+  HANDLE Mapping;
+#endif
+};
+
+inline bool IsBlank(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Parse a floating point number from [p, end), advancing p past it.  The
+// common case (at most 19 significant digits and a small exponent) is
+// converted exactly with a single multiply / divide by a power of 10; anything
+// else goes through strtod.
+bool ParseDouble(const char*& p, const char* end, double& value)
+{
+  static const double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+  while (p < end && IsBlank(*p))
+  {
+    ++p;
+  }
+  const char* start = p;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  vtkTypeUInt64 mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool haveDigits = false;
+  for (; p < end && *p >= '0' && *p <= '9'; ++p, haveDigits = true)
+  {
+    if (digits < 19)
+    {
+      mantissa = mantissa * 10 + (*p - '0');
+      digits += (mantissa != 0);
+    }
+    else
+    {
+      exponent++;
+    }
+  }
+  if (p < end && *p == '.')
+  {
+    for (++p; p < end && *p >= '0' && *p <= '9'; ++p, haveDigits = true)
+    {
+      if (digits < 19)
+      {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits += (mantissa != 0);
+        exponent--;
+      }
+    }
+  }
+  if (!haveDigits)
+  {
+    p = start;
+    return false;
+  }
+  if (p < end && (*p == 'e' || *p == 'E'))
+  {
+    const char* q = p + 1;
+    bool negativeExponent = false;
+    if (q < end && (*q == '-' || *q == '+'))
+    {
+      negativeExponent = (*q == '-');
+      ++q;
+    }
+    if (q < end && *q >= '0' && *q <= '9')
+    {
+      int e = 0;
+      for (; q < end && *q >= '0' && *q <= '9'; ++q)
+      {
+        e = e < 10000 ? e * 10 + (*q - '0') : e;
+      }
+      exponent += negativeExponent ? -e : e;
+      p = q;
+    }
+  }
+
+  if (mantissa < (vtkTypeUInt64(1) << 53) && exponent >= -22 && exponent <= 22)
+  {
+    value = static_cast<double>(mantissa);
+    value = exponent < 0 ? value / powersOf10[-exponent] : value * powersOf10[exponent];
+    value = negative ? -value : value;
+    return true;
+  }
+
+  // the slow path; the token is copied as the mapped file isn't 0 terminated
+  char buffer[64];
+  size_t length = static_cast<size_t>(p - start);
+  if (length >= sizeof(buffer))
+  {
+    length = sizeof(buffer) - 1;
+  }
+  memcpy(buffer, start, length);
+  buffer[length] = 0;
+  value = strtod(buffer, 0);
+  return true;
+}
+
+// One of the chunks a (mapped) piece is split into, and the points read
+// from it.
+struct PointsChunk
+{
+  const char* Begin;
+  const char* End;
+  vtkIdType FirstPoint; // index (within the piece) of the 1st point (line)
+  vtkIdType NumberOfPoints; // lines, if ASCII
+
+  std::vector<double> Points;
+  std::vector<float> Intensity;
+  std::vector<unsigned char> RGB;
+  vtkBoundingBox BBox;
+
+  // A line without intensity (or rgb) keeps the values of the line before
+  // it, which may be in a previous chunk: the points added before the 1st
+  // line of the chunk that has them get the last values of the previous
+  // chunks once the chunks are appended.
+  vtkIdType PointsBeforeIntensity;
+  vtkIdType PointsBeforeRGB;
+  bool HasIntensity;
+  bool HasRGB;
+  float LastIntensity;
+  unsigned char LastRGB[3];
+};
+
+struct PointsReadUserData
+{
+  std::vector<PointsChunk>* Chunks;
+  bool Binary;
+  vtkIdType NumberOfPoints; // in the piece
+  int OnRatio;
+  bool ReadRGB;
+  bool ReadIntensity;
+
+  vtkAbstractTransform* LatLongTransform1; // null unless converting from Lat/Long
+  vtkAbstractTransform* LatLongTransform2;
+  vtkAbstractTransform* Transform; // null unless limiting to bounds or transforming output
+  bool TransformOutputData;
+  const vtkBoundingBox* ReadBBox; // null unless limiting to bounds
+};
+
+// Count the lines of each (ASCII) chunk, such that the index of the 1st
+// point of each chunk is known.
+VTK_THREAD_RETURN_TYPE CountChunkLines(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  PointsReadUserData* td = static_cast<PointsReadUserData*>(info->UserData);
+  for (size_t c = info->ThreadID; c < td->Chunks->size(); c += info->NumberOfThreads)
+  {
+    PointsChunk& chunk = (*td->Chunks)[c];
+    vtkIdType count = 0;
+    const char* p = chunk.Begin;
+    while (p < chunk.End)
+    {
+      const char* eol = static_cast<const char*>(memchr(p, '\n', chunk.End - p));
+      count++;
+      p = eol ? eol + 1 : chunk.End;
+    }
+    chunk.NumberOfPoints = count;
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+// Add a point (read from the file) to the chunk, if it passes the bounds
+// test.  Mirrors what vtkCMBPointsReader::ReadPiece does for every point.
+inline void AddChunkPoint(
+  const PointsReadUserData* td, PointsChunk& chunk, double pt[3], float intensity, double rgb[3])
+{
+  if (td->LatLongTransform1)
+  {
+    td->LatLongTransform1->InternalTransformPoint(pt, pt);
+    td->LatLongTransform2->InternalTransformPoint(pt, pt);
+  }
+  chunk.BBox.AddPoint(pt);
+
+  double transformedPt[3];
+  double* outPt = pt;
+  if (td->Transform)
+  {
+    td->Transform->InternalTransformPoint(pt, transformedPt);
+    if (td->ReadBBox && !td->ReadBBox->ContainsPoint(transformedPt))
+    {
+      return;
+    }
+    if (td->TransformOutputData)
+    {
+      outPt = transformedPt;
+    }
+  }
+  else if (td->ReadBBox && !td->ReadBBox->ContainsPoint(pt))
+  {
+    return;
+  }
+
+  chunk.Points.insert(chunk.Points.end(), outPt, outPt + 3);
+  if (td->ReadIntensity)
+  {
+    chunk.Intensity.push_back(intensity);
+  }
+  if (td->ReadRGB)
+  {
+    chunk.RGB.push_back(static_cast<unsigned char>(rgb[0]));
+    chunk.RGB.push_back(static_cast<unsigned char>(rgb[1]));
+    chunk.RGB.push_back(static_cast<unsigned char>(rgb[2]));
+  }
+}
+
+VTK_THREAD_RETURN_TYPE ReadChunkPoints(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  PointsReadUserData* td = static_cast<PointsReadUserData*>(info->UserData);
+  for (size_t c = info->ThreadID; c < td->Chunks->size(); c += info->NumberOfThreads)
+  {
+    PointsChunk& chunk = (*td->Chunks)[c];
+    chunk.HasIntensity = chunk.HasRGB = false;
+    chunk.PointsBeforeIntensity = chunk.PointsBeforeRGB = 0;
+    float intensity = 0;
+    double rgb[3] = { 0, 0, 0 };
+    double pt[3];
+    if (td->Binary)
+    {
+      // direct (strided) copy of the points we want
+      vtkIdType i = chunk.FirstPoint + (td->OnRatio - chunk.FirstPoint % td->OnRatio) % td->OnRatio;
+      for (; i < chunk.FirstPoint + chunk.NumberOfPoints; i += td->OnRatio)
+      {
+        memcpy(pt, chunk.Begin + (i - chunk.FirstPoint) * LIDAR_BINARY_POINT_SIZE,
+          LIDAR_BINARY_POINT_SIZE);
+        AddChunkPoint(td, chunk, pt, intensity, rgb);
+      }
+      continue;
+    }
+
+    const char* p = chunk.Begin;
+    for (vtkIdType i = chunk.FirstPoint; p < chunk.End && i < td->NumberOfPoints; i++)
+    {
+      const char* eol = static_cast<const char*>(memchr(p, '\n', chunk.End - p));
+      const char* lineEnd = eol ? eol : chunk.End;
+      if (i % td->OnRatio == 0)
+      {
+        // x y z [intensity [r g b]]
+        double values[7];
+        int numberOfValues = 0;
+        while (numberOfValues < 7 && ParseDouble(p, lineEnd, values[numberOfValues]))
+        {
+          numberOfValues++;
+        }
+        if (numberOfValues >= 3)
+        {
+          pt[0] = values[0];
+          pt[1] = values[1];
+          pt[2] = values[2];
+          if (numberOfValues >= 4)
+          {
+            intensity = static_cast<float>(values[3]);
+            if (!chunk.HasIntensity)
+            {
+              chunk.HasIntensity = true;
+              chunk.PointsBeforeIntensity = static_cast<vtkIdType>(chunk.Points.size() / 3);
+            }
+          }
+          if (numberOfValues >= 7)
+          {
+            rgb[0] = values[4];
+            rgb[1] = values[5];
+            rgb[2] = values[6];
+            if (!chunk.HasRGB)
+            {
+              chunk.HasRGB = true;
+              chunk.PointsBeforeRGB = static_cast<vtkIdType>(chunk.Points.size() / 3);
+            }
+          }
+          AddChunkPoint(td, chunk, pt, intensity, rgb);
+        }
+      }
+      p = lineEnd + 1;
+    }
+    chunk.LastIntensity = intensity;
+    for (int i = 0; i < 3; i++)
+    {
+      chunk.LastRGB[i] = static_cast<unsigned char>(rgb[i]);
+    }
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+}
+
 vtkStandardNewMacro(vtkCMBPointsReader);
 
 vtkCxxSetObjectMacro(vtkCMBPointsReader, Transform, vtkTransform);
@@ -59,6 +466,11 @@ vtkCMBPointsReader::vtkCMBPointsReader()
 
   this->OutputDataTypeIsDouble = false;
   this->FileType = VTK_ASCII;
+
+  this->PieceBounds[0] = this->PieceBounds[2] = this->PieceBounds[4] = VTK_DOUBLE_MAX;
+  this->PieceBounds[1] = this->PieceBounds[3] = this->PieceBounds[5] = VTK_DOUBLE_MIN;
+  this->UseIndexFile = true;
+  this->IndexFileModified = false;
 }
 
 vtkCMBPointsReader::~vtkCMBPointsReader()
@@ -80,6 +492,7 @@ void vtkCMBPointsReader::SetConvertFromLatLongToXYZ(bool mode)
   for (size_t i = 0; i < this->LIDARPieces.size(); i++)
   {
     this->LIDARPieces[i].BBox.Reset();
+    this->LIDARPieces[i].BBoxIsExact = false;
   }
 
   this->LatLongTransform2Initialized = false;
@@ -146,6 +559,21 @@ void vtkCMBPointsReader::RemoveAllRequestedReadPieces()
   this->Modified();
 }
 
+double* vtkCMBPointsReader::GetPieceBounds()
+{
+  if (this->PieceIndex >= 0 && this->PieceIndex < static_cast<int>(this->LIDARPieces.size()) &&
+    this->LIDARPieces[this->PieceIndex].BBox.IsValid())
+  {
+    this->LIDARPieces[this->PieceIndex].BBox.GetBounds(this->PieceBounds);
+  }
+  else
+  {
+    this->PieceBounds[0] = this->PieceBounds[2] = this->PieceBounds[4] = VTK_DOUBLE_MAX;
+    this->PieceBounds[1] = this->PieceBounds[3] = this->PieceBounds[5] = VTK_DOUBLE_MIN;
+  }
+  return this->PieceBounds;
+}
+
 int vtkCMBPointsReader::GetKnownNumberOfPieces()
 {
   return static_cast<int>(this->LIDARPieces.size());
@@ -225,6 +653,11 @@ int vtkCMBPointsReader::RequestData(vtkInformation* vtkNotUsed(request),
     return 0;
   }
 
+  // if we can, read the pieces from a memory mapping of the file (fin is
+  // still used to find pieces we don't know about yet)
+  PointsFileMap fileMap;
+  fileMap.Open(this->FileName);
+
   int numOutputPts = this->GetEstimatedNumOfOutPoints();
   if (numOutputPts == 0)
   {
@@ -311,8 +744,8 @@ int vtkCMBPointsReader::RequestData(vtkInformation* vtkNotUsed(request),
     }
     do
     {
-      res = this->ReadPiece(fin, j, onRationForAllPieces, numOutputPts, newPts, newVerts, scalars,
-        intensityArray, pieceIndexArray);
+      res = this->ReadPiece(fin, fileMap.GetData(), fileMap.GetSize(), j, onRationForAllPieces,
+        numOutputPts, newPts, newVerts, scalars, intensityArray, pieceIndexArray);
       if (res != READ_OK)
       {
         fin.close();
@@ -332,8 +765,8 @@ int vtkCMBPointsReader::RequestData(vtkInformation* vtkNotUsed(request),
         onRatio = ceil(
           static_cast<double>(this->LIDARPieces[it->first].NumPoints) / this->MaxNumberOfPoints);
       }
-      res = this->ReadPiece(fin, it->first, onRatio, numOutputPts, newPts, newVerts, scalars,
-        intensityArray, pieceIndexArray);
+      res = this->ReadPiece(fin, fileMap.GetData(), fileMap.GetSize(), it->first, onRatio,
+        numOutputPts, newPts, newVerts, scalars, intensityArray, pieceIndexArray);
       if (res != READ_OK)
       {
         fin.close();
@@ -372,6 +805,10 @@ int vtkCMBPointsReader::RequestData(vtkInformation* vtkNotUsed(request),
     }
   }
   bbox.GetBounds(this->DataBounds);
+  if (this->IndexFileModified)
+  {
+    this->WriteIndexFile();
+  }
   if (intensityArray)
   {
     output->GetPointData()->SetActiveScalars(intensityArray->GetName());
@@ -436,6 +873,13 @@ int vtkCMBPointsReader::ReadFileInfo()
     return READ_OK;
   }
 
+  // the index file (if up to date) has everything the scan would find
+  if (this->UseIndexFile && this->ReadIndexFile())
+  {
+    this->CompleteFileHasBeenRead = true;
+    return READ_OK;
+  }
+
   ifstream fin;
 
   // always open in binary mode, because we want tellg/seekg to work
@@ -471,6 +915,7 @@ int vtkCMBPointsReader::ReadFileInfo()
   if (res == READ_OK)
   {
     this->CompleteFileHasBeenRead = true;
+    this->WriteIndexFile();
   }
   else if (res == READ_ABORT)
   {
@@ -577,9 +1022,10 @@ int vtkCMBPointsReader::GetPointInfo(ifstream& fin)
   return VTK_OK;
 }
 
-int vtkCMBPointsReader::ReadPiece(ifstream& fin, int pieceIndex, int onRatio, long totalNumPts,
-  vtkPoints* newPts, vtkCellArray* newVerts, vtkUnsignedCharArray* scalars,
-  vtkFloatArray* intensityArray, vtkUnsignedCharArray* pieceIndexArray)
+int vtkCMBPointsReader::ReadPiece(ifstream& fin, const char* mappedFile,
+  vtkTypeUInt64 mappedFileSize, int pieceIndex, int onRatio, long totalNumPts, vtkPoints* newPts,
+  vtkCellArray* newVerts, vtkUnsignedCharArray* scalars, vtkFloatArray* intensityArray,
+  vtkUnsignedCharArray* pieceIndexArray)
 {
   int res = this->MoveToStartOfPiece(fin, pieceIndex);
   if (res != READ_OK)
@@ -621,7 +1067,21 @@ int vtkCMBPointsReader::ReadPiece(ifstream& fin, int pieceIndex, int onRatio, lo
     }
   }
 
-  long numPts = this->LIDARPieces[pieceIndex].NumPoints;
+  if (mappedFile)
+  {
+    vtkTypeUInt64 pieceEnd;
+    res = this->ReadMappedPiece(mappedFile, mappedFileSize, pieceIndex, onRatio, totalNumPts,
+      newPts, newVerts, scalars, intensityArray, pieceIndexArray, pieceEnd);
+    if (res != READ_OK)
+    {
+      return res;
+    }
+    // position fin at the end of the piece, for reading the info of the
+    // next piece (below)
+    fin.seekg(static_cast<std::streamoff>(pieceEnd), ios::beg);
+  }
+
+  long numPts = mappedFile ? 0 : this->LIDARPieces[pieceIndex].NumPoints;
   float intensity;
   // initialized in case we have piece that doesn't have rgb but 1st did
   double rgb[3] = { 0, 0, 0 };
@@ -658,20 +1118,7 @@ int vtkCMBPointsReader::ReadPiece(ifstream& fin, int pieceIndex, int onRatio, lo
       if (this->ConvertFromLatLongToXYZ)
       {
         this->LatLongTransform1->TransformPoint(pt, pt);
-        if (!this->LatLongTransform2Initialized)
-        {
-          this->LatLongTransform2Initialized = true;
-          this->LatLongTransform2->Identity();
-          double rotationAxis[3], zAxis[3] = { 0, 0, 1 };
-          double tempPt[3] = { pt[0], pt[1], pt[2] };
-          vtkMath::Normalize(tempPt);
-          vtkMath::Cross(tempPt, zAxis, rotationAxis);
-          double angle = vtkMath::DegreesFromRadians(acos(tempPt[2]));
-
-          this->LatLongTransform2->PreMultiply();
-          this->LatLongTransform2->RotateWXYZ(angle, rotationAxis);
-          this->LatLongTransform2->Translate(-pt[0], -pt[1], -pt[2]);
-        }
+        this->InitializeLatLongTransform(pt);
         this->LatLongTransform2->TransformPoint(pt, pt);
       }
 
@@ -734,6 +1181,14 @@ int vtkCMBPointsReader::ReadPiece(ifstream& fin, int pieceIndex, int onRatio, lo
     }
   }
 
+  // having added every point of the piece, the bounds are exact (and worth
+  // keeping in the index file)
+  if (onRatio == 1 && !this->LIDARPieces[pieceIndex].BBoxIsExact)
+  {
+    this->LIDARPieces[pieceIndex].BBoxIsExact = true;
+    this->IndexFileModified = true;
+  }
+
   // we've read this far... the farthest we've been thus far;  read a little
   // farther to get info on the next piece (if present)
   if (!this->CompleteFileHasBeenRead &&
@@ -774,6 +1229,253 @@ int vtkCMBPointsReader::ReadPiece(ifstream& fin, int pieceIndex, int onRatio, lo
   return res;
 }
 
+// Setup the 2nd Lat/Long transform (if not done already) based on the first
+// point read (already converted by the 1st transform)
+void vtkCMBPointsReader::InitializeLatLongTransform(double pt[3])
+{
+  if (this->LatLongTransform2Initialized)
+  {
+    return;
+  }
+  this->LatLongTransform2Initialized = true;
+  this->LatLongTransform2->Identity();
+  double rotationAxis[3], zAxis[3] = { 0, 0, 1 };
+  double tempPt[3] = { pt[0], pt[1], pt[2] };
+  vtkMath::Normalize(tempPt);
+  vtkMath::Cross(tempPt, zAxis, rotationAxis);
+  double angle = vtkMath::DegreesFromRadians(acos(tempPt[2]));
+
+  this->LatLongTransform2->PreMultiply();
+  this->LatLongTransform2->RotateWXYZ(angle, rotationAxis);
+  this->LatLongTransform2->Translate(-pt[0], -pt[1], -pt[2]);
+}
+
+int vtkCMBPointsReader::ReadMappedPiece(const char* mappedFile, vtkTypeUInt64 mappedFileSize,
+  int pieceIndex, int onRatio, long totalNumPts, vtkPoints* newPts, vtkCellArray* newVerts,
+  vtkUnsignedCharArray* scalars, vtkFloatArray* intensityArray,
+  vtkUnsignedCharArray* pieceIndexArray, vtkTypeUInt64& pieceEnd)
+{
+  LIDARPieceInfo& pieceInfo = this->LIDARPieces[pieceIndex];
+  vtkIdType numPts = pieceInfo.NumPoints;
+  vtkTypeUInt64 pieceBegin = static_cast<vtkTypeUInt64>(pieceInfo.PiecePointsOffset);
+  if (pieceBegin > mappedFileSize)
+  {
+    pieceBegin = mappedFileSize;
+  }
+
+  // where does the piece end?
+  const char* begin = mappedFile + pieceBegin;
+  const char* end = mappedFile + mappedFileSize;
+  if (this->FileType == VTK_BINARY)
+  {
+    vtkTypeUInt64 numBytes = static_cast<vtkTypeUInt64>(numPts) * LIDAR_BINARY_POINT_SIZE;
+    if (numBytes > mappedFileSize - pieceBegin)
+    {
+      numPts = static_cast<vtkIdType>((mappedFileSize - pieceBegin) / LIDAR_BINARY_POINT_SIZE);
+      numBytes = static_cast<vtkTypeUInt64>(numPts) * LIDAR_BINARY_POINT_SIZE;
+    }
+    end = begin + numBytes;
+  }
+  else if (static_cast<size_t>(pieceIndex) + 1 < this->LIDARPieces.size())
+  {
+    vtkTypeUInt64 nextPieceStart =
+      static_cast<vtkTypeUInt64>(this->LIDARPieces[pieceIndex + 1].PieceStartOffset);
+    end = mappedFile + (nextPieceStart < pieceBegin
+                           ? pieceBegin
+                           : (nextPieceStart > mappedFileSize ? mappedFileSize : nextPieceStart));
+  }
+  else if (!this->CompleteFileHasBeenRead)
+  {
+    // don't know where the next piece starts; count off the lines of this one
+    const char* p = begin;
+    for (vtkIdType i = 0; i < numPts && p < end; i++)
+    {
+      const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+      p = eol ? eol + 1 : end;
+    }
+    end = p;
+  }
+  pieceEnd = static_cast<vtkTypeUInt64>(end - mappedFile);
+
+  char progressText[100];
+  sprintf(progressText, "%s %d", "Reading Piece ", pieceIndex);
+  this->SetProgressText(progressText);
+
+  // a few chunks per thread, each at least 1MB
+  vtkNew<vtkMultiThreader> threader;
+  int numberOfThreads = threader->GetNumberOfThreads();
+  vtkTypeUInt64 pieceSize = static_cast<vtkTypeUInt64>(end - begin);
+  vtkTypeUInt64 numberOfChunks = pieceSize / (1 << 20) + 1;
+  if (numberOfChunks > static_cast<vtkTypeUInt64>(4 * numberOfThreads))
+  {
+    numberOfChunks = 4 * numberOfThreads;
+  }
+  if (static_cast<vtkTypeUInt64>(numberOfThreads) > numberOfChunks)
+  {
+    numberOfThreads = static_cast<int>(numberOfChunks);
+  }
+  threader->SetNumberOfThreads(numberOfThreads);
+
+  std::vector<PointsChunk> chunks(static_cast<size_t>(numberOfChunks));
+  for (size_t c = 0; c < chunks.size(); c++)
+  {
+    PointsChunk& chunk = chunks[c];
+    if (this->FileType == VTK_BINARY)
+    {
+      chunk.FirstPoint = static_cast<vtkIdType>(numPts * c / chunks.size());
+      chunk.NumberOfPoints =
+        static_cast<vtkIdType>(numPts * (c + 1) / chunks.size()) - chunk.FirstPoint;
+      chunk.Begin = begin + chunk.FirstPoint * LIDAR_BINARY_POINT_SIZE;
+      chunk.End = chunk.Begin + chunk.NumberOfPoints * LIDAR_BINARY_POINT_SIZE;
+    }
+    else
+    {
+      // ASCII chunks start at the beginning of a line
+      chunk.Begin = c == 0 ? begin : chunks[c - 1].End;
+      chunk.End = begin + pieceSize * (c + 1) / chunks.size();
+      if (chunk.End < chunk.Begin)
+      {
+        chunk.End = chunk.Begin;
+      }
+      const char* eol = c + 1 == chunks.size()
+        ? 0
+        : static_cast<const char*>(memchr(chunk.End, '\n', end - chunk.End));
+      chunk.End = eol ? eol + 1 : end;
+    }
+  }
+
+  PointsReadUserData userData;
+  userData.Chunks = &chunks;
+  userData.Binary = this->FileType == VTK_BINARY;
+  userData.NumberOfPoints = numPts;
+  userData.OnRatio = onRatio;
+  userData.ReadRGB = scalars != 0;
+  userData.ReadIntensity = intensityArray != 0;
+  userData.LatLongTransform1 = 0;
+  userData.LatLongTransform2 = 0;
+  userData.Transform = 0;
+  userData.TransformOutputData = this->TransformOutputData;
+  userData.ReadBBox = this->LimitReadToBounds ? &this->ReadBBox : 0;
+
+  if (!userData.Binary)
+  {
+    threader->SetSingleMethod(CountChunkLines, &userData);
+    threader->SingleMethodExecute();
+    vtkIdType firstPoint = 0;
+    for (size_t c = 0; c < chunks.size(); c++)
+    {
+      chunks[c].FirstPoint = firstPoint;
+      firstPoint += chunks[c].NumberOfPoints;
+    }
+  }
+
+  // the transforms are updated here, as only their InternalTransformPoint
+  // (which doesn't update) may be used by the threads
+  if (this->ConvertFromLatLongToXYZ && numPts > 0)
+  {
+    if (!this->LatLongTransform2Initialized)
+    {
+      // setup from the 1st point of the piece
+      double pt[3] = { 0, 0, 0 };
+      if (userData.Binary)
+      {
+        memcpy(pt, begin, LIDAR_BINARY_POINT_SIZE);
+      }
+      else
+      {
+        const char* p = begin;
+        for (int i = 0; i < 3 && ParseDouble(p, end, pt[i]); i++)
+        {
+        }
+      }
+      this->LatLongTransform1->TransformPoint(pt, pt);
+      this->InitializeLatLongTransform(pt);
+    }
+    this->LatLongTransform1->Update();
+    this->LatLongTransform2->Update();
+    userData.LatLongTransform1 = this->LatLongTransform1;
+    userData.LatLongTransform2 = this->LatLongTransform2;
+  }
+  if (this->Transform && (this->LimitReadToBounds || this->TransformOutputData))
+  {
+    this->Transform->Update();
+    userData.Transform = this->Transform;
+  }
+
+  threader->SetSingleMethod(ReadChunkPoints, &userData);
+  threader->SingleMethodExecute();
+
+  // append the points (in order)
+  vtkIdType numberOfNewPts = 0;
+  for (size_t c = 0; c < chunks.size(); c++)
+  {
+    numberOfNewPts += static_cast<vtkIdType>(chunks[c].Points.size() / 3);
+    pieceInfo.BBox.AddBox(chunks[c].BBox);
+  }
+  vtkIdType idx = newPts->GetNumberOfPoints();
+  newPts->SetNumberOfPoints(idx + numberOfNewPts);
+  if (scalars)
+  {
+    scalars->SetNumberOfTuples(idx + numberOfNewPts);
+  }
+  if (intensityArray)
+  {
+    intensityArray->SetNumberOfTuples(idx + numberOfNewPts);
+  }
+  pieceIndexArray->SetNumberOfTuples(idx + numberOfNewPts);
+  // the values carried over from the previous chunks (as the serial read
+  // starts each piece with)
+  float carriedIntensity = 0;
+  unsigned char carriedRGB[3] = { 0, 0, 0 };
+  for (size_t c = 0; c < chunks.size(); c++)
+  {
+    PointsChunk& chunk = chunks[c];
+    vtkIdType chunkPts = static_cast<vtkIdType>(chunk.Points.size() / 3);
+    if (!userData.Binary)
+    {
+      vtkIdType n = chunk.HasIntensity ? chunk.PointsBeforeIntensity : chunkPts;
+      std::fill(chunk.Intensity.begin(), chunk.Intensity.begin() + (intensityArray ? n : 0),
+        carriedIntensity);
+      n = chunk.HasRGB ? chunk.PointsBeforeRGB : chunkPts;
+      for (vtkIdType i = 0; scalars && i < n; i++)
+      {
+        std::copy(carriedRGB, carriedRGB + 3, chunk.RGB.begin() + 3 * i);
+      }
+      if (chunk.HasIntensity)
+      {
+        carriedIntensity = chunk.LastIntensity;
+      }
+      if (chunk.HasRGB)
+      {
+        std::copy(chunk.LastRGB, chunk.LastRGB + 3, carriedRGB);
+      }
+    }
+    for (vtkIdType i = 0; i < chunkPts; i++, idx++)
+    {
+      newPts->SetPoint(idx, &chunk.Points[3 * i]);
+      newVerts->InsertNextCell(1, &idx);
+      pieceIndexArray->SetValue(idx, static_cast<unsigned char>(pieceIndex));
+    }
+    if (scalars && chunkPts)
+    {
+      memcpy(scalars->GetPointer(3 * (idx - chunkPts)), &chunk.RGB[0], 3 * chunkPts);
+    }
+    if (intensityArray && chunkPts)
+    {
+      memcpy(
+        intensityArray->GetPointer(idx - chunkPts), &chunk.Intensity[0], sizeof(float) * chunkPts);
+    }
+
+    this->UpdateProgress(static_cast<double>(idx) / static_cast<double>(totalNumPts));
+    if (this->GetAbortExecute())
+    {
+      return READ_ABORT;
+    }
+  }
+
+  return READ_OK;
+}
+
 //  attempt to move to specified piece
 int vtkCMBPointsReader::MoveToStartOfPiece(ifstream& fin, int pieceIndex)
 {
@@ -881,13 +1583,140 @@ int vtkCMBPointsReader::MoveToStartOfPiece(ifstream& fin, int pieceIndex)
   return READ_OK;
 }
 
+std::string vtkCMBPointsReader::GetIndexFileName()
+{
+  return std::string(this->FileName) + ".cmbidx";
+}
+
+// The index file is ASCII:
+//   CMBPointsIndex <version>
+//   <file size> <file modification time>
+//   <FileType> <ValuesPerLine> <BytesPerPoint>
+//   <number of pieces>
+// followed by a line per piece:
+//   <start offset> <points offset> <number of points> <has bounds> [<bounds>]
+// Bounds are only written for pieces that have been read in full, and not
+// when converting from Lat/Long (the bounds are of the converted points).
+bool vtkCMBPointsReader::ReadIndexFile()
+{
+  struct stat fs;
+  if (stat(this->FileName, &fs) != 0)
+  {
+    return false;
+  }
+  ifstream index(this->GetIndexFileName().c_str());
+  std::string magic;
+  int version = 0, fileType = 0, valuesPerLine = 0, bytesPerPoint = 0;
+  long long fileSize = 0, modifiedTime = 0;
+  long long numberOfPieces = 0;
+  if (!(index >> magic >> version >> fileSize >> modifiedTime >> fileType >> valuesPerLine >>
+        bytesPerPoint >> numberOfPieces) ||
+    magic != "CMBPointsIndex" || version != 1 || fileSize != static_cast<long long>(fs.st_size) ||
+    modifiedTime != static_cast<long long>(fs.st_mtime) || fileType != this->FileType ||
+    bytesPerPoint <= 0 || numberOfPieces < 0)
+  {
+    return false;
+  }
+
+  std::vector<LIDARPieceInfo> pieces(static_cast<size_t>(numberOfPieces));
+  for (size_t i = 0; i < pieces.size(); i++)
+  {
+    int hasBounds = 0;
+    if (!(index >> pieces[i].PieceStartOffset >> pieces[i].PiecePointsOffset >>
+          pieces[i].NumPoints >> hasBounds))
+    {
+      return false;
+    }
+    if (hasBounds)
+    {
+      double bounds[6];
+      if (!(index >> bounds[0] >> bounds[1] >> bounds[2] >> bounds[3] >> bounds[4] >> bounds[5]))
+      {
+        return false;
+      }
+      if (!this->ConvertFromLatLongToXYZ)
+      {
+        pieces[i].BBox.SetBounds(bounds);
+        pieces[i].BBoxIsExact = true;
+      }
+    }
+  }
+
+  this->LIDARPieces.swap(pieces);
+  this->ValuesPerLine = valuesPerLine;
+  this->BytesPerPoint = bytesPerPoint;
+  if (!this->LIDARPieces.empty())
+  {
+    this->LastReadPieceOffset = this->LIDARPieces.back().PieceStartOffset;
+  }
+  this->IndexFileModified = false;
+  return true;
+}
+
+void vtkCMBPointsReader::WriteIndexFile()
+{
+  this->IndexFileModified = false;
+  struct stat fs;
+  if (!this->UseIndexFile || !this->CompleteFileHasBeenRead || stat(this->FileName, &fs) != 0)
+  {
+    return;
+  }
+
+  // write to a temporary file and rename, so that a reader never sees a
+  // partially written index (failure, for example a read only directory,
+  // just means no index)
+  std::string indexFileName = this->GetIndexFileName();
+  std::string tmpFileName = indexFileName + ".tmp";
+  {
+    ofstream index(tmpFileName.c_str());
+    if (!index)
+    {
+      return;
+    }
+    index.precision(17);
+    index << "CMBPointsIndex 1\n"
+          << static_cast<long long>(fs.st_size) << " " << static_cast<long long>(fs.st_mtime)
+          << "\n"
+          << this->FileType << " " << this->ValuesPerLine << " " << this->BytesPerPoint << "\n"
+          << this->LIDARPieces.size() << "\n";
+    for (size_t i = 0; i < this->LIDARPieces.size(); i++)
+    {
+      const LIDARPieceInfo& piece = this->LIDARPieces[i];
+      index << piece.PieceStartOffset << " " << piece.PiecePointsOffset << " " << piece.NumPoints;
+      if (piece.BBoxIsExact && piece.BBox.IsValid() && !this->ConvertFromLatLongToXYZ)
+      {
+        double bounds[6];
+        piece.BBox.GetBounds(bounds);
+        index << " 1 " << bounds[0] << " " << bounds[1] << " " << bounds[2] << " " << bounds[3]
+              << " " << bounds[4] << " " << bounds[5] << "\n";
+      }
+      else
+      {
+        index << " 0\n";
+      }
+    }
+    if (!index)
+    {
+      index.close();
+      vtksys::SystemTools::RemoveFile(tmpFileName.c_str());
+      return;
+    }
+  }
+  vtksys::SystemTools::RemoveFile(indexFileName.c_str());
+  if (rename(tmpFileName.c_str(), indexFileName.c_str()) != 0)
+  {
+    vtksys::SystemTools::RemoveFile(tmpFileName.c_str());
+  }
+}
+
 void vtkCMBPointsReader::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
 
   os << indent << "File Name: " << (this->FileName ? this->FileName : "(none)") << "\n";
-  os << indent
-     << "Convert From Lat/Long to xyz: " << (this->ConvertFromLatLongToXYZ ? "On" : "Off");
+  os << indent << "Convert From Lat/Long to xyz: " << (this->ConvertFromLatLongToXYZ ? "On" : "Off")
+     << "\n";
+  os << indent << "Use Index File: " << (this->UseIndexFile ? "On" : "Off") << "\n";
 }
 
 int vtkCMBPointsReader::RequestInformation(vtkInformation* vtkNotUsed(request),
@@ -24,6 +24,7 @@
 
 #include "vtkBoundingBox.h"
 #include <map>
+#include <string>
 #include <vector>
 
 class vtkTransform;
@@ -97,6 +98,23 @@ public:
   // header)
   int ReadFileInfo();
 
+  // Description:
+  // Whether or not to use an index file (FileName + ".cmbidx") next to the
+  // file.  The index holds what ReadFileInfo() would otherwise have to scan
+  // the whole file for (the offset and number of points of every piece),
+  // plus the bounds of the pieces that have been read in full.  It is keyed on
+  // the size and modification time of the file, and rewritten when stale.
+  // Defaults to true.
+  vtkBooleanMacro(UseIndexFile, bool);
+  vtkSetMacro(UseIndexFile, bool);
+  vtkGetMacro(UseIndexFile, bool);
+
+  // Description:
+  // Get the bounds of the piece specified by the PieceIndex, as known from
+  // reading the piece or from the index file; returns uninitialized bounds
+  // (VTK_DOUBLE_MAX, VTK_DOUBLE_MIN) if not known.
+  double* GetPieceBounds();
+
   // Description:
   // Boolean value indicates whether or not to limit points read to a specified
   // (ReadBounds) region.
@@ -165,14 +183,32 @@ protected:
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) override;
   int MoveToStartOfPiece(ifstream& fin, int pieceIndex);
 
-  int ReadPiece(ifstream& fin, int pieceIndex, int onRatio, long totalNumPts, vtkPoints* newPts,
-    vtkCellArray* newVerts, vtkUnsignedCharArray* scalars, vtkFloatArray* intensityArray,
+  int ReadPiece(ifstream& fin, const char* mappedFile, vtkTypeUInt64 mappedFileSize,
+    int pieceIndex, int onRatio, long totalNumPts, vtkPoints* newPts, vtkCellArray* newVerts,
+    vtkUnsignedCharArray* scalars, vtkFloatArray* intensityArray,
     vtkUnsignedCharArray* pieceIndexArray);
 
+  // Description:
+  // Read a piece from the memory mapped file; the piece is split into chunks
+  // (of whole lines, if ASCII) that are parsed by separate threads.  Returns
+  // the offset of the end of the piece in pieceEnd.
+  int ReadMappedPiece(const char* mappedFile, vtkTypeUInt64 mappedFileSize, int pieceIndex,
+    int onRatio, long totalNumPts, vtkPoints* newPts, vtkCellArray* newVerts,
+    vtkUnsignedCharArray* scalars, vtkFloatArray* intensityArray,
+    vtkUnsignedCharArray* pieceIndexArray, vtkTypeUInt64& pieceEnd);
+  void InitializeLatLongTransform(double pt[3]);
+
   // Description:
   // Get file type used to do last read
   vtkGetMacro(FileType, int);
   int GetPointInfo(ifstream& fin);
+
+  // Description:
+  // Read / write the index file; ReadIndexFile() returns false if there is no
+  // index, or it is out of date.
+  std::string GetIndexFileName();
+  bool ReadIndexFile();
+  void WriteIndexFile();
   vtkIdType GetEstimatedNumOfOutPoints();
 
   char* FileName;
@@ -198,11 +234,13 @@ protected:
     {
       this->PiecePointsOffset = 0;
       this->NumPoints = 0;
+      this->BBoxIsExact = false;
     }
     long PiecePointsOffset;
     long PieceStartOffset;
     vtkIdType NumPoints;
     vtkBoundingBox BBox;
+    bool BBoxIsExact; // every point of the piece was added to BBox
   };
 
   std::vector<LIDARPieceInfo> LIDARPieces;
@@ -210,6 +248,10 @@ protected:
   vtkIdType RealNumberOfOutputPoints;
   vtkIdType LastReadPieceOffset;
   int PieceIndex;
+  double PieceBounds[6];
+
+  bool UseIndexFile;
+  bool IndexFileModified;
 
   vtkTransform* Transform;
 
@@ -0,0 +1,286 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Measures the time to bring the client mirror of a model up to date after
+// an operation, for models of an increasing number of entities: either by
+// fetching the whole model from vtkModelManagerWrapper (what every operator
+// result used to cost) or by loading the cmbModelDelta of the changed
+// entities that answers the operator request.
+//
+// Each operation is a "set property" operator renaming a face, applied with
+// an "operator-apply" request to vtkModelManagerWrapper as the client does,
+// so the time of the request includes running the operator and serializing
+// its result and delta. The client updated with the deltas is then checked
+// against the one updated with the whole model, and a delta is checked to
+// bring the owning model of a created face along.
+#include "cmbModelDelta.h"
+#include "vtkModelManagerWrapper.h"
+
+#include "smtk/attribute/Attribute.h"
+#include "smtk/attribute/ModelEntityItem.h"
+#include "smtk/attribute/StringItem.h"
+#include "smtk/io/LoadJSON.h"
+#include "smtk/io/SaveJSON.h"
+#include "smtk/model/Face.h"
+#include "smtk/model/Manager.h"
+#include "smtk/model/Model.h"
+#include "smtk/model/Operator.h"
+#include "smtk/model/Session.h"
+#include "smtk/model/SessionRef.h"
+
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+
+#include "cJSON.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Send a request to the server, and parse its response.
+cJSON* request(vtkModelManagerWrapper* server, cJSON* req, size_t& bytes)
+{
+  char* reqStr = cJSON_Print(req);
+  cJSON_Delete(req);
+  server->SetJSONRequest(reqStr);
+  free(reqStr);
+  server->ProcessJSONRequest(NULL);
+  const char* responseStr = server->GetJSONResponse();
+  bytes = responseStr ? strlen(responseStr) : 0;
+  return responseStr ? cJSON_Parse(responseStr) : NULL;
+}
+
+cJSON* newRequest(const char* method, cJSON* params)
+{
+  cJSON* req = cJSON_CreateObject();
+  cJSON_AddItemToObject(req, "jsonrpc", cJSON_CreateString("2.0"));
+  cJSON_AddItemToObject(req, "method", cJSON_CreateString(method));
+  cJSON_AddItemToObject(req, "id", cJSON_CreateString("1"));
+  if (params)
+  {
+    cJSON_AddItemToObject(req, "params", params);
+  }
+  return req;
+}
+
+// Round trip a fetch-model request, as fetchWholeModel does.
+bool fetchWholeModel(vtkModelManagerWrapper* server, smtk::model::ManagerPtr client, size_t& bytes)
+{
+  cJSON* response = request(server, newRequest("fetch-model", NULL), bytes);
+  cJSON* model;
+  cJSON* topo;
+  bool ok = response && (model = cJSON_GetObjectItem(response, "result")) &&
+    model->type == cJSON_Object && (topo = cJSON_GetObjectItem(model, "topo")) &&
+    smtk::io::LoadJSON::ofManager(topo, client);
+  cJSON_Delete(response);
+  return ok;
+}
+
+// Rename a face with an operator-apply request, as vtkSMModelManagerProxy
+// does; returns the response, holding the delta.
+cJSON* renameFace(vtkModelManagerWrapper* server, const smtk::model::SessionRef& session,
+  const smtk::model::Face& face, const std::string& name, size_t& bytes)
+{
+  smtk::model::OperatorPtr op = session.session()->op("set property");
+  if (!op)
+  {
+    return NULL;
+  }
+  op->specification()->associateEntity(face);
+  op->findString("name")->setValue("name");
+  op->findString("string value")->setValue(name);
+
+  cJSON* params = cJSON_CreateObject();
+  smtk::io::SaveJSON::forOperator(op->specification(), params);
+  cJSON_AddItemToObject(
+    params, "sessionId", cJSON_CreateString(session.entity().toString().c_str()));
+  return request(server, newRequest("operator-apply", params), bytes);
+}
+
+// Load the delta of an operator-apply response, checking that it follows
+// the last one.
+bool applyDelta(cJSON* response, unsigned long& generation, smtk::model::ManagerPtr client)
+{
+  cJSON* result;
+  cJSON* delta;
+  unsigned long deltaGeneration = 0;
+  bool ok = response && (result = cJSON_GetObjectItem(response, "result")) &&
+    (delta = cJSON_GetObjectItem(result, "delta")) &&
+    cmbModelDelta::generationOf(delta, deltaGeneration) && deltaGeneration == generation + 1 &&
+    cmbModelDelta::load(delta, client);
+  generation = deltaGeneration;
+  return ok;
+}
+
+// The entities of the two clients, and their names, are the same.
+bool sameModels(smtk::model::ManagerPtr a, smtk::model::ManagerPtr b)
+{
+  if (a->topology().size() != b->topology().size())
+  {
+    return false;
+  }
+  smtk::model::UUIDWithEntity it;
+  for (it = a->topology().begin(); it != a->topology().end(); ++it)
+  {
+    smtk::model::EntityRef ea(a, it->first);
+    smtk::model::EntityRef eb(b, it->first);
+    if (!eb.isValid() || ea.name() != eb.name() || ea.entityFlags() != eb.entityFlags())
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A face created by an operator comes with the record of its model, which
+// now lists it, without the operator marking the model as modified.
+bool createdFaceUpdatesModel(smtk::model::Model& model, const smtk::model::SessionRef& session,
+  smtk::model::ManagerPtr client)
+{
+  smtk::model::Face face = model.manager()->addFace();
+  face.setName("created face");
+  model.addCell(face);
+
+  smtk::model::OperatorPtr op = session.session()->op("set property");
+  smtk::model::OperatorResult result = op->createResult(smtk::model::OPERATION_SUCCEEDED);
+  result->findModelEntity("created")->appendValue(face);
+  cmbModelDelta delta;
+  delta.addOperatorResult(result);
+  cJSON* json = delta.toJSON(0);
+  bool ok = cmbModelDelta::load(json, client);
+  cJSON_Delete(json);
+
+  smtk::model::CellEntities cells = smtk::model::Model(client, model.entity()).cells();
+  const smtk::model::CellEntity clientFace(client, face.entity());
+  return ok && std::find(cells.begin(), cells.end(), clientFace) != cells.end();
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc > 1 && (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")))
+  {
+    cerr << "usage:  ModelSyncBenchmark [numberOfOperations] [numberOfFaces ...]\n";
+    return -1;
+  }
+  int numberOfOperations = argc > 1 ? atoi(argv[1]) : 10;
+  std::vector<int> sizes;
+  for (int i = 2; i < argc; ++i)
+  {
+    if (atoi(argv[i]) > 0)
+    {
+      sizes.push_back(atoi(argv[i]));
+    }
+  }
+  if (sizes.empty())
+  {
+    sizes.push_back(1000);
+    sizes.push_back(10000);
+    sizes.push_back(50000);
+  }
+  if (numberOfOperations < 1)
+  {
+    numberOfOperations = 1;
+  }
+
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  printf("%10s %14s %14s %14s %14s %14s\n", "faces", "apply (ms/op)", "full (ms/op)",
+    "delta (ms/op)", "full (bytes)", "apply (bytes)");
+  for (size_t s = 0; s < sizes.size(); ++s)
+  {
+    vtkSmartPointer<vtkModelManagerWrapper> server =
+      vtkSmartPointer<vtkModelManagerWrapper>::New();
+    smtk::model::ManagerPtr serverMgr = server->GetModelManager();
+    smtk::model::SessionRef session = serverMgr->createSession("native");
+    smtk::model::Model model = serverMgr->addModel(2, 2, "benchmark model");
+    model.setSession(session);
+    smtk::model::Faces faces;
+    for (int i = 0; i < sizes[s]; ++i)
+    {
+      smtk::model::Face face = serverMgr->addFace();
+      std::ostringstream name;
+      name << "face " << i;
+      face.setName(name.str());
+      model.addCell(face);
+      faces.push_back(face);
+    }
+
+    smtk::model::ManagerPtr fullClient = smtk::model::Manager::create();
+    smtk::model::ManagerPtr deltaClient = smtk::model::Manager::create();
+    size_t bytes;
+    if (!fetchWholeModel(server, fullClient, bytes) || !fetchWholeModel(server, deltaClient, bytes))
+    {
+      cerr << "Could not fetch the model of " << sizes[s] << " faces\n";
+      return 1;
+    }
+
+    double applyTime = 0.0;
+    double fullTime = 0.0;
+    double deltaTime = 0.0;
+    size_t fullBytes = 0;
+    size_t applyBytes = 0;
+    unsigned long generation = 0;
+    for (int op = 0; op < numberOfOperations; ++op)
+    {
+      std::ostringstream name;
+      name << "operation " << op;
+
+      timer->StartTimer();
+      cJSON* response = renameFace(server, session, faces[op % faces.size()], name.str(), bytes);
+      timer->StopTimer();
+      applyTime += timer->GetElapsedTime();
+      applyBytes += bytes;
+
+      timer->StartTimer();
+      bool ok = fetchWholeModel(server, fullClient, bytes);
+      timer->StopTimer();
+      fullTime += timer->GetElapsedTime();
+      fullBytes += bytes;
+
+      timer->StartTimer();
+      ok = applyDelta(response, generation, deltaClient) && ok;
+      timer->StopTimer();
+      deltaTime += timer->GetElapsedTime();
+      cJSON_Delete(response);
+
+      if (!ok ||
+        smtk::model::EntityRef(deltaClient, faces[op % faces.size()].entity()).name() != name.str())
+      {
+        cerr << "Operation " << op << " was not synchronized on a model of " << sizes[s]
+             << " faces\n";
+        return 1;
+      }
+    }
+    if (!sameModels(fullClient, deltaClient))
+    {
+      cerr << "The deltas and the whole model differ on a model of " << sizes[s] << " faces\n";
+      return 1;
+    }
+    if (!createdFaceUpdatesModel(model, session, deltaClient))
+    {
+      cerr << "The delta of a created face does not update its model\n";
+      return 1;
+    }
+
+    printf("%10d %14.3f %14.3f %14.3f %14lu %14lu\n", sizes[s],
+      1000.0 * applyTime / numberOfOperations, 1000.0 * fullTime / numberOfOperations,
+      1000.0 * deltaTime / numberOfOperations,
+      static_cast<unsigned long>(fullBytes / numberOfOperations),
+      static_cast<unsigned long>(applyBytes / numberOfOperations));
+  }
+
+  return 0;
+}
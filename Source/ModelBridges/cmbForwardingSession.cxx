@@ -111,10 +111,16 @@ smtk::model::OperatorResult cmbForwardingSession::operateDelegate(smtk::model::R
 
   cJSON* resp = this->m_proxy->requestJSONOp(op, "operator-apply", this->sessionId());
   cJSON* err = NULL;
-  cJSON* res;
+  cJSON* res = NULL;
 
-  if (!resp || (err = cJSON_GetObjectItem(resp, "error")) ||
-    !(res = cJSON_GetObjectItem(resp, "result")) ||
+  // Bring the changed entities over before the result that refers to them.
+  if (resp && !cJSON_GetObjectItem(resp, "error") &&
+    (res = cJSON_GetObjectItem(resp, "result")) && res->type == cJSON_Object)
+  {
+    this->m_proxy->applyModelDelta(cJSON_GetObjectItem(res, "delta"));
+  }
+
+  if (!resp || (err = cJSON_GetObjectItem(resp, "error")) || !res ||
     !smtk::io::LoadJSON::ofOperatorResult(res, result, op))
   {
     if (resp)
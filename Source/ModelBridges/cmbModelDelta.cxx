@@ -0,0 +1,205 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+#include "cmbModelDelta.h"
+
+#include "smtk/attribute/Attribute.h"
+#include "smtk/attribute/ModelEntityItem.h"
+
+#include "smtk/io/LoadJSON.h"
+#include "smtk/io/SaveJSON.h"
+#include "smtk/model/EntityIterator.h"
+#include "smtk/model/Manager.h"
+#include "smtk/model/Model.h"
+
+#include "cJSON.h"
+
+namespace
+{
+
+void addItemEntities(
+  smtk::model::OperatorResult result, const char* itemName, smtk::model::EntityRefs& ents)
+{
+  smtk::attribute::ModelEntityItem::Ptr item = result->findModelEntity(itemName);
+  if (!item)
+  {
+    return;
+  }
+  smtk::model::EntityRefArray::const_iterator it;
+  for (it = item->begin(); it != item->end(); ++it)
+  {
+    if (!it->entity().isNull())
+    {
+      ents.insert(*it);
+    }
+  }
+}
+
+// The entities whose relations change when ent is created or expunged: the
+// model that owns it, the entity it is embedded in, and those it bounds.
+void addParents(const smtk::model::EntityRef& ent, smtk::model::EntityRefs& parents)
+{
+  if (!ent.isValid())
+  {
+    return;
+  }
+  smtk::model::Model model = ent.owningModel();
+  if (model.isValid())
+  {
+    parents.insert(model);
+  }
+  smtk::model::EntityRef embedding = ent.embeddedIn();
+  if (embedding.isValid())
+  {
+    parents.insert(embedding);
+  }
+  smtk::model::EntityRefs bordants = ent.bordantEntities();
+  parents.insert(bordants.begin(), bordants.end());
+}
+
+cJSON* createIdArray(const smtk::model::EntityRefs& ents)
+{
+  cJSON* arr = cJSON_CreateArray();
+  smtk::model::EntityRefs::const_iterator it;
+  for (it = ents.begin(); it != ents.end(); ++it)
+  {
+    cJSON_AddItemToArray(arr, cJSON_CreateString(it->entity().toString().c_str()));
+  }
+  return arr;
+}
+}
+
+cmbModelDelta::cmbModelDelta()
+{
+}
+
+void cmbModelDelta::addOperatorResult(smtk::model::OperatorResult result)
+{
+  if (!result)
+  {
+    return;
+  }
+  addItemEntities(result, "created", this->m_created);
+  addItemEntities(result, "modified", this->m_modified);
+  addItemEntities(result, "expunged", this->m_expunged);
+}
+
+void cmbModelDelta::addCreated(const smtk::model::EntityRef& ent)
+{
+  this->m_created.insert(ent);
+}
+
+void cmbModelDelta::addModified(const smtk::model::EntityRef& ent)
+{
+  this->m_modified.insert(ent);
+}
+
+void cmbModelDelta::addExpunged(const smtk::model::EntityRef& ent)
+{
+  this->m_expunged.insert(ent);
+}
+
+void cmbModelDelta::addParentsOf(const smtk::model::EntityRefs& ents)
+{
+  smtk::model::EntityRefs::const_iterator it;
+  for (it = ents.begin(); it != ents.end(); ++it)
+  {
+    addParents(*it, this->m_parentsOf[*it]);
+  }
+}
+
+bool cmbModelDelta::empty() const
+{
+  return this->m_created.empty() && this->m_modified.empty() && this->m_expunged.empty();
+}
+
+cJSON* cmbModelDelta::toJSON(unsigned long generation) const
+{
+  cJSON* delta = cJSON_CreateObject();
+  cJSON_AddItemToObject(delta, "generation", cJSON_CreateNumber(static_cast<double>(generation)));
+  cJSON_AddItemToObject(delta, "created", createIdArray(this->m_created));
+  cJSON_AddItemToObject(delta, "modified", createIdArray(this->m_modified));
+  cJSON_AddItemToObject(delta, "expunged", createIdArray(this->m_expunged));
+
+  // The children of a created entity (its uses, shells, loops...) are new
+  // too, but are not always listed in the result; those of a modified
+  // entity are not sent, its own record holds its relations to them.
+  smtk::model::EntityRefs records(this->m_modified);
+  smtk::model::EntityIterator eit;
+  eit.traverse(this->m_created.begin(), this->m_created.end(), smtk::model::ITERATE_CHILDREN);
+  for (eit.begin(); !eit.isAtEnd(); ++eit)
+  {
+    records.insert(*eit);
+  }
+  // The parents of the created and expunged entities gained or lost a
+  // relation, even when the result doesn't list them as modified.
+  smtk::model::EntityRefs::const_iterator it;
+  for (it = this->m_created.begin(); it != this->m_created.end(); ++it)
+  {
+    addParents(*it, records);
+  }
+  for (it = this->m_expunged.begin(); it != this->m_expunged.end(); ++it)
+  {
+    // the relations of an entity that is already erased are only known if
+    // addParentsOf() was called for it
+    addParents(*it, records);
+    std::map<smtk::model::EntityRef, smtk::model::EntityRefs>::const_iterator parents =
+      this->m_parentsOf.find(*it);
+    if (parents == this->m_parentsOf.end())
+    {
+      continue;
+    }
+    smtk::model::EntityRefs::const_iterator pit;
+    for (pit = parents->second.begin(); pit != parents->second.end(); ++pit)
+    {
+      if (pit->isValid())
+      {
+        records.insert(*pit);
+      }
+    }
+  }
+  for (it = this->m_expunged.begin(); it != this->m_expunged.end(); ++it)
+  {
+    records.erase(*it);
+  }
+
+  cJSON* recs = cJSON_CreateObject();
+  smtk::io::SaveJSON::forEntities(recs, records, smtk::model::ITERATE_BARE,
+    static_cast<smtk::io::JSONFlags>(smtk::io::JSON_ENTITIES | smtk::io::JSON_PROPERTIES));
+  cJSON_AddItemToObject(delta, "records", recs);
+  return delta;
+}
+
+bool cmbModelDelta::generationOf(cJSON* node, unsigned long& generation)
+{
+  cJSON* gen;
+  if (!node || node->type != cJSON_Object || !(gen = cJSON_GetObjectItem(node, "generation")) ||
+    gen->type != cJSON_Number || gen->valuedouble < 0.0)
+  {
+    return false;
+  }
+  generation = static_cast<unsigned long>(gen->valuedouble);
+  return true;
+}
+
+bool cmbModelDelta::load(cJSON* delta, smtk::model::ManagerPtr mgr)
+{
+  cJSON* records;
+  if (!delta || delta->type != cJSON_Object || !mgr ||
+    !(records = cJSON_GetObjectItem(delta, "records")) || records->type != cJSON_Object)
+  {
+    return false;
+  }
+  // Nothing was created or modified
+  if (!records->child)
+  {
+    return true;
+  }
+  return smtk::io::LoadJSON::ofManager(records, mgr) != 0;
+}
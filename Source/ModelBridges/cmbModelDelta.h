@@ -0,0 +1,79 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+#ifndef __cmbModelDelta_h
+#define __cmbModelDelta_h
+
+#include "ModelBridgeClientModule.h"
+#include "smtk/PublicPointerDefs.h"
+#include "smtk/model/EntityRef.h"
+
+#include <map>
+
+struct cJSON;
+
+// .NAME cmbModelDelta - The entities changed by an operator
+// .SECTION Description
+// vtkModelManagerWrapper answers "operator-apply" requests with a delta
+// holding the records of only the entities the operator created or
+// modified, and the ids of those it expunged, instead of the records of
+// the whole models that own them. The client mirror of the model
+// (vtkSMModelManagerProxy) loads the delta into its model manager.
+//
+// Each delta carries the generation of the server's model manager, which
+// is incremented once per operator applied, so that the client can tell
+// when it missed a delta and has to fetch the whole model again.
+//
+// The JSON of a delta is:
+//   { "generation": N,
+//     "created": [uuid, ...], "modified": [uuid, ...], "expunged": [uuid, ...],
+//     "records": { uuid: entity record, ... } }
+// where the records are those of the created entities and their children,
+// of the modified entities, and of the parents (owning model, embedding and
+// bordant entities) of the created and expunged entities, as written by the
+// "fetch-model" request (entities and properties, no tessellations).
+class MODELBRIDGECLIENT_EXPORT cmbModelDelta
+{
+public:
+  cmbModelDelta();
+
+  /// Add the "created", "modified" and "expunged" entities of an operator result.
+  void addOperatorResult(smtk::model::OperatorResult result);
+
+  void addCreated(const smtk::model::EntityRef& ent);
+  void addModified(const smtk::model::EntityRef& ent);
+  void addExpunged(const smtk::model::EntityRef& ent);
+
+  /// Add the parents of entities that an operator may expunge, before it runs:
+  /// the relations of an expunged entity are gone once the operator is done.
+  void addParentsOf(const smtk::model::EntityRefs& ents);
+
+  bool empty() const;
+
+  /// Serialize the delta; the caller owns the returned object.
+  cJSON* toJSON(unsigned long generation) const;
+
+  /// Get the generation of a serialized delta (or of a "fetch-model" result).
+  static bool generationOf(cJSON* node, unsigned long& generation);
+
+  /// Load the records of a serialized delta into \a mgr.
+  ///
+  /// The expunged entities are not erased from \a mgr: that is left to the
+  /// handling of the operator result that lists them, as it was before deltas.
+  static bool load(cJSON* delta, smtk::model::ManagerPtr mgr);
+
+protected:
+  smtk::model::EntityRefs m_created;
+  smtk::model::EntityRefs m_modified;
+  smtk::model::EntityRefs m_expunged;
+  // the parents of the entities passed to addParentsOf()
+  std::map<smtk::model::EntityRef, smtk::model::EntityRefs> m_parentsOf;
+};
+
+#endif // __cmbModelDelta_h
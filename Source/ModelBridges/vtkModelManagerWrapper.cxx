@@ -9,6 +9,8 @@
 //=========================================================================
 #include "vtkModelManagerWrapper.h"
 
+#include "cmbModelDelta.h"
+
 #include "smtk/io/LoadJSON.h"
 #include "smtk/io/SaveJSON.h"
 
@@ -32,6 +34,7 @@ vtkModelManagerWrapper::vtkModelManagerWrapper()
   this->ModelMgr = smtk::model::Manager::create();
   this->JSONRequest = NULL;
   this->JSONResponse = NULL;
+  this->ModelGeneration = 0;
   //  this->ModelEntityID = NULL;
 }
 
@@ -49,6 +52,7 @@ void vtkModelManagerWrapper::PrintSelf(ostream& os, vtkIndent indent)
   //  os << indent << "ModelEntityID:" << this->ModelEntityID << "\n";
   os << indent << "JSONResponse:" << this->JSONResponse << "\n";
   os << indent << "ModelMgr:" << this->ModelMgr.get() << "\n";
+  os << indent << "ModelGeneration:" << this->ModelGeneration << "\n";
 }
 
 /// Get the SMTK model being displayed.
@@ -190,6 +194,8 @@ void vtkModelManagerWrapper::ProcessJSONRequest(vtkSMTKOperator* vsOp)
         // Until someone makes us.
         smtk::io::SaveJSON::fromModelManager(model, this->ModelMgr,
           static_cast<smtk::io::JSONFlags>(smtk::io::JSON_ENTITIES | smtk::io::JSON_PROPERTIES));
+        cJSON_AddItemToObject(model, "generation",
+          cJSON_CreateNumber(static_cast<double>(this->ModelGeneration)));
         cJSON_AddItemToObject(result, "result", model);
       }
       else if (methStr == "operator-able")
@@ -229,6 +235,11 @@ void vtkModelManagerWrapper::ProcessJSONRequest(vtkSMTKOperator* vsOp)
           ani->setIsEnabled(true);
           ani->setValue(1);
           smtk::model::OperatorResult ores;
+          // The entities the operator acts on may be expunged by it, keep
+          // their parents for the delta while their relations still exist.
+          cmbModelDelta delta;
+          delta.addParentsOf(
+            localOp->specification()->associatedModelEntities<smtk::model::EntityRefs>());
           bool exeptionCaught = false;
           try
           {
@@ -249,11 +260,19 @@ void vtkModelManagerWrapper::ProcessJSONRequest(vtkSMTKOperator* vsOp)
             this->GenerateError(result, errMsg, "");
             exeptionCaught = true;
           }
+          // The operator may have changed the model even when it threw, in
+          // which case the client sees a gap at the next delta and refetches.
+          ++this->ModelGeneration;
 
           if (!exeptionCaught)
           {
             cJSON* oresult = cJSON_CreateObject();
             smtk::io::SaveJSON::forOperatorResult(ores, oresult);
+            // Replace the records of the whole models owning the changed
+            // entities with those of the changed entities only.
+            cJSON_DeleteItemFromObject(oresult, "records");
+            delta.addOperatorResult(ores);
+            cJSON_AddItemToObject(oresult, "delta", delta.toJSON(this->ModelGeneration));
             cJSON_AddItemToObject(result, "result", oresult);
           }
         }
@@ -31,7 +31,10 @@ class vtkSMTKOperator;
 //
 // Model synchronization is accomplished by serializing the
 // SMTK model into a JSON string maintained as field data on
-// an instance of this class.
+// an instance of this class. The whole model is only sent
+// when the client fetches it; the result of each operator
+// carries a cmbModelDelta with just the entities it changed,
+// numbered by the ModelGeneration.
 // Operators are also serialized (1) by this instance in order
 // for the client to enumerate them and (2) by the client in
 // order for this object to execute them.
@@ -55,6 +58,12 @@ public:
 
   vtkGetStringMacro(JSONResponse);
 
+  // Description:
+  // The number of operators applied to the model manager, sent with
+  // the model and with every model delta so that the client can detect
+  // a delta it has missed.
+  vtkGetMacro(ModelGeneration, unsigned long);
+
   std::string CanOperatorExecute(const std::string& jsonOperator);
   std::string ApplyOperator(const std::string& jsonOperator);
 
@@ -70,6 +79,7 @@ protected:
 
   char* JSONRequest;
   char* JSONResponse;
+  unsigned long ModelGeneration;
   //  char* ModelEntityID;
 
   // Instance model Manager:
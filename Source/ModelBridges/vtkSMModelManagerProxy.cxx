@@ -23,6 +23,7 @@
 #include "cJSON.h"
 
 #include "cmbForwardingSession.h"
+#include "cmbModelDelta.h"
 #include "vtkClientServerStream.h"
 #include "vtkObjectFactory.h"
 #include "vtkSMPropertyHelper.h"
@@ -45,6 +46,7 @@ vtkSMModelManagerProxy::vtkSMModelManagerProxy()
   // This model will be mirrored (topology-only) from the server
   this->m_modelMgr = smtk::model::Manager::create();
   this->m_serverSession = NULL;
+  this->m_modelGeneration = 0;
 }
 
 vtkSMModelManagerProxy::~vtkSMModelManagerProxy()
@@ -58,6 +60,7 @@ void vtkSMModelManagerProxy::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
   os << indent << "ModelMgr: " << this->m_modelMgr.get() << "\n";     // m_modelMgr
   os << indent << "ServerSession: " << this->m_serverSession << "\n"; // m_serverSession
+  os << indent << "ModelGeneration: " << this->m_modelGeneration << "\n";
 }
 
 /// Return the list of session types available on the server (not the local modelManager()'s list).
@@ -611,10 +614,27 @@ void vtkSMModelManagerProxy::fetchWholeModel()
   //  std::cout << " ----- \n\n\n" << cJSON_Print(response) << "\n ----- \n\n\n";
   if (response && (model = cJSON_GetObjectItem(response, "result")) &&
     model->type == cJSON_Object && (topo = cJSON_GetObjectItem(model, "topo")))
+  {
     LoadJSON::ofManager(topo, this->m_modelMgr);
+    cmbModelDelta::generationOf(model, this->m_modelGeneration);
+  }
   cJSON_Delete(response);
 }
 
+bool vtkSMModelManagerProxy::applyModelDelta(cJSON* delta)
+{
+  unsigned long generation;
+  if (!cmbModelDelta::generationOf(delta, generation) ||
+    generation != this->m_modelGeneration + 1 || !cmbModelDelta::load(delta, this->m_modelMgr))
+  {
+    // A delta was missed (or is unreadable), resynchronize.
+    this->fetchWholeModel();
+    return false;
+  }
+  this->m_modelGeneration = generation;
+  return true;
+}
+
 void vtkSMModelManagerProxy::endSessions()
 {
   while (!this->m_remoteSessionIds.empty())
@@ -43,6 +43,13 @@ public:
 
   void fetchWholeModel();
 
+  /// Load the entities changed by an operator (see cmbModelDelta) into the
+  /// model manager. When the delta does not follow the last one applied,
+  /// the whole model is fetched instead and false is returned.
+  bool applyModelDelta(cJSON* delta);
+  /// The generation of the server's model that modelManager() mirrors.
+  unsigned long modelGeneration() const { return this->m_modelGeneration; }
+
   smtk::model::ManagerPtr modelManager();
   void endSessions();
   bool validSession(const smtk::common::UUID& sessionId);
@@ -77,6 +84,7 @@ protected:
   /// map for session file types
   /// <sessionName, <engine-name, fileTypesList> >
   std::map<std::string, smtk::model::StringData> m_sessionFileTypes;
+  unsigned long m_modelGeneration;
 
 private:
   vtkSMModelManagerProxy(const vtkSMModelManagerProxy&); // Not implemented.
@@ -84,6 +84,79 @@ vtkIdType vtkSMCMBGlyphPointSourceProxy::InsertNextPoint(
   return id;
 }
 
+vtkIdType vtkSMCMBGlyphPointSourceProxy::InsertNextPoints(
+  vtkIdType n, double* points, double* scales, double* orientations)
+{
+  if (n <= 0)
+  {
+    return this->GetNumberOfPoints();
+  }
+  vtkClientServerStream stream;
+  stream << vtkClientServerStream::Invoke << VTKOBJECT(this) << "InsertNextPoints" << n
+         << vtkClientServerStream::InsertArray(points, static_cast<int>(3 * n))
+         << vtkClientServerStream::End;
+  this->ExecuteStream(stream);
+  vtkIdType id;
+  int retVal = this->GetSession()->GetLastResult(this->Location).GetArgument(0, 0, &id);
+  if (!retVal)
+  {
+    vtkErrorMacro("Error getting id from server.");
+    return -1;
+  }
+
+  if (scales || orientations)
+  {
+    vtkClientServerStream properties;
+    if (scales)
+    {
+      properties << vtkClientServerStream::Invoke << VTKOBJECT(this) << "SetScales" << id << n
+                 << vtkClientServerStream::InsertArray(scales, static_cast<int>(3 * n))
+                 << vtkClientServerStream::End;
+    }
+    if (orientations)
+    {
+      properties << vtkClientServerStream::Invoke << VTKOBJECT(this) << "SetOrientations" << id
+                 << n << vtkClientServerStream::InsertArray(orientations, static_cast<int>(3 * n))
+                 << vtkClientServerStream::End;
+    }
+    this->ExecuteStream(properties);
+  }
+  this->MarkModified(this);
+  return id;
+}
+
+vtkIdType vtkSMCMBGlyphPointSourceProxy::InsertNextGlyphs(vtkSMCMBGlyphPointSourceProxy* source)
+{
+  vtkClientServerStream stream;
+  stream << vtkClientServerStream::Invoke << VTKOBJECT(this) << "InsertNextGlyphs"
+         << VTKOBJECT(source) << vtkClientServerStream::End;
+  this->ExecuteStream(stream);
+  vtkIdType id;
+  int retVal = this->GetSession()->GetLastResult(this->Location).GetArgument(0, 0, &id);
+  if (!retVal)
+  {
+    vtkErrorMacro("Error getting id from server.");
+    return -1;
+  }
+  this->MarkModified(this);
+  return id;
+}
+
+void vtkSMCMBGlyphPointSourceProxy::GetModifiedRange(vtkIdType range[2])
+{
+  range[0] = 0;
+  range[1] = -1;
+  vtkClientServerStream stream;
+  stream << vtkClientServerStream::Invoke << VTKOBJECT(this) << "GetModifiedRange"
+         << vtkClientServerStream::End;
+  this->ExecuteStream(stream);
+  const vtkClientServerStream& res = this->GetLastResult(this->Location);
+  if (!res.GetArgument(0, 0, range, 2))
+  {
+    vtkErrorMacro("Error getting modified range from server.");
+  }
+}
+
 void vtkSMCMBGlyphPointSourceProxy::SetScale(vtkIdType index, double* scale)
 {
   this->SendDouble3Vector("SetScale", index, scale);
@@ -41,6 +41,22 @@ public:
   vtkIdType InsertNextPoint(
     double* point, double* color, double* scale, double* orientation, int visibility);
 
+  // Description:
+  // Insert n points in a single round trip to the server, optionally
+  // along with their scales and orientations (3 values per point).
+  // Returns the id of the first inserted point.
+  vtkIdType InsertNextPoints(
+    vtkIdType n, double* points, double* scales = 0, double* orientations = 0);
+
+  // Description:
+  // Insert the glyphs (points, scales and orientations) of source, copied
+  // on the server in a single round trip.  Returns the id of the first one.
+  vtkIdType InsertNextGlyphs(vtkSMCMBGlyphPointSourceProxy* source);
+
+  // Description:
+  // The range of glyph ids modified before the last update of the source.
+  void GetModifiedRange(vtkIdType range[2]);
+
   void SetScale(vtkIdType index, double* scale);
   void SetOrientation(vtkIdType index, double* orientation);
   void SetVisibility(vtkIdType index, int flag);
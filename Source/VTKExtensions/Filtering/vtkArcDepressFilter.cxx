@@ -22,6 +22,8 @@
 #include "vtkKochanekSpline.h"
 #include "vtkLine.h"
 #include "vtkMergePoints.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPiecewiseFunction.h"
 #include "vtkPlaneSource.h"
@@ -61,6 +63,8 @@ public:
   virtual void addPoint(double w, double v, double s, double m) = 0;
   virtual void clearPoints() = 0;
   virtual ArcDepressFunction* clone() const = 0;
+  // do any lazy setup now, so evaluate() can be called from several threads
+  virtual void prepare() {}
 };
 
 class MixArcDepressFunction : public ArcDepressFunction
@@ -103,6 +107,12 @@ public:
     return new MixArcDepressFunction(fun0->clone(), fun1->clone(), mix);
   }
 
+  void prepare() override
+  {
+    fun0->prepare();
+    fun1->prepare();
+  }
+
   ArcDepressFunction *fun0, *fun1;
   double mix;
 };
@@ -194,6 +204,15 @@ public:
     fun->RemoveAllPoints();
     computed = false;
   }
+
+  void prepare() override
+  {
+    if (!computed)
+    {
+      fun->Compute();
+      computed = true;
+    }
+  }
   double prev;
   bool computed;
   vtkKochanekSpline* fun;
@@ -222,7 +241,13 @@ public:
   virtual double apply(double d, double* pt, double* n) const = 0;
   virtual void addWeightPoint(double w, double v, double s, double m) = 0;
   virtual bool inside(double d) const = 0;
+  // largest |d| for which inside(d) can be true
+  virtual double maxDistance() const = 0;
   virtual void setFunctionRange(double /*minZ*/, double /*maxZ*/) {}
+  // whether setFunctionRange() changes the function
+  virtual bool dependsOnRange() const { return false; }
+  // do any lazy setup now, so apply() can be called from several threads
+  virtual void prepare() {}
 };
 
 class DepArcMixProfileFunction : public DepArcProfileFunction
@@ -264,11 +289,24 @@ public:
   }
 
   bool inside(double d) const override { return fun[0]->inside(d) || fun[1]->inside(d); }
+  double maxDistance() const override
+  {
+    return std::max(fun[0]->maxDistance(), fun[1]->maxDistance());
+  }
   void setFunctionRange(double minZ, double maxZ) override
   {
     fun[0]->setFunctionRange(minZ, maxZ);
     fun[1]->setFunctionRange(minZ, maxZ);
   }
+  bool dependsOnRange() const override
+  {
+    return fun[0]->dependsOnRange() || fun[1]->dependsOnRange();
+  }
+  void prepare() override
+  {
+    fun[0]->prepare();
+    fun[1]->prepare();
+  }
 
   void addWeightPoint(
     double vtkNotUsed(w), double vtkNotUsed(v), double vtkNotUsed(s), double vtkNotUsed(m)) override
@@ -403,6 +441,34 @@ public:
     return d <= maxWidth[Right];
   }
 
+  double maxDistance() const override { return std::max(maxWidth[Left], maxWidth[Right]); }
+
+  // bound of maxDistance() of interpolate(other, t), for any t
+  double maxInterpolatedDistance(DepArcWedgeProfileFunction const* other) const
+  {
+    double r = std::max(this->maxDistance(), other->maxDistance());
+    if (this->relative && other->relative)
+    {
+      // the interpolated max width is half the base width plus the
+      // displacement times a blend of the inverse slopes
+      double invSlope = 0;
+      for (int i = 0; i < 2; ++i)
+      {
+        if (this->slope[i] != 0)
+          invSlope = std::max(invSlope, 1 / std::abs(this->slope[i]));
+        if (other->slope[i] != 0)
+          invSlope = std::max(invSlope, 1 / std::abs(other->slope[i]));
+      }
+      r = std::max(r, 0.5 * std::max(std::abs(this->baseWidth), std::abs(other->baseWidth)) +
+          std::max(std::abs(this->displacement), std::abs(other->displacement)) * invSlope);
+    }
+    return r;
+  }
+
+  bool dependsOnRange() const override { return !relative; }
+
+  void prepare() override { weightFuntion->prepare(); }
+
   DepArcProfileFunction* interpolate(DepArcWedgeProfileFunction* other, double t)
   {
     assert(other->weightFuntion != NULL);
@@ -644,6 +710,17 @@ public:
     return getMinDistance() <= d && d <= getMaxDistance();
   }
 
+  double maxDistance() const override
+  {
+    return std::max(std::abs(getMinDistance()), std::abs(getMaxDistance()));
+  }
+
+  void prepare() override
+  {
+    SelectedFunction[WeightFun]->prepare();
+    SelectedFunction[DispFun]->prepare();
+  }
+
 protected:
   bool IsSymmetric;
   bool IsRelative;
@@ -679,10 +756,12 @@ boost::shared_ptr<DepArcProfileFunction> interpolate_functions(
 class DepArcData
 {
   friend class vtkArcDepressFilter;
+  friend VTK_THREAD_RETURN_TYPE vtkArcDepressDisplacePoints(void* arg);
 
 private:
   DepArcData()
     : IsEnabled(true)
+    , Version(0)
   {
   }
 
@@ -833,6 +912,63 @@ private:
       }
     }
 
+    // squared distance to the closest point, which is getPoint(t)
+    // (same arithmetic as findClosestPoint, without building the point)
+    double closestDistSquared(point const& pt, double& t) const
+    {
+      t = 0;
+      double l2 = dr.normSquared();
+      if (l2 == 0)
+      {
+        return pt.distSquared(*pt1);
+      }
+      point tpt1 = pt - *pt1;
+      t = tpt1.dot(this->dr) / l2;
+      if (t <= 0.0)
+      {
+        t = 0;
+        return pt.distSquared(*pt1);
+      }
+      else if (t >= 1.0)
+      {
+        t = 1;
+        return pt.distSquared(*pt2);
+      }
+      point tmppt = *(pt1) + dr * t;
+      return pt.distSquared(tmppt);
+    }
+
+    // largest distance at which the functions along the segment can apply
+    double maxDistance() const
+    {
+      boost::shared_ptr<DepArcProfileFunction> fun0 = pt1->getFunction();
+      boost::shared_ptr<DepArcProfileFunction> fun1 = pt2->getFunction();
+      if (!fun0 || !fun1)
+      {
+        // getPoint() can not interpolate, only the end points apply
+        return std::max(fun0 ? fun0->maxDistance() : 0.0, fun1 ? fun1->maxDistance() : 0.0);
+      }
+      if (fun0 == fun1)
+      {
+        return fun0->maxDistance();
+      }
+      DepArcWedgeProfileFunction* w0 = dynamic_cast<DepArcWedgeProfileFunction*>(fun0.get());
+      DepArcWedgeProfileFunction* w1 = dynamic_cast<DepArcWedgeProfileFunction*>(fun1.get());
+      if (w0 != NULL && w1 != NULL)
+      {
+        return w0->maxInterpolatedDistance(w1);
+      }
+      return std::max(fun0->maxDistance(), fun1->maxDistance());
+    }
+
+    void getBounds(double bounds[4]) const
+    {
+      bounds[0] = std::min(pt1->pt[0], pt2->pt[0]);
+      bounds[1] = std::max(pt1->pt[0], pt2->pt[0]);
+      bounds[2] = std::min(pt1->pt[1], pt2->pt[1]);
+      bounds[3] = std::max(pt1->pt[1], pt2->pt[1]);
+    }
+
     bool side(point& pt, point& closePt) const
     {
       point cpDir = pt - closePt;
@@ -864,6 +1000,168 @@ private:
   };
 
   bool IsEnabled;
+  // changes with every edit of the arc (see vtkArcDepressFilter::ArcModified)
+  unsigned long Version;
+
+  // Uniform grid of the segments, each one binned in the cells its bounds
+  // (grown by how far any of the functions reach) overlap.  A mesh point only
+  // looks at the segments of its cell: the others are farther than any
+  // function reaches, so they can neither displace it nor be its closest
+  // segment when it is displaced.
+  struct segment_index
+  {
+    segment_index()
+      : built(false)
+      , cellSize(1)
+    {
+      origin[0] = origin[1] = 0;
+      dims[0] = dims[1] = 0;
+    }
+    bool built;
+    double origin[2];
+    double cellSize;
+    vtkIdType dims[2];
+    // the segments of cell c are segments[offsets[c]] to segments[offsets[c + 1]],
+    // in increasing order
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> segments;
+  };
+  segment_index index;
+
+  void cellRange(double const bounds[4], vtkIdType range[4]) const
+  {
+    for (int i = 0; i < 2; ++i)
+    {
+      double lo = std::floor((bounds[2 * i] - index.origin[i]) / index.cellSize);
+      double hi = std::floor((bounds[2 * i + 1] - index.origin[i]) / index.cellSize);
+      range[2 * i] = lo < 0 ? 0 : static_cast<vtkIdType>(lo);
+      range[2 * i + 1] = std::min(static_cast<vtkIdType>(hi), index.dims[i] - 1);
+    }
+  }
+
+  void buildIndex()
+  {
+    index.built = false;
+    if (lines.empty())
+    {
+      return;
+    }
+    double reach = 0, length = 0;
+    double bounds[4] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+      reach = std::max(reach, lines[i]->maxDistance());
+      length += lines[i]->length();
+      double lb[4];
+      lines[i]->getBounds(lb);
+      bounds[0] = std::min(bounds[0], lb[0]);
+      bounds[1] = std::max(bounds[1], lb[1]);
+      bounds[2] = std::min(bounds[2], lb[2]);
+      bounds[3] = std::max(bounds[3], lb[3]);
+    }
+    if (!(reach < VTK_DOUBLE_MAX))
+    {
+      // the functions are not set up (or unbounded), search everything
+      return;
+    }
+    index.origin[0] = bounds[0] - reach;
+    index.origin[1] = bounds[2] - reach;
+    double width = bounds[1] - bounds[0] + 2 * reach;
+    double height = bounds[3] - bounds[2] + 2 * reach;
+
+    // cells about the size of the reach (or of a segment), but not (many)
+    // more cells than segments
+    double maxNumberOfCells = 4.0 * static_cast<double>(lines.size()) + 16.0;
+    index.cellSize = std::max(reach, length / lines.size());
+    double minCellSize = std::sqrt(width * height / maxNumberOfCells);
+    minCellSize = std::max(minCellSize, std::max(width, height) / maxNumberOfCells);
+    if (!(index.cellSize > minCellSize))
+    {
+      index.cellSize = minCellSize;
+    }
+    if (!(index.cellSize > 0))
+    {
+      index.cellSize = 1;
+    }
+    index.dims[0] = static_cast<vtkIdType>(width / index.cellSize) + 1;
+    index.dims[1] = static_cast<vtkIdType>(height / index.cellSize) + 1;
+
+    // count, then fill
+    index.offsets.assign(index.dims[0] * index.dims[1] + 1, 0);
+    std::vector<vtkIdType> lineRanges(4 * lines.size());
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+      double lb[4];
+      lines[i]->getBounds(lb);
+      lb[0] -= reach;
+      lb[1] += reach;
+      lb[2] -= reach;
+      lb[3] += reach;
+      vtkIdType* range = &lineRanges[4 * i];
+      this->cellRange(lb, range);
+      for (vtkIdType y = range[2]; y <= range[3]; ++y)
+      {
+        for (vtkIdType x = range[0]; x <= range[1]; ++x)
+        {
+          ++index.offsets[x + y * index.dims[0] + 1];
+        }
+      }
+    }
+    for (size_t c = 1; c < index.offsets.size(); ++c)
+    {
+      index.offsets[c] += index.offsets[c - 1];
+    }
+    index.segments.resize(index.offsets.back());
+    std::vector<unsigned int> next(index.offsets.begin(), index.offsets.end() - 1);
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+      vtkIdType const* range = &lineRanges[4 * i];
+      for (vtkIdType y = range[2]; y <= range[3]; ++y)
+      {
+        for (vtkIdType x = range[0]; x <= range[1]; ++x)
+        {
+          index.segments[next[x + y * index.dims[0]]++] = static_cast<unsigned int>(i);
+        }
+      }
+    }
+    index.built = true;
+  }
+
+  // The points outside these (x, y) bounds are never displaced by the arc;
+  // false when they are not known.  Valid after prepare().
+  bool getInfluenceBounds(double bounds[4]) const
+  {
+    if (!index.built)
+    {
+      return false;
+    }
+    bounds[0] = index.origin[0];
+    bounds[1] = index.origin[0] + index.dims[0] * index.cellSize;
+    bounds[2] = index.origin[1];
+    bounds[3] = index.origin[1] + index.dims[1] * index.cellSize;
+    return true;
+  }
+
+  // Get the functions ready for getDistance() from several threads, and
+  // bin the segments (unless every segment is to be searched).  Must follow
+  // setUpFunctions() and updateBound().
+  void prepare(bool useIndex)
+  {
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+      boost::shared_ptr<DepArcProfileFunction> fun = points[i]->getFunction();
+      if (fun)
+        fun->prepare();
+    }
+    if (useIndex)
+    {
+      this->buildIndex();
+    }
+    else
+    {
+      index.built = false;
+    }
+  }
 
   void addPoint(double x, double y)
   {
@@ -890,6 +1188,7 @@ private:
     }
     points.clear();
     functions.clear();
+    index.built = false;
     assert(lines.empty() && points.empty() && functions.empty());
   }
 
@@ -900,21 +1199,40 @@ private:
       return false;
     }
     point pt(pin[0], pin[1]);
-    point closePt = *(points[0]);
-    result = pt.distSquared(closePt);
+    unsigned int const* candidates = NULL;
+    size_t numberOfCandidates = lines.size();
+    if (index.built)
+    {
+      double x = std::floor((pin[0] - index.origin[0]) / index.cellSize);
+      double y = std::floor((pin[1] - index.origin[1]) / index.cellSize);
+      if (x < 0 || y < 0 || x >= index.dims[0] || y >= index.dims[1])
+      {
+        return false;
+      }
+      vtkIdType c = static_cast<vtkIdType>(x) + static_cast<vtkIdType>(y) * index.dims[0];
+      numberOfCandidates = index.offsets[c + 1] - index.offsets[c];
+      if (numberOfCandidates == 0)
+      {
+        return false;
+      }
+      candidates = &index.segments[index.offsets[c]];
+    }
+    result = pt.distSquared(*(points[0]));
     lsId = 0;
-    for (unsigned int i = 0; i < lines.size(); ++i)
+    double closeT = -1; // points[0]
+    for (size_t j = 0; j < numberOfCandidates; ++j)
     {
-      line_seg const* ls = lines[i];
-      point tmppt = ls->findClosestPoint(pt);
-      double tmp = pt.distSquared(tmppt);
+      size_t i = candidates ? candidates[j] : j;
+      double t;
+      double tmp = lines[i]->closestDistSquared(pt, t);
       if (tmp < result)
       {
         result = tmp;
-        closePt = tmppt;
+        closeT = t;
         lsId = i;
       }
     }
+    point closePt = (closeT < 0) ? *(points[0]) : lines[lsId]->getPoint(closeT);
     result = sqrt(result);
     resultPt = closePt;
     if (closePt.getFunction() == NULL)
@@ -950,6 +1268,7 @@ private:
     size_t prev = points.size() - 1;
     DepArcData::line_seg* l = new DepArcData::line_seg(points[prev], points[0]);
     lines.push_back(l);
+    index.built = false;
   }
 
   void setFunction(size_t b, size_t e, boost::shared_ptr<DepArcProfileFunction> fun)
@@ -1029,6 +1348,18 @@ private:
     }
   }
 
+  // whether updateBound() changes how the points are displaced
+  bool dependsOnBound()
+  {
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+      boost::shared_ptr<DepArcProfileFunction> fun = points[i]->getFunction();
+      if (fun && fun->dependsOnRange())
+        return true;
+    }
+    return false;
+  }
+
   void updateBound(double minZ, double maxZ)
   {
     for (unsigned int i = 0; i < functions.size(); ++i)
@@ -1043,6 +1374,90 @@ private:
   std::vector<boost::shared_ptr<DepArcProfileFunction> > functions;
 };
 
+namespace
+{
+// The points an arc displaced (those within reach of one of its functions),
+// in increasing id order
+struct ArcDepressDisplacement
+{
+  std::vector<vtkIdType> Ids;
+  std::vector<double> Points; // position after the displacement
+  std::vector<signed char> Dirs; // 0 no change, 1 raise, -1 dig
+
+  void clear()
+  {
+    this->Ids.clear();
+    this->Points.clear();
+    this->Dirs.clear();
+  }
+  size_t size() const { return this->Ids.size(); }
+  void push_back(vtkIdType id, double const* pt, signed char dir)
+  {
+    this->Ids.push_back(id);
+    this->Points.insert(this->Points.end(), pt, pt + 3);
+    this->Dirs.push_back(dir);
+  }
+  void append(ArcDepressDisplacement const& other, size_t i)
+  {
+    this->push_back(other.Ids[i], &other.Points[3 * i], other.Dirs[i]);
+  }
+};
+
+// One arc of ApplyOrder, as applied by the last computeDisplacement
+struct ArcDepressStage
+{
+  int ArcId;
+  unsigned long ArcVersion;
+  // the z range the functions were set up with (only matters for the
+  // functions that depend on it)
+  double InputBounds[2];
+  // the points outside of these were not displaced
+  bool HasInfluenceBounds;
+  double InfluenceBounds[4];
+  ArcDepressDisplacement Displacement;
+};
+}
+
+// What the last RequestData computed, so an edit of one arc only
+// re-evaluates the points around it (its old and new influence bounds).
+struct vtkArcDepressFilterInternals
+{
+  vtkArcDepressFilterInternals()
+    : NumberOfArcEdits(0)
+    , Input(NULL)
+    , InputTime(0)
+    , UseNormalDirection(false)
+    , AllPointsDirty(true)
+  {
+  }
+
+  // Drop everything when not computed from the same input.
+  void CheckInput(vtkPolyData* input, bool useNormalDirection)
+  {
+    if (input != this->Input || input->GetMTime() != this->InputTime ||
+      useNormalDirection != this->UseNormalDirection)
+    {
+      this->Stages.clear();
+      this->CellChange.clear();
+      this->Input = input;
+      this->InputTime = input->GetMTime();
+      this->UseNormalDirection = useNormalDirection;
+    }
+  }
+
+  unsigned long NumberOfArcEdits;
+  vtkPolyData* Input;
+  vtkMTimeType InputTime;
+  bool UseNormalDirection;
+  std::vector<ArcDepressStage> Stages;
+  // volume added and removed by each triangle
+  std::vector<double> CellChange;
+  // points re-evaluated by the last computeDisplacement; the other ones
+  // moved exactly as they did before
+  std::vector<char> DirtyPoints;
+  bool AllPointsDirty;
+};
+
 void vtkArcDepressFilter::PrintSelf(ostream& /*os*/, vtkIndent /*indent*/)
 {
 }
@@ -1052,6 +1467,7 @@ void vtkArcDepressFilter::ClearActiveArcPoints(int arc_ind)
   if (arc_ind < 0 || static_cast<size_t>(arc_ind) >= Arcs.size() || Arcs[arc_ind] == NULL)
     return;
   Arcs[arc_ind]->clear();
+  this->ArcModified(Arcs[arc_ind]);
   this->Modified();
 }
 
@@ -1060,6 +1476,7 @@ void vtkArcDepressFilter::SetArcAsClosed(int arc_ind)
   if (arc_ind < 0 || static_cast<size_t>(arc_ind) >= Arcs.size() || Arcs[arc_ind] == NULL)
     return;
   Arcs[arc_ind]->closeArc();
+  this->ArcModified(Arcs[arc_ind]);
 }
 
 void vtkArcDepressFilter::SetAxis(int axis)
@@ -1075,6 +1492,7 @@ void vtkArcDepressFilter::AddPointToArc(double in_ind, double v1, double v2)
   if (static_cast<size_t>(ind) >= Arcs.size() || Arcs[ind] == NULL)
     return;
   Arcs[ind]->addPoint(v1, v2);
+  this->ArcModified(Arcs[ind]);
   this->Modified();
 }
 
@@ -1094,6 +1512,7 @@ void vtkArcDepressFilter::SetManualControlRanges(double arc_ind, double funId, d
   assert(mfun != NULL);
   mfun->setMinMaxDesplacementDepth(minDispDepth, maxDispDepth);
   mfun->setMinMaxDistance(minDist, maxDist);
+  this->ArcModified(td);
   this->Modified();
 }
 
@@ -1109,6 +1528,7 @@ void vtkArcDepressFilter::AddArc(int arc_ind)
   if (st_arc_ind < this->Arcs.size() && this->Arcs[st_arc_ind] == NULL)
   {
     this->Arcs[st_arc_ind] = new DepArcData();
+    this->ArcModified(this->Arcs[st_arc_ind]);
     this->Modified();
   }
 }
@@ -1135,6 +1555,7 @@ void vtkArcDepressFilter::SetFunctionToPoint(int arc_ind, int ptId, int funId)
   if (arc_ind < 0 || static_cast<size_t>(arc_ind) >= Arcs.size() || Arcs[arc_ind] == NULL)
     return;
   Arcs[arc_ind]->setFunctionToPoint(ptId, funId);
+  this->ArcModified(Arcs[arc_ind]);
 }
 
 void vtkArcDepressFilter::AddWeightingFunPoint(
@@ -1149,6 +1570,7 @@ void vtkArcDepressFilter::AddWeightingFunPoint(
   DepArcData* td = Arcs[ind];
   assert(fid < td->functions.size());
   td->functions[fid]->addWeightPoint(x, y, m, s);
+  this->ArcModified(td);
 }
 
 void vtkArcDepressFilter::AddManualDispFunPoint(
@@ -1168,6 +1590,7 @@ void vtkArcDepressFilter::AddManualDispFunPoint(
   assert(mfun != NULL);
 
   mfun->addPoint(DepArcManualProfileFunction::DispFun, x, y, m, s);
+  this->ArcModified(td);
 }
 
 vtkArcDepressFilter::vtkArcDepressFilter()
@@ -1175,6 +1598,8 @@ vtkArcDepressFilter::vtkArcDepressFilter()
 {
   currentData = NULL;
   this->UseNormalDirection = false;
+  this->UseSegmentIndex = true;
+  this->Internals = new vtkArcDepressFilterInternals;
 }
 
 vtkArcDepressFilter::~vtkArcDepressFilter()
@@ -1184,6 +1609,12 @@ vtkArcDepressFilter::~vtkArcDepressFilter()
     delete this->Arcs[i];
   }
   this->Arcs.clear();
+  delete this->Internals;
+}
+
+void vtkArcDepressFilter::ArcModified(DepArcData* arc)
+{
+  arc->Version = ++this->Internals->NumberOfArcEdits;
 }
 
 void vtkArcDepressFilter::ResizeOrder(int size)
@@ -1225,12 +1656,121 @@ double pyramidVolume(double pts[6][3])
 }
 }
 
+namespace
+{
+struct ArcDepressUserData
+{
+  DepArcData* Arc;
+  vtkPoints* Points; // before the arc
+  vtkPoints* InputPoints;
+  vtkDataArray* Normals; // NULL unless displacing along the normals
+  vtkIdType const* Ids;  // the points to displace, all of them if NULL
+  vtkIdType NumberOfIds;
+  vtkIdType ChunkSize;
+  std::vector<ArcDepressDisplacement> Chunks;
+};
+}
+
+// Displace the points by one arc; each thread does every NumberOfThreads-th
+// chunk of points.
+VTK_THREAD_RETURN_TYPE vtkArcDepressDisplacePoints(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ArcDepressUserData* userData = static_cast<ArcDepressUserData*>(info->UserData);
+  DepArcData const& dad = *userData->Arc;
+  double point[3], normal[3];
+  double d;
+  size_t lsId;
+  DepArcData::point closestPt;
+  for (size_t c = info->ThreadID; c < userData->Chunks.size(); c += info->NumberOfThreads)
+  {
+    ArcDepressDisplacement& chunk = userData->Chunks[c];
+    vtkIdType begin = static_cast<vtkIdType>(c) * userData->ChunkSize;
+    vtkIdType end = std::min(begin + userData->ChunkSize, userData->NumberOfIds);
+    for (vtkIdType k = begin; k < end; ++k)
+    {
+      vtkIdType i = userData->Ids ? userData->Ids[k] : k;
+      userData->Points->GetPoint(i, point);
+      double pt2d[] = { point[0], point[1] };
+      if (!dad.getDistance(pt2d, d, lsId, closestPt))
+      {
+        continue;
+      }
+      double dir = 0;
+      if (userData->Normals)
+      {
+        userData->Normals->GetTuple(i, normal);
+        dir = closestPt.apply(d, point, normal);
+      }
+      else
+      {
+        point[2] = closestPt.apply(d, point[2], dir);
+      }
+#ifndef NDEBUG
+      double original[3];
+      userData->InputPoints->GetPoint(i, original);
+      assert(userData->Normals || (point[0] == original[0] && point[1] == original[1]));
+#endif
+      chunk.push_back(i, point, (dir == 0) ? 0 : (dir < 0) ? -1 : 1);
+    }
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+namespace
+{
+// Displace the points (all of them if ids is NULL) by one arc, in parallel;
+// the displacement is in the order of the points.
+void displacePoints(ArcDepressUserData& userData, vtkIdType const* ids, vtkIdType numberOfIds,
+  ArcDepressDisplacement& result)
+{
+  result.clear();
+  if (numberOfIds == 0)
+  {
+    return;
+  }
+  userData.Ids = ids;
+  userData.NumberOfIds = numberOfIds;
+  userData.Chunks.clear();
+  userData.Chunks.resize((numberOfIds + userData.ChunkSize - 1) / userData.ChunkSize);
+
+  vtkNew<vtkMultiThreader> threader;
+  if (static_cast<int>(userData.Chunks.size()) < threader->GetNumberOfThreads())
+  {
+    threader->SetNumberOfThreads(static_cast<int>(userData.Chunks.size()));
+  }
+  threader->SetSingleMethod(vtkArcDepressDisplacePoints, &userData);
+  threader->SingleMethodExecute();
+
+  size_t size = 0;
+  for (size_t c = 0; c < userData.Chunks.size(); ++c)
+  {
+    size += userData.Chunks[c].size();
+  }
+  result.Ids.reserve(size);
+  result.Points.reserve(3 * size);
+  result.Dirs.reserve(size);
+  for (size_t c = 0; c < userData.Chunks.size(); ++c)
+  {
+    ArcDepressDisplacement const& chunk = userData.Chunks[c];
+    result.Ids.insert(result.Ids.end(), chunk.Ids.begin(), chunk.Ids.end());
+    result.Points.insert(result.Points.end(), chunk.Points.begin(), chunk.Points.end());
+    result.Dirs.insert(result.Dirs.end(), chunk.Dirs.begin(), chunk.Dirs.end());
+  }
+  userData.Chunks.clear();
+}
+
+bool insideBounds(double const bounds[4], double const* pt)
+{
+  return bounds[0] <= pt[0] && pt[0] <= bounds[1] && bounds[2] <= pt[1] && pt[1] <= bounds[3];
+}
+}
+
 void vtkArcDepressFilter::computeDisplacement(
   vtkPolyData* input, vtkPolyData* output, std::vector<int>& pointChanged)
 {
   vtkDataArray* normals = input->GetPointData()->GetNormals();
 
-  vtkIdType i;
   vtkCellArray *newVerts, *newLines, *newPolys;
   vtkPoints* newPoints;
   vtkIdType estimatedSize, numCells = input->GetNumberOfCells();
@@ -1259,14 +1799,17 @@ void vtkArcDepressFilter::computeDisplacement(
   newPolys->Allocate(estimatedSize, estimatedSize / 2);
 
   //Transform points
-  double point[3], original[3];
-  double normal[3];
   for (size_t t = 0; t < Arcs.size(); ++t)
   {
     if (Arcs[t] != NULL)
       Arcs[t]->setUpFunctions();
   }
   bool useNorm = UseNormalDirection && normals != NULL;
+  ArcDepressUserData userData;
+  userData.Points = newPoints;
+  userData.InputPoints = inPts;
+  userData.Normals = useNorm ? normals : NULL;
+  userData.ChunkSize = 4096;
   double currentBounds[2];
   {
     double bounds[6];
@@ -1275,6 +1818,19 @@ void vtkArcDepressFilter::computeDisplacement(
     currentBounds[1] = bounds[5];
   }
 
+  // The arcs are applied one after the other, starting from where the
+  // previous one left the points.  A point only needs to be re-evaluated
+  // (it is "dirty") once it is in the influence bounds (old or new) of an
+  // edited arc; the other points are displaced as they were the last time.
+  // Anything else that changed (the order, the z range of an arc, ...)
+  // re-evaluates all the points from there on.
+  vtkArcDepressFilterInternals* internals = this->Internals;
+  std::vector<ArcDepressStage> stages;
+  std::vector<char>& dirty = internals->DirtyPoints;
+  dirty.assign(numPts, 0);
+  std::vector<vtkIdType> dirtyIds;
+  bool allDirty = false;
+  double point[3];
   for (unsigned int j = 0; j < ApplyOrder.size() && numPts != 0; ++j)
   {
     int id = ApplyOrder[j];
@@ -1282,43 +1838,123 @@ void vtkArcDepressFilter::computeDisplacement(
       continue;
     DepArcData& dad = *Arcs[id];
     dad.updateBound(currentBounds[0], currentBounds[1]);
-    double d;
-    size_t lsId;
-    DepArcData::point closestPt;
-    newPoints->GetPoint(0, point);
-    double updateBounds[] = { point[2], point[2] };
-    for (i = 0; i < numPts; i++)
+    dad.prepare(this->UseSegmentIndex);
+
+    stages.push_back(ArcDepressStage());
+    ArcDepressStage& stage = stages.back();
+    stage.ArcId = id;
+    stage.ArcVersion = dad.Version;
+    stage.InputBounds[0] = currentBounds[0];
+    stage.InputBounds[1] = currentBounds[1];
+    stage.HasInfluenceBounds = dad.getInfluenceBounds(stage.InfluenceBounds);
+
+    ArcDepressStage* cached =
+      (stages.size() <= internals->Stages.size()) ? &internals->Stages[stages.size() - 1] : NULL;
+    if (!allDirty &&
+      (cached == NULL || cached->ArcId != id ||
+        ((cached->InputBounds[0] != currentBounds[0] ||
+           cached->InputBounds[1] != currentBounds[1]) &&
+          dad.dependsOnBound())))
     {
-      newPoints->GetPoint(i, point);
-      inPts->GetPoint(i, original);
-      double pt2d[] = { point[0], point[1] };
+      allDirty = true;
+    }
+    else if (!allDirty && cached->ArcVersion != dad.Version)
+    {
+      if (!cached->HasInfluenceBounds || !stage.HasInfluenceBounds)
+      {
+        allDirty = true;
+      }
+      else
+      {
+        size_t numberOfDirty = dirtyIds.size();
+        for (vtkIdType i = 0; i < numPts; ++i)
+        {
+          if (dirty[i])
+            continue;
+          newPoints->GetPoint(i, point);
+          if (insideBounds(cached->InfluenceBounds, point) ||
+            insideBounds(stage.InfluenceBounds, point))
+          {
+            dirty[i] = 1;
+            dirtyIds.push_back(i);
+          }
+        }
+        std::inplace_merge(
+          dirtyIds.begin(), dirtyIds.begin() + numberOfDirty, dirtyIds.end());
+      }
+    }
 
-      if (dad.getDistance(pt2d, d, lsId, closestPt))
+    userData.Arc = &dad;
+    ArcDepressDisplacement& displacement = stage.Displacement;
+    if (allDirty)
+    {
+      displacePoints(userData, NULL, numPts, displacement);
+    }
+    else if (dirtyIds.empty())
+    {
+      displacement.Ids.swap(cached->Displacement.Ids);
+      displacement.Points.swap(cached->Displacement.Points);
+      displacement.Dirs.swap(cached->Displacement.Dirs);
+    }
+    else
+    {
+      // the dirty points, merged into what the clean ones did before
+      ArcDepressDisplacement changed;
+      displacePoints(userData, &dirtyIds[0], static_cast<vtkIdType>(dirtyIds.size()), changed);
+      ArcDepressDisplacement const& previous = cached->Displacement;
+      size_t p = 0, c = 0;
+      while (p < previous.size() || c < changed.size())
       {
-        double dir = 0;
-        if (useNorm)
+        if (p < previous.size() && dirty[previous.Ids[p]])
         {
-          normals->GetTuple(i, normal);
-          dir = closestPt.apply(d, point, normal);
+          ++p;
         }
-        else
+        else if (c == changed.size() ||
+          (p < previous.size() && previous.Ids[p] < changed.Ids[c]))
         {
-          point[2] = closestPt.apply(d, point[2], dir);
+          displacement.append(previous, p++);
         }
-        if (point[2] < updateBounds[0])
-          updateBounds[0] = point[2];
-        if (point[2] > updateBounds[1])
-          updateBounds[1] = point[2];
-        if (dir != 0)
+        else
         {
-          pointChanged[i] = (dir < 0) ? -1 : 1;
+          displacement.append(changed, c++);
         }
       }
-      assert(useNorm || (point[0] == original[0] && point[1] == original[1]));
-      newPoints->SetPoint(i, point);
     }
-    currentBounds[0] = updateBounds[0];
-    currentBounds[1] = updateBounds[1];
+
+    // apply it; the new z range is the displaced points and the first one
+    newPoints->GetPoint(0, point);
+    currentBounds[0] = currentBounds[1] = point[2];
+    for (size_t k = 0; k < displacement.size(); ++k)
+    {
+      double const* pt = &displacement.Points[3 * k];
+      newPoints->SetPoint(displacement.Ids[k], pt);
+      currentBounds[0] = std::min(currentBounds[0], pt[2]);
+      currentBounds[1] = std::max(currentBounds[1], pt[2]);
+    }
+  }
+  // the last arcs applied before may be gone (removed, or taken out of the
+  // order); the points they moved are back where the arcs before left them
+  for (size_t s = stages.size(); !allDirty && s < internals->Stages.size(); ++s)
+  {
+    ArcDepressDisplacement const& dropped = internals->Stages[s].Displacement;
+    for (size_t k = 0; k < dropped.size(); ++k)
+    {
+      dirty[dropped.Ids[k]] = 1;
+    }
+  }
+  internals->Stages.swap(stages);
+  internals->AllPointsDirty = allDirty;
+
+  for (size_t s = 0; s < internals->Stages.size(); ++s)
+  {
+    ArcDepressDisplacement const& displacement = internals->Stages[s].Displacement;
+    for (size_t k = 0; k < displacement.size(); ++k)
+    {
+      if (displacement.Dirs[k] != 0)
+      {
+        pointChanged[displacement.Ids[k]] = displacement.Dirs[k];
+      }
+    }
   }
   newVerts->DeepCopy(input->GetVerts());
   newLines->DeepCopy(input->GetLines());
@@ -1350,14 +1986,36 @@ void vtkArcDepressFilter::computeDisplacement(
 void vtkArcDepressFilter::computeChange(
   vtkPolyData* input, vtkPoints* originalPts, vtkPoints* newPoints, std::vector<int>& pointChanged)
 {
-  double* mod[3] = { NULL, &amountAdded, &amountRemoved };
-  amountRemoved = 0;
-  amountAdded = 0;
 #ifndef NDEBUG
   bool useNorm = UseNormalDirection && NULL != input->GetPointData()->GetNormals();
 #endif
+  // only the triangles of the re-evaluated points can change
+  std::vector<double>& cellChange = this->Internals->CellChange;
+  std::vector<char> const& dirty = this->Internals->DirtyPoints;
+  bool allDirty = this->Internals->AllPointsDirty ||
+    cellChange.size() != 2 * static_cast<size_t>(input->GetNumberOfCells());
+  cellChange.resize(2 * input->GetNumberOfCells());
   for (unsigned int i = 0; i < input->GetNumberOfCells(); ++i)
   {
+    if (!allDirty)
+    {
+      vtkIdType npts;
+      vtkIdType* cellPts;
+      input->GetCellPoints(i, npts, cellPts);
+      bool cellDirty = false;
+      for (vtkIdType j = 0; j < npts && !cellDirty; ++j)
+      {
+        cellDirty = dirty[cellPts[j]] != 0;
+      }
+      if (!cellDirty)
+      {
+        continue;
+      }
+    }
+    double& cellAdded = cellChange[2 * i];
+    double& cellRemoved = cellChange[2 * i + 1];
+    cellAdded = cellRemoved = 0;
+    double* mod[3] = { NULL, &cellAdded, &cellRemoved };
     vtkCell* cell = input->GetCell(i);
     bool changed = false;
     bool allChanged = true;
@@ -1378,7 +2036,7 @@ void vtkArcDepressFilter::computeChange(
     if (changed)
     {
       double pts[6][3];
-      double* modifier = (digRaiseCheck[0]) ? &amountRemoved : &amountAdded;
+      double* modifier = (digRaiseCheck[0]) ? &cellRemoved : &cellAdded;
       vtkIdType ptIds[] = { cell->GetPointId(0), cell->GetPointId(1), cell->GetPointId(2) };
       if (digRaiseCheck[0] == 3 || digRaiseCheck[1] == 3)
       {
@@ -1483,8 +2141,8 @@ void vtkArcDepressFilter::computeChange(
             { pts[o + ota][0], pts[o + ota][1], pts[o + ota][2] },
             { pts[o + otb][0], pts[o + otb][1], pts[o + otb][2] },
             { intersection[otd][0], intersection[otd][1], intersection[otd][2] } };
-          assert((pointChanged[ptIds[z]] < 0 && mod[digRaiseCheck[0]] == &amountRemoved) ||
-            (pointChanged[ptIds[z]] > 0 && mod[digRaiseCheck[0]] == &amountAdded));
+          assert((pointChanged[ptIds[z]] < 0 && mod[digRaiseCheck[0]] == &cellRemoved) ||
+            (pointChanged[ptIds[z]] > 0 && mod[digRaiseCheck[0]] == &cellAdded));
           *(mod[digRaiseCheck[0]]) += wedgeVolume(pts2);
         }
         else
@@ -1517,26 +2175,34 @@ void vtkArcDepressFilter::computeChange(
           double d2 = dist(pts[notChanged], intersection[1]);
           int otherPt = (d2 < d1) ? 0 : 1;
           int addA[] = { 0, 3 };
-          double* mN = &amountAdded;
-          double* mO = &amountRemoved;
+          double* mN = &cellAdded;
+          double* mO = &cellRemoved;
           if (pointChanged[ptIds[at[notChanged][0]]] < 0)
           {
             addA[0] = 3;
             addA[1] = 0;
-            mN = &amountRemoved;
-            mO = &amountAdded;
+            mN = &cellRemoved;
+            mO = &cellAdded;
           }
           *mN += std::abs(vtkTetra::ComputeVolume(pts[at[notChanged][0] + addA[0]], pts[notChanged],
             intersection[otherPt], pts[at[notChanged][0] + addA[1]]));
 
           *mO += std::abs(vtkTetra::ComputeVolume(pts[at[notChanged][1] + addA[0]], pts[notChanged],
             intersection[otherPt], pts[at[notChanged][1] + addA[1]]));
-          assert((pointChanged[ptIds[at[notChanged][1]]] < 0 && mO == &amountRemoved) ||
-            (pointChanged[ptIds[at[notChanged][1]]] > 0 && mO == &amountAdded));
+          assert((pointChanged[ptIds[at[notChanged][1]]] < 0 && mO == &cellRemoved) ||
+            (pointChanged[ptIds[at[notChanged][1]]] > 0 && mO == &cellAdded));
         }
       }
     }
   }
+
+  this->amountAdded = 0;
+  this->amountRemoved = 0;
+  for (size_t i = 0; i < cellChange.size(); i += 2)
+  {
+    this->amountAdded += cellChange[i];
+    this->amountRemoved += cellChange[i + 1];
+  }
 }
 
 int vtkArcDepressFilter::RequestData(vtkInformation* vtkNotUsed(request),
@@ -1579,6 +2245,8 @@ int vtkArcDepressFilter::RequestData(vtkInformation* vtkNotUsed(request),
     return 1;
   }
 
+  this->Internals->CheckInput(input, this->UseNormalDirection);
+
   if (input->GetNumberOfCells() != 0)
   {
     triangleFilter = vtkSmartPointer<vtkTriangleFilter>::New();
@@ -1716,6 +2384,7 @@ void vtkArcDepressFilter::CreateManualFunction(
     static_cast<DepArcProfileFunction::FunctionType>(desptFunctionType),
     static_cast<DepArcProfileFunction::FunctionType>(weightFunType), (isSymmetric != 0),
     (isRelative != 0)));
+  this->ArcModified(td);
   this->Modified();
 }
 
@@ -1744,5 +2413,6 @@ void vtkArcDepressFilter::CreateWedgeFunction(double arc_ind_in, double funId_in
 
   td->functions[funId] = boost::shared_ptr<DepArcProfileFunction>(new DepArcWedgeProfileFunction(
     weightFunType, relative, disMode, clamp, basewidth, displacement, slopeLeft, slopeRight));
+  this->ArcModified(td);
   this->Modified();
 }
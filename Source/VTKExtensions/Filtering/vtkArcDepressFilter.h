@@ -17,6 +17,9 @@
 #include <vector>
 
 class DepArcData;
+//BTX
+struct vtkArcDepressFilterInternals;
+//ETX
 
 class VTKCMBFILTERING_EXPORT vtkArcDepressFilter : public vtkPolyDataAlgorithm
 {
@@ -49,6 +52,14 @@ public:
 
   void setUseNormalDirection(int);
 
+  // Description:
+  // Whether each arc bins its segments in a grid, so that a point only
+  // looks at the segments near it (the default).  Off, every point looks at
+  // every segment of an arc; the output is the same either way.
+  vtkSetMacro(UseSegmentIndex, bool);
+  vtkGetMacro(UseSegmentIndex, bool);
+  vtkBooleanMacro(UseSegmentIndex, bool);
+
   double GetAmountRemoved() { return amountRemoved; }
   double GetAmountAdded() { return amountAdded; }
 
@@ -66,10 +77,16 @@ protected:
   void computeChange(vtkPolyData* input, vtkPoints* originalPts, vtkPoints* newPoints,
     std::vector<int>& pointChanged);
 
+  // Description:
+  // Record an edit of the arc, so only the points around it are
+  // re-evaluated by the next RequestData.
+  void ArcModified(DepArcData* arc);
+
   int Axis;
   std::vector<DepArcData*> Arcs;
   std::vector<unsigned> ApplyOrder;
   bool UseNormalDirection;
+  bool UseSegmentIndex;
 
   double amountRemoved;
   double amountAdded;
@@ -82,6 +99,7 @@ private:
   void operator=(const vtkArcDepressFilter&) {} // Not implemented.
 
   bool IsProcessing;
+  vtkArcDepressFilterInternals* Internals;
   //ETX
 
   vtkPolyData* currentData;
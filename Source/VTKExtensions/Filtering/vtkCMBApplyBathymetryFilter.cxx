@@ -9,6 +9,7 @@
 //=========================================================================
 #include "vtkCMBApplyBathymetryFilter.h"
 
+#include "vtkCMBBathymetryInterpolator.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCellLocator.h"
@@ -17,7 +18,6 @@
 #include "vtkFloatArray.h"
 #include "vtkGenericCell.h"
 #include "vtkImageData.h"
-#include "vtkIncrementalOctreePointLocator.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
@@ -28,8 +28,8 @@
 #include "vtkWeakPointer.h"
 
 #include <iostream>
-#include <map>
 #include <sstream>
+#include <vector>
 
 vtkStandardNewMacro(vtkCMBApplyBathymetryFilter);
 
@@ -44,53 +44,65 @@ void flatZValues(T* t, int size, double val)
   }
 }
 template <class T>
-void copyArrayZValues(T* t, vtkIdType size, std::vector<double>& idToElevation, bool useHighLimit,
-  double eleHigh, bool useLowLimit, double eleLow, bool invertScalars)
+void copyTypedZValues(T* t, vtkIdType size, std::vector<double>& idToElevation, bool useHighLimit,
+  double eleHigh, bool useLowLimit, double eleLow, bool invertScalars, int numComps)
 {
   double scalarPrefactor = invertScalars ? -1. : 1.;
   double dtmp;
   for (vtkIdType i = 0; i < size; ++i)
   {
-    dtmp = scalarPrefactor * static_cast<double>(t[i]);
+    dtmp = scalarPrefactor * static_cast<double>(t[i * numComps]);
     dtmp = (useHighLimit && dtmp > eleHigh) ? eleHigh : dtmp;
     dtmp = (useLowLimit && dtmp < eleLow) ? eleLow : dtmp;
     idToElevation[i] = dtmp;
   }
 }
+// the elevations are the values of component comp of dataArray
+void copyArrayZValues(vtkDataArray* dataArray, vtkIdType size, std::vector<double>& idToElevation,
+  bool useHighLimit, double eleHigh, bool useLowLimit, double eleLow, bool invertScalars,
+  int comp = 0)
+{
+  int numComps = dataArray->GetNumberOfComponents();
+  switch (dataArray->GetDataType())
+  {
+    vtkTemplateMacro(copyTypedZValues(static_cast<VTK_TT*>(dataArray->GetVoidPointer(0)) + comp,
+      size, idToElevation, useHighLimit, eleHigh, useLowLimit, eleLow, invertScalars, numComps));
+  }
+}
 };
 
-class vtkCMBApplyBathymetryFilter::vtkCmbInternalTerrainInfo
+vtkCMBApplyBathymetryFilter::vtkCMBApplyBathymetryFilter()
 {
-public:
-  vtkCmbInternalTerrainInfo(vtkInformation* input, const double& radius, double& invalid,
-    bool useHighLimit, double eleHigh, bool useLowLimit, double eleLow, bool invertScalars);
-  ~vtkCmbInternalTerrainInfo() { this->IdToElevation.clear(); }
-  //returns the average elevation for a circle given the radius
-  template <class T>
-  T getElevation(T* point);
-  void setRadius(const double& r) { Radius = r; }
-
-  std::vector<double> IdToElevation;
+  this->Interpolator = vtkCMBBathymetryInterpolator::New();
+  this->SetNumberOfInputPorts(2);
+  this->ElevationRadius = 1.0;
+  this->InterpolationMode = vtkCMBBathymetryInterpolator::AVERAGE;
+  this->FlattenZValues = false;
+  this->NoOP = false;
+  this->FlatZValue = 0.0;
+  this->UseHighestZValue = false;
+  this->UseLowestZValue = false;
+  this->HighestZValue = this->LowestZValue = 0.0;
+  this->InvalidValue = 0.0;
+  this->InvertScalars = false;
+}
 
-protected:
-  double Radius;
-  double InvalidValue;
-  vtkSmartPointer<vtkIncrementalOctreePointLocator> Locator;
-};
+vtkCMBApplyBathymetryFilter::~vtkCMBApplyBathymetryFilter()
+{
+  this->Interpolator->Delete();
+}
 
-vtkCMBApplyBathymetryFilter::vtkCmbInternalTerrainInfo::vtkCmbInternalTerrainInfo(
-  vtkInformation* inInfo, const double& radius, double& invalid, bool useHighLimit, double eleHigh,
-  bool useLowLimit, double eleLow, bool invertScalars)
-  : Radius(radius)
-  , InvalidValue(invalid)
+bool vtkCMBApplyBathymetryFilter::SetupBathymetrySource(vtkInformation* inInfo)
 {
-  //1. Create a set of points while removing all the z values from the points
-  //and storing them in the map.
-  //2. Create locater of the resulting 2D point set
+  //1. Collect the points while removing all the z values from the points
+  //and storing them as the elevation of the point.
+  //2. Bin the resulting 2D point set
 
+  vtkCMBBathymetryInterpolator* interpolator = this->Interpolator;
+  interpolator->SetNumberOfSourcePoints(0);
   if (!inInfo)
   {
-    return;
+    return false;
   }
   vtkIdType numPoints = 0;
   vtkPolyData* pd = vtkPolyData::SafeDownCast(inInfo->Get(vtkDataObject::DATA_OBJECT()));
@@ -107,164 +119,81 @@ vtkCMBApplyBathymetryFilter::vtkCmbInternalTerrainInfo::vtkCmbInternalTerrainInf
   }
   if (numPoints <= 0)
   {
-    return;
+    return false;
   }
 
-  //second iteration is building the point set and elevation mapping
-  vtkPoints* inputPoints = NULL;
-  vtkPoints* points = vtkPoints::New();
-  vtkIdType size, i;
+  vtkIdType i;
   double p[3];
-  double dtmp;
-  double scalarPrefactor = invertScalars ? -1. : 1.;
+  std::vector<double> elevations;
   // Uniform Grids may not have the max number of points
   if (gridInput)
   {
     vtkDataArray* dataArray = gridInput->GetPointData()->GetScalars("Elevation");
     if (!dataArray || dataArray->GetNumberOfTuples() != numPoints)
     {
-      return;
+      return false;
     }
-    points->SetNumberOfPoints(numPoints);
-    this->IdToElevation.resize(numPoints);
+    elevations.resize(numPoints);
+    copyArrayZValues(dataArray, numPoints, elevations, this->UseHighestZValue,
+      this->HighestZValue, this->UseLowestZValue, this->LowestZValue, this->InvertScalars);
     vtkIdType at = 0;
     for (i = 0; i < numPoints; i++)
     {
-      if (!gridInput->IsPointVisible(i))
+      if (gridInput->IsPointVisible(i))
       {
-        continue;
+        ++at;
       }
-      dtmp = scalarPrefactor * dataArray->GetTuple1(i);
-      dtmp = (useHighLimit && dtmp > eleHigh) ? eleHigh : dtmp;
-      dtmp = (useLowLimit && dtmp < eleLow) ? eleLow : dtmp;
-      imageInput->GetPoint(i, p);
-
-      //flatten z
-      p[2] = 0.0;
-      points->SetPoint(at, p);
-      this->IdToElevation[at] = dtmp;
-      ++at;
     }
-    points->Resize(at);
-    this->IdToElevation.resize(at);
-  }
-  else
-  {
-    points->SetNumberOfPoints(numPoints);
-    if (pd)
+    interpolator->SetNumberOfSourcePoints(at);
+    at = 0;
+    for (i = 0; i < numPoints; i++)
     {
-      inputPoints = pd->GetPoints();
-      size = inputPoints->GetNumberOfPoints();
-      points->SetNumberOfPoints(size);
-      this->IdToElevation.resize(size);
-      for (i = 0; i < size; ++i)
+      if (!gridInput->IsPointVisible(i))
       {
-        //get the point
-        inputPoints->GetPoint(i, p);
-        // check elevation limit
-        dtmp = scalarPrefactor * p[2];
-        dtmp = (useHighLimit && dtmp > eleHigh) ? eleHigh : dtmp;
-        dtmp = (useLowLimit && dtmp < eleLow) ? eleLow : dtmp;
-        //store the z value & flatten
-        this->IdToElevation[i] = dtmp;
-        p[2] = 0.0;
-        points->SetPoint(i, p);
+        continue;
       }
+      gridInput->GetPoint(i, p);
+      interpolator->SetSourcePoint(at++, p[0], p[1], elevations[i]);
     }
-    else if (imageInput)
+  }
+  else if (pd)
+  {
+    vtkPoints* inputPoints = pd->GetPoints();
+    vtkIdType size = inputPoints->GetNumberOfPoints();
+    elevations.resize(size);
+    copyArrayZValues(inputPoints->GetData(), size, elevations, this->UseHighestZValue,
+      this->HighestZValue, this->UseLowestZValue, this->LowestZValue, this->InvertScalars, 2);
+    interpolator->SetNumberOfSourcePoints(size);
+    for (i = 0; i < size; ++i)
     {
-      size = imageInput->GetNumberOfPoints();
-      points->SetNumberOfPoints(size);
-      this->IdToElevation.resize(size);
-      vtkDataArray* dataArray = imageInput->GetPointData()->GetScalars("Elevation");
-      if (!dataArray || dataArray->GetNumberOfTuples() != size)
-      {
-        return;
-      }
-
-      //store the z value
-      if (dataArray->GetDataType() == VTK_FLOAT)
-      {
-        vtkFloatArray* floatArray = static_cast<vtkFloatArray*>(dataArray);
-        copyArrayZValues(floatArray->GetPointer(0), size, this->IdToElevation, useHighLimit,
-          eleHigh, useLowLimit, eleLow, invertScalars);
-      }
-      else if (dataArray->GetDataType() == VTK_DOUBLE)
-      {
-        vtkDoubleArray* doubleArray = static_cast<vtkDoubleArray*>(dataArray);
-        copyArrayZValues(doubleArray->GetPointer(0), size, this->IdToElevation, useHighLimit,
-          eleHigh, useLowLimit, eleLow, invertScalars);
-      }
-
-      for (i = 0; i < size; ++i)
-      {
-        //get the point
-        imageInput->GetPoint(i, p);
-
-        //flatten z
-        p[2] = 0.0;
-        points->SetPoint(i, p);
-      }
+      inputPoints->GetPoint(i, p);
+      interpolator->SetSourcePoint(i, p[0], p[1], elevations[i]);
     }
   }
-  vtkPolyData* pointSet = vtkPolyData::New();
-  pointSet->SetPoints(points);
-  points->FastDelete();
-
-  this->Locator = vtkSmartPointer<vtkIncrementalOctreePointLocator>::New();
-  this->Locator->AutomaticOn();
-  this->Locator->SetTolerance(0.0);
-  this->Locator->SetDataSet(pointSet);
-  this->Locator->BuildLocator();
-  pointSet->Delete();
-}
-
-template <class T>
-T vtkCMBApplyBathymetryFilter::vtkCmbInternalTerrainInfo::getElevation(T* point)
-{
-  double dpoint[3];
-  dpoint[0] = static_cast<double>(point[0]);
-  dpoint[1] = static_cast<double>(point[1]);
-  dpoint[2] = 0.0;
-  vtkIdList* ids = vtkIdList::New();
-  this->Locator->FindPointsWithinRadius(this->Radius, dpoint, ids);
-  double sum = 0;
-  std::map<vtkIdType, double>::const_iterator it;
-  vtkIdType size = ids->GetNumberOfIds();
-  for (vtkIdType i = 0; i < size; ++i)
+  else if (imageInput)
   {
-    //average the elevation
-    assert(ids->GetId(i) < static_cast<vtkIdType>(this->IdToElevation.size()));
-    sum += this->IdToElevation[ids->GetId(i)];
+    vtkIdType size = imageInput->GetNumberOfPoints();
+    vtkDataArray* dataArray = imageInput->GetPointData()->GetScalars("Elevation");
+    if (!dataArray || dataArray->GetNumberOfTuples() != size)
+    {
+      return false;
+    }
+    elevations.resize(size);
+    copyArrayZValues(dataArray, size, elevations, this->UseHighestZValue, this->HighestZValue,
+      this->UseLowestZValue, this->LowestZValue, this->InvertScalars);
+    interpolator->SetNumberOfSourcePoints(size);
+    for (i = 0; i < size; ++i)
+    {
+      imageInput->GetPoint(i, p);
+      interpolator->SetSourcePoint(i, p[0], p[1], elevations[i]);
+    }
   }
-  ids->Delete();
-
-  //handle the zero size use case
-  T elev = static_cast<T>((size == 0) ? InvalidValue : sum / size);
-  return elev;
-}
-
-vtkCMBApplyBathymetryFilter::vtkCMBApplyBathymetryFilter()
-{
-  this->TerrainInfo = NULL;
-  this->SetNumberOfInputPorts(2);
-  this->ElevationRadius = 1.0;
-  this->FlattenZValues = false;
-  this->NoOP = false;
-  this->FlatZValue = 0.0;
-  this->UseHighestZValue = false;
-  this->UseLowestZValue = false;
-  this->HighestZValue = this->LowestZValue = 0.0;
-  this->InvalidValue = 0.0;
-  this->InvertScalars = false;
-}
 
-vtkCMBApplyBathymetryFilter::~vtkCMBApplyBathymetryFilter()
-{
-  if (this->TerrainInfo)
-  {
-    delete this->TerrainInfo;
-  }
+  interpolator->SetElevationRadius(this->ElevationRadius);
+  interpolator->SetInvalidValue(this->InvalidValue);
+  interpolator->SetInterpolationMode(this->InterpolationMode);
+  interpolator->BuildLocator();
+  return interpolator->GetNumberOfSourcePoints() > 0;
 }
 
 int vtkCMBApplyBathymetryFilter::FillInputPortInformation(int port, vtkInformation* info)
@@ -317,17 +246,13 @@ int vtkCMBApplyBathymetryFilter::RequestData(vtkInformation* /*request*/,
       return 0;
     }
 
-    //Construct the TerrainInfo first
-    this->TerrainInfo = new vtkCmbInternalTerrainInfo(inputVector[1]->GetInformationObject(0),
-      this->ElevationRadius, this->InvalidValue, this->UseHighestZValue, this->HighestZValue,
-      this->UseLowestZValue, this->LowestZValue, this->InvertScalars);
-    if (!this->TerrainInfo->IdToElevation.empty())
+    //Bin the bathymetry points first
+    if (this->SetupBathymetrySource(inputVector[1]->GetInformationObject(0)))
     {
       validMesh = this->ApplyBathymetry(finalMesh->GetPoints());
     }
-
-    delete this->TerrainInfo;
-    this->TerrainInfo = NULL;
+    // don't hold on to the (possibly huge) bathymetry
+    this->Interpolator->SetNumberOfSourcePoints(0);
   }
 
   if (validMesh)
@@ -367,34 +292,12 @@ bool vtkCMBApplyBathymetryFilter::FlattenMesh(vtkPoints* points)
 
 bool vtkCMBApplyBathymetryFilter::ApplyBathymetry(vtkPoints* points)
 {
-  //get the point data void pointer
-  vtkDataArray* dataArray = points->GetData();
-  vtkIdType size = points->GetNumberOfPoints();
-  if (size == 0)
+  if (points->GetNumberOfPoints() == 0)
   {
     return false;
   }
-  double pnom = static_cast<double>(size);
-  if (dataArray->GetDataType() == VTK_FLOAT)
-  {
-    vtkFloatArray* floatArray = static_cast<vtkFloatArray*>(dataArray);
-    float* pos = floatArray->GetPointer(0);
-    for (vtkIdType i = 0; i < size; ++i, pos += 3)
-    {
-      pos[2] = this->TerrainInfo->getElevation(pos);
-      this->UpdateProgress(static_cast<double>(i) / pnom);
-    }
-  }
-  else
-  {
-    vtkDoubleArray* doubleArray = static_cast<vtkDoubleArray*>(dataArray);
-    double* pos = doubleArray->GetPointer(0);
-    for (vtkIdType i = 0; i < size; ++i, pos += 3)
-    {
-      pos[2] = this->TerrainInfo->getElevation(pos);
-      this->UpdateProgress(static_cast<double>(i) / pnom);
-    }
-  }
+  // the points are independent of each other; done in parallel
+  this->Interpolator->InterpolateElevations(points, this);
   return true;
 }
 
@@ -403,6 +306,7 @@ void vtkCMBApplyBathymetryFilter::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
   os << indent << "NoOP: " << this->NoOP << std::endl;
   os << indent << "ElevationRadius: " << this->ElevationRadius << std::endl;
+  os << indent << "InterpolationMode: " << this->InterpolationMode << std::endl;
   os << indent << "FlatZValue: " << this->FlatZValue << std::endl;
   os << indent << "FlattenZValues: " << this->FlattenZValues << std::endl;
   os << indent << "InvalidValue: " << this->InvalidValue << std::endl;
@@ -17,6 +17,7 @@
 #include "vtkCMBFilteringModule.h" // For export macro
 #include "vtkDataSetAlgorithm.h"
 
+class vtkCMBBathymetryInterpolator;
 class vtkPoints;
 
 class VTKCMBFILTERING_EXPORT vtkCMBApplyBathymetryFilter : public vtkDataSetAlgorithm
@@ -31,6 +32,13 @@ public:
   vtkSetMacro(ElevationRadius, double);
   vtkGetMacro(ElevationRadius, double);
 
+  // Description:
+  // How the elevation of a point is computed from the bathymetry points
+  // within ElevationRadius: 0 - average (default), 1 - inverse distance
+  // weighted, 2 - nearest.  See vtkCMBBathymetryInterpolator.
+  vtkSetClampMacro(InterpolationMode, int, 0, 2);
+  vtkGetMacro(InterpolationMode, int);
+
   //Description:
   //Set/Get the highest z value which the input will be set to if
   // UseHighestZValue is set to true. Default is 0.0
@@ -107,9 +115,11 @@ protected:
   bool FlattenMesh(vtkPoints*);
 
   //methods for apply bathymetry
+  bool SetupBathymetrySource(vtkInformation* sourceInfo);
   bool ApplyBathymetry(vtkPoints* points);
 
   double ElevationRadius;
+  int InterpolationMode;
   double HighestZValue;
   bool UseHighestZValue;
   double LowestZValue;
@@ -120,8 +130,7 @@ protected:
   double InvalidValue;
   bool InvertScalars;
 
-  class vtkCmbInternalTerrainInfo;
-  vtkCmbInternalTerrainInfo* TerrainInfo;
+  vtkCMBBathymetryInterpolator* Interpolator;
 
 private:
   vtkCMBApplyBathymetryFilter(const vtkCMBApplyBathymetryFilter&); // Not implemented.
@@ -11,20 +11,170 @@
 
 #include "vtkCellLocator.h"
 #include "vtkDoubleArray.h"
+#include "vtkGenericCell.h"
 #include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTransform.h"
+#include <algorithm>
 #include <math.h>
+#include <vector>
 
 vtkStandardNewMacro(vtkCMBClassifyPointsFilter);
 
+namespace
+{
+struct ClassifyUserData
+{
+  vtkDataSet* Input;
+  vtkCellLocator* Locator;
+  int MaxCellSize;
+  // the input points in the order they are classified
+  const vtkIdType* Order;
+  vtkIdType NumberOfPoints;
+  vtkIdType BlockSize;
+  // the cell of each input point (-1 when outside of the mesh)
+  vtkIdType* CellIds;
+
+  // the output is filled in chunks of input points, each one knowing
+  // where its classified points go
+  int NumberOfChunks;
+  vtkIdType* ChunkCount;
+  vtkIdType* ChunkOffset;
+  double* OutputPoints;
+  vtkIdType* OutputIds;
+};
+
+void GetChunkRange(const ClassifyUserData* ud, int chunk, vtkIdType& start, vtkIdType& end)
+{
+  start = ud->NumberOfPoints * chunk / ud->NumberOfChunks;
+  end = ud->NumberOfPoints * (chunk + 1) / ud->NumberOfChunks;
+}
+
+// Order the points along a Morton (Z order) curve over the bounds of the
+// input, so consecutive queries visit the same locator buckets and cells.
+// A counting sort on a coarse curve is enough for that, and keeps the
+// points of a curve cell in their input order.
+void SortAlongCurve(vtkDataSet* input, std::vector<vtkIdType>& order)
+{
+  const int bits = 6; // per axis
+  const unsigned int resolution = 1 << bits;
+  vtkIdType n = input->GetNumberOfPoints();
+  double bounds[6];
+  input->GetBounds(bounds);
+  double scale[3];
+  for (int k = 0; k < 3; ++k)
+  {
+    double length = bounds[2 * k + 1] - bounds[2 * k];
+    scale[k] = (length > 0.0) ? resolution / length : 0.0;
+  }
+
+  std::vector<unsigned int> keys(n);
+  std::vector<vtkIdType> offsets((1 << (3 * bits)) + 1, 0);
+  double p[3];
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    input->GetPoint(i, p);
+    unsigned int key = 0;
+    for (int k = 0; k < 3; ++k)
+    {
+      unsigned int q = static_cast<unsigned int>((p[k] - bounds[2 * k]) * scale[k]);
+      q = (q < resolution) ? q : resolution - 1;
+      for (int b = 0; b < bits; ++b)
+      {
+        key |= ((q >> b) & 1) << (3 * b + k);
+      }
+    }
+    keys[i] = key;
+    ++offsets[key + 1];
+  }
+  for (size_t i = 1; i < offsets.size(); ++i)
+  {
+    offsets[i] += offsets[i - 1];
+  }
+  order.resize(n);
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    order[offsets[keys[i]]++] = i;
+  }
+}
+
+// Find the cell of every BlockSize-th block of (sorted) points; the
+// locator and the mesh are only read.
+VTK_THREAD_RETURN_TYPE vtkCMBClassifyPointsExecute(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  const ClassifyUserData* ud = static_cast<ClassifyUserData*>(info->UserData);
+  vtkNew<vtkGenericCell> cell;
+  std::vector<double> weights(ud->MaxCellSize > 0 ? ud->MaxCellSize : 1);
+  double p[3], pcoords[3];
+  for (vtkIdType start = info->ThreadID * ud->BlockSize; start < ud->NumberOfPoints;
+       start += info->NumberOfThreads * ud->BlockSize)
+  {
+    vtkIdType end = std::min(start + ud->BlockSize, ud->NumberOfPoints);
+    for (vtkIdType i = start; i < end; ++i)
+    {
+      vtkIdType ptId = ud->Order[i];
+      ud->Input->GetPoint(ptId, p);
+      ud->CellIds[ptId] = ud->Locator->FindCell(p, 0.0, cell.GetPointer(), pcoords, &weights[0]);
+    }
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+VTK_THREAD_RETURN_TYPE vtkCMBClassifyPointsCount(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  const ClassifyUserData* ud = static_cast<ClassifyUserData*>(info->UserData);
+  for (int chunk = info->ThreadID; chunk < ud->NumberOfChunks; chunk += info->NumberOfThreads)
+  {
+    vtkIdType start, end, count = 0;
+    GetChunkRange(ud, chunk, start, end);
+    for (vtkIdType i = start; i < end; ++i)
+    {
+      count += (ud->CellIds[i] != -1) ? 1 : 0;
+    }
+    ud->ChunkCount[chunk] = count;
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+VTK_THREAD_RETURN_TYPE vtkCMBClassifyPointsCompact(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  const ClassifyUserData* ud = static_cast<ClassifyUserData*>(info->UserData);
+  for (int chunk = info->ThreadID; chunk < ud->NumberOfChunks; chunk += info->NumberOfThreads)
+  {
+    if (ud->ChunkCount[chunk] == 0)
+    {
+      continue;
+    }
+    vtkIdType start, end;
+    GetChunkRange(ud, chunk, start, end);
+    vtkIdType outId = ud->ChunkOffset[chunk];
+    for (vtkIdType i = start; i < end; ++i)
+    {
+      if (ud->CellIds[i] == -1)
+      {
+        continue;
+      }
+      ud->Input->GetPoint(i, ud->OutputPoints + 3 * outId);
+      ud->OutputIds[outId] = ud->CellIds[i];
+      ++outId;
+    }
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+}
+
 // Construct with defaults
 vtkCMBClassifyPointsFilter::vtkCMBClassifyPointsFilter()
 {
@@ -56,40 +206,86 @@ int vtkCMBClassifyPointsFilter::RequestData(vtkInformation* vtkNotUsed(request),
 
   vtkDataSet* mesh = vtkDataSet::SafeDownCast(meshInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  // Create a Cell Locator
+  vtkIdType n = input->GetNumberOfPoints();
+  std::vector<vtkIdType> cellIds(n, -1);
+
+  // Create a Cell Locator; with the cell bounds cached (and the mesh's
+  // cells built by a first GetCell) its thread safe FindCell only reads it
   vtkSmartPointer<vtkCellLocator> locator = vtkSmartPointer<vtkCellLocator>::New();
-  locator->SetDataSet(mesh);
-  locator->BuildLocator();
+  vtkNew<vtkMultiThreader> threader;
+  int numberOfThreads = threader->GetNumberOfThreads();
+  if (n > 0 && mesh->GetNumberOfCells() > 0)
+  {
+    locator->SetDataSet(mesh);
+    locator->CacheCellBoundsOn();
+    locator->BuildLocator();
+    vtkNew<vtkGenericCell> cell;
+    mesh->GetCell(0, cell.GetPointer());
 
-  vtkIdType i, n = input->GetNumberOfPoints();
-  double p[3];
+    std::vector<vtkIdType> order;
+    SortAlongCurve(input, order);
+
+    ClassifyUserData userData;
+    userData.Input = input;
+    userData.Locator = locator;
+    userData.MaxCellSize = mesh->GetMaxCellSize();
+    userData.Order = &order[0];
+    userData.NumberOfPoints = n;
+    userData.BlockSize = 1024;
+    userData.CellIds = &cellIds[0];
+    vtkIdType numberOfBlocks = (n + userData.BlockSize - 1) / userData.BlockSize;
+    threader->SetNumberOfThreads(
+      static_cast<int>(std::min(static_cast<vtkIdType>(numberOfThreads), numberOfBlocks)));
+    threader->SetSingleMethod(vtkCMBClassifyPointsExecute, &userData);
+    threader->SingleMethodExecute();
+  }
+
+  // the classified points, in the order of the input
+  int numberOfChunks = static_cast<int>(n / 65536) + 1;
+  if (numberOfChunks > 4 * numberOfThreads)
+  {
+    numberOfChunks = 4 * numberOfThreads;
+  }
+  threader->SetNumberOfThreads(std::min(numberOfThreads, numberOfChunks));
+  std::vector<vtkIdType> chunkCount(numberOfChunks, 0);
+  std::vector<vtkIdType> chunkOffset(numberOfChunks, 0);
+  ClassifyUserData userData;
+  userData.Input = input;
+  userData.NumberOfPoints = n;
+  userData.CellIds = cellIds.empty() ? NULL : &cellIds[0];
+  userData.NumberOfChunks = numberOfChunks;
+  userData.ChunkCount = &chunkCount[0];
+  userData.ChunkOffset = &chunkOffset[0];
+  threader->SetSingleMethod(vtkCMBClassifyPointsCount, &userData);
+  threader->SingleMethodExecute();
+
+  vtkIdType newNumPoints = 0;
+  for (int i = 0; i < numberOfChunks; i++)
+  {
+    chunkOffset[i] = newNumPoints;
+    newNumPoints += chunkCount[i];
+  }
 
   // Lets allocate the arrays
   vtkSmartPointer<vtkPoints> newPoints;
   newPoints = vtkSmartPointer<vtkPoints>::New();
   newPoints->SetDataTypeToDouble();
-  newPoints->Allocate(n);
+  newPoints->SetNumberOfPoints(newNumPoints);
   output->SetPoints(newPoints);
   vtkSmartPointer<vtkIdTypeArray> ids;
   ids = vtkSmartPointer<vtkIdTypeArray>::New();
   ids->SetNumberOfComponents(1);
-  ids->Allocate(n);
+  ids->SetNumberOfTuples(newNumPoints);
   ids->SetName("GridCellIds");
   vtkPointData* pdata = output->GetPointData();
   pdata->SetScalars(ids);
 
-  vtkIdType cellId;
-
-  for (i = 0; i < n; i++)
+  if (newNumPoints > 0)
   {
-    input->GetPoint(i, p);
-    cellId = locator->FindCell(p);
-    if (cellId == -1)
-    {
-      continue;
-    }
-    newPoints->InsertNextPoint(p);
-    ids->InsertNextTypedTuple(&cellId);
+    userData.OutputPoints = static_cast<vtkDoubleArray*>(newPoints->GetData())->GetPointer(0);
+    userData.OutputIds = ids->GetPointer(0);
+    threader->SetSingleMethod(vtkCMBClassifyPointsCompact, &userData);
+    threader->SingleMethodExecute();
   }
   return 1;
 }
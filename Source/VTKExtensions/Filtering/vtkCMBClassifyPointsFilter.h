@@ -12,6 +12,9 @@
 // vtkCMBClassifyPointsFilter classifies a set of points with respects to input.  If a point does not lie inside of a cell
 // it will be omitted.  Else the point will be added to the set and the cell's ID will be added
 // to the point data of the filter's output.
+// The points are located in parallel, in blocks of nearby points (along a
+// space filling curve), against a single locator; the output keeps the
+// order of the input points.
 
 #ifndef __vtkCMBClassifyPointsFilter_h
 #define __vtkCMBClassifyPointsFilter_h
@@ -10,6 +10,7 @@
 
 #include "vtkCMBConeCellClassifier.h"
 
+#include "vtkCMBConePointClassifier.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCleanPolyData.h"
@@ -78,14 +79,10 @@ int vtkCMBConeCellClassifier::RequestData(vtkInformation* vtkNotUsed(request),
   output->GetCellData()->SetScalars(newVals.GetPointer());
 
   // Process all of the cones
-  vtkIdType i, j, cell;
-  double p[3], transP[3];
-  int cellVal;
+  vtkIdType i, cell;
   vtkIdType numPts;
-  int maxSize = input->GetMaxCellSize();
-  vtkIdType* pids = new vtkIdType[maxSize];
+  vtkIdType* pids;
   vtkCellArray* cells = input->GetCells();
-  vtkPoints* points = input->GetPoints();
   // We need to get the unit vector based on the Cone's Axis Direction
   this->AxisUnitDir[0] = this->AxisDirection[0];
   this->AxisUnitDir[1] = this->AxisDirection[1];
@@ -104,6 +101,27 @@ int vtkCMBConeCellClassifier::RequestData(vtkInformation* vtkNotUsed(request),
   transform->Scale(this->Scaling);
   transform->Inverse();
   transform->Update();
+
+  // Classify each point once, rather than once per cell using it
+  vtkNew<vtkCMBConePointClassifier> classifier;
+  classifier->SetCone(
+    this->BaseCenter, this->AxisUnitDir, this->Height, this->BaseRadius, this->TopRadius);
+  classifier->SetPointTransform(transform->GetMatrix());
+  classifier->ClassifyPoints(input->GetPoints());
+  int mode;
+  switch (this->ClassificationMode)
+  {
+    case 1: // Fully inside mode
+      mode = vtkCMBConePointClassifier::ALL_IN;
+      break;
+    case 0: // Partially inside mode
+      mode = vtkCMBConePointClassifier::PARTIAL_OR_ALL_IN;
+      break;
+    default: // Only cells that intersect
+      mode = vtkCMBConePointClassifier::INTERSECT_ONLY;
+      break;
+  }
+
   // First copy the original values of the cell data
   for (i = 0; i < numCells; i++)
   {
@@ -113,108 +131,24 @@ int vtkCMBConeCellClassifier::RequestData(vtkInformation* vtkNotUsed(request),
   cells->InitTraversal();
   for (cell = 0; cells->GetNextCell(numPts, pids); cell++)
   {
-    cellVal = values->GetValue(cell);
-    if (cellVal != this->OriginalCellValue)
+    if (values->GetValue(cell) != this->OriginalCellValue)
     {
       // if the cell doesn't have the value we are look to change
       // skip it
       continue;
     }
-    // Fully inside mode
-    if (this->ClassificationMode == 1)
-    {
-      for (j = 0; j < numPts; j++)
-      {
-        points->GetPoint(pids[j], p);
-        transform->InternalTransformPoint(p, transP);
-        if (!this->IsInside(transP))
-        {
-          break;
-        }
-      }
-      // Did all the points pass?
-      if (j == numPts)
-      {
-        newVals->SetValue(cell, this->NewCellValue);
-      }
-    }
-    // Partially inside mode
-    else if (this->ClassificationMode == 0)
+    if (classifier->IsCellInside(mode, numPts, pids))
     {
-      for (j = 0; j < numPts; j++)
-      {
-        points->GetPoint(pids[j], p);
-        transform->InternalTransformPoint(p, transP);
-        if (this->IsInside(transP))
-        {
-          break;
-        }
-      }
-      // Did we find a point inside?
-      if (j != numPts)
-      {
-        newVals->SetValue(cell, this->NewCellValue);
-      }
-    }
-    else // Only cells that intersect
-    {
-      bool foundInside = false;
-      bool foundOutside = false;
-      for (j = 0; j < numPts; j++)
-      {
-        points->GetPoint(pids[j], p);
-        transform->InternalTransformPoint(p, transP);
-        if (this->IsInside(transP))
-        {
-          foundInside = true;
-        }
-        else
-        {
-          foundOutside = true;
-        }
-        if (foundInside && foundOutside)
-        {
-          break;
-        }
-      }
-      // Did we find a point inside?
-      if (foundInside && foundOutside)
-      {
-        newVals->SetValue(cell, this->NewCellValue);
-      }
+      newVals->SetValue(cell, this->NewCellValue);
     }
   }
-  delete[] pids;
   return 1;
 }
 
 bool vtkCMBConeCellClassifier::IsInside(const double p[3])
 {
-  double vec[3];
-  vtkMath::Subtract(p, this->BaseCenter, vec);
-  // Get the dot product to see if the
-  // projection of p onto the cone axis lies between 0 and coneLength
-  double l = vtkMath::Dot(vec, this->AxisUnitDir);
-  if ((l < 0.0) || (l > this->Height))
-  {
-    return false; // point is outside of the cone
-  }
-  // Now see what the radius at that point along the cone
-  // should be based on interpolating between the radii of the cone
-  double r2 = this->BaseRadius + ((this->TopRadius - this->BaseRadius) * l / this->Height);
-  // Square the result - we will need it in a min.
-  r2 *= r2;
-  // Calculate the perpendicular distance squared from the point and the cone
-  // axis - this is the distance between the point and p0 squared minus the projected
-  // length squared
-  double dist2 = vtkMath::Dot(vec, vec) - (l * l);
-  // if the perp dist is greater than the radius value we calculated then we know the point
-  // is outside the cone (else its inside)
-  if (dist2 > r2)
-  {
-    return false; // point is outside of the cone
-  }
-  return true;
+  return vtkCMBConePointClassifier::IsInside(
+    p, this->BaseCenter, this->AxisUnitDir, this->Height, this->BaseRadius, this->TopRadius);
 }
 
 void vtkCMBConeCellClassifier::PrintSelf(ostream& os, vtkIndent indent)
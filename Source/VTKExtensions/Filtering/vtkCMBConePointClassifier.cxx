@@ -0,0 +1,202 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+#include "vtkCMBConePointClassifier.h"
+
+#include "vtkMath.h"
+#include "vtkMatrix4x4.h"
+#include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+
+#include <algorithm>
+#include <vector>
+
+vtkStandardNewMacro(vtkCMBConePointClassifier);
+
+namespace
+{
+struct ConeShape
+{
+  const double* BaseCenter;
+  const double* AxisUnitDir;
+  double Height;
+  double BaseRadius;
+  double TopRadius;
+  const double* Matrix; // NULL for no transform
+};
+
+// The same arithmetic as vtkCMBConePointClassifier::IsInside (and as
+// vtkLinearTransform for the transform), without the branches so the
+// compiler can vectorize the loop.
+template <bool Transform, class T>
+void classifyChunk(
+  const ConeShape& cone, const T* pts, vtkIdType begin, vtkIdType end, unsigned char* inside)
+{
+  const double* m = cone.Matrix;
+  const double* c = cone.BaseCenter;
+  const double* a = cone.AxisUnitDir;
+  double height = cone.Height;
+  double baseRadius = cone.BaseRadius;
+  double slope = cone.TopRadius - cone.BaseRadius;
+  pts += 3 * begin;
+  for (vtkIdType i = begin; i < end; ++i, pts += 3)
+  {
+    double p[3] = { static_cast<double>(pts[0]), static_cast<double>(pts[1]),
+      static_cast<double>(pts[2]) };
+    if (Transform)
+    {
+      double x = m[0] * p[0] + m[1] * p[1] + m[2] * p[2] + m[3];
+      double y = m[4] * p[0] + m[5] * p[1] + m[6] * p[2] + m[7];
+      double z = m[8] * p[0] + m[9] * p[1] + m[10] * p[2] + m[11];
+      p[0] = x;
+      p[1] = y;
+      p[2] = z;
+    }
+    double vec[3] = { p[0] - c[0], p[1] - c[1], p[2] - c[2] };
+    double l = vec[0] * a[0] + vec[1] * a[1] + vec[2] * a[2];
+    double r2 = baseRadius + (slope * l / height);
+    r2 *= r2;
+    double dist2 = (vec[0] * vec[0] + vec[1] * vec[1] + vec[2] * vec[2]) - (l * l);
+    inside[i] &= static_cast<unsigned char>(!(l < 0.0) & !(l > height) & !(dist2 > r2));
+  }
+}
+
+template <bool Transform>
+void classifyRange(
+  const ConeShape& cone, vtkPoints* points, vtkIdType begin, vtkIdType end, unsigned char* inside)
+{
+  int dataType = points->GetDataType();
+  if (dataType == VTK_DOUBLE)
+  {
+    classifyChunk<Transform>(
+      cone, static_cast<const double*>(points->GetVoidPointer(0)), begin, end, inside);
+  }
+  else if (dataType == VTK_FLOAT)
+  {
+    classifyChunk<Transform>(
+      cone, static_cast<const float*>(points->GetVoidPointer(0)), begin, end, inside);
+  }
+  else
+  {
+    // any other point type
+    double p[3];
+    std::vector<double> tmp(3 * (end - begin));
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      points->GetPoint(i, p);
+      std::copy(p, p + 3, &tmp[3 * (i - begin)]);
+    }
+    classifyChunk<Transform>(cone, &tmp[0], 0, end - begin, inside + begin);
+  }
+}
+}
+
+vtkCMBConePointClassifier::vtkCMBConePointClassifier()
+{
+  this->BaseCenter[0] = this->BaseCenter[1] = this->BaseCenter[2] = 0.0;
+  this->AxisUnitDir[0] = this->AxisUnitDir[1] = 0.0;
+  this->AxisUnitDir[2] = 1.0;
+  this->Height = 1.0;
+  this->BaseRadius = 0.5;
+  this->TopRadius = 0.0;
+  this->HasPointTransform = false;
+  vtkMatrix4x4::Identity(this->PointTransform);
+}
+
+vtkCMBConePointClassifier::~vtkCMBConePointClassifier()
+{
+}
+
+void vtkCMBConePointClassifier::SetCone(const double baseCenter[3], const double axisDirection[3],
+  double height, double baseRadius, double topRadius)
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    this->BaseCenter[i] = baseCenter[i];
+    this->AxisUnitDir[i] = axisDirection[i];
+  }
+  vtkMath::Normalize(this->AxisUnitDir);
+  this->Height = height;
+  this->BaseRadius = baseRadius;
+  this->TopRadius = topRadius;
+  this->Modified();
+}
+
+void vtkCMBConePointClassifier::SetPointTransform(vtkMatrix4x4* matrix)
+{
+  this->HasPointTransform = matrix != NULL;
+  if (matrix)
+  {
+    vtkMatrix4x4::DeepCopy(this->PointTransform, matrix);
+  }
+  this->Modified();
+}
+
+void vtkCMBConePointClassifier::ClassifyRange(
+  vtkPoints* points, vtkIdType begin, vtkIdType end, unsigned char* inside) const
+{
+  ConeShape cone;
+  cone.BaseCenter = this->BaseCenter;
+  cone.AxisUnitDir = this->AxisUnitDir;
+  cone.Height = this->Height;
+  cone.BaseRadius = this->BaseRadius;
+  cone.TopRadius = this->TopRadius;
+  cone.Matrix = this->HasPointTransform ? this->PointTransform : NULL;
+  if (cone.Matrix)
+  {
+    classifyRange<true>(cone, points, begin, end, inside);
+  }
+  else
+  {
+    classifyRange<false>(cone, points, begin, end, inside);
+  }
+}
+
+bool vtkCMBConePointClassifier::IsInside(const double p[3], const double baseCenter[3],
+  const double axisUnitDir[3], double height, double baseRadius, double topRadius)
+{
+  double vec[3];
+  vtkMath::Subtract(p, baseCenter, vec);
+  // Get the dot product to see if the
+  // projection of p onto the cone axis lies between 0 and coneLength
+  double l = vtkMath::Dot(vec, axisUnitDir);
+  if ((l < 0.0) || (l > height))
+  {
+    return false; // point is outside of the cone
+  }
+  // Now see what the radius at that point along the cone
+  // should be based on interpolating between the radii of the cone
+  double r2 = baseRadius + ((topRadius - baseRadius) * l / height);
+  // Square the result - we will need it in a min.
+  r2 *= r2;
+  // Calculate the perpendicular distance squared from the point and the cone
+  // axis - this is the distance between the point and p0 squared minus the projected
+  // length squared
+  double dist2 = vtkMath::Dot(vec, vec) - (l * l);
+  // if the perp dist is greater than the radius value we calculated then we know the point
+  // is outside the cone (else its inside)
+  if (dist2 > r2)
+  {
+    return false; // point is outside of the cone
+  }
+  return true;
+}
+
+void vtkCMBConePointClassifier::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "BaseCenter: " << this->BaseCenter[0] << ", " << this->BaseCenter[1] << ", "
+     << this->BaseCenter[2] << "\n";
+  os << indent << "AxisUnitDir: " << this->AxisUnitDir[0] << ", " << this->AxisUnitDir[1]
+     << ", " << this->AxisUnitDir[2] << "\n";
+  os << indent << "Height: " << this->Height << "\n";
+  os << indent << "BaseRadius: " << this->BaseRadius << "\n";
+  os << indent << "TopRadius: " << this->TopRadius << "\n";
+  os << indent << "HasPointTransform: " << this->HasPointTransform << "\n";
+}
@@ -0,0 +1,69 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// .NAME vtkCMBConePointClassifier - inside / outside a truncated cone
+// .SECTION Description
+// vtkCMBConePointClassifier classifies all the points of a mesh against a
+// truncated cone (see vtkCMBPointClassifier): each point is transformed
+// into the cone's coordinates and tested once.
+// Shared by vtkCMBConeCellClassifier and vtkCMBMeshConeSelector.
+
+#ifndef __vtkCMBConePointClassifier_h
+#define __vtkCMBConePointClassifier_h
+
+#include "cmbSystemConfig.h"
+#include "vtkCMBFilteringModule.h" // For export macro
+#include "vtkCMBPointClassifier.h"
+
+class vtkMatrix4x4;
+
+class VTKCMBFILTERING_EXPORT vtkCMBConePointClassifier : public vtkCMBPointClassifier
+{
+public:
+  static vtkCMBConePointClassifier* New();
+  vtkTypeMacro(vtkCMBConePointClassifier, vtkCMBPointClassifier);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  // Description:
+  // Set the cone.  The axis direction does not have to be normalized.
+  void SetCone(const double baseCenter[3], const double axisDirection[3], double height,
+    double baseRadius, double topRadius);
+
+  // Description:
+  // Linear transform taking the points into the coordinates of the cone;
+  // NULL (the default) when they already are.
+  void SetPointTransform(vtkMatrix4x4* matrix);
+
+  // Description:
+  // Returns true if the point p is inside the truncated cone with this
+  // base center, (unit) axis, height and radii.
+  static bool IsInside(const double p[3], const double baseCenter[3], const double axisUnitDir[3],
+    double height, double baseRadius, double topRadius);
+
+protected:
+  vtkCMBConePointClassifier();
+  ~vtkCMBConePointClassifier() override;
+
+  void ClassifyRange(
+    vtkPoints* points, vtkIdType begin, vtkIdType end, unsigned char* inside) const override;
+
+  double BaseCenter[3];
+  double AxisUnitDir[3];
+  double Height;
+  double BaseRadius;
+  double TopRadius;
+  bool HasPointTransform;
+  double PointTransform[16];
+
+private:
+  vtkCMBConePointClassifier(const vtkCMBConePointClassifier&); // Not implemented.
+  void operator=(const vtkCMBConePointClassifier&);            // Not implemented.
+};
+
+#endif
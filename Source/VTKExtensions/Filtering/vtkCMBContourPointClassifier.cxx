@@ -0,0 +1,219 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+#include "vtkCMBContourPointClassifier.h"
+
+#include "vtkImplicitSelectionLoop.h"
+#include "vtkMath.h"
+#include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+#include "vtkPolygon.h"
+
+#include <algorithm>
+
+vtkStandardNewMacro(vtkCMBContourPointClassifier);
+
+namespace
+{
+// The loop projected onto its plane
+struct ContourLoop
+{
+  const double* Origin;
+  const double* AxisU;
+  const double* AxisV;
+  const double* U;
+  const double* V;
+  vtkIdType NumberOfPoints;
+  const double* Bounds;
+
+  // Project the point onto the plane of the loop, and count the crossings
+  // of the loop by a ray from it (even-odd rule).
+  bool IsInside(double x, double y, double z) const
+  {
+    double d[3] = { x - this->Origin[0], y - this->Origin[1], z - this->Origin[2] };
+    double u = d[0] * this->AxisU[0] + d[1] * this->AxisU[1] + d[2] * this->AxisU[2];
+    double v = d[0] * this->AxisV[0] + d[1] * this->AxisV[1] + d[2] * this->AxisV[2];
+    if (u < this->Bounds[0] || u > this->Bounds[1] || v < this->Bounds[2] || v > this->Bounds[3])
+    {
+      return false;
+    }
+    const double* lu = this->U;
+    const double* lv = this->V;
+    bool inside = false;
+    for (vtkIdType j = 0, k = this->NumberOfPoints - 1; j < this->NumberOfPoints; k = j++)
+    {
+      if (((lv[j] > v) != (lv[k] > v)) &&
+        (u < (lu[k] - lu[j]) * (v - lv[j]) / (lv[k] - lv[j]) + lu[j]))
+      {
+        inside = !inside;
+      }
+    }
+    return inside;
+  }
+};
+
+template <class T>
+void classifyChunk(
+  const ContourLoop& loop, const T* pts, vtkIdType begin, vtkIdType end, unsigned char* inside)
+{
+  pts += 3 * begin;
+  for (vtkIdType i = begin; i < end; ++i, pts += 3)
+  {
+    if (inside[i])
+    {
+      inside[i] = loop.IsInside(
+        static_cast<double>(pts[0]), static_cast<double>(pts[1]), static_cast<double>(pts[2]));
+    }
+  }
+}
+}
+
+vtkCMBContourPointClassifier::vtkCMBContourPointClassifier()
+{
+  this->Origin[0] = this->Origin[1] = this->Origin[2] = 0.0;
+  this->Normal[0] = this->Normal[1] = 0.0;
+  this->Normal[2] = 1.0;
+  this->AxisU[0] = 1.0;
+  this->AxisU[1] = this->AxisU[2] = 0.0;
+  this->AxisV[1] = 1.0;
+  this->AxisV[0] = this->AxisV[2] = 0.0;
+  // empty bounds: nothing is inside until a loop is set
+  this->LoopBounds[0] = this->LoopBounds[2] = 1.0;
+  this->LoopBounds[1] = this->LoopBounds[3] = -1.0;
+}
+
+vtkCMBContourPointClassifier::~vtkCMBContourPointClassifier()
+{
+}
+
+bool vtkCMBContourPointClassifier::SetContour(vtkImplicitSelectionLoop* contour)
+{
+  this->LoopU.clear();
+  this->LoopV.clear();
+  this->LoopBounds[0] = this->LoopBounds[2] = 1.0;
+  this->LoopBounds[1] = this->LoopBounds[3] = -1.0;
+  this->Modified();
+
+  vtkPoints* loop = contour ? contour->GetLoop() : NULL;
+  vtkIdType numPts = loop ? loop->GetNumberOfPoints() : 0;
+  if (numPts < 3)
+  {
+    return false;
+  }
+
+  // the same plane as vtkImplicitSelectionLoop: through the average of
+  // the loop points, with its (or the loop's) normal
+  if (contour->GetAutomaticNormalGeneration())
+  {
+    vtkPolygon::ComputeNormal(loop, this->Normal);
+  }
+  else
+  {
+    contour->GetNormal(this->Normal);
+  }
+  if (vtkMath::Normalize(this->Normal) == 0.0)
+  {
+    vtkErrorMacro("Cannot determine inside/outside of loop");
+    return false;
+  }
+  vtkMath::Perpendiculars(this->Normal, this->AxisU, this->AxisV, 0.0);
+
+  double x[3];
+  this->Origin[0] = this->Origin[1] = this->Origin[2] = 0.0;
+  for (vtkIdType i = 0; i < numPts; i++)
+  {
+    loop->GetPoint(i, x);
+    vtkMath::Add(this->Origin, x, this->Origin);
+  }
+  vtkMath::MultiplyScalar(this->Origin, 1.0 / numPts);
+
+  this->LoopU.resize(numPts);
+  this->LoopV.resize(numPts);
+  for (vtkIdType i = 0; i < numPts; i++)
+  {
+    loop->GetPoint(i, x);
+    vtkMath::Subtract(x, this->Origin, x);
+    this->LoopU[i] = vtkMath::Dot(x, this->AxisU);
+    this->LoopV[i] = vtkMath::Dot(x, this->AxisV);
+  }
+  this->LoopBounds[0] = *std::min_element(this->LoopU.begin(), this->LoopU.end());
+  this->LoopBounds[1] = *std::max_element(this->LoopU.begin(), this->LoopU.end());
+  this->LoopBounds[2] = *std::min_element(this->LoopV.begin(), this->LoopV.end());
+  this->LoopBounds[3] = *std::max_element(this->LoopV.begin(), this->LoopV.end());
+  return true;
+}
+
+void vtkCMBContourPointClassifier::ClassifyRange(
+  vtkPoints* points, vtkIdType begin, vtkIdType end, unsigned char* inside) const
+{
+  if (this->LoopU.empty())
+  {
+    std::fill(inside + begin, inside + end, 0);
+    return;
+  }
+  ContourLoop loop;
+  loop.Origin = this->Origin;
+  loop.AxisU = this->AxisU;
+  loop.AxisV = this->AxisV;
+  loop.U = &this->LoopU[0];
+  loop.V = &this->LoopV[0];
+  loop.NumberOfPoints = static_cast<vtkIdType>(this->LoopU.size());
+  loop.Bounds = this->LoopBounds;
+
+  switch (points->GetDataType())
+  {
+    case VTK_DOUBLE:
+      classifyChunk(
+        loop, static_cast<const double*>(points->GetVoidPointer(0)), begin, end, inside);
+      break;
+    case VTK_FLOAT:
+      classifyChunk(
+        loop, static_cast<const float*>(points->GetVoidPointer(0)), begin, end, inside);
+      break;
+    default:
+    {
+      double p[3];
+      for (vtkIdType i = begin; i < end; ++i)
+      {
+        if (inside[i])
+        {
+          points->GetPoint(i, p);
+          inside[i] = loop.IsInside(p[0], p[1], p[2]);
+        }
+      }
+    }
+  }
+}
+
+bool vtkCMBContourPointClassifier::IsInside(const double p[3]) const
+{
+  if (this->LoopU.empty())
+  {
+    return false;
+  }
+  ContourLoop loop;
+  loop.Origin = this->Origin;
+  loop.AxisU = this->AxisU;
+  loop.AxisV = this->AxisV;
+  loop.U = &this->LoopU[0];
+  loop.V = &this->LoopV[0];
+  loop.NumberOfPoints = static_cast<vtkIdType>(this->LoopU.size());
+  loop.Bounds = this->LoopBounds;
+  return loop.IsInside(p[0], p[1], p[2]);
+}
+
+void vtkCMBContourPointClassifier::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Origin: " << this->Origin[0] << ", " << this->Origin[1] << ", "
+     << this->Origin[2] << "\n";
+  os << indent << "Normal: " << this->Normal[0] << ", " << this->Normal[1] << ", "
+     << this->Normal[2] << "\n";
+  os << indent << "NumberOfLoopPoints: " << this->LoopU.size() << "\n";
+}
@@ -0,0 +1,70 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// .NAME vtkCMBContourPointClassifier - inside / outside a selection loop
+// .SECTION Description
+// vtkCMBContourPointClassifier classifies the points of a mesh against a
+// selection loop (vtkImplicitSelectionLoop), see vtkCMBPointClassifier.
+// The loop is projected once onto its plane, and each point is then
+// projected and tested with a 2D point in polygon test, without computing
+// the distance to the loop that the implicit function evaluates.
+// Used by vtkCMBMeshContourSelector.
+// .SECTION See Also
+// vtkCMBConePointClassifier
+
+#ifndef __vtkCMBContourPointClassifier_h
+#define __vtkCMBContourPointClassifier_h
+
+#include "cmbSystemConfig.h"
+#include "vtkCMBFilteringModule.h" // For export macro
+#include "vtkCMBPointClassifier.h"
+#include <vector> // For the loop
+
+class vtkImplicitSelectionLoop;
+
+class VTKCMBFILTERING_EXPORT vtkCMBContourPointClassifier : public vtkCMBPointClassifier
+{
+public:
+  static vtkCMBContourPointClassifier* New();
+  vtkTypeMacro(vtkCMBContourPointClassifier, vtkCMBPointClassifier);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  // Description:
+  // Set the selection loop, using its normal (or the one computed from the
+  // loop if it generates it automatically).  Returns false, and no point
+  // will be inside, if the loop does not define a polygon.
+  bool SetContour(vtkImplicitSelectionLoop* contour);
+
+  // Description:
+  // Whether the point p projects inside the loop.
+  bool IsInside(const double p[3]) const;
+
+protected:
+  vtkCMBContourPointClassifier();
+  ~vtkCMBContourPointClassifier() override;
+
+  void ClassifyRange(
+    vtkPoints* points, vtkIdType begin, vtkIdType end, unsigned char* inside) const override;
+
+  // the plane of the loop, and two unit axes in it
+  double Origin[3];
+  double Normal[3];
+  double AxisU[3];
+  double AxisV[3];
+  // the loop projected onto its plane, in (u, v) coordinates
+  std::vector<double> LoopU;
+  std::vector<double> LoopV;
+  double LoopBounds[4];
+
+private:
+  vtkCMBContourPointClassifier(const vtkCMBContourPointClassifier&); // Not implemented.
+  void operator=(const vtkCMBContourPointClassifier&);               // Not implemented.
+};
+
+#endif
@@ -25,6 +25,9 @@
 #include "vtkTransform.h"
 #include "vtkUnsignedCharArray.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkCMBGlyphPointSource);
 
 vtkCMBGlyphPointSource::vtkCMBGlyphPointSource()
@@ -81,6 +84,8 @@ vtkCMBGlyphPointSource::vtkCMBGlyphPointSource()
 
   // Create a tranform that can be re-used
   this->Transform = vtkSmartPointer<vtkTransform>::New();
+
+  this->PointBoundsValid = false;
   this->SetNumberOfInputPorts(0);
 }
 
@@ -108,6 +113,24 @@ int vtkCMBGlyphPointSource::RequestData(vtkInformation* vtkNotUsed(request),
   return 1;
 }
 
+void vtkCMBGlyphPointSource::PointsAppended(vtkIdType first)
+{
+  if (!this->PointBoundsValid)
+  {
+    this->PointBounds.Reset();
+    this->PointBoundsValid = true;
+    first = 0;
+  }
+  double p[3];
+  vtkIdType n = this->Points->GetNumberOfPoints();
+  for (vtkIdType i = first; i < n; i++)
+  {
+    this->Points->GetPoint(i, p);
+    this->PointBounds.AddPoint(p);
+  }
+  this->PointBounds.GetBounds(this->GlyphSourceBounds);
+}
+
 void vtkCMBGlyphPointSource::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
@@ -126,7 +149,7 @@ void vtkCMBGlyphPointSource::PrintSelf(ostream& os, vtkIndent indent)
 vtkIdType vtkCMBGlyphPointSource::InsertNextPoint(double x, double y, double z)
 {
   vtkIdType id = this->Points->InsertNextPoint(x, y, z);
-  this->Points->GetBounds(this->GlyphSourceBounds);
+  this->PointsAppended(id);
   this->Color->InsertNextTuple4((255.0 * this->DefaultColor[0]) + 0.5,
     (255.0 * this->DefaultColor[1]) + 0.5, (255.0 * this->DefaultColor[2]) + 0.5,
     (255.0 * this->DefaultColor[3]) + 0.5);
@@ -145,7 +168,7 @@ vtkIdType vtkCMBGlyphPointSource::InsertNextPoint(double x, double y, double z,
   double b, double a, double sx, double sy, double sz, double ox, double oy, double oz, int vis)
 {
   vtkIdType id = this->Points->InsertNextPoint(x, y, z);
-  this->Points->GetBounds(this->GlyphSourceBounds);
+  this->PointsAppended(id);
 
   this->Color->InsertNextTuple4(
     (255.0 * r) + 0.5, (255.0 * g) + 0.5, (255.0 * b) + 0.5, (255.0 * a) + 0.5);
@@ -160,6 +183,134 @@ vtkIdType vtkCMBGlyphPointSource::InsertNextPoint(double x, double y, double z,
   return id;
 }
 
+vtkIdType vtkCMBGlyphPointSource::InsertNextPoints(vtkIdType n, double* points)
+{
+  return this->InsertNextPoints(n, points, 0, 0, 0, 0);
+}
+
+vtkIdType vtkCMBGlyphPointSource::InsertNextPoints(vtkIdType n, double* points, double* colors,
+  double* scales, double* orientations, int* visibilities)
+{
+  vtkIdType first = this->Points->GetNumberOfPoints();
+  if (n <= 0 || !points)
+  {
+    return first;
+  }
+
+  // grow every array once, then fill in the new tuples
+  vtkIdType total = first + n;
+  this->Points->SetNumberOfPoints(total);
+  this->Color->SetNumberOfTuples(total);
+  this->Scaling->SetNumberOfTuples(total);
+  this->Orientation->SetNumberOfTuples(total);
+  this->Visibility->SetNumberOfTuples(total);
+  this->SelectionMask->SetNumberOfTuples(total);
+
+  unsigned char defaultColor[4];
+  for (int j = 0; j < 4; j++)
+  {
+    defaultColor[j] = (255.0 * this->DefaultColor[j]) + 0.5;
+  }
+  unsigned char* color = this->Color->GetPointer(4 * first);
+  double* scale = this->Scaling->GetPointer(3 * first);
+  double* orientation = this->Orientation->GetPointer(3 * first);
+  for (vtkIdType i = 0; i < n; i++, color += 4, scale += 3, orientation += 3)
+  {
+    vtkIdType id = first + i;
+    this->Points->SetPoint(id, points + 3 * i);
+    if (colors)
+    {
+      for (int j = 0; j < 4; j++)
+      {
+        color[j] = (255.0 * colors[4 * i + j]) + 0.5;
+      }
+    }
+    else
+    {
+      std::copy(defaultColor, defaultColor + 4, color);
+    }
+    if (scales)
+    {
+      std::copy(scales + 3 * i, scales + 3 * i + 3, scale);
+    }
+    else
+    {
+      scale[0] = scale[1] = scale[2] = 1.0;
+    }
+    if (orientations)
+    {
+      std::copy(orientations + 3 * i, orientations + 3 * i + 3, orientation);
+    }
+    else
+    {
+      orientation[0] = orientation[1] = orientation[2] = 0.0;
+    }
+    this->Visibility->SetValue(id, visibilities ? visibilities[i] : 1);
+    this->SelectionMask->SetValue(id, colors ? 1 : 0);
+    // Update the vertices point Ids
+    this->CellIds->InsertCellPoint(id);
+  }
+  this->CellIds->UpdateCellCount(total);
+
+  this->Color->Modified();
+  this->Scaling->Modified();
+  this->Orientation->Modified();
+  this->Visibility->Modified();
+  this->SelectionMask->Modified();
+  this->PointsAppended(first);
+  this->Modified();
+  return first;
+}
+
+vtkIdType vtkCMBGlyphPointSource::InsertNextGlyphs(vtkCMBGlyphPointSource* source)
+{
+  vtkIdType n = source ? source->GetNumberOfPoints() : 0;
+  if (n == 0)
+  {
+    return this->Points->GetNumberOfPoints();
+  }
+  std::vector<double> points(3 * n);
+  for (vtkIdType i = 0; i < n; i++)
+  {
+    source->Points->GetPoint(i, &points[3 * i]);
+  }
+  return this->InsertNextPoints(n, &points[0], 0, source->Scaling->GetPointer(0),
+    source->Orientation->GetPointer(0), 0);
+}
+
+void vtkCMBGlyphPointSource::SetPoints(vtkIdType index, vtkIdType n, double* points)
+{
+  for (vtkIdType i = 0; i < n; i++)
+  {
+    this->Points->SetPoint(index + i, points + 3 * i);
+  }
+  this->Points->Modified();
+  this->Points->GetBounds(this->GlyphSourceBounds);
+  this->PointBounds.SetBounds(this->GlyphSourceBounds);
+  this->PointBoundsValid = true;
+  this->Modified();
+}
+
+void vtkCMBGlyphPointSource::SetScales(vtkIdType index, vtkIdType n, double* scales)
+{
+  if (n > 0)
+  {
+    std::copy(scales, scales + 3 * n, this->Scaling->GetPointer(3 * index));
+    this->Scaling->Modified();
+  }
+  this->Modified();
+}
+
+void vtkCMBGlyphPointSource::SetOrientations(vtkIdType index, vtkIdType n, double* orientations)
+{
+  if (n > 0)
+  {
+    std::copy(orientations, orientations + 3 * n, this->Orientation->GetPointer(3 * index));
+    this->Orientation->Modified();
+  }
+  this->Modified();
+}
+
 void vtkCMBGlyphPointSource::SetScale(vtkIdType index, double sx, double sy, double sz)
 {
   this->Scaling->SetTuple3(index, sx, sy, sz);
@@ -244,6 +395,7 @@ void vtkCMBGlyphPointSource::ApplyTransform(double* odelta, double* pdelta, doub
     val[2] *= sdelta[2];
     this->Scaling->SetTuple(i, val);
   }
+  this->PointBoundsValid = false;
   this->Modified();
 }
 
@@ -269,6 +421,7 @@ void vtkCMBGlyphPointSource::ApplyTransform(
   val[1] *= sdelta[1];
   val[2] *= sdelta[2];
   this->Scaling->SetTuple(i, val);
+  this->PointBoundsValid = false;
   this->Modified();
 }
 
@@ -295,6 +448,8 @@ void vtkCMBGlyphPointSource::SetPoint(vtkIdType index, double x, double y, doubl
 {
   this->Points->SetPoint(index, x, y, z);
   this->Points->GetBounds(this->GlyphSourceBounds);
+  this->PointBounds.SetBounds(this->GlyphSourceBounds);
+  this->PointBoundsValid = true;
   this->Modified();
 }
 
@@ -344,6 +499,8 @@ void vtkCMBGlyphPointSource::ReadFromFile(const char* fname)
   this->Visibility = vtkBitArray::SafeDownCast(pdata->GetArray("Visibility", index));
   this->SelectionMask = vtkBitArray::SafeDownCast(pdata->GetArray("UniqueColor", index));
   reader->Delete();
+  this->PointBoundsValid = false;
+  this->Modified();
 }
 
 void vtkCMBGlyphPointSource::WriteToFile(const char* fname)
@@ -10,11 +10,15 @@
 // .NAME vtkCMBGlyphPointSource - Represents a set of points that will be used for Glyphing
 // .SECTION Description
 // The input Source data is shallow copied to the output
+//
+// Glyphs can be inserted (and their properties set) a range at a time,
+// which grows each of the arrays only once.
 
 #ifndef __vtkCMBGlyphPointSource_h
 #define __vtkCMBGlyphPointSource_h
 
 #include "cmbSystemConfig.h"
+#include "vtkBoundingBox.h"        // For PointBounds
 #include "vtkCMBFilteringModule.h" // For export macro
 #include "vtkPolyDataAlgorithm.h"
 #include "vtkSmartPointer.h"
@@ -43,6 +47,30 @@ public:
   vtkIdType InsertNextPoint(double x, double y, double z, double r, double g, double b, double a,
     double sx, double sy, double sz, double ox, double oy, double oz, int vis);
 
+  // Description:
+  // Insert n points (xyz triplets) at once, with the default properties.
+  // Returns the id of the first one.
+  vtkIdType InsertNextPoints(vtkIdType n, double* points);
+
+  // Description:
+  // Insert n points and their properties at once: colors are rgba
+  // quadruplets, scales and orientations triplets.  Any of the properties
+  // can be null for the default ones.  Returns the id of the first point.
+  vtkIdType InsertNextPoints(vtkIdType n, double* points, double* colors, double* scales,
+    double* orientations, int* visibilities);
+
+  // Description:
+  // Insert the glyphs of source (their points, scales and orientations),
+  // with the default properties otherwise.  Returns the id of the first one.
+  vtkIdType InsertNextGlyphs(vtkCMBGlyphPointSource* source);
+
+  // Description:
+  // Set the position / scale / orientation (xyz triplets) of the n glyphs
+  // starting at index.
+  void SetPoints(vtkIdType index, vtkIdType n, double* points);
+  void SetScales(vtkIdType index, vtkIdType n, double* scales);
+  void SetOrientations(vtkIdType index, vtkIdType n, double* orientations);
+
   void SetScale(vtkIdType index, double sx, double sy, double sz);
   void SetOrientation(vtkIdType index, double ox, double oy, double oz);
   void ApplyTransform(double* orinetationDelta, double* positionDelta, double* scaleDelta);
@@ -104,6 +132,11 @@ protected:
 
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) override;
 
+  // Description:
+  // Points first to the last one were appended: extend the bounds of the
+  // points (what GlyphSourceBounds is set to) to them.
+  void PointsAppended(vtkIdType first);
+
   vtkSmartPointer<vtkPolyData> Source;
   vtkSmartPointer<vtkPoints> Points;
   vtkSmartPointer<vtkUnsignedCharArray> Color;
@@ -116,6 +149,9 @@ protected:
   double TempData[6];
   double DefaultColor[4];
   double GlyphSourceBounds[6];
+  // bounds of the points, invalid once a point moves
+  vtkBoundingBox PointBounds;
+  bool PointBoundsValid;
 
 private:
   vtkCMBGlyphPointSource(const vtkCMBGlyphPointSource&); // Not implemented.
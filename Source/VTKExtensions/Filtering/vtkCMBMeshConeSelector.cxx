@@ -9,6 +9,7 @@
 //=========================================================================
 #include "vtkCMBMeshConeSelector.h"
 
+#include "vtkCMBConePointClassifier.h"
 #include "vtkCMBConeSource.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
@@ -18,6 +19,7 @@
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkLine.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
@@ -168,19 +170,23 @@ int vtkCMBMeshConeSelector::RequestData(vtkInformation* vtkNotUsed(request),
   outSelectionList->SetNumberOfComponents(1);
   vtkIdType numSelIds = 0;
   vtkIdType i, npts, *pts;
-  // We need to get the unit vector based on the Cone's Axis Direction
-  double AxisUnitDir[3];
-  AxisUnitDir[0] = this->ConeSource->GetDirection()[0];
-  AxisUnitDir[1] = this->ConeSource->GetDirection()[1];
-  AxisUnitDir[2] = this->ConeSource->GetDirection()[2];
-  vtkMath::Normalize(AxisUnitDir);
+
+  // Classify each point once, rather than once per cell using it
+  vtkNew<vtkCMBConePointClassifier> cone;
+  cone->SetCone(this->ConeSource->GetBaseCenter(), this->ConeSource->GetDirection(),
+    this->ConeSource->GetHeight(), this->ConeSource->GetBaseRadius(),
+    this->ConeSource->GetTopRadius());
+  if (this->Transform)
+  {
+    this->Transform->Update();
+    cone->SetPointTransform(this->Transform->GetMatrix());
+  }
+  cone->ClassifyPoints(inPts);
 
   for (i = 0; i < numCells; i++)
   {
     input->GetCellPoints(i, npts, pts);
-    if (this->DoCellConeCheck(npts, pts, input, this->ConeSource->GetBaseCenter(), AxisUnitDir,
-          this->ConeSource->GetHeight(), this->ConeSource->GetBaseRadius(),
-          this->ConeSource->GetTopRadius()))
+    if (this->DoCellConeCheck(npts, pts, cone.GetPointer()))
     {
       outSelectionList->InsertNextValue(i);
     }
@@ -209,176 +215,14 @@ int vtkCMBMeshConeSelector::RequestData(vtkInformation* vtkNotUsed(request),
 
   return 1;
 }
-// The following algorithm is copied from Bob's vtkCMBConeCellClassifier
-
-inline bool IsInsideCone(const double p[3], double BaseCenter[3], double AxisUnitDir[3],
-  double Height, double BaseRadius, double TopRadius)
-{
-  double vec[3];
-  vtkMath::Subtract(p, BaseCenter, vec);
-  // Get the dot product to see if the
-  // projection of p onto the cone axis lies between 0 and coneLength
-  double l = vtkMath::Dot(vec, AxisUnitDir);
-  if ((l < 0.0) || (l > Height))
-  {
-    return false; // point is outside of the cone
-  }
-  // Now see what the radius at that point along the cone
-  // should be based on interpolating between the radii of the cone
-  double r2 = BaseRadius + ((TopRadius - BaseRadius) * l / Height);
-  // Square the result - we will need it in a min.
-  r2 *= r2;
-  // Calculate the perpendicular distance squared from the point and the cone
-  // axis - this is the distance between the point and p0 squared minus the projected
-  // length squared
-  double dist2 = vtkMath::Dot(vec, vec) - (l * l);
-  // if the perp dist is greater than the radius value we calculated then we know the point
-  // is outside the cone (else its inside)
-  if (dist2 > r2)
-  {
-    return false; // point is outside of the cone
-  }
-  return true;
-}
-
-inline bool IsAllIn(vtkIdType npts, vtkIdType* pts, double* point, double BaseCenter[3],
-  double AxisUnitDir[3], double Height, double BaseRadius, double TopRadius,
-  vtkUnstructuredGrid* input)
-{
-  for (vtkIdType ptIndex = 0; ptIndex < npts; ptIndex++)
-  {
-    input->GetPoint(pts[ptIndex], point);
-    if (!IsInsideCone(point, BaseCenter, AxisUnitDir, Height, BaseRadius, TopRadius))
-    {
-      return false;
-    }
-  }
-  return true;
-}
-
-inline bool IsTransFormAllIn(vtkIdType npts, vtkIdType* pts, double* point, double BaseCenter[3],
-  double AxisUnitDir[3], double Height, double BaseRadius, double TopRadius,
-  vtkTransform* transform, double* transpoint, vtkUnstructuredGrid* input)
+bool vtkCMBMeshConeSelector::DoCellConeCheck(
+  vtkIdType npts, vtkIdType* pts, vtkCMBConePointClassifier* cone)
 {
-  for (vtkIdType ptIndex = 0; ptIndex < npts; ptIndex++)
-  {
-    input->GetPoint(pts[ptIndex], point);
-    transform->TransformPoint(point, transpoint);
-    if (!IsInsideCone(transpoint, BaseCenter, AxisUnitDir, Height, BaseRadius, TopRadius))
-    {
-      return false;
-    }
-  }
-  return true;
-}
-
-inline bool IsAllOut(vtkIdType npts, vtkIdType* pts, double* point, double BaseCenter[3],
-  double AxisUnitDir[3], double Height, double BaseRadius, double TopRadius,
-  vtkUnstructuredGrid* input)
-{
-  for (vtkIdType ptIndex = 0; ptIndex < npts; ptIndex++)
-  {
-    input->GetPoint(pts[ptIndex], point);
-    if (IsInsideCone(point, BaseCenter, AxisUnitDir, Height, BaseRadius, TopRadius))
-    {
-      return false;
-    }
-  }
-  return true;
-}
-
-inline bool IsTransFormAllOut(vtkIdType npts, vtkIdType* pts, double* point, double BaseCenter[3],
-  double AxisUnitDir[3], double Height, double BaseRadius, double TopRadius,
-  vtkTransform* transform, double* transpoint, vtkUnstructuredGrid* input)
-{
-  for (vtkIdType ptIndex = 0; ptIndex < npts; ptIndex++)
-  {
-    input->GetPoint(pts[ptIndex], point);
-    transform->TransformPoint(point, transpoint);
-    if (IsInsideCone(transpoint, BaseCenter, AxisUnitDir, Height, BaseRadius, TopRadius))
-    {
-      return false;
-    }
-  }
-  return true;
-}
-inline bool IsIntersecting(vtkIdType npts, vtkIdType* pts, double* point, double BaseCenter[3],
-  double AxisUnitDir[3], double Height, double BaseRadius, double TopRadius,
-  vtkUnstructuredGrid* input)
-{
-  bool partIn = false;
-  bool partOut = false;
-  for (vtkIdType ptIndex = 0; ptIndex < npts; ptIndex++)
-  {
-    input->GetPoint(pts[ptIndex], point);
-    if (IsInsideCone(point, BaseCenter, AxisUnitDir, Height, BaseRadius, TopRadius))
-    {
-      partIn = true;
-    }
-    else
-    {
-      partOut = true;
-    }
-  }
-  return partIn && partOut;
-}
-
-inline bool IsTransFormIntersecting(vtkIdType npts, vtkIdType* pts, double* point,
-  double BaseCenter[3], double AxisUnitDir[3], double Height, double BaseRadius, double TopRadius,
-  vtkTransform* transform, double* transpoint, vtkUnstructuredGrid* input)
-{
-  bool partIn = false;
-  bool partOut = false;
-  for (vtkIdType ptIndex = 0; ptIndex < npts; ptIndex++)
-  {
-    input->GetPoint(pts[ptIndex], point);
-    transform->TransformPoint(point, transpoint);
-    if (IsInsideCone(transpoint, BaseCenter, AxisUnitDir, Height, BaseRadius, TopRadius))
-    {
-      partIn = true;
-    }
-    else
-    {
-      partOut = true;
-    }
-  }
-  return partIn && partOut;
-}
-
-bool vtkCMBMeshConeSelector::DoCellConeCheck(vtkIdType npts, vtkIdType* pts,
-  vtkUnstructuredGrid* input, double BaseCenter[3], double AxisUnitDir[3], double Height,
-  double BaseRadius, double TopRadius)
-{
-  double point[3];
-  double transPts[3];
-  bool bKeep = false;
-  if (npts <= 0 || !pts || !input)
-  {
-    return bKeep;
-  }
-  switch (this->SelectConeType)
+  if (npts <= 0 || !pts || !cone)
   {
-    case ALL_IN:
-      bKeep = (this->Transform == NULL)
-        ? IsAllIn(npts, pts, point, BaseCenter, AxisUnitDir, Height, BaseRadius, TopRadius, input)
-        : IsTransFormAllIn(npts, pts, point, BaseCenter, AxisUnitDir, Height, BaseRadius, TopRadius,
-            this->Transform, transPts, input);
-      break;
-    case INTERSECT_ONLY:
-      bKeep = (this->Transform == NULL)
-        ? IsIntersecting(
-            npts, pts, point, BaseCenter, AxisUnitDir, Height, BaseRadius, TopRadius, input)
-        : IsTransFormIntersecting(npts, pts, point, BaseCenter, AxisUnitDir, Height, BaseRadius,
-            TopRadius, this->Transform, transPts, input);
-      break;
-    case PARTIAL_OR_ALL_IN:
-      bKeep = (this->Transform == NULL)
-        ? !IsAllOut(npts, pts, point, BaseCenter, AxisUnitDir, Height, BaseRadius, TopRadius, input)
-        : !IsTransFormAllOut(npts, pts, point, BaseCenter, AxisUnitDir, Height, BaseRadius,
-            TopRadius, this->Transform, transPts, input);
-      break;
+    return false;
   }
-  return bKeep;
+  return cone->IsCellInside(this->SelectConeType, npts, pts);
 }
 
 void vtkCMBMeshConeSelector::PrintSelf(ostream& os, vtkIndent indent)
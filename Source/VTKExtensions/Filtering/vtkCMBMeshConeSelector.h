@@ -22,6 +22,7 @@
 #include "vtkCMBFilteringModule.h" // For export macro
 #include "vtkSelectionAlgorithm.h"
 
+class vtkCMBConePointClassifier;
 class vtkCMBConeSource;
 class vtkTransform;
 class vtkUnstructuredGrid;
@@ -102,9 +103,10 @@ protected:
   int FillInputPortInformation(int port, vtkInformation* info) override;
   int FillOutputPortInformation(int port, vtkInformation* info) override;
 
-  virtual bool DoCellConeCheck(vtkIdType npts, vtkIdType* pts, vtkUnstructuredGrid* input,
-    double BaseCenter[3], double AxisUnitDir[3], double Height, double BaseRadius,
-    double TopRadius);
+  // Description:
+  // Whether the cell with these points is selected, from the classification
+  // of the points against the cone.
+  virtual bool DoCellConeCheck(vtkIdType npts, vtkIdType* pts, vtkCMBConePointClassifier* cone);
 
   int SelectConeType;
   int SelectionFieldType;
@@ -9,6 +9,7 @@
 //=========================================================================
 #include "vtkCMBMeshContourSelector.h"
 
+#include "vtkCMBContourPointClassifier.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkConvertSelection.h"
@@ -21,6 +22,7 @@
 #include "vtkInformationVector.h"
 #include "vtkLine.h"
 #include "vtkMergePoints.h"
+#include "vtkMultiThreader.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
@@ -31,11 +33,126 @@
 #include "vtkTriangle.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
 #include <math.h>
+#include <vector>
 
 vtkStandardNewMacro(vtkCMBMeshContourSelector);
 vtkCxxSetObjectMacro(vtkCMBMeshContourSelector, Contour, vtkImplicitSelectionLoop);
 
+// Which mesh cell / node ids are in a set, as bitsets indexed by the ids
+struct vtkCMBMeshContourSelectorIdSets
+{
+  // mesh node ids on the surface of a volume mesh
+  std::vector<bool> SurfaceNodes;
+  // mesh cell / node ids already added to the selected output
+  std::vector<bool> OutMeshCells;
+  std::vector<bool> OutNodes;
+
+  static bool Contains(const std::vector<bool>& set, vtkIdType id)
+  {
+    return id >= 0 && id < static_cast<vtkIdType>(set.size()) && set[id];
+  }
+
+  // Returns false if id was already in the set
+  static bool Insert(std::vector<bool>& set, vtkIdType id)
+  {
+    if (id < 0)
+    {
+      return true;
+    }
+    if (id >= static_cast<vtkIdType>(set.size()))
+    {
+      set.resize(id + 1, false);
+    }
+    else if (set[id])
+    {
+      return false;
+    }
+    set[id] = true;
+    return true;
+  }
+};
+
+// Checks all the cells of the input against the (classified) contour for
+// selecting through.  Chunks of cells are handed out to the threads in
+// turn; a chunk is a whole number of bitset words, so that each thread only
+// writes its own words.
+struct vtkCMBMeshContourSelectorWorker
+{
+  vtkCMBMeshContourSelector* Self;
+  vtkUnstructuredGrid* Input;
+  vtkCMBContourPointClassifier* Contour;
+  vtkIdType NumberOfCells;
+  vtkIdType ChunkSize;
+  std::vector<vtkTypeUInt64> Selected;
+
+  static VTK_THREAD_RETURN_TYPE Execute(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    vtkCMBMeshContourSelectorWorker* self =
+      static_cast<vtkCMBMeshContourSelectorWorker*>(info->UserData);
+    for (vtkIdType begin = info->ThreadID * self->ChunkSize; begin < self->NumberOfCells;
+         begin += info->NumberOfThreads * self->ChunkSize)
+    {
+      self->CheckCells(begin, std::min(begin + self->ChunkSize, self->NumberOfCells));
+    }
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  void CheckCells(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType npts, *pts;
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      this->Input->GetCellPoints(i, npts, pts);
+      if (this->Self->DoCellContourCheck(npts, pts, this->Contour))
+      {
+        this->Selected[i >> 6] |= vtkTypeUInt64(1) << (i & 63);
+      }
+    }
+  }
+
+  // Check all the cells, and append the selected ones to cellIds in order
+  void Run(vtkIdTypeArray* cellIds)
+  {
+    this->ChunkSize = 64 * 256;
+    this->Selected.assign((this->NumberOfCells + 63) / 64, 0);
+    vtkNew<vtkMultiThreader> threader;
+    vtkIdType numberOfChunks = (this->NumberOfCells + this->ChunkSize - 1) / this->ChunkSize;
+    if (numberOfChunks < threader->GetNumberOfThreads())
+    {
+      threader->SetNumberOfThreads(static_cast<int>(std::max(numberOfChunks, vtkIdType(1))));
+    }
+    threader->SetSingleMethod(vtkCMBMeshContourSelectorWorker::Execute, this);
+    threader->SingleMethodExecute();
+
+    // compact the bitset
+    vtkIdType numSelected = 0;
+    for (size_t w = 0; w < this->Selected.size(); w++)
+    {
+      for (vtkTypeUInt64 bits = this->Selected[w]; bits; bits &= bits - 1)
+      {
+        numSelected++;
+      }
+    }
+    vtkIdType next = cellIds->GetNumberOfTuples();
+    cellIds->SetNumberOfTuples(next + numSelected);
+    vtkIdType* out = cellIds->GetPointer(next);
+    for (size_t w = 0; w < this->Selected.size(); w++)
+    {
+      vtkTypeUInt64 bits = this->Selected[w];
+      for (vtkIdType i = static_cast<vtkIdType>(64 * w); bits; bits >>= 1, i++)
+      {
+        if (bits & 1)
+        {
+          *out++ = i;
+        }
+      }
+    }
+  }
+};
+
 vtkCMBMeshContourSelector::vtkCMBMeshContourSelector()
 {
   this->SetNumberOfInputPorts(3);
@@ -170,17 +287,22 @@ int vtkCMBMeshContourSelector::RequestData(vtkInformation* vtkNotUsed(request),
   outSelectionList->SetNumberOfComponents(1);
   vtkIdType numSelIds = 0;
   vtkIdType i;
+  // Classify the points against the contour once, rather than once per
+  // cell using them
+  vtkNew<vtkCMBContourPointClassifier> contour;
+  if (this->Contour)
+  {
+    contour->SetContour(this->Contour);
+  }
   if (this->SelectCellThrough && this->Contour)
   {
-    vtkIdType npts, *pts;
-    for (i = 0; i < numCells; i++)
-    {
-      input->GetCellPoints(i, npts, pts);
-      if (this->DoCellContourCheck(npts, pts, input))
-      {
-        outSelectionList->InsertNextValue(i);
-      }
-    }
+    contour->ClassifyPoints(inPts);
+    vtkCMBMeshContourSelectorWorker worker;
+    worker.Self = this;
+    worker.Input = input;
+    worker.Contour = contour.GetPointer();
+    worker.NumberOfCells = numCells;
+    worker.Run(outSelectionList);
   }
   // if we are NOT doing select through, then we need a selection that
   // contains all the surface cells/points selected based on the contour's boundary or a rubber band
@@ -218,7 +340,7 @@ int vtkCMBMeshContourSelector::RequestData(vtkInformation* vtkNotUsed(request),
     }
 
     // Extract the surface if it is a volume and we are not doing select through
-    vtkSmartPointer<vtkIdList> SurfaceNodeIdList = 0;
+    vtkCMBMeshContourSelectorIdSets idSets;
     if (bVolume)
     {
       vtkPolyData* surfaceInput = 0;
@@ -244,9 +366,39 @@ int vtkCMBMeshContourSelector::RequestData(vtkInformation* vtkNotUsed(request),
         return 0;
       }
       vtkIdType numSurfaceNodes = SurfaceNodeIdArray->GetNumberOfTuples();
-      SurfaceNodeIdList = vtkSmartPointer<vtkIdList>::New();
-      vtkIdType* idsP = SurfaceNodeIdList->WritePointer(0, numSurfaceNodes);
-      memcpy(idsP, SurfaceNodeIdArray->GetPointer(0), numSurfaceNodes * sizeof(vtkIdType));
+      for (i = 0; i < numSurfaceNodes; i++)
+      {
+        vtkCMBMeshContourSelectorIdSets::Insert(
+          idSets.SurfaceNodes, SurfaceNodeIdArray->GetValue(i));
+      }
+    }
+
+    // Classify the points of the selection against the contour
+    numSelIds = selArray->GetNumberOfTuples();
+    if (this->Contour)
+    {
+      vtkNew<vtkIdList> contourPointIds;
+      if (node->GetFieldType() == vtkSelectionNode::CELL)
+      {
+        vtkIdType npts, *pts;
+        for (i = 0; i < numSelIds; i++)
+        {
+          input->GetCellPoints(selArray->GetValue(i), npts, pts);
+          for (vtkIdType n = 0; n < npts; n++)
+          {
+            contourPointIds->InsertNextId(pts[n]);
+          }
+        }
+      }
+      else
+      {
+        contourPointIds->SetNumberOfIds(numSelIds);
+        for (i = 0; i < numSelIds; i++)
+        {
+          contourPointIds->SetId(i, selArray->GetValue(i));
+        }
+      }
+      contour->ClassifyPoints(inPts, contourPointIds.GetPointer());
     }
 
     vtkNew<vtkIdList> outNodeIdList;
@@ -274,14 +426,13 @@ int vtkCMBMeshContourSelector::RequestData(vtkInformation* vtkNotUsed(request),
     double totNormal[3] = { 0.0, 0.0, 0.0 };
     int totNumNormals = 0;
     vtkNew<vtkIdList> tmpIds;
-    numSelIds = selArray->GetNumberOfTuples();
     for (i = 0; i < numSelIds; i++)
     {
       selid = selArray->GetValue(i);
       this->DoSurfaceSelectionCheck(node->GetFieldType(), tmpIds.GetPointer(), bVolume, selid,
         input, meshCellIdArray, meshNodeIdArray, newPoints.GetPointer(), outVerts.GetPointer(),
-        outMeshCellIds.GetPointer(), outNodeIdList.GetPointer(), SurfaceNodeIdList,
-        outSelectionList, totNormal, totNumNormals);
+        outMeshCellIds.GetPointer(), outNodeIdList.GetPointer(), &idSets,
+        this->Contour ? contour.GetPointer() : NULL, outSelectionList, totNormal, totNumNormals);
     }
 
     if (totNumNormals > 0)
@@ -372,8 +523,9 @@ int vtkCMBMeshContourSelector::FillInputPortInformation(int port, vtkInformation
 void vtkCMBMeshContourSelector::DoSurfaceSelectionCheck(int selType, vtkIdList* tmpIds,
   bool bVolume, vtkIdType selId, vtkUnstructuredGrid* input, vtkIdTypeArray* meshCellIdArray,
   vtkIdTypeArray* meshNodeIdArray, vtkPoints* newPoints, vtkCellArray* outVerts,
-  vtkIdList* outMeshCellIds, vtkIdList* outNodeIdList, vtkIdList* surfaceNodeList,
-  vtkIdTypeArray* outSelectionList, double* totNormal, int& totNumNormals)
+  vtkIdList* outMeshCellIds, vtkIdList* outNodeIdList, vtkCMBMeshContourSelectorIdSets* idSets,
+  vtkCMBContourPointClassifier* contour, vtkIdTypeArray* outSelectionList, double* totNormal,
+  int& totNumNormals)
 {
   vtkIdType npts, *pts;
   double point[3], *pointPtr;
@@ -387,28 +539,28 @@ void vtkCMBMeshContourSelector::DoSurfaceSelectionCheck(int selType, vtkIdList*
   if (selType == vtkSelectionNode::CELL)
   {
     meshCellId = meshCellIdArray->GetValue(selId);
-    if (outMeshCellIds->IsId(meshCellId) >= 0) // already done
+    if (vtkCMBMeshContourSelectorIdSets::Contains(idSets->OutMeshCells, meshCellId)) // already done
     {
       return;
     }
     input->GetCellPoints(selId, npts, pts);
-    if (bVolume && surfaceNodeList) // only check the surface points
+    if (bVolume) // only check the surface points
     {
-      tmpIds->Initialize();
+      tmpIds->Reset();
       for (vtkIdType n = 0; n < npts; n++)
       {
         meshNodeId = meshNodeIdArray->GetValue(pts[n]);
-        if (surfaceNodeList->IsId(meshNodeId) >= 0)
+        if (vtkCMBMeshContourSelectorIdSets::Contains(idSets->SurfaceNodes, meshNodeId))
         {
-          tmpIds->InsertUniqueId(pts[n]);
+          tmpIds->InsertNextId(pts[n]);
         }
       }
       npts = tmpIds->GetNumberOfIds();
       pts = tmpIds->GetPointer(0);
     }
-    if (this->Contour) // check against contour
+    if (contour) // check against contour
     {
-      if (this->DoCellContourCheck(npts, pts, input))
+      if (this->DoCellContourCheck(npts, pts, contour))
       {
         outSelectionList->InsertNextValue(selId);
         bKeep = true;
@@ -422,18 +574,22 @@ void vtkCMBMeshContourSelector::DoSurfaceSelectionCheck(int selType, vtkIdList*
     }
     if (bKeep && this->GenerateSelectedOutput)
     {
-      outMeshCellIds->InsertUniqueId(meshCellId);
+      vtkCMBMeshContourSelectorIdSets::Insert(idSets->OutMeshCells, meshCellId);
+      outMeshCellIds->InsertNextId(meshCellId);
       for (vtkIdType n = 0; n < npts; n++)
       {
+        input->GetPoint(pts[n], point);
+        if (n < 4)
+        {
+          std::copy(point, point + 3, tmpPts[n]);
+        }
         meshNodeId = meshNodeIdArray->GetValue(pts[n]);
-        if (outNodeIdList->IsId(meshNodeId) >= 0)
+        if (!vtkCMBMeshContourSelectorIdSets::Insert(idSets->OutNodes, meshNodeId))
         {
           continue;
         }
-        outNodeIdList->InsertUniqueId(meshNodeId);
-        input->GetPoint(pts[n], tmpPts[n]);
-        pointPtr = tmpPts[n];
-        nextPt = newPoints->InsertNextPoint(pointPtr);
+        outNodeIdList->InsertNextId(meshNodeId);
+        nextPt = newPoints->InsertNextPoint(point);
         outVerts->InsertNextCell(1, &nextPt);
       }
       // compute the average normal for the point
@@ -454,16 +610,15 @@ void vtkCMBMeshContourSelector::DoSurfaceSelectionCheck(int selType, vtkIdList*
   else if (selType == vtkSelectionNode::POINT)
   {
     meshNodeId = meshNodeIdArray->GetValue(selId);
-    if (outNodeIdList->IsId(meshNodeId) >= 0) // already done
+    if (vtkCMBMeshContourSelectorIdSets::Contains(idSets->OutNodes, meshNodeId)) // already done
     {
       return;
     }
     input->GetPoint(selId, point);
     pointPtr = point;
-    if (this->Contour)
+    if (contour)
     {
-      double s = this->Contour->FunctionValue(pointPtr);
-      if (s < 0) // point is inside contour
+      if (contour->IsPointInside(selId)) // point is inside contour
       {
         bKeep = true;
         outSelectionList->InsertNextValue(selId);
@@ -476,7 +631,8 @@ void vtkCMBMeshContourSelector::DoSurfaceSelectionCheck(int selType, vtkIdList*
     if (bKeep && this->GenerateSelectedOutput)
     {
       tmpIds->Initialize();
-      outNodeIdList->InsertUniqueId(meshNodeId);
+      vtkCMBMeshContourSelectorIdSets::Insert(idSets->OutNodes, meshNodeId);
+      outNodeIdList->InsertNextId(meshNodeId);
       nextPt = newPoints->InsertNextPoint(pointPtr);
       outVerts->InsertNextCell(1, &nextPt);
       // ideally, for surface mesh, we should only check the cells
@@ -485,23 +641,24 @@ void vtkCMBMeshContourSelector::DoSurfaceSelectionCheck(int selType, vtkIdList*
       vtkIdType currentCellId;
       vtkIdType numCells = tmpIds->GetNumberOfIds();
       int numUsedCells = 0;
+      vtkNew<vtkIdList> ptsIds;
       for (vtkIdType i = 0; i < numCells; i++)
       {
         currentCellId = tmpIds->GetId(i);
         meshCellId = meshCellIdArray->GetValue(currentCellId);
-        if (outMeshCellIds->IsId(meshCellId) >= 0) // done
+        if (vtkCMBMeshContourSelectorIdSets::Contains(idSets->OutMeshCells, meshCellId)) // done
         {
           continue;
         }
         input->GetCellPoints(currentCellId, npts, pts);
-        vtkSmartPointer<vtkIdList> ptsIds = vtkSmartPointer<vtkIdList>::New();
-        if (bVolume && surfaceNodeList)
+        if (bVolume)
         {
+          ptsIds->Reset();
           vtkIdType ptMeshId;
           for (vtkIdType n = 0; n < npts; n++)
           {
             ptMeshId = meshNodeIdArray->GetValue(pts[n]);
-            if (surfaceNodeList->IsId(ptMeshId) >= 0)
+            if (vtkCMBMeshContourSelectorIdSets::Contains(idSets->SurfaceNodes, ptMeshId))
             {
               ptsIds->InsertNextId(pts[n]);
             }
@@ -539,7 +696,8 @@ void vtkCMBMeshContourSelector::DoSurfaceSelectionCheck(int selType, vtkIdList*
           aNormal[2] += mNormal[2];
           numUsedCells++;
         }
-        outMeshCellIds->InsertUniqueId(meshCellId);
+        vtkCMBMeshContourSelectorIdSets::Insert(idSets->OutMeshCells, meshCellId);
+        outMeshCellIds->InsertNextId(meshCellId);
       }
       if (numUsedCells > 0)
       {
@@ -555,80 +713,14 @@ void vtkCMBMeshContourSelector::DoSurfaceSelectionCheck(int selType, vtkIdList*
   }
 }
 
-inline bool IsAllIn(vtkIdType npts, vtkIdType* pts, double* point, vtkImplicitSelectionLoop* cFunc,
-  vtkUnstructuredGrid* input)
-{
-  double s;
-  for (vtkIdType ptIndex = 0; ptIndex < npts; ptIndex++)
-  {
-    input->GetPoint(pts[ptIndex], point);
-    s = cFunc->FunctionValue(point);
-    if (s >= 0)
-    {
-      return false;
-    }
-  }
-  return true;
-}
-inline bool IsAllOut(vtkIdType npts, vtkIdType* pts, double* point, vtkImplicitSelectionLoop* cFunc,
-  vtkUnstructuredGrid* input)
-{
-  double s;
-  for (vtkIdType ptIndex = 0; ptIndex < npts; ptIndex++)
-  {
-    input->GetPoint(pts[ptIndex], point);
-    s = cFunc->FunctionValue(point);
-    if (s < 0)
-    {
-      return false;
-    }
-  }
-  return true;
-}
-inline bool IsIntersecting(vtkIdType npts, vtkIdType* pts, double* point,
-  vtkImplicitSelectionLoop* cFunc, vtkUnstructuredGrid* input)
-{
-  double s;
-  bool partIn = false;
-  bool partOut = false;
-  for (vtkIdType ptIndex = 0; ptIndex < npts; ptIndex++)
-  {
-    input->GetPoint(pts[ptIndex], point);
-    s = cFunc->FunctionValue(point);
-    if (s < 0)
-    {
-      partIn = true;
-    }
-    else
-    {
-      partOut = true;
-    }
-  }
-  return partIn && partOut;
-}
-
 bool vtkCMBMeshContourSelector::DoCellContourCheck(
-  vtkIdType npts, vtkIdType* pts, vtkUnstructuredGrid* input)
+  vtkIdType npts, vtkIdType* pts, vtkCMBContourPointClassifier* contour)
 {
-  double point[3];
-  bool bKeep = false;
-  if (npts <= 0 || !pts || !input)
-  {
-    return bKeep;
-  }
-  switch (this->SelectContourType)
+  if (npts <= 0 || !pts || !contour)
   {
-    case ALL_IN:
-      bKeep = IsAllIn(npts, pts, point, this->Contour, input);
-      break;
-    case INTERSECT_ONLY:
-      bKeep = IsIntersecting(npts, pts, point, this->Contour, input);
-      break;
-    case PARTIAL_OR_ALL_IN:
-      bKeep = !IsAllOut(npts, pts, point, this->Contour, input);
-      break;
+    return false;
   }
-  return bKeep;
+  return contour->IsCellInside(this->SelectContourType, npts, pts);
 }
 
 void vtkCMBMeshContourSelector::PrintSelf(ostream& os, vtkIndent indent)
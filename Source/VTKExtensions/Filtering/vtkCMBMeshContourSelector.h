@@ -15,6 +15,11 @@
 // Based on the selection type (surface or select through), a surface
 // filter may be used or not before doing selection. The input to this
 // filter is a surface or volume mesh.
+//
+// The points are tested against the contour in parallel, with a 2D point in
+// polygon test in the plane of the contour (vtkCMBContourPointClassifier).
+// When selecting through, the cells are then tested in parallel too and
+// collected in a bitset, compacted into the selection in order.
 
 // .SECTION See Also
 // vtkSelectionAlgorithm, vtkImplicitSelectionLoop
@@ -26,6 +31,7 @@
 #include "vtkCMBFilteringModule.h" // For export macro
 #include "vtkSelectionAlgorithm.h"
 
+class vtkCMBContourPointClassifier;
 class vtkImplicitSelectionLoop;
 class vtkPolyData;
 class vtkPoints;
@@ -36,6 +42,11 @@ class vtkIdList;
 
 #include <map>
 
+//BTX
+struct vtkCMBMeshContourSelectorIdSets;
+struct vtkCMBMeshContourSelectorWorker;
+//ETX
+
 class VTKCMBFILTERING_EXPORT vtkCMBMeshContourSelector : public vtkSelectionAlgorithm
 {
 public:
@@ -152,12 +163,23 @@ protected:
   int FillInputPortInformation(int port, vtkInformation* info) override;
   int FillOutputPortInformation(int port, vtkInformation* info) override;
 
+  // Description:
+  // Check the selected cell or point selId against the contour (already
+  // classified, NULL for a rubber band selection), and add it to the
+  // outputs.  idSets holds which mesh cells / nodes are already in the
+  // outputs, and which mesh nodes are on the surface of a volume.
   virtual void DoSurfaceSelectionCheck(int selType, vtkIdList* tmpIds, bool bVolume,
     vtkIdType selId, vtkUnstructuredGrid* input, vtkIdTypeArray* meshCellIdArray,
     vtkIdTypeArray* meshNodeIdArray, vtkPoints* newPoints, vtkCellArray* outVerts,
-    vtkIdList* outMeshCellIds, vtkIdList* outNodeIdList, vtkIdList* surfaceNodeList,
-    vtkIdTypeArray* outSelectionList, double* totNormal, int& totNumNormals);
-  virtual bool DoCellContourCheck(vtkIdType npts, vtkIdType* pts, vtkUnstructuredGrid* input);
+    vtkIdList* outMeshCellIds, vtkIdList* outNodeIdList, vtkCMBMeshContourSelectorIdSets* idSets,
+    vtkCMBContourPointClassifier* contour, vtkIdTypeArray* outSelectionList, double* totNormal,
+    int& totNumNormals);
+
+  // Description:
+  // Whether the cell with these points is selected, from the classification
+  // of the points against the contour.
+  virtual bool DoCellContourCheck(
+    vtkIdType npts, vtkIdType* pts, vtkCMBContourPointClassifier* contour);
 
   int SelectCellThrough;
   int SelectContourType;
@@ -175,6 +197,8 @@ private:
   void operator=(const vtkCMBMeshContourSelector&);            // Not implemented.
 
   bool IsProcessing;
+
+  friend struct vtkCMBMeshContourSelectorWorker;
   //ETX
 };
 
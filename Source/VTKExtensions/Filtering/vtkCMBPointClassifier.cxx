@@ -0,0 +1,137 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+#include "vtkCMBPointClassifier.h"
+
+#include "vtkIdList.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+
+#include <algorithm>
+
+struct vtkCMBPointClassifierUserData
+{
+  const vtkCMBPointClassifier* Classifier;
+  vtkPoints* Points;
+  vtkIdType NumberOfPoints;
+  vtkIdType ChunkSize;
+  unsigned char* Inside;
+};
+
+vtkCMBPointClassifier::vtkCMBPointClassifier()
+{
+}
+
+vtkCMBPointClassifier::~vtkCMBPointClassifier()
+{
+}
+
+// every NumberOfThreads-th chunk of the points, from the chunk ThreadID on
+VTK_THREAD_RETURN_TYPE vtkCMBPointClassifier::ClassifyPointsExecute(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  const vtkCMBPointClassifierUserData* ud =
+    static_cast<vtkCMBPointClassifierUserData*>(info->UserData);
+  for (vtkIdType begin = info->ThreadID * ud->ChunkSize; begin < ud->NumberOfPoints;
+       begin += info->NumberOfThreads * ud->ChunkSize)
+  {
+    ud->Classifier->ClassifyRange(
+      ud->Points, begin, std::min(begin + ud->ChunkSize, ud->NumberOfPoints), ud->Inside);
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+void vtkCMBPointClassifier::ClassifyPoints(vtkPoints* points, vtkIdList* pointIds)
+{
+  vtkIdType numberOfPoints = points ? points->GetNumberOfPoints() : 0;
+  this->Inside.assign(numberOfPoints, 0);
+  if (numberOfPoints == 0)
+  {
+    return;
+  }
+  // mark the points to classify
+  if (pointIds)
+  {
+    for (vtkIdType i = 0; i < pointIds->GetNumberOfIds(); i++)
+    {
+      this->Inside[pointIds->GetId(i)] = 1;
+    }
+  }
+  else
+  {
+    std::fill(this->Inside.begin(), this->Inside.end(), 1);
+  }
+
+  vtkCMBPointClassifierUserData userData;
+  userData.Classifier = this;
+  userData.Points = points;
+  userData.NumberOfPoints = numberOfPoints;
+  userData.ChunkSize = 16384;
+  userData.Inside = &this->Inside[0];
+
+  vtkNew<vtkMultiThreader> threader;
+  vtkIdType numberOfChunks = (numberOfPoints + userData.ChunkSize - 1) / userData.ChunkSize;
+  int dataType = points->GetDataType();
+  if (dataType != VTK_FLOAT && dataType != VTK_DOUBLE)
+  {
+    // GetPoint() is not safe from several threads for all the types
+    threader->SetNumberOfThreads(1);
+    userData.ChunkSize = numberOfPoints;
+  }
+  else if (numberOfChunks < threader->GetNumberOfThreads())
+  {
+    threader->SetNumberOfThreads(static_cast<int>(numberOfChunks));
+  }
+  threader->SetSingleMethod(vtkCMBPointClassifier::ClassifyPointsExecute, &userData);
+  threader->SingleMethodExecute();
+}
+
+bool vtkCMBPointClassifier::IsCellInside(int mode, vtkIdType npts, const vtkIdType* pts) const
+{
+  const unsigned char* inside = &this->Inside[0];
+  vtkIdType j;
+  switch (mode)
+  {
+    case ALL_IN:
+      for (j = 0; j < npts && inside[pts[j]]; j++)
+      {
+      }
+      return j == npts;
+    case PARTIAL_OR_ALL_IN:
+      for (j = 0; j < npts && !inside[pts[j]]; j++)
+      {
+      }
+      return j != npts;
+    case INTERSECT_ONLY:
+    {
+      bool foundInside = false;
+      bool foundOutside = false;
+      for (j = 0; j < npts && !(foundInside && foundOutside); j++)
+      {
+        if (inside[pts[j]])
+        {
+          foundInside = true;
+        }
+        else
+        {
+          foundOutside = true;
+        }
+      }
+      return foundInside && foundOutside;
+    }
+  }
+  return false;
+}
+
+void vtkCMBPointClassifier::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfClassifiedPoints: " << this->Inside.size() << "\n";
+}
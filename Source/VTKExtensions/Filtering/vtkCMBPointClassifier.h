@@ -0,0 +1,92 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// .NAME vtkCMBPointClassifier - inside / outside a shape, for all the points
+// .SECTION Description
+// vtkCMBPointClassifier is the base class of the classifiers that test all
+// the points of a mesh against a shape in one (parallel) pass, keeping the
+// result in a mask (a byte per point), and then classify the cells from the
+// mask of their points (see CellModes), instead of testing their points
+// again for every cell that uses them.
+//
+// The points are split in chunks over vtkMultiThreader; the subclasses
+// only implement the test of a range of points (ClassifyRange).
+// .SECTION See Also
+// vtkCMBConePointClassifier vtkCMBContourPointClassifier
+
+#ifndef __vtkCMBPointClassifier_h
+#define __vtkCMBPointClassifier_h
+
+#include "cmbSystemConfig.h"
+#include "vtkCMBFilteringModule.h" // For export macro
+#include "vtkMultiThreader.h"      // For VTK_THREAD_RETURN_TYPE
+#include "vtkObject.h"
+#include <vector> // For the point mask
+
+class vtkIdList;
+class vtkPoints;
+
+class VTKCMBFILTERING_EXPORT vtkCMBPointClassifier : public vtkObject
+{
+public:
+  vtkTypeMacro(vtkCMBPointClassifier, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  //BTX
+  enum CellModes
+  {
+    // all the points of the cell are inside
+    ALL_IN = 0,
+    // at least one point of the cell is inside
+    PARTIAL_OR_ALL_IN,
+    // some of the points of the cell are inside, and some outside
+    INTERSECT_ONLY
+  };
+  //ETX
+
+  // Description:
+  // Classify the points; the points are split over vtkMultiThreader.  If
+  // pointIds is given only those points are classified, and the others
+  // left outside.
+  void ClassifyPoints(vtkPoints* points, vtkIdList* pointIds = NULL);
+
+  // Description:
+  // Whether point ptId was inside (after ClassifyPoints).
+  bool IsPointInside(vtkIdType ptId) const { return this->Inside[ptId] != 0; }
+
+  // Description:
+  // Whether a cell with these points is inside for the mode (one of
+  // CellModes), from the classification of its points.
+  bool IsCellInside(int mode, vtkIdType npts, const vtkIdType* pts) const;
+
+protected:
+  vtkCMBPointClassifier();
+  ~vtkCMBPointClassifier() override;
+
+  // Description:
+  // Classify the points begin to end: inside[i] is 1 for the points to
+  // classify, and is to be left 1 only for those inside.  Called from
+  // several threads at once for float and double points; for points of any
+  // other type (read with GetPoint()) it is called once, for all the points.
+  virtual void ClassifyRange(
+    vtkPoints* points, vtkIdType begin, vtkIdType end, unsigned char* inside) const = 0;
+
+  // Description:
+  // The vtkMultiThreader method of ClassifyPoints().
+  static VTK_THREAD_RETURN_TYPE ClassifyPointsExecute(void* arg);
+
+  // 1 if the point is inside, 0 if not
+  std::vector<unsigned char> Inside;
+
+private:
+  vtkCMBPointClassifier(const vtkCMBPointClassifier&); // Not implemented.
+  void operator=(const vtkCMBPointClassifier&);        // Not implemented.
+};
+
+#endif
@@ -9,20 +9,458 @@
 //=========================================================================
 #include "vtkClosestPointFilter.h"
 
-#include "vtkCellLocator.h"
+#include "vtkDoubleArray.h"
 #include "vtkErrorCode.h"
+#include "vtkGenericCell.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
-#include "vtkMultiBlockDataSet.h"
+#include "vtkMatrix4x4.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkSmartPointer.h"
 #include "vtkTransform.h"
-#
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// Node of the bounding volume hierarchy: the cells CellIds[Begin, End),
+// and the children Child and Child + 1 (Child < 0 for a leaf).
+struct CellTreeNode
+{
+  double Bounds[6];
+  vtkIdType Begin;
+  vtkIdType End;
+  vtkIdType Child;
+};
+
+// Orders cells by the coordinate of their center along an axis
+struct CenterLess
+{
+  const double* Centers;
+  int Axis;
+  CenterLess(const double* centers, int axis)
+    : Centers(centers)
+    , Axis(axis)
+  {
+  }
+  bool operator()(vtkIdType a, vtkIdType b) const
+  {
+    return this->Centers[3 * a + this->Axis] < this->Centers[3 * b + this->Axis];
+  }
+};
+
+// What a thread needs for its queries
+struct CellTreeQuery
+{
+  vtkNew<vtkGenericCell> Cell;
+  std::vector<double> Weights;
+  std::vector<vtkIdType> Stack;
+};
+
+double boundsDistance2(const double bounds[6], const double x[3])
+{
+  double dist2 = 0.0;
+  for (int i = 0; i < 3; ++i)
+  {
+    double d = x[i] < bounds[2 * i] ? bounds[2 * i] - x[i]
+                                    : (x[i] > bounds[2 * i + 1] ? x[i] - bounds[2 * i + 1] : 0.0);
+    dist2 += d * d;
+  }
+  return dist2;
+}
+
+// Whether the part [0, tMax] of the line p1 + t * (p2 - p1) crosses bounds
+bool boundsHitByLine(const double bounds[6], const double p1[3], const double p2[3], double tMax)
+{
+  double tMin = 0.0;
+  for (int i = 0; i < 3; ++i)
+  {
+    double d = p2[i] - p1[i];
+    if (d == 0.0)
+    {
+      if (p1[i] < bounds[2 * i] || p1[i] > bounds[2 * i + 1])
+      {
+        return false;
+      }
+      continue;
+    }
+    double t0 = (bounds[2 * i] - p1[i]) / d;
+    double t1 = (bounds[2 * i + 1] - p1[i]) / d;
+    if (t0 > t1)
+    {
+      std::swap(t0, t1);
+    }
+    tMin = std::max(tMin, t0);
+    tMax = std::min(tMax, t1);
+    if (tMin > tMax)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Same arithmetic as vtkLinearTransform::TransformPoint
+void transformPoint(const double m[16], const double in[3], double out[3])
+{
+  double x = m[0] * in[0] + m[1] * in[1] + m[2] * in[2] + m[3];
+  double y = m[4] * in[0] + m[5] * in[1] + m[6] * in[2] + m[7];
+  double z = m[8] * in[0] + m[9] * in[1] + m[10] * in[2] + m[11];
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+}
+}
+
+struct vtkClosestPointFilterInternals
+{
+  vtkSmartPointer<vtkPolyData> Input;
+  vtkMTimeType InputTime;
+  int MaxCellSize;
+  std::vector<CellTreeNode> Nodes;
+  std::vector<vtkIdType> CellIds;
+  double ToData[16];
+  double ToWorld[16];
+
+  vtkClosestPointFilterInternals()
+    : InputTime(0)
+    , MaxCellSize(0)
+  {
+    vtkMatrix4x4::Identity(this->ToData);
+    vtkMatrix4x4::Identity(this->ToWorld);
+  }
+
+  // Rebuild the tree if the input is not the one it was built for
+  void Update(vtkPolyData* input)
+  {
+    if (input == this->Input.GetPointer() && input && input->GetMTime() == this->InputTime)
+    {
+      return;
+    }
+    this->Input = input;
+    this->InputTime = input ? input->GetMTime() : 0;
+    this->Build();
+  }
+
+  void Build();
+  void InitializeQuery(CellTreeQuery& query) const
+  {
+    query.Weights.resize(std::max(this->MaxCellSize, 1));
+    query.Stack.reserve(128);
+  }
+  bool FindClosestPoint(const double x[3], double closest[3], CellTreeQuery& query) const;
+  bool IntersectWithLine(
+    const double p1[3], const double p2[3], double x[3], CellTreeQuery& query) const;
+
+  // In world space
+  bool FindClosestPointWorld(const double p[3], double closest[3], CellTreeQuery& query) const
+  {
+    double tp[3], ctp[3];
+    transformPoint(this->ToData, p, tp);
+    if (!this->FindClosestPoint(tp, ctp, query))
+    {
+      std::copy(p, p + 3, closest);
+      return false;
+    }
+    transformPoint(this->ToWorld, ctp, closest);
+    return true;
+  }
+  bool FindClosestPointAlongLineWorld(
+    const double p1[3], const double p2[3], double closest[3], CellTreeQuery& query) const
+  {
+    double tp[3], tp2[3], ctp[3];
+    transformPoint(this->ToData, p1, tp);
+    transformPoint(this->ToData, p2, tp2);
+    // If the intersection fails try closestpoint
+    if (!this->IntersectWithLine(tp, tp2, ctp, query) &&
+      !this->FindClosestPoint(tp, ctp, query))
+    {
+      std::copy(p1, p1 + 3, closest);
+      return false;
+    }
+    transformPoint(this->ToWorld, ctp, closest);
+    return true;
+  }
+};
+
+void vtkClosestPointFilterInternals::Build()
+{
+  this->Nodes.clear();
+  this->CellIds.clear();
+  this->MaxCellSize = 0;
+  vtkPolyData* input = this->Input;
+  vtkIdType numCells = input ? input->GetNumberOfCells() : 0;
+  if (numCells == 0)
+  {
+    return;
+  }
+
+  // bounds and center of the (non empty) cells; this also builds the
+  // cells of the input, so GetCell can be called from several threads
+  std::vector<double> cellBounds(6 * numCells);
+  std::vector<double> centers(3 * numCells);
+  vtkIdType npts, *pts;
+  double p[3];
+  this->CellIds.reserve(numCells);
+  for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
+  {
+    input->GetCellPoints(cellId, npts, pts);
+    if (npts == 0)
+    {
+      continue;
+    }
+    this->MaxCellSize = std::max(this->MaxCellSize, static_cast<int>(npts));
+    double* b = &cellBounds[6 * cellId];
+    b[0] = b[2] = b[4] = VTK_DOUBLE_MAX;
+    b[1] = b[3] = b[5] = -VTK_DOUBLE_MAX;
+    for (vtkIdType i = 0; i < npts; ++i)
+    {
+      input->GetPoint(pts[i], p);
+      for (int j = 0; j < 3; ++j)
+      {
+        b[2 * j] = std::min(b[2 * j], p[j]);
+        b[2 * j + 1] = std::max(b[2 * j + 1], p[j]);
+      }
+    }
+    for (int j = 0; j < 3; ++j)
+    {
+      centers[3 * cellId + j] = 0.5 * (b[2 * j] + b[2 * j + 1]);
+    }
+    this->CellIds.push_back(cellId);
+  }
+  if (this->CellIds.empty())
+  {
+    return;
+  }
+
+  // pad the boxes a little so round off does not make a line miss a cell
+  // lying in a face of its box
+  double* inputBounds = input->GetBounds();
+  double pad = 1.0e-9 *
+    (1.0 + std::max(inputBounds[1] - inputBounds[0],
+             std::max(inputBounds[3] - inputBounds[2], inputBounds[5] - inputBounds[4])));
+
+  // top down, splitting the cells of a node at the median of their centers
+  // along the longest axis, until there are at most 8 of them
+  const vtkIdType leafSize = 8;
+  CellTreeNode root;
+  root.Begin = 0;
+  root.End = static_cast<vtkIdType>(this->CellIds.size());
+  this->Nodes.push_back(root);
+  for (size_t n = 0; n < this->Nodes.size(); ++n)
+  {
+    CellTreeNode& node = this->Nodes[n];
+    double* b = node.Bounds;
+    double c[6] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX,
+      VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+    b[0] = b[2] = b[4] = VTK_DOUBLE_MAX;
+    b[1] = b[3] = b[5] = -VTK_DOUBLE_MAX;
+    for (vtkIdType i = node.Begin; i < node.End; ++i)
+    {
+      const double* cb = &cellBounds[6 * this->CellIds[i]];
+      const double* cc = &centers[3 * this->CellIds[i]];
+      for (int j = 0; j < 3; ++j)
+      {
+        b[2 * j] = std::min(b[2 * j], cb[2 * j]);
+        b[2 * j + 1] = std::max(b[2 * j + 1], cb[2 * j + 1]);
+        c[2 * j] = std::min(c[2 * j], cc[j]);
+        c[2 * j + 1] = std::max(c[2 * j + 1], cc[j]);
+      }
+    }
+    for (int j = 0; j < 3; ++j)
+    {
+      b[2 * j] -= pad;
+      b[2 * j + 1] += pad;
+    }
+    node.Child = -1;
+    if (node.End - node.Begin <= leafSize)
+    {
+      continue;
+    }
+    int axis = 0;
+    for (int j = 1; j < 3; ++j)
+    {
+      if (c[2 * j + 1] - c[2 * j] > c[2 * axis + 1] - c[2 * axis])
+      {
+        axis = j;
+      }
+    }
+    vtkIdType begin = node.Begin, end = node.End, mid = (begin + end) / 2;
+    std::nth_element(this->CellIds.begin() + begin, this->CellIds.begin() + mid,
+      this->CellIds.begin() + end, CenterLess(&centers[0], axis));
+    node.Child = static_cast<vtkIdType>(this->Nodes.size());
+    CellTreeNode child;
+    child.Begin = begin;
+    child.End = mid;
+    this->Nodes.push_back(child); // node is invalid from here on
+    child.Begin = mid;
+    child.End = end;
+    this->Nodes.push_back(child);
+  }
+}
+
+bool vtkClosestPointFilterInternals::FindClosestPoint(
+  const double x[3], double closest[3], CellTreeQuery& query) const
+{
+  if (this->Nodes.empty())
+  {
+    return false;
+  }
+  double minDist2 = VTK_DOUBLE_MAX;
+  bool found = false;
+  double cp[3], pcoords[3], dist2;
+  int subId;
+  query.Stack.clear();
+  query.Stack.push_back(0);
+  while (!query.Stack.empty())
+  {
+    const CellTreeNode& node = this->Nodes[query.Stack.back()];
+    query.Stack.pop_back();
+    if (boundsDistance2(node.Bounds, x) > minDist2)
+    {
+      continue;
+    }
+    if (node.Child < 0)
+    {
+      for (vtkIdType i = node.Begin; i < node.End; ++i)
+      {
+        this->Input->GetCell(this->CellIds[i], query.Cell.GetPointer());
+        int stat = query.Cell->EvaluatePosition(
+          const_cast<double*>(x), cp, subId, pcoords, dist2, &query.Weights[0]);
+        if (stat != -1 && dist2 < minDist2)
+        {
+          minDist2 = dist2;
+          std::copy(cp, cp + 3, closest);
+          found = true;
+        }
+      }
+      continue;
+    }
+    // visit the closer child first
+    double d0 = boundsDistance2(this->Nodes[node.Child].Bounds, x);
+    double d1 = boundsDistance2(this->Nodes[node.Child + 1].Bounds, x);
+    vtkIdType nearChild = d0 <= d1 ? node.Child : node.Child + 1;
+    query.Stack.push_back(d0 <= d1 ? node.Child + 1 : node.Child);
+    query.Stack.push_back(nearChild);
+  }
+  return found;
+}
+
+bool vtkClosestPointFilterInternals::IntersectWithLine(
+  const double p1[3], const double p2[3], double x[3], CellTreeQuery& query) const
+{
+  if (this->Nodes.empty())
+  {
+    return false;
+  }
+  // the hit closest to p1
+  double minT = 1.0;
+  bool found = false;
+  double t, hit[3], pcoords[3];
+  int subId;
+  query.Stack.clear();
+  query.Stack.push_back(0);
+  while (!query.Stack.empty())
+  {
+    const CellTreeNode& node = this->Nodes[query.Stack.back()];
+    query.Stack.pop_back();
+    if (!boundsHitByLine(node.Bounds, p1, p2, minT))
+    {
+      continue;
+    }
+    if (node.Child < 0)
+    {
+      for (vtkIdType i = node.Begin; i < node.End; ++i)
+      {
+        this->Input->GetCell(this->CellIds[i], query.Cell.GetPointer());
+        if (query.Cell->IntersectWithLine(const_cast<double*>(p1), const_cast<double*>(p2), 0.0, t,
+              hit, pcoords, subId) &&
+          (!found || t < minT))
+        {
+          minT = t;
+          std::copy(hit, hit + 3, x);
+          found = true;
+        }
+      }
+      continue;
+    }
+    query.Stack.push_back(node.Child + 1);
+    query.Stack.push_back(node.Child);
+  }
+  return found;
+}
+
+namespace
+{
+struct ClosestPointsUserData
+{
+  const vtkClosestPointFilterInternals* Internals;
+  bool Lines;
+  const double* Queries; // 3 (points) or 6 (lines) values per query
+  double* Closest;
+  vtkIdType NumberOfQueries;
+  vtkIdType ChunkSize;
+};
+
+VTK_THREAD_RETURN_TYPE findClosestPoints(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ClosestPointsUserData* userData = static_cast<ClosestPointsUserData*>(info->UserData);
+  const vtkClosestPointFilterInternals* internals = userData->Internals;
+  CellTreeQuery query;
+  internals->InitializeQuery(query);
+  for (vtkIdType begin = info->ThreadID * userData->ChunkSize; begin < userData->NumberOfQueries;
+       begin += info->NumberOfThreads * userData->ChunkSize)
+  {
+    vtkIdType end = std::min(begin + userData->ChunkSize, userData->NumberOfQueries);
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      if (userData->Lines)
+      {
+        const double* line = userData->Queries + 6 * i;
+        internals->FindClosestPointAlongLineWorld(
+          line, line + 3, userData->Closest + 3 * i, query);
+      }
+      else
+      {
+        internals->FindClosestPointWorld(
+          userData->Queries + 3 * i, userData->Closest + 3 * i, query);
+      }
+    }
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+void findAllClosestPoints(const vtkClosestPointFilterInternals* internals, bool lines,
+  vtkIdType n, const double* queries, double* closest)
+{
+  if (n <= 0)
+  {
+    return;
+  }
+  ClosestPointsUserData userData;
+  userData.Internals = internals;
+  userData.Lines = lines;
+  userData.Queries = queries;
+  userData.Closest = closest;
+  userData.NumberOfQueries = n;
+  userData.ChunkSize = 64;
+
+  vtkNew<vtkMultiThreader> threader;
+  vtkIdType numberOfChunks = (n + userData.ChunkSize - 1) / userData.ChunkSize;
+  if (numberOfChunks < threader->GetNumberOfThreads())
+  {
+    threader->SetNumberOfThreads(static_cast<int>(numberOfChunks));
+  }
+  threader->SetSingleMethod(findClosestPoints, &userData);
+  threader->SingleMethodExecute();
+}
+}
 
 vtkStandardNewMacro(vtkClosestPointFilter);
 
@@ -32,18 +470,89 @@ vtkClosestPointFilter::vtkClosestPointFilter()
   this->Orientation[0] = this->Orientation[1] = this->Orientation[2] = 0.0;
   this->Scale[0] = this->Scale[1] = this->Scale[2] = 1.0;
   this->Transform = vtkTransform::New();
-  this->Locator = vtkCellLocator::New();
   this->SetNumberOfInputPorts(1);
   this->PointMode = true;
   this->TestPoint[0] = this->TestPoint[1] = this->TestPoint[2] = 0.0;
   this->ClosestPoint[0] = this->ClosestPoint[1] = this->ClosestPoint[2] = 0.0;
   this->TransformInverse = NULL;
+  this->TestPoints = vtkDoubleArray::New();
+  this->TestPoints->SetNumberOfComponents(3);
+  this->TestLines = vtkDoubleArray::New();
+  this->TestLines->SetNumberOfComponents(6);
+  this->ClosestPoints = vtkDoubleArray::New();
+  this->ClosestPoints->SetNumberOfComponents(3);
+  this->ClosestLinePoints = vtkDoubleArray::New();
+  this->ClosestLinePoints->SetNumberOfComponents(3);
+  this->Internals = new vtkClosestPointFilterInternals;
 }
 
 vtkClosestPointFilter::~vtkClosestPointFilter()
 {
-  this->Locator->Delete();
   this->Transform->Delete();
+  this->TestPoints->Delete();
+  this->TestLines->Delete();
+  this->ClosestPoints->Delete();
+  this->ClosestLinePoints->Delete();
+  delete this->Internals;
+}
+
+void vtkClosestPointFilter::AddTestPoint(double x, double y, double z)
+{
+  this->TestPoints->InsertNextTuple3(x, y, z);
+  this->Modified();
+}
+
+void vtkClosestPointFilter::RemoveAllTestPoints()
+{
+  if (this->TestPoints->GetNumberOfTuples())
+  {
+    this->TestPoints->Reset();
+    this->Modified();
+  }
+}
+
+void vtkClosestPointFilter::AddTestLine(
+  double x1, double y1, double z1, double x2, double y2, double z2)
+{
+  double line[6] = { x1, y1, z1, x2, y2, z2 };
+  this->TestLines->InsertNextTuple(line);
+  this->Modified();
+}
+
+void vtkClosestPointFilter::RemoveAllTestLines()
+{
+  if (this->TestLines->GetNumberOfTuples())
+  {
+    this->TestLines->Reset();
+    this->Modified();
+  }
+}
+
+bool vtkClosestPointFilter::FindClosestPoint(const double p[3], double closest[3]) const
+{
+  CellTreeQuery query;
+  this->Internals->InitializeQuery(query);
+  return this->Internals->FindClosestPointWorld(p, closest, query);
+}
+
+bool vtkClosestPointFilter::FindClosestPointAlongLine(
+  const double p1[3], const double p2[3], double closest[3]) const
+{
+  CellTreeQuery query;
+  this->Internals->InitializeQuery(query);
+  return this->Internals->FindClosestPointAlongLineWorld(p1, p2, closest, query);
+}
+
+void vtkClosestPointFilter::FindClosestPoints(
+  vtkIdType n, const double* points, double* closest) const
+{
+  findAllClosestPoints(this->Internals, false, n, points, closest);
+}
+
+void vtkClosestPointFilter::FindClosestPointsAlongLines(
+  vtkIdType n, const double* lines, double* closest) const
+{
+  findAllClosestPoints(this->Internals, true, n, lines, closest);
 }
 
 int vtkClosestPointFilter::RequestData(vtkInformation* vtkNotUsed(request),
@@ -53,8 +562,9 @@ int vtkClosestPointFilter::RequestData(vtkInformation* vtkNotUsed(request),
   vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
   vtkPolyData* input = vtkPolyData::SafeDownCast(inInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  this->Locator->SetDataSet(input);
-  this->Locator->BuildLocator();
+  // Only rebuild the cell tree if the input changed (not for a new test
+  // point)
+  this->Internals->Update(input);
 
   //   // See if we need to update the transform
   //   if (this->BuildTime < this->MTime)
@@ -68,39 +578,28 @@ int vtkClosestPointFilter::RequestData(vtkInformation* vtkNotUsed(request),
   this->Transform->Scale(this->Scale[0], this->Scale[1], this->Scale[2]);
 
   this->TransformInverse = this->Transform->GetInverse();
+  vtkMatrix4x4::DeepCopy(this->Internals->ToWorld, this->Transform->GetMatrix());
+  vtkMatrix4x4::DeepCopy(
+    this->Internals->ToData, this->Transform->GetLinearInverse()->GetMatrix());
   this->BuildTime.Modified();
   //    }
 
-  double tp[3], ctp[3];
-  int subId;
-  double d2;
-  vtkIdType cellId;
-
   if (this->PointMode)
   {
-    // Transform the test point to the data's coordinate system
-    this->TransformInverse->TransformPoint(this->TestPoint, tp);
-
-    // Now calculate the closest point
-    this->Locator->FindClosestPoint(tp, ctp, cellId, subId, d2);
+    this->FindClosestPoint(this->TestPoint, this->ClosestPoint);
   }
   else
   {
-    double tp2[3], t, pcoords[3];
-    // Transform the test line to the data's coordinate system
-    this->TransformInverse->TransformPoint(this->TestLine, tp);
-    this->TransformInverse->TransformPoint(&(this->TestLine[3]), tp2);
-
-    // Now calculate the closest point
-    if (!this->Locator->IntersectWithLine(tp, tp2, 0.0, t, ctp, pcoords, subId))
-    {
-      // Well the intersection failed try closestpoint
-      this->Locator->FindClosestPoint(tp, ctp, cellId, subId, d2);
-    }
+    this->FindClosestPointAlongLine(this->TestLine, &(this->TestLine[3]), this->ClosestPoint);
   }
 
-  // Transform the point back to world space
-  this->Transform->TransformPoint(ctp, this->ClosestPoint);
+  // The batched test points and lines
+  this->ClosestPoints->SetNumberOfTuples(this->TestPoints->GetNumberOfTuples());
+  this->FindClosestPoints(this->TestPoints->GetNumberOfTuples(),
+    this->TestPoints->GetPointer(0), this->ClosestPoints->GetPointer(0));
+  this->ClosestLinePoints->SetNumberOfTuples(this->TestLines->GetNumberOfTuples());
+  this->FindClosestPointsAlongLines(this->TestLines->GetNumberOfTuples(),
+    this->TestLines->GetPointer(0), this->ClosestLinePoints->GetPointer(0));
 
   return VTK_OK;
 }
@@ -131,4 +630,6 @@ void vtkClosestPointFilter::PrintSelf(ostream& os, vtkIndent indent)
      << this->Orientation[2] << ")\n";
   os << indent << "Scale: (" << this->Scale[0] << ", " << this->Scale[1] << ", " << this->Scale[2]
      << ")\n";
+  os << indent << "Number Of Test Points: " << this->TestPoints->GetNumberOfTuples() << "\n";
+  os << indent << "Number Of Test Lines: " << this->TestLines->GetNumberOfTuples() << "\n";
 }
@@ -9,7 +9,13 @@
 //=========================================================================
 // .NAME vtkClosestPointFilter - Calculates the closest point to PolyData
 // .SECTION Description
-// Reader for SceneGen vegetation file.
+// Calculates the point of the input closest to a test point, or where a
+// test line first hits the input.  The cells of the input are kept in a
+// bounding volume hierarchy that is only rebuilt when the input changes,
+// so a new test point does not rebuild anything.  Many test points / lines
+// can be answered in one update (see AddTestPoint and AddTestLine); they
+// are evaluated in parallel.  Once updated, the filter can also be queried
+// directly (FindClosestPoint ...) from several threads at once.
 
 #ifndef __ClosestPointFilter_h
 #define __ClosestPointFilter_h
@@ -18,9 +24,13 @@
 #include "vtkCMBFilteringModule.h" // For export macro
 #include "vtkPolyDataAlgorithm.h"
 
-class vtkCellLocator;
-class vtkTransform;
 class vtkAbstractTransform;
+class vtkDoubleArray;
+class vtkTransform;
+
+//BTX
+struct vtkClosestPointFilterInternals;
+//ETX
 
 class VTKCMBFILTERING_EXPORT vtkClosestPointFilter : public vtkPolyDataAlgorithm
 {
@@ -92,6 +102,39 @@ public:
   // Calculate the closest point
   vtkGetVector3Macro(ClosestPoint, double);
 
+  // Description:
+  // Test points answered together, in parallel, in one update; the results
+  // are in ClosestPoints, in the same order.
+  void AddTestPoint(double x, double y, double z);
+  void RemoveAllTestPoints();
+
+  // Description:
+  // Test lines answered together, in parallel, in one update; like the
+  // TestLine, the result is the first intersection of the line with the
+  // input, or the point closest to its first point if there is none.  The
+  // results are in ClosestLinePoints, in the same order.
+  void AddTestLine(double x1, double y1, double z1, double x2, double y2, double z2);
+  void RemoveAllTestLines();
+
+  // Description:
+  // Results of the test points / lines (3 components per tuple).
+  vtkGetObjectMacro(ClosestPoints, vtkDoubleArray);
+  vtkGetObjectMacro(ClosestLinePoints, vtkDoubleArray);
+
+  // Description:
+  // Query the input and transform of the last update without going through
+  // the pipeline (all in world space).  Return false if the input has no
+  // cells (closest is then the test point).  Safe to call from several
+  // threads at once.
+  bool FindClosestPoint(const double p[3], double closest[3]) const;
+  bool FindClosestPointAlongLine(const double p1[3], const double p2[3], double closest[3]) const;
+
+  // Description:
+  // Same as above for n points (3n values) / n lines (6n values) at once,
+  // in parallel.
+  void FindClosestPoints(vtkIdType n, const double* points, double* closest) const;
+  void FindClosestPointsAlongLines(vtkIdType n, const double* lines, double* closest) const;
+
   // Description:
   // Return the time of the last transform build.
   vtkGetMacro(BuildTime, unsigned long);
@@ -111,7 +154,10 @@ protected:
   bool PointMode;
   vtkTransform* Transform;
   vtkAbstractTransform* TransformInverse;
-  vtkCellLocator* Locator;
+  vtkDoubleArray* TestPoints;
+  vtkDoubleArray* TestLines;
+  vtkDoubleArray* ClosestPoints;
+  vtkDoubleArray* ClosestLinePoints;
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) override;
   vtkTimeStamp BuildTime; // time at which the transform was built
 
@@ -119,6 +165,8 @@ private:
   vtkClosestPointFilter(const vtkClosestPointFilter&); // Not implemented.
   void operator=(const vtkClosestPointFilter&);        // Not implemented.
 
+  vtkClosestPointFilterInternals* Internals;
+
   //ETX
 };
 
@@ -10,9 +10,17 @@
 #include "vtkPointThresholdFilter.h"
 #include "vtkCellArray.h"
 #include "vtkDataArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMatrix4x4.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkTransform.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <vector>
 
 vtkStandardNewMacro(vtkPointThresholdFilter);
 vtkCxxSetObjectMacro(vtkPointThresholdFilter, Transform, vtkTransform);
@@ -43,6 +51,250 @@ void vtkPointThresholdFilter::SetTransform(double elements[16])
   tmpTransform->Delete();
 }
 
+// A threshold set compiled into plain bounds: the bounds that aren't used are
+// opened up to +/- VTK_DOUBLE_MAX (or to the full 0-255 color range), so that
+// every active set is evaluated with the same comparisons.
+struct ThresholdPredicate
+{
+  double Min[3];
+  double Max[3];
+  int MinRGB[3];
+  int MaxRGB[3];
+  bool Invert;
+
+  bool IsOut(const double* pt, const unsigned char* rgb) const
+  {
+    bool out = (pt[0] < this->Min[0]) | (pt[1] < this->Min[1]) | (pt[2] < this->Min[2]) |
+      (pt[0] > this->Max[0]) | (pt[1] > this->Max[1]) | (pt[2] > this->Max[2]);
+    if (rgb)
+    {
+      out |= (rgb[0] < this->MinRGB[0]) | (rgb[1] < this->MinRGB[1]) |
+        (rgb[2] < this->MinRGB[2]) | (rgb[0] > this->MaxRGB[0]) | (rgb[1] > this->MaxRGB[1]) |
+        (rgb[2] > this->MaxRGB[2]);
+    }
+    return out != this->Invert;
+  }
+};
+
+namespace
+{
+struct ThresholdUserData
+{
+  const ThresholdPredicate* Predicates;
+  size_t NumberOfPredicates;
+
+  vtkPoints* InputPoints;
+  const unsigned char* Color;
+  const double* Matrix; // affine transform (row major), or null
+
+  vtkIdType NumberOfInputPoints;
+  int NumberOfChunks;
+
+  // keep-mask and the number of points kept per chunk (first pass), and
+  // the offset of each chunk into the output (second pass)
+  unsigned char* Keep;
+  vtkIdType* ChunkCount;
+  vtkIdType* ChunkOffset;
+
+  bool TransformOutputData;
+  float* OutputPoints;
+  vtkIdType* OutputVerts;
+  std::vector<std::pair<vtkAbstractArray*, vtkAbstractArray*> >* PointDataArrays;
+};
+
+void GetChunkRange(const ThresholdUserData* td, int chunk, vtkIdType& start, vtkIdType& end)
+{
+  start = td->NumberOfInputPoints * chunk / td->NumberOfChunks;
+  end = td->NumberOfInputPoints * (chunk + 1) / td->NumberOfChunks;
+}
+
+inline void TransformPoint(const double* m, const double in[3], double out[3])
+{
+  out[0] = m[0] * in[0] + m[1] * in[1] + m[2] * in[2] + m[3];
+  out[1] = m[4] * in[0] + m[5] * in[1] + m[6] * in[2] + m[7];
+  out[2] = m[8] * in[0] + m[9] * in[1] + m[10] * in[2] + m[11];
+}
+
+// Read a point (and, if there is a transform, its transformed position).
+template <typename T>
+inline void GetInputPoint(
+  const T* p, const double* matrix, double point[3], double transformed[3])
+{
+  point[0] = static_cast<double>(p[0]);
+  point[1] = static_cast<double>(p[1]);
+  point[2] = static_cast<double>(p[2]);
+  if (matrix)
+  {
+    TransformPoint(matrix, point, transformed);
+  }
+}
+
+// the points passed in start at the chunk's first point
+template <typename T>
+void EvaluateChunk(const ThresholdUserData* td, const T* points, vtkIdType start, vtkIdType end,
+  vtkIdType& count)
+{
+  count = 0;
+  double point[3], transformed[3];
+  const double* pt = td->Matrix ? transformed : point;
+  for (vtkIdType i = start; i < end; i++)
+  {
+    GetInputPoint(points + 3 * (i - start), td->Matrix, point, transformed);
+    const unsigned char* rgb = td->Color ? td->Color + 3 * i : 0;
+    unsigned char keep = 1;
+    for (size_t p = 0; p < td->NumberOfPredicates && keep; p++)
+    {
+      keep = !td->Predicates[p].IsOut(pt, rgb);
+    }
+    td->Keep[i] = keep;
+    count += keep;
+  }
+}
+
+template <typename T>
+void CompactChunk(const ThresholdUserData* td, const T* points, vtkIdType start, vtkIdType end,
+  vtkIdType outId)
+{
+  double point[3], transformed[3];
+  const double* matrix = td->TransformOutputData ? td->Matrix : 0;
+  const double* pt = matrix ? transformed : point;
+  for (vtkIdType i = start; i < end; i++)
+  {
+    if (!td->Keep[i])
+    {
+      continue;
+    }
+    GetInputPoint(points + 3 * (i - start), matrix, point, transformed);
+    float* outPt = td->OutputPoints + 3 * outId;
+    outPt[0] = static_cast<float>(pt[0]);
+    outPt[1] = static_cast<float>(pt[1]);
+    outPt[2] = static_cast<float>(pt[2]);
+    td->OutputVerts[2 * outId] = 1;
+    td->OutputVerts[2 * outId + 1] = outId;
+    for (size_t a = 0; a < td->PointDataArrays->size(); a++)
+    {
+      (*td->PointDataArrays)[a].second->SetTuple(outId, i, (*td->PointDataArrays)[a].first);
+    }
+    outId++;
+  }
+}
+
+// Call functor with the points of the chunk; points of any type but float or
+// double are converted to a double buffer first.
+template <typename Functor>
+void ProcessChunk(const ThresholdUserData* td, vtkIdType start, vtkIdType end, Functor functor)
+{
+  vtkDataArray* data = td->InputPoints->GetData();
+  if (data->GetDataType() == VTK_FLOAT)
+  {
+    functor(static_cast<const float*>(data->GetVoidPointer(3 * start)));
+  }
+  else if (data->GetDataType() == VTK_DOUBLE)
+  {
+    functor(static_cast<const double*>(data->GetVoidPointer(3 * start)));
+  }
+  else if (end > start)
+  {
+    std::vector<double> buffer(3 * (end - start));
+    for (vtkIdType i = start; i < end; i++)
+    {
+      td->InputPoints->GetPoint(i, &buffer[3 * (i - start)]);
+    }
+    functor(&buffer[0]);
+  }
+}
+
+struct EvaluateFunctor
+{
+  const ThresholdUserData* UserData;
+  vtkIdType Start;
+  vtkIdType End;
+  vtkIdType* Count;
+  template <typename T>
+  void operator()(const T* points) const
+  {
+    EvaluateChunk(this->UserData, points, this->Start, this->End, *this->Count);
+  }
+};
+
+struct CompactFunctor
+{
+  const ThresholdUserData* UserData;
+  vtkIdType Start;
+  vtkIdType End;
+  vtkIdType OutId;
+  template <typename T>
+  void operator()(const T* points) const
+  {
+    CompactChunk(this->UserData, points, this->Start, this->End, this->OutId);
+  }
+};
+
+// The chunks are split evenly amongst the threads; the cost per point is
+// the same everywhere, so there is no need for anything fancier.
+VTK_THREAD_RETURN_TYPE vtkPointThresholdEvaluate(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  const ThresholdUserData* td = static_cast<ThresholdUserData*>(info->UserData);
+  for (int chunk = info->ThreadID; chunk < td->NumberOfChunks; chunk += info->NumberOfThreads)
+  {
+    EvaluateFunctor functor;
+    functor.UserData = td;
+    GetChunkRange(td, chunk, functor.Start, functor.End);
+    functor.Count = td->ChunkCount + chunk;
+    ProcessChunk(td, functor.Start, functor.End, functor);
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+VTK_THREAD_RETURN_TYPE vtkPointThresholdCompact(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  const ThresholdUserData* td = static_cast<ThresholdUserData*>(info->UserData);
+  for (int chunk = info->ThreadID; chunk < td->NumberOfChunks; chunk += info->NumberOfThreads)
+  {
+    if (td->ChunkCount[chunk] == 0)
+    {
+      continue;
+    }
+    CompactFunctor functor;
+    functor.UserData = td;
+    GetChunkRange(td, chunk, functor.Start, functor.End);
+    functor.OutId = td->ChunkOffset[chunk];
+    ProcessChunk(td, functor.Start, functor.End, functor);
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+}
+
+void vtkPointThresholdFilter::CompileThresholds(
+  std::vector<ThresholdPredicate>& predicates, bool haveColor)
+{
+  predicates.clear();
+  for (std::vector<PointThreshold*>::iterator it = FilterList.begin(); it != FilterList.end(); ++it)
+  {
+    //Skip disabled filters
+    if (!(*it)->UseFilter)
+    {
+      continue;
+    }
+    ThresholdPredicate predicate;
+    predicate.Min[0] = (*it)->UseMinX ? (*it)->MinX : -VTK_DOUBLE_MAX;
+    predicate.Min[1] = (*it)->UseMinY ? (*it)->MinY : -VTK_DOUBLE_MAX;
+    predicate.Min[2] = (*it)->UseMinZ ? (*it)->MinZ : -VTK_DOUBLE_MAX;
+    predicate.Max[0] = (*it)->UseMaxX ? (*it)->MaxX : VTK_DOUBLE_MAX;
+    predicate.Max[1] = (*it)->UseMaxY ? (*it)->MaxY : VTK_DOUBLE_MAX;
+    predicate.Max[2] = (*it)->UseMaxZ ? (*it)->MaxZ : VTK_DOUBLE_MAX;
+    for (int i = 0; i < 3; i++)
+    {
+      predicate.MinRGB[i] = (haveColor && (*it)->UseMinRGB) ? (*it)->MinRGB[i] : 0;
+      predicate.MaxRGB[i] = (haveColor && (*it)->UseMaxRGB) ? (*it)->MaxRGB[i] : 255;
+    }
+    predicate.Invert = (*it)->Invert;
+    predicates.push_back(predicate);
+  }
+}
+
 int vtkPointThresholdFilter::RequestData(vtkInformation* /*request*/,
   vtkInformationVector** inputVector, vtkInformationVector* outputVector)
 {
@@ -68,126 +320,114 @@ int vtkPointThresholdFilter::RequestData(vtkInformation* /*request*/,
       break;
     }
   }
-  if (!IsAnyFilterActive)
+  if (!IsAnyFilterActive || !input->GetPoints())
   {
     output->ShallowCopy(input);
     return 1;
   }
 
-  vtkPoints* newPoints = vtkPoints::New();
-  vtkCellArray* newVerts = vtkCellArray::New();
-
-  newPoints->SetDataTypeToFloat();
-
-  output->SetPoints(newPoints);
-  output->SetVerts(newVerts);
-
-  newPoints->Allocate(input->GetPoints()->GetNumberOfPoints());
-  newVerts->Allocate(input->GetPoints()->GetNumberOfPoints());
-
-  output->GetPointData()->CopyAllocate(input->GetPointData());
-
-  newPoints->UnRegister(this);
-  newVerts->UnRegister(this);
-
-  //Populate Output
   vtkPoints* points = input->GetPoints();
+  vtkIdType numberOfInputPoints = points->GetNumberOfPoints();
   vtkUnsignedCharArray* scalars =
-    static_cast<vtkUnsignedCharArray*>(input->GetPointData()->GetScalars("Color"));
+    vtkUnsignedCharArray::SafeDownCast(input->GetPointData()->GetScalars("Color"));
+  if (scalars && scalars->GetNumberOfComponents() != 3)
+  {
+    scalars = 0;
+  }
 
-  unsigned char* color = 0;
-  if (scalars)
+  std::vector<ThresholdPredicate> predicates;
+  this->CompileThresholds(predicates, scalars != 0);
+
+  double matrix[16];
+  if (this->Transform)
   {
-    color = scalars->GetPointer(0);
+    vtkMatrix4x4::DeepCopy(matrix, this->Transform->GetMatrix());
   }
 
-  unsigned newNumPoints = 0;
-  double transformedPoint[3], *pointPtr;
-  for (int i = 0; i < input->GetPoints()->GetNumberOfPoints(); ++i)
+  vtkNew<vtkMultiThreader> threader;
+  int numberOfThreads = threader->GetNumberOfThreads();
+  // a few chunks per thread; each chunk is (at least) 64K points
+  int numberOfChunks = static_cast<int>(numberOfInputPoints / 65536) + 1;
+  if (numberOfChunks > 4 * numberOfThreads)
+  {
+    numberOfChunks = 4 * numberOfThreads;
+  }
+  if (numberOfThreads > numberOfChunks)
   {
-    double rgb[3] = { 0, 0, 0 };
-    double point[3];
+    numberOfThreads = numberOfChunks;
+  }
+  threader->SetNumberOfThreads(numberOfThreads);
 
-    if (color)
-    {
-      rgb[0] = static_cast<double>(color[(i * 3)]);
-      rgb[1] = static_cast<double>(color[(i * 3) + 1]);
-      rgb[2] = static_cast<double>(color[(i * 3) + 2]);
-    }
+  std::vector<unsigned char> keep(numberOfInputPoints);
+  std::vector<vtkIdType> chunkCount(numberOfChunks, 0);
+  std::vector<vtkIdType> chunkOffset(numberOfChunks, 0);
 
-    points->GetPoint(i, point);
+  ThresholdUserData userData;
+  userData.Predicates = predicates.empty() ? 0 : &predicates[0];
+  userData.NumberOfPredicates = predicates.size();
+  userData.InputPoints = points;
+  userData.Color = scalars ? scalars->GetPointer(0) : 0;
+  userData.Matrix = this->Transform ? matrix : 0;
+  userData.NumberOfInputPoints = numberOfInputPoints;
+  userData.NumberOfChunks = numberOfChunks;
+  userData.Keep = keep.empty() ? 0 : &keep[0];
+  userData.ChunkCount = &chunkCount[0];
+  userData.ChunkOffset = &chunkOffset[0];
+  userData.TransformOutputData = this->TransformOutputData;
 
-    if (this->Transform)
-    {
-      this->Transform->TransformPoint(point, transformedPoint);
-      pointPtr = transformedPoint;
-    }
-    else
-    {
-      pointPtr = point;
-    }
+  // 1st pass: which points are kept
+  threader->SetSingleMethod(vtkPointThresholdEvaluate, &userData);
+  threader->SingleMethodExecute();
 
-    bool pointIsIn = true;
-    //Iterate over all filters and if it fails one the point is not in
-    for (std::vector<PointThreshold*>::iterator it = FilterList.begin(); it != FilterList.end();
-         ++it)
-    {
-      //Skip disabled filters
-      if (!(*it)->UseFilter)
-      {
-        continue;
-      }
-      //Filter points to add
-      if (((*it)->UseMinX && (pointPtr[0] < (*it)->MinX)) ||
-        ((*it)->UseMinY && (pointPtr[1] < (*it)->MinY)) ||
-        ((*it)->UseMinZ && (pointPtr[2] < (*it)->MinZ)) ||
-        ((*it)->UseMaxX && (pointPtr[0] > (*it)->MaxX)) ||
-        ((*it)->UseMaxY && (pointPtr[1] > (*it)->MaxY)) ||
-        ((*it)->UseMaxZ && (pointPtr[2] > (*it)->MaxZ)))
-      {
-        pointIsIn = false;
-      }
-
-      if (color &&
-        (((*it)->UseMinRGB && (static_cast</*REPLACED*/ int>(rgb[0]) < (*it)->MinRGB[0] ||
-                                static_cast</*REPLACED*/ int>(rgb[1]) < (*it)->MinRGB[1] ||
-                                static_cast</*REPLACED*/ int>(rgb[2]) < (*it)->MinRGB[2])) ||
-            ((*it)->UseMaxRGB && (static_cast</*REPLACED*/ int>(rgb[0]) > (*it)->MaxRGB[0] ||
-                                   static_cast</*REPLACED*/ int>(rgb[1]) > (*it)->MaxRGB[1] ||
-                                   static_cast</*REPLACED*/ int>(rgb[2]) > (*it)->MaxRGB[2]))))
-      {
-        pointIsIn = false;
-      }
-
-      if ((*it)->Invert)
-      {
-        pointIsIn = !pointIsIn;
-      }
-      if (!pointIsIn)
-      {
-        break;
-      }
-    }
-    if (!pointIsIn)
-    {
-      continue;
-    }
+  // where each chunk's points go in the output
+  vtkIdType newNumPoints = 0;
+  for (int i = 0; i < numberOfChunks; i++)
+  {
+    chunkOffset[i] = newNumPoints;
+    newNumPoints += chunkCount[i];
+  }
 
-    vtkIdType idx;
-    if (this->Transform && this->TransformOutputData)
-    {
-      idx = newPoints->InsertNextPoint(transformedPoint);
-    }
-    else
+  // 2nd pass: copy the kept points (and their point data) into place
+  vtkNew<vtkPoints> newPoints;
+  newPoints->SetDataTypeToFloat();
+  newPoints->SetNumberOfPoints(newNumPoints);
+  vtkNew<vtkIdTypeArray> verts;
+  verts->SetNumberOfValues(2 * newNumPoints);
+
+  vtkPointData* inPD = input->GetPointData();
+  vtkPointData* outPD = output->GetPointData();
+  outPD->Initialize();
+  std::vector<std::pair<vtkAbstractArray*, vtkAbstractArray*> > pointDataArrays;
+  for (int i = 0; i < inPD->GetNumberOfArrays(); i++)
+  {
+    vtkAbstractArray* inArray = inPD->GetAbstractArray(i);
+    vtkAbstractArray* outArray = inArray->NewInstance();
+    outArray->SetName(inArray->GetName());
+    outArray->SetNumberOfComponents(inArray->GetNumberOfComponents());
+    outArray->SetNumberOfTuples(newNumPoints);
+    int outIndex = outPD->AddArray(outArray);
+    int attributeType = inPD->IsArrayAnAttribute(i);
+    if (attributeType >= 0)
     {
-      idx = newPoints->InsertNextPoint(point);
+      outPD->SetActiveAttribute(outIndex, attributeType);
     }
-    newVerts->InsertNextCell(1, &idx);
-    output->GetPointData()->CopyData(input->GetPointData(), i, newNumPoints++);
+    outArray->Delete();
+    pointDataArrays.push_back(std::make_pair(inArray, outArray));
   }
 
-  newVerts->Squeeze();
-  newPoints->Squeeze();
-  output->GetPointData()->Squeeze();
+  userData.OutputPoints = static_cast<vtkFloatArray*>(newPoints->GetData())->GetPointer(0);
+  userData.OutputVerts = verts->GetPointer(0);
+  userData.PointDataArrays = &pointDataArrays;
+  if (newNumPoints > 0)
+  {
+    threader->SetSingleMethod(vtkPointThresholdCompact, &userData);
+    threader->SingleMethodExecute();
+  }
+
+  vtkNew<vtkCellArray> newVerts;
+  newVerts->SetCells(newNumPoints, verts.GetPointer());
+
+  output->SetPoints(newPoints.GetPointer());
+  output->SetVerts(newVerts.GetPointer());
   return 1;
 }
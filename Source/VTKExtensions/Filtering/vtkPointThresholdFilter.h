@@ -14,8 +14,10 @@
 #include "vtkPolyDataAlgorithm.h"
 #include <iostream>
 #include <ostream>
+#include <vector>
 
 class vtkTransform;
+struct ThresholdPredicate;
 
 //BTX
 class PointThreshold
@@ -444,6 +446,13 @@ protected:
   int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
     vtkInformationVector* outputVector) override;
 
+  //BTX
+  // Description:
+  // Compile the active threshold sets into a flat table of predicates, with
+  // the unused bounds opened up, that is evaluated for every point.
+  void CompileThresholds(std::vector<ThresholdPredicate>& predicates, bool haveColor);
+  //ETX
+
 private:
   vtkPointThresholdFilter(const vtkPointThresholdFilter&); // Not implemented
   void operator=(const vtkPointThresholdFilter&);          //Not implemented
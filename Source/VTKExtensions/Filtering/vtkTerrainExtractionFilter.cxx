@@ -52,39 +52,189 @@
 #include <rtvl/rtvl_voter.hxx>
 #include <rtvl/rtvl_weight_smooth.hxx>
 
-#include <rgtl/rgtl_object_array_points.hxx>
-#include <rgtl/rgtl_octree_cell_bounds.hxx>
-#include <rgtl/rgtl_octree_objects.hxx>
-
 #include <vnl/vnl_matrix_fixed.h>
 #include <vnl/vnl_vector_fixed.h>
 
-#include <vcl_map.h>
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <set>
 
 #include "smtk/extension/vtk/reader/vtkLIDARReader.h"
+#include <vtksys/Directory.hxx>
 #include <vtksys/Glob.hxx>
 #include <vtksys/SystemTools.hxx>
 
 vtkStandardNewMacro(vtkTerrainExtractionFilter);
 
-class TerrainPoint
+// The terrain of a level block, stored as a structure of arrays: z and scale
+// as floats, the unit normal packed into 16 bit x, y and z components (z is
+// kept, not derived from x and y, so that a downward normal is still seen as
+// a bad one), the level each sample was extracted at, and a bitmask of the
+// samples that are known.  Each row of the bitmask starts on a new word so
+// that rows can be updated from different threads.
+class TerrainGrid
 {
 public:
-  bool known;
-  int level;
-  double scale;
-  double z;
-  vnl_vector_fixed<double, 3> normal;
-  TerrainPoint()
-  {
-    this->known = false;
-    this->level = 0;
-    this->scale = 0;
-    this->z = 0;
-    this->normal.fill(0.0);
+  TerrainGrid()
+    : Ni(0)
+    , Nj(0)
+    , WordsPerRow(0)
+  {
+  }
+
+  // memory per sample, not counting the bitmask
+  static size_t GetBytesPerSample()
+  {
+    return 2 * sizeof(float) + 3 * sizeof(short) + sizeof(unsigned char);
+  }
+
+  void Resize(unsigned int ni, unsigned int nj)
+  {
+    size_t n = static_cast<size_t>(ni) * nj;
+    this->Ni = ni;
+    this->Nj = nj;
+    this->WordsPerRow = (ni + 63) / 64;
+    this->Z.assign(n, 0.0f);
+    this->Scale.assign(n, 0.0f);
+    this->Normal.assign(3 * n, 0);
+    this->Level.assign(n, 0);
+    this->Known.assign(static_cast<size_t>(this->WordsPerRow) * nj, 0);
+  }
+
+  void Release()
+  {
+    vcl_vector<float>().swap(this->Z);
+    vcl_vector<float>().swap(this->Scale);
+    vcl_vector<short>().swap(this->Normal);
+    vcl_vector<unsigned char>().swap(this->Level);
+    vcl_vector<vtkTypeUInt64>().swap(this->Known);
+  }
+
+  bool Empty() const { return this->Z.empty(); }
+
+  size_t GetMemorySize() const
+  {
+    return static_cast<size_t>(this->Ni) * this->Nj * GetBytesPerSample() +
+      static_cast<size_t>(this->WordsPerRow) * this->Nj * sizeof(vtkTypeUInt64);
+  }
+
+  bool IsKnown(unsigned int i, unsigned int j) const
+  {
+    return ((this->Known[j * this->WordsPerRow + (i >> 6)] >> (i & 63)) & 1) != 0;
+  }
+  double GetZ(unsigned int i, unsigned int j) const { return this->Z[j * this->Ni + i]; }
+  double GetScale(unsigned int i, unsigned int j) const { return this->Scale[j * this->Ni + i]; }
+  void GetNormal(unsigned int i, unsigned int j, vnl_vector_fixed<double, 3>& n) const
+  {
+    const short* packed = &this->Normal[3 * (j * this->Ni + i)];
+    n[0] = UnpackNormal(packed[0]);
+    n[1] = UnpackNormal(packed[1]);
+    n[2] = UnpackNormal(packed[2]);
+  }
+
+  void Set(unsigned int i, unsigned int j, int level, double scale, double z,
+    const vnl_vector_fixed<double, 3>& normal)
+  {
+    size_t index = j * this->Ni + i;
+    this->Z[index] = static_cast<float>(z);
+    this->Scale[index] = static_cast<float>(scale);
+    this->Normal[3 * index] = PackNormal(normal[0]);
+    this->Normal[3 * index + 1] = PackNormal(normal[1]);
+    this->Normal[3 * index + 2] = PackNormal(normal[2]);
+    this->Level[index] = static_cast<unsigned char>(level);
+    this->Known[j * this->WordsPerRow + (i >> 6)] |= vtkTypeUInt64(1) << (i & 63);
+  }
+
+  // row access, for the interpolation of the next level
+  const float* GetZRow(unsigned int j) const { return &this->Z[j * this->Ni]; }
+  const float* GetScaleRow(unsigned int j) const { return &this->Scale[j * this->Ni]; }
+  const short* GetNormalRow(unsigned int j) const { return &this->Normal[3 * j * this->Ni]; }
+  const unsigned char* GetLevelRow(unsigned int j) const { return &this->Level[j * this->Ni]; }
+  const vtkTypeUInt64* GetKnownRow(unsigned int j) const
+  {
+    return &this->Known[j * this->WordsPerRow];
+  }
+
+  bool Write(std::ostream& os) const
+  {
+    WriteVector(os, this->Z);
+    WriteVector(os, this->Scale);
+    WriteVector(os, this->Normal);
+    WriteVector(os, this->Level);
+    WriteVector(os, this->Known);
+    return !os.fail();
+  }
+  // the grid must have been resized to the (Ni, Nj) it was written with
+  bool Read(std::istream& is)
+  {
+    ReadVector(is, this->Z);
+    ReadVector(is, this->Scale);
+    ReadVector(is, this->Normal);
+    ReadVector(is, this->Level);
+    ReadVector(is, this->Known);
+    return !is.fail();
+  }
+
+  static short PackNormal(double v) { return static_cast<short>(vcl_floor(v * 32767.0 + 0.5)); }
+  static double UnpackNormal(short v) { return v / 32767.0; }
+
+private:
+  template <typename T>
+  static void WriteVector(std::ostream& os, const vcl_vector<T>& v)
+  {
+    if (!v.empty())
+    {
+      os.write(reinterpret_cast<const char*>(&v[0]), v.size() * sizeof(T));
+    }
   }
+  template <typename T>
+  static void ReadVector(std::istream& is, vcl_vector<T>& v)
+  {
+    if (!v.empty())
+    {
+      is.read(reinterpret_cast<char*>(&v[0]), v.size() * sizeof(T));
+    }
+  }
+
+  unsigned int Ni;
+  unsigned int Nj;
+  unsigned int WordsPerRow;
+  vcl_vector<float> Z;
+  vcl_vector<float> Scale;
+  vcl_vector<short> Normal;
+  vcl_vector<unsigned char> Level;
+  vcl_vector<vtkTypeUInt64> Known;
 };
 
+// Per sample accumulators for interpolating one row of the next level.
+struct TerrainRowAccumulator
+{
+  void Reset(unsigned int n)
+  {
+    this->Z.assign(n, 0.0);
+    this->Weight.assign(n, 0.0);
+    this->Scale.assign(n, 0.0);
+    this->Nx.assign(n, 0.0);
+    this->Ny.assign(n, 0.0);
+    this->Nz.assign(n, 0.0);
+    this->Level.assign(n, -1);
+  }
+  vcl_vector<double> Z;
+  vcl_vector<double> Weight;
+  vcl_vector<double> Scale;
+  vcl_vector<double> Nx;
+  vcl_vector<double> Ny;
+  vcl_vector<double> Nz;
+  vcl_vector<int> Level;
+  // samples skipped for their (nearly) horizontal normal; not reset by Reset()
+  vtkIdType BadNormals;
+};
+
+class TerrainBlockPager;
+
 class TerrainLevelBlock
 {
 public:
@@ -94,9 +244,26 @@ public:
     this->NumberOfSubBlocks = 0;
     this->SplitLevel = 0;
     this->Ni = this->Nj = 0;
+    this->Pager = 0;
+    this->Resident = false;
+    this->Spilled = false;
+    this->SpillOffset = 0;
   };
   ~TerrainLevelBlock();
 
+  void ReleaseTerrain() { this->Terrain.Release(); }
+  size_t GetTerrainMemorySize() const
+  {
+    return static_cast<size_t>(this->Ni) * this->Nj * TerrainGrid::GetBytesPerSample() +
+      static_cast<size_t>((this->Ni + 63) / 64) * this->Nj * sizeof(vtkTypeUInt64);
+  }
+
+  // paging state, only used when streaming the Terrain to disk
+  TerrainBlockPager* Pager;
+  bool Resident;
+  bool Spilled;
+  std::streamoff SpillOffset;
+
   unsigned int Ni;
   unsigned int Nj;
   unsigned int Offset[2];
@@ -106,55 +273,192 @@ public:
   int NumberOfSubBlocks;
   int SplitLevel;
   TerrainLevelBlock*(SubBlock[4]);
-  vcl_vector<TerrainPoint> Terrain;
-  TerrainPoint& GetPoint(unsigned int i, unsigned int j) { return this->Terrain[j * this->Ni + i]; }
-  TerrainPoint& GetPoint(unsigned int index[2])
-  {
-    return this->Terrain[index[1] * this->Ni + index[0]];
+  TerrainGrid Terrain;
+  void AllocateTerrain() { this->Terrain.Resize(this->Ni, this->Nj); }
+
+  // Accumulate the contribution of row j of this block to the bilinear
+  // interpolation of a row (at y) of the next level.  For each of the
+  // numberOfSamples samples of that row, column[k] is the column of this
+  // block to its left, dx[k] the fractional offset from that column, and
+  // x[k] its x coordinate.
+  void ContributeRow(int j, double rowWeight, double y, unsigned int numberOfSamples,
+    const int* column, const double* dx, const double* x, TerrainRowAccumulator& acc)
+  {
+    if (j < 0 || j >= int(this->Nj))
+    {
+      return;
+    }
+    double py = this->Origin[1] + this->Spacing[1] * (j + this->Offset[1]);
+    const float* z = this->Terrain.GetZRow(j);
+    const float* scale = this->Terrain.GetScaleRow(j);
+    const short* normal = this->Terrain.GetNormalRow(j);
+    const unsigned char* level = this->Terrain.GetLevelRow(j);
+    const vtkTypeUInt64* known = this->Terrain.GetKnownRow(j);
+    for (unsigned int k = 0; k < numberOfSamples; k++)
+    {
+      for (int c = 0; c < 2; c++)
+      {
+        int i = column[k] + c;
+        if (i < 0 || i >= int(this->Ni) || !((known[i >> 6] >> (i & 63)) & 1))
+        {
+          continue;
+        }
+        double nx = TerrainGrid::UnpackNormal(normal[3 * i]);
+        double ny = TerrainGrid::UnpackNormal(normal[3 * i + 1]);
+        double nz = TerrainGrid::UnpackNormal(normal[3 * i + 2]);
+        if (nz < 0.01)
+        {
+          // reported once the level is done (see Extract2D)
+          acc.BadNormals++;
+          continue;
+        }
+        double w = rowWeight * (c ? dx[k] : 1 - dx[k]);
+        double px = this->Origin[0] + this->Spacing[0] * (i + this->Offset[0]);
+        // Contribute the height of this plane at the given (x,y) location.
+        acc.Z[k] += w * (z[i] + ((px - x[k]) * nx + (py - y) * ny) / nz);
+        acc.Nx[k] += w * nx;
+        acc.Ny[k] += w * ny;
+        acc.Nz[k] += w * nz;
+        acc.Scale[k] += w * scale[i];
+        acc.Weight[k] += w;
+        if (level[i] > acc.Level[k])
+        {
+          acc.Level[k] = level[i];
+        }
+      }
+    }
   }
-  TerrainPoint& GetPointWithOffset(unsigned int i, unsigned int j)
+};
+
+// Pages the Terrain grids of the level blocks out to a scratch file (and
+// back in when needed) such that the grids resident in memory stay within
+// the memory cap.  A block's Terrain is read only once the block has been
+// extracted, so it is written at most once; evicting it again later only
+// drops the in-memory copy.
+class TerrainBlockPager
+{
+public:
+  TerrainBlockPager(const vcl_string& fileName, size_t maximumResidentBytes)
+    : FileName(fileName)
+    , ResidentBytes(0)
+    , MaximumResidentBytes(maximumResidentBytes)
+    , FileSize(0)
   {
-    return this->Terrain[(j + this->Offset[1]) * this->Ni + i + this->Offset[0]];
+    this->File.open(
+      fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
   }
-  TerrainPoint& GetPointWithOffset(unsigned int index[2])
+  ~TerrainBlockPager()
   {
-    return this->Terrain[(index[1] + this->Offset[1]) * this->Ni + index[0] + this->Offset[0]];
+    std::list<TerrainLevelBlock*>::iterator iter = this->ResidentBlocks.begin();
+    for (; iter != this->ResidentBlocks.end(); iter++)
+    {
+      (*iter)->Pager = 0;
+    }
+    this->File.close();
+    vtksys::SystemTools::RemoveFile(this->FileName.c_str());
   }
-  void Contribute(int i, int j, double w, double x, double y, double& z,
-    vnl_vector_fixed<double, 3>& n, double& tw, int& level, double& scale)
+
+  bool IsValid() { return this->File.is_open(); }
+
+  // Make sure the block's Terrain is in memory (reading it back from the
+  // scratch file if it was evicted) and mark it most recently used.
+  bool Use(TerrainLevelBlock* block)
   {
-    if (i >= 0 && i < int(this->Ni) && j >= 0 && j < int(this->Nj))
+    if (block->Resident)
     {
-      TerrainPoint& tp = this->GetPoint(i, j);
-      if (tp.known)
+      this->ResidentBlocks.remove(block);
+    }
+    else
+    {
+      // a block may come in with its Terrain already filled in (for example
+      // restored from the extraction cache)
+      if (block->Terrain.Empty())
+      {
+        block->AllocateTerrain();
+      }
+      if (block->Spilled)
       {
-        if (tp.normal[2] < 0.01)
+        this->File.seekg(block->SpillOffset);
+        if (!block->Terrain.Read(this->File))
         {
-          vcl_cerr << "bad normal!!!" << vcl_endl << "  n = " << tp.normal << vcl_endl;
-          return;
+          this->File.clear();
+          return false;
         }
-        double px = this->Origin[0] + this->Spacing[0] * (i + this->Offset[0]);
-        double py = this->Origin[1] + this->Spacing[1] * (j + this->Offset[1]);
-        double pz = tp.z;
-        double nx = tp.normal[0];
-        double ny = tp.normal[1];
-        double nz = tp.normal[2];
-        // Contribute the height of this plane at the given (x,y) location.
-        z += w * (pz + ((px - x) * nx + (py - y) * ny) / nz);
-        n += w * tp.normal;
-        scale += w * tp.scale;
-        tw += w;
-        if (tp.level > level)
+      }
+      block->Resident = true;
+      block->Pager = this;
+      this->ResidentBytes += block->GetTerrainMemorySize();
+    }
+    this->ResidentBlocks.push_front(block);
+    return true;
+  }
+
+  // The block's Terrain is not needed anymore.
+  void Forget(TerrainLevelBlock* block)
+  {
+    if (block->Resident)
+    {
+      this->ResidentBlocks.remove(block);
+      this->ResidentBytes -= block->GetTerrainMemorySize();
+      block->Resident = false;
+    }
+    block->ReleaseTerrain();
+    block->Pager = 0;
+  }
+
+  // Evict the least recently used blocks (except the pinned one) until the
+  // resident Terrain fits within the memory cap.
+  bool Trim(TerrainLevelBlock* pinned)
+  {
+    std::list<TerrainLevelBlock*>::iterator iter = this->ResidentBlocks.end();
+    while (this->ResidentBytes > this->MaximumResidentBytes &&
+      iter != this->ResidentBlocks.begin())
+    {
+      --iter;
+      TerrainLevelBlock* block = *iter;
+      if (block == pinned || block->Terrain.Empty())
+      {
+        continue;
+      }
+      if (!block->Spilled)
+      {
+        this->File.seekp(this->FileSize);
+        if (!block->Terrain.Write(this->File))
         {
-          level = tp.level;
+          this->File.clear();
+          return false;
         }
+        block->SpillOffset = this->FileSize;
+        block->Spilled = true;
+        this->FileSize += block->GetTerrainMemorySize();
       }
+      this->ResidentBytes -= block->GetTerrainMemorySize();
+      block->Resident = false;
+      block->ReleaseTerrain();
+      iter = this->ResidentBlocks.erase(iter);
     }
+    return true;
   }
+
+private:
+  TerrainBlockPager(const TerrainBlockPager&); // Not implemented.
+  void operator=(const TerrainBlockPager&);    // Not implemented.
+
+  vcl_string FileName;
+  std::fstream File;
+  // most recently used first
+  std::list<TerrainLevelBlock*> ResidentBlocks;
+  size_t ResidentBytes;
+  size_t MaximumResidentBytes;
+  std::streamoff FileSize;
 };
 
 TerrainLevelBlock::~TerrainLevelBlock()
 {
+  if (this->Pager)
+  {
+    this->Pager->Forget(this);
+  }
   for (int i = 0; i < this->NumberOfSubBlocks; i++)
   {
     if (this->SubBlock[i])
@@ -164,6 +468,258 @@ TerrainLevelBlock::~TerrainLevelBlock()
   }
 }
 
+// Work-stealing scheduler for the row tiles of a level block.  Tiles are
+// dealt round-robin to the workers up front; a worker pops tiles from the
+// back of its own queue and, once that runs dry, steals from the front of
+// the other workers' queues.  Rows near the data are far more expensive than
+// empty rows, so this keeps every core busy until the whole block is done.
+class TerrainTileScheduler
+{
+public:
+  struct Tile
+  {
+    unsigned int Index;
+    unsigned int StartRow;
+    unsigned int EndRow;
+  };
+
+  TerrainTileScheduler(int numberOfWorkers, unsigned int numberOfRows, unsigned int rowsPerTile)
+    : NumberOfWorkers(numberOfWorkers)
+  {
+    this->Queues = new WorkerQueue[numberOfWorkers];
+    unsigned int index = 0;
+    for (unsigned int row = 0; row < numberOfRows; row += rowsPerTile, index++)
+    {
+      Tile tile;
+      tile.Index = index;
+      tile.StartRow = row;
+      tile.EndRow = row + rowsPerTile > numberOfRows ? numberOfRows : row + rowsPerTile;
+      this->Queues[index % numberOfWorkers].Tiles.push_back(tile);
+    }
+    this->NumberOfTiles = index;
+  }
+  ~TerrainTileScheduler() { delete[] this->Queues; }
+
+  unsigned int GetNumberOfTiles() const { return this->NumberOfTiles; }
+
+  bool NextTile(int workerId, Tile& tile)
+  {
+    {
+      WorkerQueue& own = this->Queues[workerId];
+      std::lock_guard<std::mutex> lock(own.Mutex);
+      if (!own.Tiles.empty())
+      {
+        tile = own.Tiles.back();
+        own.Tiles.pop_back();
+        return true;
+      }
+    }
+    for (int i = 1; i < this->NumberOfWorkers; i++)
+    {
+      WorkerQueue& victim = this->Queues[(workerId + i) % this->NumberOfWorkers];
+      std::lock_guard<std::mutex> lock(victim.Mutex);
+      if (!victim.Tiles.empty())
+      {
+        tile = victim.Tiles.front();
+        victim.Tiles.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  TerrainTileScheduler(const TerrainTileScheduler&); // Not implemented.
+  void operator=(const TerrainTileScheduler&);       // Not implemented.
+
+  struct WorkerQueue
+  {
+    std::mutex Mutex;
+    std::deque<Tile> Tiles;
+  };
+  WorkerQueue* Queues;
+  int NumberOfWorkers;
+  unsigned int NumberOfTiles;
+};
+
+// Output of a single row tile; tiles are merged in row order after all the
+// workers are done so the result does not depend on the schedule.
+struct TerrainTileOutput
+{
+  vtkSmartPointer<vtkPoints> Points;
+  vtkSmartPointer<vtkDoubleArray> Scales;
+  vtkSmartPointer<vtkUnsignedCharArray> RGBScalars;
+  vtkSmartPointer<vtkFloatArray> IntensityArray;
+};
+
+// Flat 2-D bucket grid over the (x, y) location of the voting tokens of a
+// level block.  It is built once per block (tokens that can't vote are left
+// out) and shared read only by all the threads.  Entries are sorted by bucket
+// and hold a copy of the token location, so a query walks a few contiguous
+// ranges of memory instead of an octree.
+class TerrainVoterGrid
+{
+public:
+  struct Entry
+  {
+    double X;
+    double Y;
+    double Z;
+    int Id;
+  };
+
+  void Build(rtvl_tokens<3>& tokens, double cellSize)
+  {
+    unsigned int n = tokens.points.get_number_of_points();
+    vcl_vector<Entry> entries;
+    entries.reserve(n);
+    double bounds[4] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+    for (unsigned int i = 0; i < n; i++)
+    {
+      rtvl_tensor<3> const& tensor = tokens.tokens[i];
+      double flatness = tensor.saliency(0) / tensor.lambda(0);
+      double const flatness_threshold = 0;
+      if (!(flatness >= flatness_threshold))
+      {
+        continue;
+      }
+      double p[3];
+      tokens.points.get_point(i, p);
+      Entry entry = { p[0], p[1], p[2], static_cast<int>(i) };
+      entries.push_back(entry);
+      bounds[0] = p[0] < bounds[0] ? p[0] : bounds[0];
+      bounds[1] = p[0] > bounds[1] ? p[0] : bounds[1];
+      bounds[2] = p[1] < bounds[2] ? p[1] : bounds[2];
+      bounds[3] = p[1] > bounds[3] ? p[1] : bounds[3];
+    }
+
+    this->Entries.clear();
+    this->CellStart.assign(1, 0);
+    this->Dimensions[0] = this->Dimensions[1] = 0;
+    if (entries.empty())
+    {
+      return;
+    }
+
+    // keep the number of buckets in proportion to the number of tokens
+    size_t maxNumberOfCells = 4 * entries.size() + 1024;
+    this->CellSize = cellSize > 0 ? cellSize : 1;
+    for (;;)
+    {
+      this->Dimensions[0] = static_cast<int>((bounds[1] - bounds[0]) / this->CellSize) + 1;
+      this->Dimensions[1] = static_cast<int>((bounds[3] - bounds[2]) / this->CellSize) + 1;
+      if (static_cast<size_t>(this->Dimensions[0]) * this->Dimensions[1] <= maxNumberOfCells)
+      {
+        break;
+      }
+      this->CellSize *= 2;
+    }
+    this->Origin[0] = bounds[0];
+    this->Origin[1] = bounds[2];
+
+    // counting sort of the entries by bucket
+    size_t numberOfCells = static_cast<size_t>(this->Dimensions[0]) * this->Dimensions[1];
+    this->CellStart.assign(numberOfCells + 1, 0);
+    vcl_vector<unsigned int> cellIds(entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+      cellIds[i] = this->GetCellId(this->GetCellIndex(entries[i].X, 0),
+        this->GetCellIndex(entries[i].Y, 1));
+      this->CellStart[cellIds[i] + 1]++;
+    }
+    for (size_t i = 0; i < numberOfCells; i++)
+    {
+      this->CellStart[i + 1] += this->CellStart[i];
+    }
+    this->Entries.resize(entries.size());
+    vcl_vector<unsigned int> insertAt(this->CellStart.begin(), this->CellStart.end() - 1);
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+      this->Entries[insertAt[cellIds[i]]++] = entries[i];
+    }
+  }
+
+  // Visit all the entries within radius of xy.
+  template <typename Visitor>
+  void Query(const double xy[2], double radius, Visitor& visitor) const
+  {
+    if (this->Entries.empty())
+    {
+      return;
+    }
+    int minI = this->GetCellIndex(xy[0] - radius, 0);
+    int maxI = this->GetCellIndex(xy[0] + radius, 0);
+    int minJ = this->GetCellIndex(xy[1] - radius, 1);
+    int maxJ = this->GetCellIndex(xy[1] + radius, 1);
+    double radius2 = radius * radius;
+    for (int j = minJ; j <= maxJ; j++)
+    {
+      // the buckets (i = minI..maxI) of a row are contiguous
+      const Entry* entry = &this->Entries[0] + this->CellStart[this->GetCellId(minI, j)];
+      const Entry* last = &this->Entries[0] + this->CellStart[this->GetCellId(maxI, j) + 1];
+      for (; entry != last; ++entry)
+      {
+        double dx = entry->X - xy[0];
+        double dy = entry->Y - xy[1];
+        if (dx * dx + dy * dy <= radius2)
+        {
+          visitor(*entry);
+        }
+      }
+    }
+  }
+
+private:
+  int GetCellIndex(double v, int axis) const
+  {
+    int index = static_cast<int>(vcl_floor((v - this->Origin[axis]) / this->CellSize));
+    return index < 0 ? 0 : (index >= this->Dimensions[axis] ? this->Dimensions[axis] - 1 : index);
+  }
+  unsigned int GetCellId(int i, int j) const
+  {
+    return static_cast<unsigned int>(j) * this->Dimensions[0] + i;
+  }
+
+  double Origin[2];
+  double CellSize;
+  int Dimensions[2];
+  vcl_vector<unsigned int> CellStart;
+  vcl_vector<Entry> Entries;
+};
+
+// 64 bit FNV-1a hash; keys the extraction cache on the content of the input
+// and on the parameters it is refined / extracted with.
+class TerrainCacheHash
+{
+public:
+  TerrainCacheHash()
+    : Value(14695981039346656037ULL)
+  {
+  }
+  void Add(const void* data, size_t length)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; i++)
+    {
+      this->Value ^= bytes[i];
+      this->Value *= 1099511628211ULL;
+    }
+  }
+  template <typename T>
+  void Add(const T& value)
+  {
+    this->Add(&value, sizeof(T));
+  }
+  vcl_string ToString() const
+  {
+    char buf[32];
+    sprintf(buf, "%016llx", static_cast<unsigned long long>(this->Value));
+    return buf;
+  }
+
+  vtkTypeUInt64 Value;
+};
+
 class vtkTerrainExtractionInternal
 {
 public:
@@ -175,7 +731,18 @@ public:
   rtvl_refine<3>* Refine;
   rtvl_tokens<3> Tokens;
   unsigned int LevelIndex;
-  typedef vcl_multimap<double, int> SegmentVotersType;
+  // the voters of a segment, sorted by z (then id); reused from segment to
+  // segment by each thread
+  struct SegmentVoter
+  {
+    double Z;
+    int Id;
+    bool operator<(const SegmentVoter& other) const
+    {
+      return this->Z < other.Z || (this->Z == other.Z && this->Id < other.Id);
+    }
+  };
+  typedef vcl_vector<SegmentVoter> SegmentVotersType;
 
   struct ThreadSpecificData
   {
@@ -187,7 +754,6 @@ public:
     unsigned int PreviousClosestPt;
     vtkUnsignedCharArray* RGBScalars;
     vtkFloatArray* IntensityArray;
-    int* PointMapping;
   };
 
   ThreadSpecificData ThreadData;
@@ -213,13 +779,14 @@ public:
   void BuildLevelBlockTree(TerrainLevelBlock* levelBlockTree, int currentLevel, bool split);
   void SetupBlockExtents(TerrainLevelBlock* childBlock);
 
-  void ExtractNextLevel(TerrainLevelBlock* levelBlock, TerrainLevelBlock* prevLevelBlock,
+  // returns the number of samples skipped for a bad normal
+  vtkIdType ExtractNextLevel(TerrainLevelBlock* levelBlock, TerrainLevelBlock* prevLevelBlock,
     unsigned int startRow, unsigned int endRow);
   void Extract2D(TerrainLevelBlock* levelBlock, TerrainLevelBlock* prevLevelBlock,
     vtkPoints* outPoints, vtkDoubleArray* outScales, rtvl_weight_smooth<3>& tvw);
 
   bool ExtractSegmentInit(TerrainLevelBlock* levelBlock, ThreadSpecificData& threadData,
-    rgtl_octree_objects<2>& objects2D);
+    const TerrainVoterGrid& voterGrid);
   void ExtractSegmentSearch(TerrainLevelBlock* levelBlock, ThreadSpecificData& threadData,
     vtkPoints* outPoints, vtkDoubleArray* outScales, rtvl_weight_smooth<3>& tvw);
   vtkPolyData* ExtractSave(TerrainLevelBlock* levelBlock, int extractLevel, bool levelSplit,
@@ -242,7 +809,42 @@ public:
     rtvl_weight_smooth<3>& tvw);
 
   int InitialExtractSplitLevel;
+  int NumberOfThreads;
+  // non-null only while extracting with StreamTerrainToDisk on
+  TerrainBlockPager* Pager;
+  bool UseBlock(TerrainLevelBlock* block);
+  void ForgetBlock(TerrainLevelBlock* block);
+  void ReleaseTokens();
+  void SetupLevelBlock(TerrainLevelBlock* levelBlock, double scale);
+
+  // Extraction cache (see vtkTerrainExtractionFilter::UseExtractionCache).
+  // The refine record (number of levels and their scales) is keyed on
+  // RefineSignature; each extracted level on RefineSignature plus the
+  // extraction parameters that affect it.
+  vtkTypeUInt64 InputSignature;
+  vtkTypeUInt64 AttributeSignature;
+  vtkTypeUInt64 RefineSignature;
+  bool RefinePending;
+  vcl_vector<double> CachedLevelScales;
+  vcl_string CacheDirectory;
+  vcl_vector<vcl_string> LevelCacheKeys;
+  // the output files this extraction wrote, per level
+  vcl_vector<vcl_vector<vcl_string> > LevelOutputFiles;
+  vcl_string GetRefineRecordFileName();
+  bool ReadRefineRecord(int& numberOfLevels);
+  void WriteRefineRecord(int numberOfLevels);
+  vcl_string GetLevelCacheDirectory(int level);
+  bool IsLevelCached(int level);
+  void RestoreLevel(int level, const vcl_string& fileExtension);
+  void StoreLevel(int level);
+  void TrimCache(vtkTypeUInt64 maximumBytes);
+  void WriteLevelTerrain(int level, TerrainLevelBlock* levelBlock);
+  TerrainLevelBlock* ReadLevelTerrain(int level);
   vtkSmartPointer<vtkTimerLog> Timer;
+  // per level timing of the Extract phase; see GetLevelCoreUtilization()
+  vcl_vector<double> LevelWallTime;
+  vcl_vector<double> LevelBusyTime;
+  vcl_vector<double> LevelWorkerTime;
   int MaximumLevelTime;
   double InputBounds[6];
   int MinExtractLevel;
@@ -277,45 +879,331 @@ vtkTerrainExtractionInternal::vtkTerrainExtractionInternal()
   this->RGBScalars = 0;
   this->IntensityArray = 0;
   this->PointLocator = 0;
+  this->NumberOfThreads = 0;
+  this->Pager = 0;
+  this->InputSignature = 0;
+  this->AttributeSignature = 0;
+  this->RefineSignature = 0;
+  this->RefinePending = false;
+}
+
+bool vtkTerrainExtractionInternal::UseBlock(TerrainLevelBlock* block)
+{
+  if (!this->Pager)
+  {
+    if (block->Terrain.Empty())
+    {
+      block->AllocateTerrain();
+    }
+    return true;
+  }
+  if (!this->Pager->Use(block))
+  {
+    vtkGenericWarningMacro("Failed to read terrain block back from the scratch file.");
+    return false;
+  }
+  return true;
+}
+
+void vtkTerrainExtractionInternal::ReleaseTokens()
+{
+  // when streaming, don't hold on to the tokens of a block while its
+  // children (and their tokens) are processed
+  if (this->Pager)
+  {
+    this->Tokens = rtvl_tokens<3>();
+  }
+}
+
+void vtkTerrainExtractionInternal::ForgetBlock(TerrainLevelBlock* block)
+{
+  if (this->Pager)
+  {
+    this->Pager->Forget(block);
+  }
+  else
+  {
+    block->ReleaseTerrain();
+  }
+}
+
+vtkTerrainExtractionInternal::~vtkTerrainExtractionInternal()
+{
+  this->Transform->Delete();
+  this->InverseTransform->Delete();
+  this->DeleteTemporaryFiles();
+  if (this->Refine)
+  {
+    delete this->Refine;
+  }
+  if (this->OutputSplitCount)
+  {
+    delete[] this->OutputSplitCount;
+    delete[] this->OutputFileNameBase;
+    delete[] this->LevelScales;
+  }
+  if (this->RGBScalars)
+  {
+    this->RGBScalars->Delete();
+  }
+  if (this->IntensityArray)
+  {
+    this->IntensityArray->Delete();
+  }
+  if (this->PointLocator)
+  {
+    this->PointLocator->Delete();
+  }
+}
+
+void vtkTerrainExtractionInternal::DeleteTemporaryFiles()
+{
+  vcl_vector<vcl_string>::iterator tempFileIter = this->TemporaryFiles.begin();
+  for (; tempFileIter != this->TemporaryFiles.end(); tempFileIter++)
+  {
+    vtksys::SystemTools::RemoveFile(tempFileIter->c_str());
+  }
+  this->TemporaryFiles.clear();
+}
+
+namespace
+{
+const char* TerrainOutputFileExtension(int outputPtsFormat)
+{
+  if (outputPtsFormat == VTK_OUTPUT_TYPE_XML_PD)
+  {
+    return ".vtp";
+  }
+  // always append .pts, regardless of ASCII or Binary
+  return outputPtsFormat == VTK_OUTPUT_TYPE_BINARY_PTS ? ".bin.pts" : ".pts";
+}
+
+// bumped whenever the layout of the cached terrain (terrain.bin) changes
+const int TerrainCacheVersion = 2;
+
+// the cache lives next to the intermediate (refine) results
+vcl_string TerrainExtractionCacheDirectory(const vcl_string& baseIntermediateFileName)
+{
+  return vtksys::SystemTools::GetFilenamePath(baseIntermediateFileName) +
+    "/TerrainExtractionCache";
+}
+}
+
+vcl_string vtkTerrainExtractionInternal::GetRefineRecordFileName()
+{
+  TerrainCacheHash hash;
+  hash.Add(this->RefineSignature);
+  return this->CacheDirectory + "/refine_" + hash.ToString() + ".txt";
+}
+
+bool vtkTerrainExtractionInternal::ReadRefineRecord(int& numberOfLevels)
+{
+  vcl_ifstream record(this->GetRefineRecordFileName().c_str());
+  if (!(record >> numberOfLevels) || numberOfLevels < 1)
+  {
+    return false;
+  }
+  this->CachedLevelScales.resize(numberOfLevels);
+  for (int i = 0; i < numberOfLevels; i++)
+  {
+    if (!(record >> this->CachedLevelScales[i]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void vtkTerrainExtractionInternal::WriteRefineRecord(int numberOfLevels)
+{
+  vtksys::SystemTools::MakeDirectory(this->CacheDirectory.c_str());
+  vcl_ofstream record(this->GetRefineRecordFileName().c_str());
+  record.precision(17);
+  record << numberOfLevels << "\n";
+  for (int i = 0; i < numberOfLevels; i++)
+  {
+    record << this->Refine->get_level_scale(i) << "\n";
+  }
+}
+
+vcl_string vtkTerrainExtractionInternal::GetLevelCacheDirectory(int level)
+{
+  if (this->CacheDirectory.empty() || level >= static_cast<int>(this->LevelCacheKeys.size()))
+  {
+    return vcl_string();
+  }
+  return this->CacheDirectory + "/" + this->LevelCacheKeys[level];
+}
+
+bool vtkTerrainExtractionInternal::IsLevelCached(int level)
+{
+  vcl_string directory = this->GetLevelCacheDirectory(level);
+  return !directory.empty() && vtksys::SystemTools::FileExists((directory + "/complete").c_str());
+}
+
+void vtkTerrainExtractionInternal::RestoreLevel(int level, const vcl_string& fileExtension)
+{
+  // cached output files are named "level<suffix><extension>", where the
+  // output files are named "<BaseFileName>_<level><suffix><extension>"
+  vcl_string directory = this->GetLevelCacheDirectory(level);
+  char buf[16];
+  sprintf(buf, "_%02u", level);
+  vcl_string outputBase = this->OutputPath + this->BaseFileName + buf;
+  vtksys::Directory files;
+  files.Load(directory.c_str());
+  for (unsigned long i = 0; i < files.GetNumberOfFiles(); i++)
+  {
+    vcl_string fileName = files.GetFile(i);
+    if (fileName.compare(0, 5, "level") != 0 || fileName.size() < fileExtension.size() ||
+      fileName.compare(fileName.size() - fileExtension.size(), vcl_string::npos, fileExtension))
+    {
+      continue;
+    }
+    vtksys::SystemTools::CopyAFile(
+      (directory + "/" + fileName).c_str(), (outputBase + fileName.substr(5)).c_str());
+  }
+  // mark the level as recently used, see TrimCache()
+  vtksys::SystemTools::Touch((directory + "/complete").c_str(), false);
+}
+
+void vtkTerrainExtractionInternal::StoreLevel(int level)
+{
+  vcl_string directory = this->GetLevelCacheDirectory(level);
+  if (directory.empty() || level >= static_cast<int>(this->LevelOutputFiles.size()) ||
+    this->LevelOutputFiles[level].empty())
+  {
+    return;
+  }
+  vtksys::SystemTools::MakeDirectory(directory.c_str());
+
+  // only the files written by this extraction; others matching the output
+  // names may be left over from an earlier one
+  char buf[16];
+  sprintf(buf, "_%02u", level);
+  vcl_string outputBase = this->OutputPath + this->BaseFileName + buf;
+  const vcl_vector<vcl_string>& outputFiles = this->LevelOutputFiles[level];
+  for (size_t i = 0; i < outputFiles.size(); i++)
+  {
+    if (outputFiles[i].compare(0, outputBase.size(), outputBase) != 0 ||
+      !vtksys::SystemTools::CopyAFile(outputFiles[i].c_str(),
+        (directory + "/level" + outputFiles[i].substr(outputBase.size())).c_str()))
+    {
+      return;
+    }
+  }
+  vcl_ofstream complete((directory + "/complete").c_str());
+}
+
+namespace
+{
+struct TerrainCacheEntry
+{
+  vcl_string Directory;
+  long Time;
+  vtkTypeUInt64 Bytes;
+};
+
+bool OlderCacheEntry(const TerrainCacheEntry& a, const TerrainCacheEntry& b)
+{
+  return a.Time < b.Time;
+}
+}
+
+void vtkTerrainExtractionInternal::TrimCache(vtkTypeUInt64 maximumBytes)
+{
+  vtksys::Directory entries;
+  if (this->CacheDirectory.empty() || !entries.Load(this->CacheDirectory.c_str()))
+  {
+    return;
+  }
+  std::set<vcl_string> inUse(this->LevelCacheKeys.begin(), this->LevelCacheKeys.end());
+  vcl_vector<TerrainCacheEntry> levels;
+  vtkTypeUInt64 totalBytes = 0;
+  for (unsigned long i = 0; i < entries.GetNumberOfFiles(); i++)
+  {
+    vcl_string name = entries.GetFile(i);
+    TerrainCacheEntry entry;
+    entry.Directory = this->CacheDirectory + "/" + name;
+    if (name == "." || name == ".." ||
+      !vtksys::SystemTools::FileIsDirectory(entry.Directory.c_str()))
+    {
+      continue;
+    }
+    // a level was last used when its most recent file was written or touched
+    entry.Time = 0;
+    entry.Bytes = 0;
+    vtksys::Directory files;
+    files.Load(entry.Directory.c_str());
+    for (unsigned long j = 0; j < files.GetNumberOfFiles(); j++)
+    {
+      vcl_string fileName = entry.Directory + "/" + files.GetFile(j);
+      if (vtksys::SystemTools::FileIsDirectory(fileName.c_str()))
+      {
+        continue;
+      }
+      entry.Bytes += vtksys::SystemTools::FileLength(fileName.c_str());
+      entry.Time = std::max(entry.Time, vtksys::SystemTools::ModifiedTime(fileName.c_str()));
+    }
+    totalBytes += entry.Bytes;
+    if (inUse.find(name) == inUse.end())
+    {
+      levels.push_back(entry);
+    }
+  }
+
+  std::sort(levels.begin(), levels.end(), OlderCacheEntry);
+  for (size_t i = 0; i < levels.size() && totalBytes > maximumBytes; i++)
+  {
+    if (vtksys::SystemTools::RemoveADirectory(levels[i].Directory.c_str()))
+    {
+      totalBytes -= levels[i].Bytes;
+    }
+  }
 }
 
-vtkTerrainExtractionInternal::~vtkTerrainExtractionInternal()
+void vtkTerrainExtractionInternal::WriteLevelTerrain(int level, TerrainLevelBlock* levelBlock)
 {
-  this->Transform->Delete();
-  this->InverseTransform->Delete();
-  this->DeleteTemporaryFiles();
-  if (this->Refine)
-  {
-    delete this->Refine;
-  }
-  if (this->OutputSplitCount)
+  vcl_string directory = this->GetLevelCacheDirectory(level);
+  if (directory.empty())
   {
-    delete[] this->OutputSplitCount;
-    delete[] this->OutputFileNameBase;
-    delete[] this->LevelScales;
+    return;
   }
-  if (this->RGBScalars)
+  vtksys::SystemTools::MakeDirectory(directory.c_str());
+  std::ofstream terrainFile((directory + "/terrain.bin").c_str(), std::ios::out | std::ios::binary);
+  unsigned int dimensions[2] = { levelBlock->Ni, levelBlock->Nj };
+  terrainFile.write(reinterpret_cast<const char*>(dimensions), sizeof(dimensions));
+  if (!levelBlock->Terrain.Write(terrainFile))
   {
-    this->RGBScalars->Delete();
+    terrainFile.close();
+    vtksys::SystemTools::RemoveFile((directory + "/terrain.bin").c_str());
   }
-  if (this->IntensityArray)
+}
+
+TerrainLevelBlock* vtkTerrainExtractionInternal::ReadLevelTerrain(int level)
+{
+  vcl_string directory = this->GetLevelCacheDirectory(level);
+  std::ifstream terrainFile((directory + "/terrain.bin").c_str(), std::ios::in | std::ios::binary);
+  if (directory.empty() || !terrainFile)
   {
-    this->IntensityArray->Delete();
+    return 0;
   }
-  if (this->PointLocator)
+  TerrainLevelBlock* levelBlock = new TerrainLevelBlock;
+  this->SetupLevelBlock(levelBlock, this->LevelScales[level]);
+  unsigned int dimensions[2] = { 0, 0 };
+  terrainFile.read(reinterpret_cast<char*>(dimensions), sizeof(dimensions));
+  if (dimensions[0] != levelBlock->Ni || dimensions[1] != levelBlock->Nj)
   {
-    this->PointLocator->Delete();
+    delete levelBlock;
+    return 0;
   }
-}
-
-void vtkTerrainExtractionInternal::DeleteTemporaryFiles()
-{
-  vcl_vector<vcl_string>::iterator tempFileIter = this->TemporaryFiles.begin();
-  for (; tempFileIter != this->TemporaryFiles.end(); tempFileIter++)
+  levelBlock->AllocateTerrain();
+  if (!levelBlock->Terrain.Read(terrainFile))
   {
-    vtksys::SystemTools::RemoveFile(tempFileIter->c_str());
+    delete levelBlock;
+    return 0;
   }
-  this->TemporaryFiles.clear();
+  vtksys::SystemTools::Touch((directory + "/terrain.bin").c_str(), false);
+  return levelBlock;
 }
 
 vtkTerrainExtractionFilter::vtkTerrainExtractionFilter()
@@ -338,6 +1226,11 @@ vtkTerrainExtractionFilter::vtkTerrainExtractionFilter()
   this->InitialScale = -1;
   this->DetermineIntensityAndColor = true;
   this->MaskSize = 1.0; //default pulled from rtvl_refine
+  this->NumberOfThreads = 0;
+  this->StreamTerrainToDisk = false;
+  this->UseExtractionCache = false;
+  this->MaximumExtractionCacheMB = 2048;
+  this->MaximumMemoryMB = 400;
 }
 
 vtkTerrainExtractionFilter::~vtkTerrainExtractionFilter()
@@ -374,6 +1267,25 @@ void vtkTerrainExtractionFilter::GetDataTransform(vtkTransform* transform)
   transform->DeepCopy(this->Internal->Transform);
 }
 
+double vtkTerrainExtractionFilter::GetLevelExtractionTime(int level)
+{
+  if (level < 0 || level >= static_cast<int>(this->Internal->LevelWallTime.size()))
+  {
+    return 0;
+  }
+  return this->Internal->LevelWallTime[level];
+}
+
+double vtkTerrainExtractionFilter::GetLevelCoreUtilization(int level)
+{
+  if (level < 0 || level >= static_cast<int>(this->Internal->LevelWorkerTime.size()) ||
+    this->Internal->LevelWorkerTime[level] <= 0)
+  {
+    return 0;
+  }
+  return this->Internal->LevelBusyTime[level] / this->Internal->LevelWorkerTime[level];
+}
+
 //
 // Clip through data generating surface.
 //
@@ -447,6 +1359,19 @@ int vtkTerrainExtractionFilter::RequestData(vtkInformation* vtkNotUsed(request),
       bbox.AddPoint(&points[offset]);
     }
 
+    // the (transformed) input is what the extraction cache is keyed on
+    this->Internal->InputSignature = 0;
+    if (this->UseExtractionCache)
+    {
+      TerrainCacheHash hash;
+      hash.Add(n);
+      if (n > 0)
+      {
+        hash.Add(&points[0], points.size() * sizeof(double));
+      }
+      this->Internal->InputSignature = hash.Value;
+    }
+
     bbox.GetBounds(this->InputBounds);
 
     if (this->Internal->Refine)
@@ -478,6 +1403,32 @@ int vtkTerrainExtractionFilter::RequestData(vtkInformation* vtkNotUsed(request),
       ? vtkFloatArray::SafeDownCast(input->GetPointData()->GetArray("Intensity"))
       : NULL;
 
+    // the extracted levels also depend on the color and intensity of the
+    // input, when DetermineIntensityAndColor is on
+    this->Internal->AttributeSignature = 0;
+    if (this->UseExtractionCache)
+    {
+      TerrainCacheHash hash;
+      vtkDataArray* attributes[2] = { this->Internal->InputRGBScalars,
+        this->Internal->InputIntensityArray };
+      for (int i = 0; i < 2; i++)
+      {
+        vtkIdType numberOfValues = 0;
+        if (attributes[i])
+        {
+          numberOfValues =
+            attributes[i]->GetNumberOfTuples() * attributes[i]->GetNumberOfComponents();
+        }
+        hash.Add(numberOfValues);
+        if (numberOfValues > 0)
+        {
+          hash.Add(attributes[i]->GetVoidPointer(0),
+            static_cast<size_t>(numberOfValues) * attributes[i]->GetDataTypeSize());
+        }
+      }
+      this->Internal->AttributeSignature = hash.Value;
+    }
+
     if (this->Internal->InputRGBScalars)
     {
       if (!this->Internal->RGBScalars)
@@ -534,9 +1485,30 @@ int vtkTerrainExtractionFilter::RequestData(vtkInformation* vtkNotUsed(request),
   else if (this->ExecuteMode == VTK_MODE_REFINE)
   {
     this->NumberOfLevels = 0;
-    this->Internal->Refine->set_scale(this->InitialScale);
-    this->Internal->Refine->build_tree();
-    this->TokenRefineAnalyze(baseIntermediateFileName.c_str(), output);
+    this->Internal->RefinePending = false;
+    this->Internal->CacheDirectory.clear();
+    // (can't use the cache unless the input was hashed in the setup phase)
+    if (this->UseExtractionCache && this->Internal->InputSignature != 0)
+    {
+      this->Internal->CacheDirectory = TerrainExtractionCacheDirectory(baseIntermediateFileName);
+      TerrainCacheHash hash;
+      hash.Add(this->Internal->InputSignature);
+      hash.Add(this->InitialScale);
+      hash.Add(this->MaskSize);
+      this->Internal->RefineSignature = hash.Value;
+
+      // if we've refined this input (with the same parameters) before, we
+      // only need the refine results if some level isn't in the cache;
+      // defer the refine to the Extract phase
+      int numberOfLevels;
+      if (this->Internal->ReadRefineRecord(numberOfLevels))
+      {
+        this->NumberOfLevels = numberOfLevels;
+        this->Internal->RefinePending = true;
+        return 1;
+      }
+    }
+    this->RefineInput(baseIntermediateFileName.c_str(), output);
   }
   else // VTK_MODE_EXTRACT
   {
@@ -582,13 +1554,27 @@ int vtkTerrainExtractionFilter::RequestData(vtkInformation* vtkNotUsed(request),
       this->Internal->PointLocator->BuildLocator();
     }
 
-    /*bool abort = */ this->TerrainExtract(baseIntermediateFileName.c_str(), output);
+    bool abort = this->TerrainExtract(baseIntermediateFileName.c_str(), output);
     delete this->Internal->Refine;
     this->Internal->Refine = 0;
 
     this->Internal->DeleteTemporaryFiles();
     this->AppendOutputs();
 
+    // cache the levels we extracted (as opposed to restored from the cache)
+    if (!abort && !this->Internal->CacheDirectory.empty())
+    {
+      for (int level = this->MinExtractLevel; level <= this->MaxExtractLevel; level++)
+      {
+        if (this->Internal->OutputSplitCount[level] != 0)
+        {
+          this->Internal->StoreLevel(level);
+        }
+      }
+      this->Internal->TrimCache(
+        static_cast<vtkTypeUInt64>(this->MaximumExtractionCacheMB) * 1024 * 1024);
+    }
+
     delete[] this->Internal->OutputSplitCount;
     delete[] this->Internal->OutputFileNameBase;
     delete[] this->Internal->LevelScales;
@@ -618,11 +1604,15 @@ void vtkTerrainExtractionFilter::AppendOutputs()
     fileExtension += ".pts"; //always append .pts, regardless of ASCII or Binary
   }
 
-  vcl_string outputPath = vtksys::SystemTools::GetParentDirectory(
-    vtksys::SystemTools::GetFilenamePath(this->Internal->OutputFileNameBase[0]).c_str());
-  outputPath += "/";
+  // the split levels are written to a sub-directory of the OutputPath
+  vcl_string outputPath = this->Internal->OutputPath;
   for (int level = this->MinExtractLevel; level <= this->MaxExtractLevel; level++)
   {
+    if (this->Internal->OutputSplitCount[level] == 0)
+    {
+      // not extracted (restored from the extraction cache)
+      continue;
+    }
     if (this->Internal->OutputSplitCount[level] == 1)
     {
       break;
@@ -696,6 +1686,7 @@ void vtkTerrainExtractionFilter::AppendOutputs()
             outputFileName += buf;
           }
           outputFileName += fileExtension;
+          this->Internal->LevelOutputFiles[level].push_back(outputFileName);
           appendPolyData->Update();
           if (this->GetOutputPtsFormat() == VTK_OUTPUT_TYPE_XML_PD)
           {
@@ -732,6 +1723,19 @@ void vtkTerrainExtractionFilter::AppendOutputs()
   }
 }
 
+void vtkTerrainExtractionFilter::RefineInput(
+  const char* baseFileName, vtkMultiBlockDataSet* output)
+{
+  this->Internal->Refine->set_scale(this->InitialScale);
+  this->Internal->Refine->build_tree();
+  this->TokenRefineAnalyze(baseFileName, output);
+  this->Internal->RefinePending = false;
+  if (this->Internal->Refine && !this->Internal->CacheDirectory.empty())
+  {
+    this->Internal->WriteRefineRecord(this->NumberOfLevels);
+  }
+}
+
 void vtkTerrainExtractionFilter::TokenRefineAnalyze(
   const char* baseFileName, vtkMultiBlockDataSet* /*output*/)
 {
@@ -938,6 +1942,21 @@ bool vtkTerrainExtractionInternal::UpdateProgress(int currentLevel, double* boun
   return false;
 }
 
+void vtkTerrainExtractionInternal::SetupLevelBlock(TerrainLevelBlock* levelBlock, double scale)
+{
+  // a single block covering the whole level
+  memcpy(levelBlock->Bounds, this->InputBounds, sizeof(double) * 4);
+  levelBlock->Origin[0] = this->InputBounds[0];
+  levelBlock->Origin[1] = this->InputBounds[2];
+
+  double const factor = 1;
+  levelBlock->Spacing[0] = levelBlock->Spacing[1] = scale * factor;
+  levelBlock->Ni =
+    1 + int(vcl_ceil((this->InputBounds[1] - this->InputBounds[0]) / levelBlock->Spacing[0]));
+  levelBlock->Nj =
+    1 + int(vcl_ceil((this->InputBounds[3] - this->InputBounds[2]) / levelBlock->Spacing[1]));
+}
+
 bool vtkTerrainExtractionInternal::TerrainExtractSubLevel(
   TerrainLevelBlock* prevLevelBlock, int extractLevel)
 {
@@ -955,21 +1974,16 @@ bool vtkTerrainExtractionInternal::TerrainExtractSubLevel(
   if (extractLevel > this->InitialExtractSplitLevel)
   {
     TerrainLevelBlock* levelBlock = new TerrainLevelBlock;
-    memcpy(levelBlock->Bounds, this->InputBounds, sizeof(double) * 4);
-    levelBlock->Origin[0] = this->InputBounds[0];
-    levelBlock->Origin[1] = this->InputBounds[2];
-
-    double const factor = 1;
-    levelBlock->Spacing[0] = levelBlock->Spacing[1] = scale * factor;
-    levelBlock->Ni =
-      1 + int(vcl_ceil((this->InputBounds[1] - this->InputBounds[0]) / levelBlock->Spacing[0]));
-    levelBlock->Nj =
-      1 + int(vcl_ceil((this->InputBounds[3] - this->InputBounds[2]) / levelBlock->Spacing[1]));
+    this->SetupLevelBlock(levelBlock, scale);
 
     this->Timer->StartTimer();
 
     // Allocate the terrain representation for this level.
-    levelBlock->Terrain.resize(levelBlock->Ni * levelBlock->Nj);
+    if (!this->UseBlock(levelBlock) || (prevLevelBlock && !this->UseBlock(prevLevelBlock)))
+    {
+      delete levelBlock;
+      return true;
+    }
 
     // get the tokens for this scale
     this->Refine->get_tokens(extractLevel, 0, this->Tokens);
@@ -980,8 +1994,9 @@ bool vtkTerrainExtractionInternal::TerrainExtractSubLevel(
     this->Extract2D(levelBlock, prevLevelBlock, this->OutPoints, this->OutScales, tvw);
     if (prevLevelBlock)
     {
-      prevLevelBlock->Terrain.clear();
+      this->ForgetBlock(prevLevelBlock);
     }
+    this->ReleaseTokens();
 
     this->Timer->StopTimer();
     // MaximumLevelTime / 2 becasue the next level will take about twice as long
@@ -991,6 +2006,9 @@ bool vtkTerrainExtractionInternal::TerrainExtractSubLevel(
     }
 
     this->ExtractSave(levelBlock, extractLevel, false, this->OutPoints, this->OutScales);
+    // the terrain of whole (unsplit) levels is cached, so that a later
+    // extraction can pick up from this level
+    this->WriteLevelTerrain(extractLevel, levelBlock);
 
     // update the progress
     abort = this->UpdateProgress(extractLevel, levelBlock->Bounds);
@@ -1016,20 +2034,35 @@ bool vtkTerrainExtractionInternal::TerrainExtractSubLevel(
         (levelBlock->Offset[1] + levelBlock->Nj - 1) * levelBlock->Spacing[1] + 3 * scale;
       this->Refine->get_tokens(extractLevel, bounds, this->Tokens);
 
-      // Allocate the terrain representation for this level.
-      levelBlock->Terrain.resize(levelBlock->Ni * levelBlock->Nj);
+      // Allocate the terrain representation for this level (and page the
+      // previous level back in if it was evicted while processing siblings)
+      if (!this->UseBlock(levelBlock) || !this->UseBlock(prevLevelBlock))
+      {
+        abort = true;
+        break;
+      }
 
       // DO THE WORK
       this->LevelIndex = extractLevel;
 
       this->Extract2D(levelBlock, prevLevelBlock, this->OutPoints, this->OutScales, tvw);
-      if (prevLevelBlock->NumberOfSubBlocks == 1)
+      if (prevLevelBlock->NumberOfSubBlocks == 1 || i == prevLevelBlock->NumberOfSubBlocks - 1)
       {
-        prevLevelBlock->Terrain.clear();
+        this->ForgetBlock(prevLevelBlock);
       }
+      this->ReleaseTokens();
 
       this->ExtractSave(levelBlock, extractLevel, true, this->OutPoints, this->OutScales);
 
+      // the previous level isn't needed while processing levelBlock's
+      // children; let the pager evict it if we're over the memory cap
+      if (this->Pager && !this->Pager->Trim(levelBlock))
+      {
+        vtkGenericWarningMacro("Failed to write terrain block to the scratch file.");
+        abort = true;
+        break;
+      }
+
       // update the progress
       abort = this->UpdateProgress(extractLevel, levelBlock->Bounds);
 
@@ -1090,7 +2123,7 @@ void vtkTerrainExtractionInternal::BuildLevelBlockTree(
 void vtkTerrainExtractionInternal::SetupBlockExtents(TerrainLevelBlock* childBlock)
 {
   // figure out what extents to use; for currentLevel = MinExtractLevel, want
-  // only points within bounds of the compute block; otherwise want one TerrainPoint
+  // only points within bounds of the compute block; otherwise want one terrain sample
   // beyond that need by the children of childBlock
   // Origin of the whole level
   childBlock->Origin[0] = this->InputBounds[0];
@@ -1164,11 +2197,15 @@ void vtkTerrainExtractionInternal::SetupBlockExtents(TerrainLevelBlock* childBlo
 }
 
 bool vtkTerrainExtractionFilter::TerrainExtract(
-  const char* /*baseIntermediateFileName*/, vtkMultiBlockDataSet* /*output*/)
+  const char* baseIntermediateFileName, vtkMultiBlockDataSet* output)
 {
   // want X and Y bounds in internal structure
   memcpy(this->Internal->InputBounds, this->InputBounds, sizeof(double) * 4);
   this->Internal->MinExtractLevel = this->MinExtractLevel;
+  this->Internal->NumberOfThreads = this->NumberOfThreads;
+  this->Internal->LevelWallTime.assign(this->MaxExtractLevel + 1, 0.0);
+  this->Internal->LevelBusyTime.assign(this->MaxExtractLevel + 1, 0.0);
+  this->Internal->LevelWorkerTime.assign(this->MaxExtractLevel + 1, 0.0);
   // this is the value it is initialized to in rtvl_refine
   // the remainder of "Internal" InputBounds set from Block's bounds
   this->Internal->InputBounds[4] = this->InputBounds[4];
@@ -1181,13 +2218,99 @@ bool vtkTerrainExtractionFilter::TerrainExtract(
   for (int i = 0; i <= this->MaxExtractLevel; i++)
   {
     this->Internal->OutputSplitCount[i] = 0;
-    this->Internal->LevelScales[i] = this->Internal->Refine->get_level_scale(i);
+    this->Internal->LevelScales[i] = this->Internal->RefinePending
+      ? this->Internal->CachedLevelScales[i]
+      : this->Internal->Refine->get_level_scale(i);
   }
   this->Internal->OutputFileNameBase = new vcl_string[this->MaxExtractLevel + 1];
+  this->Internal->LevelOutputFiles.assign(this->MaxExtractLevel + 1, vcl_vector<vcl_string>());
+
+  // every level depends on the levels above it, so the key of a level
+  // includes MaxExtractLevel (but not MinExtractLevel)
+  this->Internal->LevelCacheKeys.clear();
+  if (!this->Internal->CacheDirectory.empty())
+  {
+    for (int i = 0; i <= this->MaxExtractLevel; i++)
+    {
+      TerrainCacheHash hash;
+      hash.Add(this->Internal->RefineSignature);
+      hash.Add(this->MaxExtractLevel);
+      hash.Add(i);
+      hash.Add(this->OutputPtsFormat);
+      hash.Add(this->DetermineIntensityAndColor);
+      if (this->DetermineIntensityAndColor)
+      {
+        hash.Add(this->Internal->AttributeSignature);
+      }
+      hash.Add(TerrainCacheVersion);
+      this->Internal->LevelCacheKeys.push_back(hash.ToString());
+    }
+  }
+
+  // the levels, from the top, we've already extracted
+  int cachedLevel = this->MaxExtractLevel + 1;
+  while (cachedLevel > this->MinExtractLevel && this->Internal->IsLevelCached(cachedLevel - 1))
+  {
+    cachedLevel--;
+  }
+  vcl_string fileExtension = TerrainOutputFileExtension(this->OutputPtsFormat);
+  if (cachedLevel == this->MinExtractLevel)
+  {
+    for (int i = this->MinExtractLevel; i <= this->MaxExtractLevel; i++)
+    {
+      this->Internal->RestoreLevel(i, fileExtension);
+    }
+    this->Internal->DeleteTemporaryFiles();
+    return false;
+  }
+
+  if (this->Internal->RefinePending)
+  {
+    this->RefineInput(baseIntermediateFileName, output);
+    if (!this->Internal->Refine)
+    {
+      return true;
+    }
+  }
+
+  // pick up from the lowest cached level that we have the terrain for
+  TerrainLevelBlock* resumeBlock = 0;
+  int resumeLevel = cachedLevel;
+  for (; resumeLevel <= this->MaxExtractLevel && !resumeBlock; resumeLevel++)
+  {
+    resumeBlock = this->Internal->ReadLevelTerrain(resumeLevel);
+  }
+  resumeLevel = resumeBlock ? resumeLevel - 1 : this->MaxExtractLevel + 1;
+  for (int i = resumeLevel; i <= this->MaxExtractLevel; i++)
+  {
+    this->Internal->RestoreLevel(i, fileExtension);
+  }
 
   // 1st thing we do is figure out the level (if any) that we start splitting at
-  unsigned int maxMemoryMB = 400;
-  this->Internal->InitialExtractSplitLevel = this->DetermineStartingSplitLevel(maxMemoryMB);
+  this->Internal->InitialExtractSplitLevel =
+    this->DetermineStartingSplitLevel(this->MaximumMemoryMB);
+  if (this->Internal->InitialExtractSplitLevel > resumeLevel - 1)
+  {
+    // the terrain we resume from is a whole level block
+    this->Internal->InitialExtractSplitLevel = resumeLevel - 1;
+  }
+
+  // when streaming, the terrain of blocks not currently being worked on is
+  // paged out to a scratch file next to the refine results
+  if (this->StreamTerrainToDisk)
+  {
+    vcl_string scratchFileName = baseIntermediateFileName;
+    scratchFileName += "_terrain.scratch";
+    this->Internal->Pager = new TerrainBlockPager(
+      scratchFileName, static_cast<size_t>(this->MaximumMemoryMB) * 1024 * 1024);
+    if (!this->Internal->Pager->IsValid())
+    {
+      vtkErrorMacro("Unable to open terrain scratch file: " << scratchFileName);
+      delete this->Internal->Pager;
+      this->Internal->Pager = 0;
+      return true;
+    }
+  }
 
   // process 1st couple levels a single block at a time, but then start
   // processing sub-blocks, and it's sub-block, etc, down to leaf.  Can only release
@@ -1195,7 +2318,12 @@ bool vtkTerrainExtractionFilter::TerrainExtract(
   // released in ExtractNextLevel)
 
   // call recursive function which processes a current level
-  return this->Internal->TerrainExtractSubLevel(0, this->MaxExtractLevel);
+  bool abort = this->Internal->TerrainExtractSubLevel(resumeBlock, resumeLevel - 1);
+
+  delete resumeBlock;
+  delete this->Internal->Pager;
+  this->Internal->Pager = 0;
+  return abort;
 }
 
 int vtkTerrainExtractionFilter::DetermineStartingSplitLevel(unsigned int maxMemoryMB)
@@ -1229,8 +2357,8 @@ int vtkTerrainExtractionFilter::DetermineStartingSplitLevel(unsigned int maxMemo
 unsigned int vtkTerrainExtractionInternal::ComputeMemoryRequirement(
   int level, int minLevel, bool splitThisLevel, double size[2])
 {
-  // main memory requirement from TerrinPoint + output (points + scale)
-  size_t memoryPerPoint = sizeof(TerrainPoint) + sizeof(double) * 4;
+  // main memory requirement from the terrain grid + output (points + scale)
+  size_t memoryPerPoint = TerrainGrid::GetBytesPerSample() + sizeof(double) * 4;
   double nextSize[2] = { size[0], size[1] };
 
   unsigned int persistentMemory = 0;
@@ -1324,6 +2452,11 @@ vtkPolyData* vtkTerrainExtractionInternal::ExtractSave(TerrainLevelBlock* levelB
   }
 
   this->WritePoints(levelFileName, this->Main->GetOutputPtsFormat(), polyData);
+  if (!levelSplit)
+  {
+    this->LevelOutputFiles[extractLevel].push_back(
+      levelFileName + TerrainOutputFileExtension(this->Main->GetOutputPtsFormat()));
+  }
   polyData->Delete();
   return 0;
   //  return polyData;
@@ -1334,135 +2467,82 @@ struct vtkThreadUserData
   TerrainLevelBlock* LevelBlock;
   TerrainLevelBlock* PrevLevelBlock;
   vtkTerrainExtractionInternal* Internal;
-  vtkPoints** OutPoints;
-  vtkDoubleArray** OutScales;
-  vtkUnsignedCharArray** RGBScalars;
-  vtkFloatArray** IntensityArray;
+  TerrainTileScheduler* Scheduler;
+  TerrainTileOutput* TileOutputs;
+  TerrainVoterGrid* VoterGrid;
+  double* BusyTime;
+  vtkIdType* BadNormals;
   rtvl_weight_smooth<3>* TVW;
 };
 
 VTK_THREAD_RETURN_TYPE vtkExtract2DExecute(void* arg)
 {
-
   int threadId = static_cast<vtkMultiThreader::ThreadInfo*>(arg)->ThreadID;
-  int threadCount = static_cast<vtkMultiThreader::ThreadInfo*>(arg)->NumberOfThreads;
   vtkThreadUserData* td =
     static_cast<vtkThreadUserData*>(static_cast<vtkMultiThreader::ThreadInfo*>(arg)->UserData);
-
-  // which rows does this thread work on
-  unsigned int rowsPerThread = static_cast<int>(
-    vcl_ceil(static_cast<double>(td->LevelBlock->Nj) / static_cast<double>(threadCount)));
-  if (threadId * rowsPerThread >= td->LevelBlock->Nj)
-  {
-    // may end up with scenario where we have some threads with no work to do.
-    // This might happen becasue it is setup to potentially have most of the
-    // threads do the maximum amount of work, versus most do a little bit
-    // less but one does more such that it is the weakest link;  Example:
-    // 42 rows and 8 threads:  can have 7 threads do 5 rows each, and the 8th
-    // process 7 rows... or have 7 rows each process 6 rows (the 8th thread
-    // has nothing to do, but max any rows process is 6 instead of 7 as in the
-    // 1st scenario)
-    return VTK_THREAD_RETURN_VALUE;
-  }
-  unsigned int startRow = threadId * rowsPerThread;
-  unsigned int lastRow = (threadId + 1) * rowsPerThread > td->LevelBlock->Nj
-    ? td->LevelBlock->Nj
-    : (threadId + 1) * rowsPerThread;
-
-  td->Internal->ExtractNextLevel(td->LevelBlock, td->PrevLevelBlock, startRow, lastRow);
+  TerrainLevelBlock* levelBlock = td->LevelBlock;
 
   vtkTerrainExtractionInternal::ThreadSpecificData threadData;
+  rtvl_weight_smooth<3> tvw = *(td->TVW);
 
-  // setup search structure to tokens, as needed by this thread
-  unsigned int n = td->Internal->Tokens.points.get_number_of_points();
-  unsigned int /*addPtIndex = 0, */ numberOfPointsForThisThread = 0;
-  rgtl_object_array_points<2> points2D;
-  // the Y (row) extents of tokens that can affect extraction for this thread
-  double minY = -3.0 * td->Internal->LevelScales[td->Internal->LevelIndex] +
-    td->LevelBlock->Origin[1] + td->LevelBlock->Spacing[1] * (startRow + td->LevelBlock->Offset[1]);
-  double maxY = 3.0 * td->Internal->LevelScales[td->Internal->LevelIndex] +
-    td->LevelBlock->Origin[1] + td->LevelBlock->Spacing[1] * (lastRow + td->LevelBlock->Offset[1]);
-
-  points2D.set_number_of_points(n);
-  threadData.PointMapping = new int[n];
-  double bds[2][2] = { { VTK_FLOAT_MAX, -VTK_FLOAT_MAX }, { VTK_FLOAT_MAX, -VTK_FLOAT_MAX } };
-  for (unsigned int i = 0; i < n; i++)
+  TerrainTileScheduler::Tile tile;
+  while (td->Scheduler->NextTile(threadId, tile))
   {
-    double p[3];
-    td->Internal->Tokens.points.get_point(i, p);
-    if (threadCount == 1 || (p[1] >= minY && p[1] <= maxY))
-    {
-      threadData.PointMapping[numberOfPointsForThisThread] = i;
-      points2D.set_point(numberOfPointsForThisThread++, p);
-      if (p[0] < bds[0][0])
-      {
-        bds[0][0] = p[0];
-      }
-      if (p[0] > bds[0][1])
-      {
-        bds[0][1] = p[0];
-      }
-      if (p[1] < bds[1][0])
-      {
-        bds[1][0] = p[1];
-      }
-      if (p[1] > bds[1][1])
-      {
-        bds[1][1] = p[1];
-      }
-    }
-  }
-
-  points2D.set_number_of_points(numberOfPointsForThisThread);
+    double tileStart = vtkTimerLog::GetUniversalTime();
 
-  // Create the 2-D spatial data structure.
-  rgtl_octree_cell_bounds<2> bounds2D;
-  bounds2D.compute_bounds(bds, 1.01);
-  rgtl_octree_objects<2> objects2D(points2D, bounds2D, 8);
-
-  vtkPoints* outPoints = td->OutPoints[threadId];
-  vtkDoubleArray* outScales = td->OutScales[threadId];
-  outPoints->Allocate((lastRow - startRow) * td->LevelBlock->Ni);
-  outScales->Allocate((lastRow - startRow) * td->LevelBlock->Ni);
-  threadData.RGBScalars = td->RGBScalars[threadId];
-  threadData.IntensityArray = td->IntensityArray[threadId];
-  if (threadData.RGBScalars)
-  {
-    threadData.RGBScalars->Allocate((lastRow - startRow) * td->LevelBlock->Ni * 3);
-  }
-  if (threadData.IntensityArray)
-  {
-    threadData.IntensityArray->Allocate((lastRow - startRow) * td->LevelBlock->Ni);
-  }
+    td->BadNormals[threadId] +=
+      td->Internal->ExtractNextLevel(levelBlock, td->PrevLevelBlock, tile.StartRow, tile.EndRow);
 
-  rtvl_weight_smooth<3> tvw = *(td->TVW);
+    TerrainTileOutput& output = td->TileOutputs[tile.Index];
+    vtkIdType numberOfTileSamples = (tile.EndRow - tile.StartRow) * levelBlock->Ni;
+    output.Points = vtkSmartPointer<vtkPoints>::New();
+    output.Points->Allocate(numberOfTileSamples);
+    output.Scales = vtkSmartPointer<vtkDoubleArray>::New();
+    output.Scales->Allocate(numberOfTileSamples);
+    threadData.RGBScalars = 0;
+    threadData.IntensityArray = 0;
+    if (td->Internal->RGBScalars)
+    {
+      output.RGBScalars = vtkSmartPointer<vtkUnsignedCharArray>::New();
+      output.RGBScalars->SetNumberOfComponents(3);
+      output.RGBScalars->Allocate(numberOfTileSamples * 3);
+      threadData.RGBScalars = output.RGBScalars;
+    }
+    if (td->Internal->IntensityArray)
+    {
+      output.IntensityArray = vtkSmartPointer<vtkFloatArray>::New();
+      output.IntensityArray->Allocate(numberOfTileSamples);
+      threadData.IntensityArray = output.IntensityArray;
+    }
 
-  vtkIdType previousRowClosestPt = 0;
-  for (unsigned int j = startRow; j < lastRow; j++)
-  {
-    threadData.PreviousClosestPt = previousRowClosestPt;
-    for (unsigned int i = 0; i < td->LevelBlock->Ni; i++)
+    vtkIdType previousRowClosestPt = 0;
+    for (unsigned int j = tile.StartRow; j < tile.EndRow; j++)
     {
-      threadData.SegmentIJ[0] = i;
-      threadData.SegmentIJ[1] = j;
-      threadData.SegmentXY[0] =
-        td->LevelBlock->Origin[0] + td->LevelBlock->Spacing[0] * (i + td->LevelBlock->Offset[0]);
-      threadData.SegmentXY[1] =
-        td->LevelBlock->Origin[1] + td->LevelBlock->Spacing[1] * (j + td->LevelBlock->Offset[1]);
-      if (!td->Internal->ExtractSegmentInit(td->LevelBlock, threadData, objects2D))
-      {
-        continue;
-      }
-      td->Internal->ExtractSegmentSearch(
-        td->LevelBlock, threadData, outPoints, td->OutScales[threadId], tvw);
-      if (i == 0)
+      threadData.PreviousClosestPt = previousRowClosestPt;
+      for (unsigned int i = 0; i < levelBlock->Ni; i++)
       {
-        previousRowClosestPt = threadData.PreviousClosestPt;
+        threadData.SegmentIJ[0] = i;
+        threadData.SegmentIJ[1] = j;
+        threadData.SegmentXY[0] =
+          levelBlock->Origin[0] + levelBlock->Spacing[0] * (i + levelBlock->Offset[0]);
+        threadData.SegmentXY[1] =
+          levelBlock->Origin[1] + levelBlock->Spacing[1] * (j + levelBlock->Offset[1]);
+        if (!td->Internal->ExtractSegmentInit(levelBlock, threadData, *td->VoterGrid))
+        {
+          continue;
+        }
+        td->Internal->ExtractSegmentSearch(
+          levelBlock, threadData, output.Points, output.Scales, tvw);
+        if (i == 0)
+        {
+          previousRowClosestPt = threadData.PreviousClosestPt;
+        }
       }
     }
+
+    td->BusyTime[threadId] += vtkTimerLog::GetUniversalTime() - tileStart;
   }
 
-  delete[] threadData.PointMapping;
   return VTK_THREAD_RETURN_VALUE;
 }
 
@@ -1470,133 +2550,173 @@ void vtkTerrainExtractionInternal::Extract2D(TerrainLevelBlock* levelBlock,
   TerrainLevelBlock* prevLevelBlock, vtkPoints* outPoints, vtkDoubleArray* outScales,
   rtvl_weight_smooth<3>& tvw)
 {
+  double startTime = vtkTimerLog::GetUniversalTime();
+
   vtkNew<vtkMultiThreader> threader;
   vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
 
+  // if less than 4 rows per thread, use less threads
+  unsigned int numberOfThreads = this->NumberOfThreads > 0
+    ? static_cast<unsigned int>(this->NumberOfThreads)
+    : threader->GetGlobalDefaultNumberOfThreads();
+  if (levelBlock->Nj < 4 * numberOfThreads)
+  {
+    numberOfThreads = int(vcl_ceil(levelBlock->Nj / 4.0));
+  }
+  if (numberOfThreads < 1)
+  {
+    numberOfThreads = 1;
+  }
+  threader->SetNumberOfThreads(numberOfThreads);
+
+  // several tiles per thread, so that there is something left to steal when
+  // a thread runs out of (cheap) rows of its own
+  unsigned int rowsPerTile = levelBlock->Nj / (8 * numberOfThreads);
+  if (rowsPerTile < 1)
+  {
+    rowsPerTile = 1;
+  }
+  TerrainTileScheduler scheduler(numberOfThreads, levelBlock->Nj, rowsPerTile);
+  vcl_vector<TerrainTileOutput> tileOutputs(scheduler.GetNumberOfTiles());
+  vcl_vector<double> busyTime(numberOfThreads, 0.0);
+  vcl_vector<vtkIdType> badNormals(numberOfThreads, 0);
+
+  // Create the 2-D spatial data structure over the voting tokens, shared
+  // (read only) by all of the threads.
+  TerrainVoterGrid voterGrid;
+  voterGrid.Build(this->Tokens, 3 * this->Tokens.scale);
+
   vtkThreadUserData userData;
   userData.Internal = this;
   userData.LevelBlock = levelBlock;
   userData.PrevLevelBlock = prevLevelBlock;
+  userData.Scheduler = &scheduler;
+  userData.TileOutputs = tileOutputs.empty() ? 0 : &tileOutputs[0];
+  userData.VoterGrid = &voterGrid;
+  userData.BusyTime = &busyTime[0];
+  userData.BadNormals = &badNormals[0];
   userData.TVW = &tvw;
 
-  // if less than 4 rows per thread, use less threads
-  unsigned int numberOfThreads = threader->GetGlobalDefaultNumberOfThreads();
-  if (levelBlock->Nj < 4 * numberOfThreads)
+  threader->SetSingleMethod(vtkExtract2DExecute, &userData);
+  threader->SingleMethodExecute();
+
+  // combine the tile outputs (in row order)
+  vtkIdType numberOfOutputPoints = 0;
+  for (size_t i = 0; i < tileOutputs.size(); i++)
   {
-    numberOfThreads = int(vcl_ceil(levelBlock->Nj / 4.0));
+    if (tileOutputs[i].Points)
+    {
+      numberOfOutputPoints += tileOutputs[i].Points->GetNumberOfPoints();
+    }
   }
-  threader->SetNumberOfThreads(numberOfThreads);
-
-  // reset existing arrays
-  outPoints->Reset();
-  outScales->Reset();
+  outPoints->SetNumberOfPoints(numberOfOutputPoints);
+  outScales->SetNumberOfTuples(numberOfOutputPoints);
   if (this->RGBScalars)
   {
-    this->RGBScalars->Reset();
+    this->RGBScalars->SetNumberOfTuples(numberOfOutputPoints);
   }
   if (this->IntensityArray)
   {
-    this->IntensityArray->Reset();
-  }
-  userData.OutPoints = new vtkPoints*[threader->GetNumberOfThreads()];
-  userData.OutScales = new vtkDoubleArray*[threader->GetNumberOfThreads()];
-  userData.RGBScalars = new vtkUnsignedCharArray*[threader->GetNumberOfThreads()];
-  userData.IntensityArray = new vtkFloatArray*[threader->GetNumberOfThreads()];
-  if (threader->GetNumberOfThreads() == 1)
-  {
-    userData.OutPoints[0] = outPoints;
-    userData.OutScales[0] = outScales;
-    userData.RGBScalars[0] = this->RGBScalars;
-    userData.IntensityArray[0] = this->IntensityArray;
+    this->IntensityArray->SetNumberOfTuples(numberOfOutputPoints);
   }
-  else
+  vtkIdType outputOffset = 0;
+  for (size_t i = 0; i < tileOutputs.size(); i++)
   {
-    for (int i = 0; i < threader->GetNumberOfThreads(); i++)
+    TerrainTileOutput& output = tileOutputs[i];
+    vtkIdType numberOfTilePoints = output.Points ? output.Points->GetNumberOfPoints() : 0;
+    if (numberOfTilePoints == 0)
     {
-      userData.OutPoints[i] = vtkPoints::New();
-      userData.OutScales[i] = vtkDoubleArray::New();
-      if (this->RGBScalars)
-      {
-        userData.RGBScalars[i] = vtkUnsignedCharArray::New();
-        userData.RGBScalars[i]->SetNumberOfComponents(3);
-      }
-      else
-      {
-        userData.RGBScalars[i] = 0;
-      }
-      if (this->IntensityArray)
-      {
-        userData.IntensityArray[i] = vtkFloatArray::New();
-      }
-      else
-      {
-        userData.IntensityArray[i] = 0;
-      }
+      continue;
     }
-  }
-
-  threader->SetSingleMethod(vtkExtract2DExecute, &userData);
-  threader->SingleMethodExecute();
-
-  if (threader->GetNumberOfThreads() > 1)
-  {
-    // combine points and arrays, then delete
-    outPoints->Allocate(levelBlock->Nj * levelBlock->Ni);
-    outScales->Allocate(levelBlock->Nj * levelBlock->Ni);
+    outPoints->GetData()->InsertTuples(
+      outputOffset, numberOfTilePoints, 0, output.Points->GetData());
+    outScales->InsertTuples(outputOffset, numberOfTilePoints, 0, output.Scales);
     if (this->RGBScalars)
     {
-      this->RGBScalars->Allocate(levelBlock->Nj * levelBlock->Ni * 3);
+      this->RGBScalars->InsertTuples(outputOffset, numberOfTilePoints, 0, output.RGBScalars);
     }
     if (this->IntensityArray)
     {
-      this->IntensityArray->Allocate(levelBlock->Nj * levelBlock->Ni);
+      this->IntensityArray->InsertTuples(
+        outputOffset, numberOfTilePoints, 0, output.IntensityArray);
     }
+    outputOffset += numberOfTilePoints;
+  }
+
+  double wallTime = vtkTimerLog::GetUniversalTime() - startTime;
+  this->LevelWallTime[this->LevelIndex] += wallTime;
+  this->LevelWorkerTime[this->LevelIndex] += wallTime * numberOfThreads;
+  for (unsigned int i = 0; i < numberOfThreads; i++)
+  {
+    this->LevelBusyTime[this->LevelIndex] += busyTime[i];
+  }
+
+  // once for all the threads, rather than interleaved from each of them
+  vtkIdType numberOfBadNormals = 0;
+  for (unsigned int i = 0; i < numberOfThreads; i++)
+  {
+    numberOfBadNormals += badNormals[i];
+  }
+  if (numberOfBadNormals > 0)
+  {
+    vtkWarningWithObjectMacro(this->Main, << numberOfBadNormals
+                                          << " samples of the previous level were skipped "
+                                             "for a (nearly) horizontal normal.");
+  }
+}
 
-    for (int i = 0; i < threader->GetNumberOfThreads(); i++)
+namespace
+{
+// collects the voters of a segment (that are within reach of its z range)
+class SegmentVoterCollector
+{
+public:
+  SegmentVoterCollector(
+    vtkTerrainExtractionInternal::SegmentVotersType& voters, const double range[2], double reach)
+    : Voters(voters)
+    , Min(range[0] - reach)
+    , Max(range[1] + reach)
+  {
+  }
+  void operator()(const TerrainVoterGrid::Entry& entry)
+  {
+    if (entry.Z > this->Min && entry.Z < this->Max)
     {
-      for (vtkIdType j = 0; j < userData.OutPoints[i]->GetNumberOfPoints(); j++)
-      {
-        outPoints->InsertNextPoint(userData.OutPoints[i]->GetPoint(j));
-        outScales->InsertNextValue(userData.OutScales[i]->GetValue(j));
-        if (this->RGBScalars)
-        {
-          this->RGBScalars->InsertNextTuple(userData.RGBScalars[i]->GetTuple(j));
-        }
-        if (this->IntensityArray)
-        {
-          this->IntensityArray->InsertNextValue(userData.IntensityArray[i]->GetValue(j));
-        }
-      }
-      userData.OutPoints[i]->Delete();
-      userData.OutScales[i]->Delete();
-      if (userData.RGBScalars[i])
-      {
-        userData.RGBScalars[i]->Delete();
-      }
-      if (userData.IntensityArray[i])
-      {
-        userData.IntensityArray[i]->Delete();
-      }
+      vtkTerrainExtractionInternal::SegmentVoter voter = { entry.Z, entry.Id };
+      this->Voters.push_back(voter);
     }
   }
 
-  delete[] userData.OutPoints;
-  delete[] userData.OutScales;
-  delete[] userData.RGBScalars;
-  delete[] userData.IntensityArray;
+private:
+  vtkTerrainExtractionInternal::SegmentVotersType& Voters;
+  double Min;
+  double Max;
+};
+
+bool SegmentVoterZLess(const vtkTerrainExtractionInternal::SegmentVoter& voter, double z)
+{
+  return voter.Z < z;
+}
+
+bool SegmentVoterZGreater(double z, const vtkTerrainExtractionInternal::SegmentVoter& voter)
+{
+  return z < voter.Z;
+}
 }
 
-bool vtkTerrainExtractionInternal::ExtractSegmentInit(
-  TerrainLevelBlock* levelBlock, ThreadSpecificData& threadData, rgtl_octree_objects<2>& objects2D)
+bool vtkTerrainExtractionInternal::ExtractSegmentInit(TerrainLevelBlock* levelBlock,
+  ThreadSpecificData& threadData, const TerrainVoterGrid& voterGrid)
 {
   threadData.SegmentVoters.clear();
 
   // Select an initial search range.
-  TerrainPoint& tp = levelBlock->GetPoint(threadData.SegmentIJ);
-  if (tp.known)
+  const TerrainGrid& terrain = levelBlock->Terrain;
+  bool known = terrain.IsKnown(threadData.SegmentIJ[0], threadData.SegmentIJ[1]);
+  if (known)
   {
-    threadData.SegmentRange[0] = tp.z - this->Tokens.scale / 2;
-    threadData.SegmentRange[1] = tp.z + this->Tokens.scale / 2;
+    double z = terrain.GetZ(threadData.SegmentIJ[0], threadData.SegmentIJ[1]);
+    threadData.SegmentRange[0] = z - this->Tokens.scale / 2;
+    threadData.SegmentRange[1] = z + this->Tokens.scale / 2;
   }
   else
   {
@@ -1604,25 +2724,12 @@ bool vtkTerrainExtractionInternal::ExtractSegmentInit(
     threadData.SegmentRange[1] = VTK_DOUBLE_MAX;
   }
 
-  // Lookup voters that contribute to points on this line segment.
-  vcl_vector<int> voter_ids;
-  int num_voters = objects2D.query_sphere(threadData.SegmentXY, 3 * this->Tokens.scale, voter_ids);
-  for (int i = 0; i < num_voters; i++)
-  {
-    int id = threadData.PointMapping[voter_ids[i]];
-    double p[3];
-    this->Tokens.points.get_point(id, p);
-    rtvl_tensor<3> const& tensor = this->Tokens.tokens[id];
-    double flatness = tensor.saliency(0) / tensor.lambda(0);
-    double const flatness_threshold = 0;
-    if (flatness >= flatness_threshold &&
-      p[2] + 3 * this->Tokens.scale > threadData.SegmentRange[0] &&
-      p[2] - 3 * this->Tokens.scale < threadData.SegmentRange[1])
-    {
-      vtkTerrainExtractionInternal::SegmentVotersType::value_type entry(p[2], id);
-      threadData.SegmentVoters.insert(entry);
-    }
-  }
+  // Lookup voters that contribute to points on this line segment (the
+  // grid only holds tokens flat enough to vote).
+  SegmentVoterCollector collector(
+    threadData.SegmentVoters, threadData.SegmentRange, 3 * this->Tokens.scale);
+  voterGrid.Query(threadData.SegmentXY, 3 * this->Tokens.scale, collector);
+  std::sort(threadData.SegmentVoters.begin(), threadData.SegmentVoters.end());
 
   // Shrink the range to within reach of the voters.  This is an
   // optimization, and should not be propagated to another level.
@@ -1630,8 +2737,8 @@ bool vtkTerrainExtractionInternal::ExtractSegmentInit(
   {
     // Compute the search range along the line within reach of the
     // voters.
-    double range[2] = { threadData.SegmentVoters.begin()->first - 3 * this->Tokens.scale,
-      threadData.SegmentVoters.rbegin()->first + 3 * this->Tokens.scale };
+    double range[2] = { threadData.SegmentVoters.front().Z - 3 * this->Tokens.scale,
+      threadData.SegmentVoters.back().Z + 3 * this->Tokens.scale };
 
     // Shrink the line segment if possible.
     if (range[0] > threadData.SegmentRange[0])
@@ -1643,7 +2750,7 @@ bool vtkTerrainExtractionInternal::ExtractSegmentInit(
       threadData.SegmentRange[1] = range[1];
     }
   }
-  else if (!tp.known)
+  else if (!known)
   {
     // if terrain point isn't known (from previous level) AND there were no
     // SegmentVoters, then we're not going to generate an output point for
@@ -1658,10 +2765,11 @@ bool vtkTerrainExtractionInternal::ExtractSegmentVote(
 {
   // Find the voters in reach.
   double sigma = this->Tokens.scale;
-  vtkTerrainExtractionInternal::SegmentVotersType::iterator first =
-    threadData.SegmentVoters.lower_bound(loc.z - 3 * sigma);
-  vtkTerrainExtractionInternal::SegmentVotersType::iterator last =
-    threadData.SegmentVoters.upper_bound(loc.z + 3 * sigma);
+  const SegmentVotersType& voters = threadData.SegmentVoters;
+  SegmentVotersType::const_iterator first =
+    std::lower_bound(voters.begin(), voters.end(), loc.z - 3 * sigma, SegmentVoterZLess);
+  SegmentVotersType::const_iterator last =
+    std::upper_bound(first, voters.end(), loc.z + 3 * sigma, SegmentVoterZGreater);
   if (first == last)
   {
     loc.saliency = 0;
@@ -1682,9 +2790,9 @@ bool vtkTerrainExtractionInternal::ExtractSegmentVote(
   rtvl_votee_d<3> votee(votee_location, votee_tensor, votee_tensor_d);
 
   vnl_vector_fixed<double, 3> voter_location;
-  for (vtkTerrainExtractionInternal::SegmentVotersType::iterator vi = first; vi != last; ++vi)
+  for (SegmentVotersType::const_iterator vi = first; vi != last; ++vi)
   {
-    int j = vi->second;
+    int j = vi->Id;
     this->Tokens.points.get_point(j, voter_location.data_block());
     rtvl_voter<3> voter(voter_location, this->Tokens.tokens[j]);
     rtvl_vote(voter, votee, tvw, false);
@@ -1773,17 +2881,20 @@ void vtkTerrainExtractionInternal::ExtractSegmentSearch(TerrainLevelBlock* level
     threadData.SegmentXY[0] > this->InputBounds[1] ||
     threadData.SegmentXY[1] > this->InputBounds[3])
   {
-    TerrainPoint& tp = levelBlock->GetPoint(threadData.SegmentIJ);
-    if (tp.known)
+    const TerrainGrid& terrain = levelBlock->Terrain;
+    unsigned int i = threadData.SegmentIJ[0];
+    unsigned int j = threadData.SegmentIJ[1];
+    if (terrain.IsKnown(i, j))
     {
       vnl_vector_fixed<double, 3> p;
       double transformed[3];
       p(0) = threadData.SegmentXY[0];
       p(1) = threadData.SegmentXY[1];
-      p(2) = tp.z;
+      p(2) = terrain.GetZ(i, j);
       this->InverseTransform->TransformPoint(p.data_block(), transformed);
       /*tp.id = */ outPoints->InsertNextPoint(transformed);
-      outScales->InsertNextTypedTuple(&tp.scale);
+      double scale = terrain.GetScale(i, j);
+      outScales->InsertNextTypedTuple(&scale);
       if (this->PointLocator)
       {
         double dist2;
@@ -1919,10 +3030,14 @@ bool vtkTerrainExtractionInternal::ExtractSegmentLocalMax(TerrainLevelBlock* lev
   if (saliency > 200)
   {
     // Make sure the normal direction is acceptable.
-    TerrainPoint& tp = levelBlock->GetPoint(threadData.SegmentIJ);
-    if (tp.known)
-    {
-      if (dot_product(tp.normal, threadData.LastNormal) < 0.866)
+    TerrainGrid& terrain = levelBlock->Terrain;
+    unsigned int i = threadData.SegmentIJ[0];
+    unsigned int j = threadData.SegmentIJ[1];
+    if (terrain.IsKnown(i, j))
+    {
+      vnl_vector_fixed<double, 3> normal;
+      terrain.GetNormal(i, j, normal);
+      if (dot_product(normal, threadData.LastNormal) < 0.866)
       {
         // TODO: Should abort the whole segment?
         return false;
@@ -1974,11 +3089,7 @@ bool vtkTerrainExtractionInternal::ExtractSegmentLocalMax(TerrainLevelBlock* lev
         }
       }
     }
-    tp.known = true;
-    tp.level = this->LevelIndex;
-    tp.scale = this->Tokens.scale;
-    tp.z = p(2);
-    tp.normal = threadData.LastNormal;
+    terrain.Set(i, j, this->LevelIndex, this->Tokens.scale, p(2), threadData.LastNormal);
     return true;
   }
   else
@@ -1987,59 +3098,64 @@ bool vtkTerrainExtractionInternal::ExtractSegmentLocalMax(TerrainLevelBlock* lev
   }
 }
 
-void vtkTerrainExtractionInternal::ExtractNextLevel(TerrainLevelBlock* levelBlock,
+vtkIdType vtkTerrainExtractionInternal::ExtractNextLevel(TerrainLevelBlock* levelBlock,
   TerrainLevelBlock* prevLevelBlock, unsigned int startRow, unsigned int endRow)
 {
   // Short-circuit for the first level.
   if (!prevLevelBlock)
   {
-    return;
+    return 0;
+  }
+
+  // The mapping of the columns onto the previous level is the same for
+  // every row, so compute it once.
+  unsigned int ni = levelBlock->Ni;
+  vcl_vector<int> prevColumn(ni);
+  vcl_vector<double> columnDx(ni);
+  vcl_vector<double> columnX(ni);
+  for (unsigned int i = 0; i < ni; i++)
+  {
+    columnX[i] = levelBlock->Origin[0] + levelBlock->Spacing[0] * (i + levelBlock->Offset[0]);
+    double prevIndex = (columnX[i] - prevLevelBlock->Origin[0]) / prevLevelBlock->Spacing[0];
+    int prev_i = int(vcl_floor(prevIndex));
+    columnDx[i] = prevIndex - prev_i;
+    // "convert" the index to the local "block" space
+    prevColumn[i] = prev_i - prevLevelBlock->Offset[0];
   }
 
-  // Initialize the next level with bilinear interpolation of this level.
+  // Initialize the next level with bilinear interpolation of this level,
+  // a row at a time.
+  TerrainRowAccumulator acc;
+  acc.BadNormals = 0;
+  vnl_vector_fixed<double, 3> n;
   for (unsigned int j = startRow; j < endRow; j++)
   {
-    for (unsigned int i = 0; i < levelBlock->Ni; i++)
-    {
-      double p[2] = { levelBlock->Origin[0] + levelBlock->Spacing[0] * (i + levelBlock->Offset[0]),
-        levelBlock->Origin[1] + levelBlock->Spacing[1] * (j + levelBlock->Offset[1]) };
-      double prev_index[2] = { (p[0] - prevLevelBlock->Origin[0]) / prevLevelBlock->Spacing[0],
-        (p[1] - prevLevelBlock->Origin[1]) / prevLevelBlock->Spacing[1] };
-      int prev_i = int(vcl_floor(prev_index[0]));
-      int prev_j = int(vcl_floor(prev_index[1]));
-      double dx = prev_index[0] - prev_i;
-      double dy = prev_index[1] - prev_j;
-      double z = 0;
-      double w = 0;
-      vnl_vector_fixed<double, 3> n;
-      n.fill(0.0);
-      int level = -1;
-      double scale = 0;
-      // "convert" the indices to the local "block" space
-      prev_i -= prevLevelBlock->Offset[0];
-      prev_j -= prevLevelBlock->Offset[1];
-      prevLevelBlock->Contribute(
-        prev_i, prev_j, (1 - dx) * (1 - dy), p[0], p[1], z, n, w, level, scale);
-      prevLevelBlock->Contribute(
-        prev_i + 1, prev_j, (dx) * (1 - dy), p[0], p[1], z, n, w, level, scale);
-      prevLevelBlock->Contribute(
-        prev_i, prev_j + 1, (1 - dx) * (dy), p[0], p[1], z, n, w, level, scale);
-      prevLevelBlock->Contribute(
-        prev_i + 1, prev_j + 1, (dx) * (dy), p[0], p[1], z, n, w, level, scale);
+    double y = levelBlock->Origin[1] + levelBlock->Spacing[1] * (j + levelBlock->Offset[1]);
+    double prevIndex = (y - prevLevelBlock->Origin[1]) / prevLevelBlock->Spacing[1];
+    int prev_j = int(vcl_floor(prevIndex));
+    double dy = prevIndex - prev_j;
+    prev_j -= prevLevelBlock->Offset[1];
+
+    acc.Reset(ni);
+    prevLevelBlock->ContributeRow(
+      prev_j, 1 - dy, y, ni, &prevColumn[0], &columnDx[0], &columnX[0], acc);
+    prevLevelBlock->ContributeRow(
+      prev_j + 1, dy, y, ni, &prevColumn[0], &columnDx[0], &columnX[0], acc);
+
+    for (unsigned int i = 0; i < ni; i++)
+    {
+      double w = acc.Weight[i];
       if (w > 0)
       {
-        z /= w;
-        scale /= w;
+        n[0] = acc.Nx[i];
+        n[1] = acc.Ny[i];
+        n[2] = acc.Nz[i];
         n.normalize();
-        TerrainPoint& tp = levelBlock->GetPoint(i, j);
-        tp.known = true;
-        tp.level = level;
-        tp.scale = scale;
-        tp.z = z;
-        tp.normal = n;
+        levelBlock->Terrain.Set(i, j, acc.Level[i], acc.Scale[i] / w, acc.Z[i] / w, n);
       }
     }
   }
+  return acc.BadNormals;
 }
 
 int vtkTerrainExtractionFilter::FillInputPortInformation(int, vtkInformation* info)
@@ -2052,4 +3168,9 @@ int vtkTerrainExtractionFilter::FillInputPortInformation(int, vtkInformation* in
 void vtkTerrainExtractionFilter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << endl;
+  os << indent << "StreamTerrainToDisk: " << this->StreamTerrainToDisk << endl;
+  os << indent << "UseExtractionCache: " << this->UseExtractionCache << endl;
+  os << indent << "MaximumExtractionCacheMB: " << this->MaximumExtractionCacheMB << endl;
+  os << indent << "MaximumMemoryMB: " << this->MaximumMemoryMB << endl;
 }
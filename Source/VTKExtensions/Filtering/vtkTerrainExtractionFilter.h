@@ -48,6 +48,7 @@
 #include "cmbSystemConfig.h"
 #include "vtkCMBFilteringModule.h" // For export macro
 #include "vtkMultiBlockDataSetAlgorithm.h"
+#include "vtkMultiThreader.h" // For VTK_MAX_THREADS
 #include "vtkSmartPointer.h"
 
 #define VTK_MODE_SETUP_REFINE 0
@@ -226,6 +227,60 @@ public:
   vtkSetClampMacro(MaskSize, double, 0.0, 1.0);
   vtkGetMacro(MaskSize, double);
 
+  // Description:
+  // Set/Get the number of worker threads used by the Extract phase.  Each
+  // level block is cut into row tiles which the workers pull from their own
+  // queue and steal from each other once it runs dry.  If 0 (the default),
+  // vtkMultiThreader's global default number of threads is used.
+  vtkSetClampMacro(NumberOfThreads, int, 0, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  // Description:
+  // Timing information gathered during the last Extract phase, per level:
+  // the wall clock time (seconds) spent extracting the level (summed over
+  // all of its blocks) and the fraction of the available worker time that
+  // was actually spent processing tiles (1.0 being all cores busy).
+  double GetLevelExtractionTime(int level);
+  double GetLevelCoreUtilization(int level);
+
+  // Description:
+  // Set/Get the memory cap (in MB) for the Extract phase.  It determines the
+  // level at which the extraction starts splitting into blocks and, when
+  // StreamTerrainToDisk is on, how much of the per block terrain may stay
+  // resident in memory.  Defaults to 400.
+  vtkSetClampMacro(MaximumMemoryMB, unsigned int, 1, VTK_UNSIGNED_INT_MAX);
+  vtkGetMacro(MaximumMemoryMB, unsigned int);
+
+  // Description:
+  // Set/Get whether the Extract phase streams the terrain of every block
+  // through a scratch file (in IntermediateResultsPath) instead of keeping
+  // the terrain of all the blocks still needed in memory.  Blocks are paged
+  // back in on demand, such that only MaximumMemoryMB worth of terrain is
+  // resident at any time.  The refine tokens are already read per block
+  // from the intermediate results.
+  vtkBooleanMacro(StreamTerrainToDisk, bool);
+  vtkSetMacro(StreamTerrainToDisk, bool);
+  vtkGetMacro(StreamTerrainToDisk, bool);
+
+  // Description:
+  // Set/Get whether refine and extract results are cached (in a
+  // TerrainExtractionCache directory of IntermediateResultsPath) and reused
+  // by later executions on the same input.  The cache is keyed on the
+  // content of the (transformed) input and on the parameters each result
+  // depends on, so re-running with a different MinExtractLevel or output
+  // settings only extracts what isn't cached, resuming from the terrain of
+  // the lowest cached whole level.  Defaults to false.
+  vtkBooleanMacro(UseExtractionCache, bool);
+  vtkSetMacro(UseExtractionCache, bool);
+  vtkGetMacro(UseExtractionCache, bool);
+
+  // Description:
+  // Set/Get the size (in MB) the extraction cache is trimmed to after an
+  // extraction, by removing the least recently used levels (never the ones
+  // of the current extraction).  Defaults to 2048.
+  vtkSetClampMacro(MaximumExtractionCacheMB, unsigned int, 1, VTK_UNSIGNED_INT_MAX);
+  vtkGetMacro(MaximumExtractionCacheMB, unsigned int);
+
   //BTX
 protected:
   vtkTerrainExtractionFilter();
@@ -238,6 +293,7 @@ private:
   vtkTerrainExtractionFilter(const vtkTerrainExtractionFilter&); // Not implemented.
   void operator=(const vtkTerrainExtractionFilter&);             // Not implemented.
 
+  void RefineInput(const char* baseFileName, vtkMultiBlockDataSet* output);
   void TokenRefineAnalyze(const char* baseFileName, vtkMultiBlockDataSet* output);
   bool TerrainExtract(const char* baseIntermediateFileName, vtkMultiBlockDataSet* output);
   void AppendOutputs();
@@ -263,6 +319,11 @@ private:
   double InitialScale;
 
   double MaskSize;
+  int NumberOfThreads;
+  bool StreamTerrainToDisk;
+  unsigned int MaximumMemoryMB;
+  bool UseExtractionCache;
+  unsigned int MaximumExtractionCacheMB;
 
   bool DetermineIntensityAndColor;
 
@@ -0,0 +1,310 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+#include "vtkCMBBathymetryInterpolator.h"
+
+#include "vtkAlgorithm.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+
+#include <algorithm>
+#include <cmath>
+
+vtkStandardNewMacro(vtkCMBBathymetryInterpolator);
+
+namespace
+{
+struct InterpolateUserData
+{
+  const vtkCMBBathymetryInterpolator* Interpolator;
+  void* Points; // float or double xyz
+  bool IsDouble;
+  vtkIdType NumberOfPoints;
+  vtkIdType ChunkSize;
+  vtkAlgorithm* ProgressAlgorithm;
+};
+
+template <class T>
+void interpolateChunk(
+  const vtkCMBBathymetryInterpolator* interpolator, T* pos, vtkIdType begin, vtkIdType end)
+{
+  pos += 3 * begin;
+  for (vtkIdType i = begin; i < end; ++i, pos += 3)
+  {
+    pos[2] = static_cast<T>(interpolator->GetElevation(pos[0], pos[1]));
+  }
+}
+
+VTK_THREAD_RETURN_TYPE interpolateElevations(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  InterpolateUserData* userData = static_cast<InterpolateUserData*>(info->UserData);
+  vtkIdType stride = info->NumberOfThreads * userData->ChunkSize;
+  vtkIdType numberOfThreadChunks =
+    (userData->NumberOfPoints - info->ThreadID * userData->ChunkSize + stride - 1) / stride;
+  vtkIdType chunksDone = 0;
+  for (vtkIdType begin = info->ThreadID * userData->ChunkSize; begin < userData->NumberOfPoints;
+       begin += stride)
+  {
+    vtkIdType end = std::min(begin + userData->ChunkSize, userData->NumberOfPoints);
+    if (userData->IsDouble)
+    {
+      interpolateChunk(userData->Interpolator, static_cast<double*>(userData->Points), begin, end);
+    }
+    else
+    {
+      interpolateChunk(userData->Interpolator, static_cast<float*>(userData->Points), begin, end);
+    }
+    // thread 0 is the calling thread; it alone reports progress
+    if (info->ThreadID == 0 && userData->ProgressAlgorithm)
+    {
+      userData->ProgressAlgorithm->UpdateProgress(
+        static_cast<double>(++chunksDone) / numberOfThreadChunks);
+    }
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+}
+
+vtkCMBBathymetryInterpolator::vtkCMBBathymetryInterpolator()
+{
+  this->InterpolationMode = AVERAGE;
+  this->ElevationRadius = 1.0;
+  this->InvalidValue = 0.0;
+  this->Power = 2.0;
+  this->Origin[0] = this->Origin[1] = 0.0;
+  this->BucketSize = 1.0;
+  this->Dimensions[0] = this->Dimensions[1] = 0;
+}
+
+vtkCMBBathymetryInterpolator::~vtkCMBBathymetryInterpolator()
+{
+}
+
+void vtkCMBBathymetryInterpolator::SetNumberOfSourcePoints(vtkIdType numberOfPoints)
+{
+  this->SourcePoints.resize(3 * numberOfPoints);
+  this->BucketOffsets.clear();
+  this->Dimensions[0] = this->Dimensions[1] = 0;
+}
+
+void vtkCMBBathymetryInterpolator::BuildLocator()
+{
+  this->BucketOffsets.clear();
+  this->Dimensions[0] = this->Dimensions[1] = 0;
+  vtkIdType numberOfPoints = this->GetNumberOfSourcePoints();
+  if (numberOfPoints == 0)
+  {
+    return;
+  }
+
+  double bounds[4] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+  const double* pt = &this->SourcePoints[0];
+  for (vtkIdType i = 0; i < numberOfPoints; ++i, pt += 3)
+  {
+    bounds[0] = std::min(bounds[0], pt[0]);
+    bounds[1] = std::max(bounds[1], pt[0]);
+    bounds[2] = std::min(bounds[2], pt[1]);
+    bounds[3] = std::max(bounds[3], pt[1]);
+  }
+  this->Origin[0] = bounds[0];
+  this->Origin[1] = bounds[2];
+
+  // buckets about the size of the radius (so a query visits ~9 of them),
+  // but not (many) more buckets than points
+  double width = bounds[1] - bounds[0];
+  double height = bounds[3] - bounds[2];
+  double maxNumberOfBuckets = 2.0 * static_cast<double>(numberOfPoints) + 16.0;
+  this->BucketSize = this->ElevationRadius;
+  double minBucketSize = std::sqrt(width * height / maxNumberOfBuckets);
+  minBucketSize = std::max(minBucketSize, std::max(width, height) / maxNumberOfBuckets);
+  if (!(this->BucketSize > minBucketSize))
+  {
+    this->BucketSize = minBucketSize;
+  }
+  if (!(this->BucketSize > 0.0))
+  {
+    // all the points are at the same location
+    this->BucketSize = 1.0;
+  }
+  this->Dimensions[0] = static_cast<vtkIdType>(width / this->BucketSize) + 1;
+  this->Dimensions[1] = static_cast<vtkIdType>(height / this->BucketSize) + 1;
+
+  // counting sort of the points by bucket
+  std::vector<vtkIdType> bucketIds(numberOfPoints);
+  this->BucketOffsets.assign(this->Dimensions[0] * this->Dimensions[1] + 1, 0);
+  pt = &this->SourcePoints[0];
+  for (vtkIdType i = 0; i < numberOfPoints; ++i, pt += 3)
+  {
+    vtkIdType ix = std::min(static_cast<vtkIdType>((pt[0] - this->Origin[0]) / this->BucketSize),
+      this->Dimensions[0] - 1);
+    vtkIdType iy = std::min(static_cast<vtkIdType>((pt[1] - this->Origin[1]) / this->BucketSize),
+      this->Dimensions[1] - 1);
+    bucketIds[i] = ix + iy * this->Dimensions[0];
+    ++this->BucketOffsets[bucketIds[i] + 1];
+  }
+  for (size_t i = 1; i < this->BucketOffsets.size(); ++i)
+  {
+    this->BucketOffsets[i] += this->BucketOffsets[i - 1];
+  }
+  std::vector<vtkIdType> next(this->BucketOffsets.begin(), this->BucketOffsets.end() - 1);
+  std::vector<double> sorted(this->SourcePoints.size());
+  pt = &this->SourcePoints[0];
+  for (vtkIdType i = 0; i < numberOfPoints; ++i, pt += 3)
+  {
+    std::copy(pt, pt + 3, &sorted[3 * next[bucketIds[i]]++]);
+  }
+  this->SourcePoints.swap(sorted);
+}
+
+double vtkCMBBathymetryInterpolator::GetElevation(double x, double y) const
+{
+  if (this->BucketOffsets.empty())
+  {
+    return this->InvalidValue;
+  }
+
+  // the buckets overlapping the circle
+  double radius = this->ElevationRadius;
+  double range[4] = { std::floor((x - radius - this->Origin[0]) / this->BucketSize),
+    std::floor((x + radius - this->Origin[0]) / this->BucketSize),
+    std::floor((y - radius - this->Origin[1]) / this->BucketSize),
+    std::floor((y + radius - this->Origin[1]) / this->BucketSize) };
+  if (range[1] < 0 || range[0] >= this->Dimensions[0] || range[3] < 0 ||
+    range[2] >= this->Dimensions[1])
+  {
+    return this->InvalidValue;
+  }
+  vtkIdType xMin = range[0] < 0 ? 0 : static_cast<vtkIdType>(range[0]);
+  vtkIdType xMax = std::min(static_cast<vtkIdType>(range[1]), this->Dimensions[0] - 1);
+  vtkIdType yMin = range[2] < 0 ? 0 : static_cast<vtkIdType>(range[2]);
+  vtkIdType yMax = std::min(static_cast<vtkIdType>(range[3]), this->Dimensions[1] - 1);
+
+  double radius2 = radius * radius;
+  double sum = 0.0, weightSum = 0.0;
+  double exactSum = 0.0;
+  vtkIdType exactCount = 0;
+  double closest2 = VTK_DOUBLE_MAX, closestElevation = this->InvalidValue;
+  for (vtkIdType iy = yMin; iy <= yMax; ++iy)
+  {
+    vtkIdType bucket = xMin + iy * this->Dimensions[0];
+    // the buckets of a row are contiguous
+    const double* pt = &this->SourcePoints[0] + 3 * this->BucketOffsets[bucket];
+    const double* end =
+      &this->SourcePoints[0] + 3 * this->BucketOffsets[bucket + xMax - xMin + 1];
+    for (; pt != end; pt += 3)
+    {
+      double dx = pt[0] - x;
+      double dy = pt[1] - y;
+      double dist2 = dx * dx + dy * dy;
+      if (dist2 > radius2)
+      {
+        continue;
+      }
+      switch (this->InterpolationMode)
+      {
+        case NEAREST:
+          if (dist2 < closest2)
+          {
+            closest2 = dist2;
+            closestElevation = pt[2];
+          }
+          break;
+        case INVERSE_DISTANCE:
+          if (dist2 == 0.0)
+          {
+            exactSum += pt[2];
+            ++exactCount;
+          }
+          else
+          {
+            double weight = std::pow(dist2, -0.5 * this->Power);
+            sum += weight * pt[2];
+            weightSum += weight;
+          }
+          break;
+        case AVERAGE:
+        default:
+          sum += pt[2];
+          weightSum += 1.0;
+          break;
+      }
+    }
+  }
+
+  if (this->InterpolationMode == NEAREST)
+  {
+    return closestElevation;
+  }
+  if (exactCount)
+  {
+    return exactSum / exactCount;
+  }
+  //handle the zero size use case
+  return weightSum > 0.0 ? sum / weightSum : this->InvalidValue;
+}
+
+void vtkCMBBathymetryInterpolator::InterpolateElevations(
+  vtkPoints* points, vtkAlgorithm* progressAlgorithm) const
+{
+  vtkIdType numberOfPoints = points ? points->GetNumberOfPoints() : 0;
+  if (numberOfPoints == 0)
+  {
+    return;
+  }
+
+  vtkDataArray* dataArray = points->GetData();
+  if (dataArray->GetDataType() != VTK_FLOAT && dataArray->GetDataType() != VTK_DOUBLE)
+  {
+    double p[3];
+    for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+      points->GetPoint(i, p);
+      p[2] = this->GetElevation(p[0], p[1]);
+      points->SetPoint(i, p);
+      if (progressAlgorithm && (i % 4096) == 0)
+      {
+        progressAlgorithm->UpdateProgress(static_cast<double>(i) / numberOfPoints);
+      }
+    }
+    return;
+  }
+
+  InterpolateUserData userData;
+  userData.Interpolator = this;
+  userData.Points = dataArray->GetVoidPointer(0);
+  userData.IsDouble = dataArray->GetDataType() == VTK_DOUBLE;
+  userData.NumberOfPoints = numberOfPoints;
+  userData.ChunkSize = 4096;
+  userData.ProgressAlgorithm = progressAlgorithm;
+
+  vtkNew<vtkMultiThreader> threader;
+  vtkIdType numberOfChunks = (numberOfPoints + userData.ChunkSize - 1) / userData.ChunkSize;
+  if (numberOfChunks < threader->GetNumberOfThreads())
+  {
+    threader->SetNumberOfThreads(static_cast<int>(numberOfChunks));
+  }
+  threader->SetSingleMethod(interpolateElevations, &userData);
+  threader->SingleMethodExecute();
+  dataArray->Modified();
+}
+
+void vtkCMBBathymetryInterpolator::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "InterpolationMode: " << this->InterpolationMode << std::endl;
+  os << indent << "ElevationRadius: " << this->ElevationRadius << std::endl;
+  os << indent << "InvalidValue: " << this->InvalidValue << std::endl;
+  os << indent << "Power: " << this->Power << std::endl;
+  os << indent << "NumberOfSourcePoints: " << this->GetNumberOfSourcePoints() << std::endl;
+}
@@ -0,0 +1,126 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// .NAME vtkCMBBathymetryInterpolator - elevation from scattered source points
+// .SECTION Description
+// vtkCMBBathymetryInterpolator computes the elevation at a (x, y) location
+// from the source points within ElevationRadius of it (in the xy plane).
+// The source points are binned into a flat 2D grid of buckets (about the
+// size of the radius), so a query only visits the few buckets overlapping
+// its circle and allocates nothing; queries are safe to run from several
+// threads, and InterpolateElevations does so for a whole point set.
+//
+// Typical use:
+//   SetNumberOfSourcePoints(n); SetSourcePoint(i, x, y, z) for each point;
+//   BuildLocator(); then GetElevation() / InterpolateElevations().
+
+#ifndef __vtkCMBBathymetryInterpolator_h
+#define __vtkCMBBathymetryInterpolator_h
+
+#include "cmbSystemConfig.h"
+#include "vtkCMBGeneralModule.h" // For export macro
+#include "vtkObject.h"
+#include <vector> // For source point storage
+
+class vtkAlgorithm;
+class vtkPoints;
+
+class VTKCMBGENERAL_EXPORT vtkCMBBathymetryInterpolator : public vtkObject
+{
+public:
+  static vtkCMBBathymetryInterpolator* New();
+  vtkTypeMacro(vtkCMBBathymetryInterpolator, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  //BTX
+  enum InterpolationModes
+  {
+    // the average elevation of the source points within the radius
+    AVERAGE = 0,
+    // the source points within the radius, weighted by 1 / distance^Power
+    INVERSE_DISTANCE = 1,
+    // the closest source point within the radius
+    NEAREST = 2
+  };
+  //ETX
+
+  // Description:
+  // How the elevation is computed from the source points within the
+  // radius.  Default is AVERAGE.
+  vtkSetClampMacro(InterpolationMode, int, AVERAGE, NEAREST);
+  vtkGetMacro(InterpolationMode, int);
+
+  // Description:
+  // Radius (in the xy plane) of the source points used for a location.
+  // Changing it requires BuildLocator() to be called again.
+  vtkSetMacro(ElevationRadius, double);
+  vtkGetMacro(ElevationRadius, double);
+
+  // Description:
+  // Elevation for locations without any source point within the radius.
+  vtkSetMacro(InvalidValue, double);
+  vtkGetMacro(InvalidValue, double);
+
+  // Description:
+  // Exponent of the distance for INVERSE_DISTANCE weighting.  Default is 2.
+  vtkSetMacro(Power, double);
+  vtkGetMacro(Power, double);
+
+  // Description:
+  // Set the source points (and their elevation).  Call BuildLocator()
+  // once they are all set.
+  void SetNumberOfSourcePoints(vtkIdType numberOfPoints);
+  vtkIdType GetNumberOfSourcePoints() const
+  {
+    return static_cast<vtkIdType>(this->SourcePoints.size() / 3);
+  }
+  void SetSourcePoint(vtkIdType id, double x, double y, double elevation)
+  {
+    double* pt = &this->SourcePoints[3 * id];
+    pt[0] = x;
+    pt[1] = y;
+    pt[2] = elevation;
+  }
+
+  // Description:
+  // Bin the source points; required before any query.
+  void BuildLocator();
+
+  // Description:
+  // Elevation at (x, y); safe to call from several threads at once.
+  double GetElevation(double x, double y) const;
+
+  // Description:
+  // Replace the z of every point by its elevation, in parallel.  If given,
+  // the progress of progressAlgorithm is updated as the points are done.
+  void InterpolateElevations(vtkPoints* points, vtkAlgorithm* progressAlgorithm = 0) const;
+
+protected:
+  vtkCMBBathymetryInterpolator();
+  ~vtkCMBBathymetryInterpolator() override;
+
+  int InterpolationMode;
+  double ElevationRadius;
+  double InvalidValue;
+  double Power;
+
+  // x, y, elevation of each source point; sorted by bucket by BuildLocator
+  std::vector<double> SourcePoints;
+  // the source points of bucket i are BucketOffsets[i] to BucketOffsets[i + 1]
+  std::vector<vtkIdType> BucketOffsets;
+  double Origin[2];
+  double BucketSize;
+  vtkIdType Dimensions[2];
+
+private:
+  vtkCMBBathymetryInterpolator(const vtkCMBBathymetryInterpolator&); // Not implemented.
+  void operator=(const vtkCMBBathymetryInterpolator&);               // Not implemented.
+};
+
+#endif
@@ -15,14 +15,24 @@
 #include "vtkEdgeTable.h"
 #include "vtkExecutive.h"
 #include "vtkFloatArray.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkTriangleStrip.h"
 
+#include <algorithm>
 #include <float.h>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 vtkStandardNewMacro(vtkCMBBandedPolyDataContourFilter);
 
@@ -172,6 +182,522 @@ inline int vtkCMBBandedPolyDataContourFilter::InsertCell(
   return cellId;
 }
 
+namespace
+{
+// An edge by its two point ids, smallest first
+struct BandEdgeKey
+{
+  vtkIdType Min;
+  vtkIdType Max;
+  BandEdgeKey(vtkIdType v1, vtkIdType v2)
+    : Min(v1 < v2 ? v1 : v2)
+    , Max(v1 < v2 ? v2 : v1)
+  {
+  }
+  bool operator==(const BandEdgeKey& other) const
+  {
+    return this->Min == other.Min && this->Max == other.Max;
+  }
+};
+
+struct BandEdgeKeyHash
+{
+  size_t operator()(const BandEdgeKey& key) const
+  {
+    return static_cast<size_t>(key.Min) * 2654435761u ^ static_cast<size_t>(key.Max);
+  }
+};
+
+// The intersection points of an edge are FirstId to FirstId + Count - 1;
+// from the smallest point id of the edge to the largest, unless Reversed.
+struct BandEdgeIntersections
+{
+  vtkIdType FirstId;
+  int Count;
+  bool Reversed;
+};
+
+// An edge clipped by a chunk: clipped from V1 to V2 like ClipEdge, its
+// points are Points[5 * First] ... (x, y, z, t, scalar for each)
+struct BandChunkEdge
+{
+  vtkIdType V1;
+  vtkIdType V2;
+  vtkIdType First;
+  int Count;
+  bool Reversed;
+};
+
+struct BandChunk
+{
+  vtkIdType Begin; // polygons
+  vtkIdType End;
+
+  // intersection points of the edges this chunk saw first
+  std::vector<BandChunkEdge> Edges;
+  std::vector<double> Points;
+
+  // output: polygons (npts, ids...), their scalar, and contour edges (2, ids)
+  std::vector<vtkIdType> Polys;
+  vtkIdType NumberOfPolys;
+  std::vector<float> Scalars;
+  std::vector<vtkIdType> ContourEdges;
+  std::vector<std::string> Warnings;
+
+  // where the output of the chunk goes
+  vtkIdType PolysOffset;
+  vtkIdType CellOffset;
+  vtkIdType ContourEdgesOffset;
+};
+}
+
+// The parallel part of RequestData for polygons (and decomposed strips)
+struct vtkCMBBandedContourWorker
+{
+  enum Phases
+  {
+    CLIP_EDGES,
+    CLIP_POLYGONS,
+    COPY_OUTPUT
+  };
+
+  vtkCMBBandedPolyDataContourFilter* Filter;
+  vtkPolyData* Input;
+  const vtkIdType* Connectivity; // of the polygons
+  std::vector<vtkIdType> CellLocations;
+  vtkPoints* Points;
+  const double* Scalars; // output point scalars
+  int MaxCellSize;
+  bool GenerateBoundary;
+  double SRange[2];
+  std::unordered_map<BandEdgeKey, BandEdgeIntersections, BandEdgeKeyHash> Intersections;
+  std::vector<BandChunk> Chunks;
+  int Phase;
+
+  // output for COPY_OUTPUT
+  vtkIdType* PolysOut;
+  float* ScalarsOut;
+  vtkIdType* ContourEdgesOut;
+
+  void Run(int phase)
+  {
+    if (this->Chunks.empty())
+    {
+      return;
+    }
+    this->Phase = phase;
+    vtkNew<vtkMultiThreader> threader;
+    if (static_cast<int>(this->Chunks.size()) < threader->GetNumberOfThreads())
+    {
+      threader->SetNumberOfThreads(static_cast<int>(this->Chunks.size()));
+    }
+    threader->SetSingleMethod(vtkCMBBandedContourWorker::Execute, this);
+    threader->SingleMethodExecute();
+  }
+
+  static VTK_THREAD_RETURN_TYPE Execute(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    vtkCMBBandedContourWorker* self = static_cast<vtkCMBBandedContourWorker*>(info->UserData);
+    for (size_t c = info->ThreadID; c < self->Chunks.size(); c += info->NumberOfThreads)
+    {
+      switch (self->Phase)
+      {
+        case CLIP_EDGES:
+          self->ClipEdges(self->Chunks[c]);
+          break;
+        case CLIP_POLYGONS:
+          self->ClipPolygons(self->Chunks[c]);
+          break;
+        default:
+          self->CopyOutput(self->Chunks[c]);
+          break;
+      }
+    }
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  // Intersection points of the edges of the chunk's polygons, the same
+  // arithmetic as vtkCMBBandedPolyDataContourFilter::ClipEdge
+  void ClipEdges(BandChunk& chunk)
+  {
+    vtkCMBBandedPolyDataContourFilter* filter = this->Filter;
+    std::unordered_set<BandEdgeKey, BandEdgeKeyHash> seen;
+    double x1[3], x2[3];
+    for (vtkIdType cell = chunk.Begin; cell < chunk.End && !filter->GetAbortExecute(); ++cell)
+    {
+      const vtkIdType* cellPts = this->Connectivity + this->CellLocations[cell];
+      vtkIdType npts = cellPts[0];
+      const vtkIdType* pts = cellPts + 1;
+      for (vtkIdType i = 0; i < npts; i++)
+      {
+        vtkIdType v1 = pts[i];
+        vtkIdType v2 = pts[(i + 1) % npts];
+        if (!seen.insert(BandEdgeKey(v1, v2)).second)
+        {
+          continue;
+        }
+        double s1 = this->Scalars[v1];
+        double s2 = this->Scalars[v2];
+        int idx1 = filter->ComputeScalarIndex(s1);
+        int idx2 = filter->ComputeScalarIndex(s2);
+        int reverse = (v1 < v2 ? 0 : 1);
+        int low = idx1;
+        int count = idx2 - idx1;
+        if (!(s1 <= s2))
+        {
+          low = idx2;
+          count = idx1 - idx2;
+          reverse = (reverse + 1) % 2;
+        }
+        if (count <= 0)
+        {
+          continue;
+        }
+        this->Points->GetPoint(v1, x1);
+        this->Points->GetPoint(v2, x2);
+        BandChunkEdge edge;
+        edge.V1 = v1;
+        edge.V2 = v2;
+        edge.First = static_cast<vtkIdType>(chunk.Points.size() / 5);
+        edge.Count = count;
+        edge.Reversed = reverse != 0;
+        chunk.Edges.push_back(edge);
+        for (int j = 1; j < count + 1; j++)
+        {
+          double t = (filter->ClipValues[low + j] - s1) / (s2 - s1);
+          chunk.Points.push_back(x1[0] + t * (x2[0] - x1[0]));
+          chunk.Points.push_back(x1[1] + t * (x2[1] - x1[1]));
+          chunk.Points.push_back(x1[2] + t * (x2[2] - x1[2]));
+          chunk.Points.push_back(t);
+          // We cannot use directly s1 + t*(s2-s1) as is causes rounding error
+          chunk.Points.push_back(filter->ClipValues[low + j]);
+        }
+      }
+    }
+  }
+
+  // Add a band polygon of the chunk; see InsertCell
+  void InsertCell(BandChunk& chunk, int npts, const vtkIdType* pts, double s)
+  {
+    vtkCMBBandedPolyDataContourFilter* filter = this->Filter;
+    int idx = filter->ComputeScalarIndex(s + filter->ClipTolerance);
+
+    if (!filter->Clipping || (idx >= filter->ClipIndex[0] && idx < filter->ClipIndex[1]))
+    {
+      chunk.Polys.push_back(npts);
+      chunk.Polys.insert(chunk.Polys.end(), pts, pts + npts);
+      chunk.NumberOfPolys++;
+
+      if (filter->ScalarMode == VTK_SCALAR_MODE_INDEX)
+      {
+        chunk.Scalars.push_back(idx);
+      }
+      else
+      {
+        chunk.Scalars.push_back(filter->ClipValues[idx]);
+      }
+    }
+  }
+
+  void InsertContourEdge(BandChunk& chunk, vtkIdType p1, vtkIdType p2)
+  {
+    chunk.ContourEdges.push_back(2);
+    chunk.ContourEdges.push_back(p1);
+    chunk.ContourEdges.push_back(p2);
+  }
+
+  // Cut the chunk's polygons into bands
+  void ClipPolygons(BandChunk& chunk);
+
+  void CopyOutput(BandChunk& chunk)
+  {
+    std::copy(chunk.Polys.begin(), chunk.Polys.end(), this->PolysOut + chunk.PolysOffset);
+    std::copy(chunk.Scalars.begin(), chunk.Scalars.end(), this->ScalarsOut + chunk.CellOffset);
+    if (this->ContourEdgesOut)
+    {
+      std::copy(chunk.ContourEdges.begin(), chunk.ContourEdges.end(),
+        this->ContourEdgesOut + chunk.ContourEdgesOffset);
+    }
+  }
+};
+
+void vtkCMBBandedContourWorker::ClipPolygons(BandChunk& chunk)
+{
+  vtkCMBBandedPolyDataContourFilter* filter = this->Filter;
+  const double* clipValues = filter->ClipValues;
+  int numberOfClipValues = filter->NumberOfClipValues;
+  bool outputEdges = filter->OutputEdges != vtkCMBBandedPolyDataContourFilter::NO_EDGES;
+  std::vector<vtkIdType> newPolygon(this->MaxCellSize);
+  std::vector<double> s(this->MaxCellSize + 1); //scalars at vertices
+  std::vector<int> isContourValue(this->MaxCellSize);
+  std::vector<int> isOriginalVertex(this->MaxCellSize);
+  std::vector<vtkIdType> fullPoly(this->MaxCellSize);
+  std::vector<vtkIdType> intPts(filter->NumberOfClipValues);
+  vtkNew<vtkIdList> edgeNeighbors;
+  int i, idx = 0;
+  vtkIdType v, vR;
+  int intsIdx;
+  vtkIdType numIntPts, intsInc;
+  int intersectionPoint;
+  int mL, mR, m2L, m2R;
+  int numPointsToAdd, numLeftPointsToAdd, numRightPointsToAdd;
+  int numPolyPoints, numFullPts;
+  chunk.NumberOfPolys = 0;
+  for (vtkIdType cell = chunk.Begin; cell < chunk.End && !filter->GetAbortExecute(); ++cell)
+  {
+    const vtkIdType* cellPts = this->Connectivity + this->CellLocations[cell];
+    vtkIdType npts = cellPts[0];
+    const vtkIdType* pts = cellPts + 1;
+
+    //Create a new polygon that includes all the points including the
+    //intersection vertices. This hugely simplifies the logic of the
+    //code.
+    bool onBdy = false;
+    for (intersectionPoint = 0, numFullPts = 0, i = 0; i < npts; i++)
+    {
+      v = pts[i];
+      vR = pts[(i + 1) % npts];
+      if (this->GenerateBoundary)
+      {
+        this->Input->GetCellEdgeNeighbors(cell, v, vR, edgeNeighbors.GetPointer());
+        onBdy = (edgeNeighbors->GetNumberOfIds() == 0) &&
+          (!filter->Clipping || numberOfClipValues > 2);
+      }
+
+      s[numFullPts] = this->Scalars[v];
+      isContourValue[numFullPts] = filter->IsContourValue(s[numFullPts]);
+      isOriginalVertex[numFullPts] = 1;
+      vtkIdType start = -1;
+      double sval = s[numFullPts];
+      if (onBdy)
+      {
+        if (sval >= this->SRange[0] && sval <= this->SRange[1])
+        {
+          start = v;
+        }
+      }
+      fullPoly[numFullPts++] = v;
+
+      //see whether intersection points need to be added.
+      std::unordered_map<BandEdgeKey, BandEdgeIntersections, BandEdgeKeyHash>::const_iterator
+        ints = this->Intersections.find(BandEdgeKey(v, vR));
+      if (ints != this->Intersections.end())
+      {
+        intersectionPoint = 1;
+        numIntPts = ints->second.Count;
+        for (vtkIdType j = 0; j < numIntPts; j++)
+        {
+          intPts[j] = ints->second.Reversed ? ints->second.FirstId + numIntPts - j - 1
+                                            : ints->second.FirstId + j;
+        }
+        if (v < vR)
+        {
+          intsIdx = 0;
+          intsInc = 1;
+        } //order of the edge
+        else
+        {
+          intsIdx = numIntPts - 1;
+          intsInc = (-1);
+        }
+        for (; intsIdx >= 0 && intsIdx < numIntPts; intsIdx += intsInc)
+        {
+          s[numFullPts] = this->Scalars[intPts[intsIdx]];
+          isContourValue[numFullPts] = 1;
+          isOriginalVertex[numFullPts] = 0;
+          if (onBdy)
+          {
+            // Close any currently-open edge:
+            if (start >= 0)
+            {
+              this->InsertContourEdge(chunk, start, intPts[intsIdx]);
+              start = -1;
+            }
+            // Possibly open a new boundary edge
+            if ((s[numFullPts] > this->SRange[0] && s[numFullPts] < this->SRange[1]) ||
+              (s[numFullPts] == this->SRange[0] && sval < s[numFullPts]) ||
+              (s[numFullPts] == this->SRange[1] && sval > s[numFullPts]))
+            {
+              start = intPts[intsIdx];
+            }
+          }
+          fullPoly[numFullPts++] = intPts[intsIdx];
+          sval = s[numFullPts - 1];
+        }
+      }
+      // Close any open boundary edge segments:
+      if (onBdy)
+      {
+        double sR = this->Scalars[vR];
+        if (sR >= this->SRange[0] && sR <= this->SRange[1])
+        {
+          if (start >= 0)
+          {
+            this->InsertContourEdge(chunk, start, vR);
+            start = -1;
+          }
+          else
+          {
+            std::ostringstream warning;
+            warning << "Bad boundary edge! cell " << cell << " edge " << v << " s "
+                    << this->Scalars[v] << " -- ??? -- " << vR << " sR " << sR << " intloc "
+                    << (ints != this->Intersections.end() ? ints->second.FirstId : -1) << "\n";
+            chunk.Warnings.push_back(warning.str());
+          }
+        }
+        else if (start >= 0)
+        {
+          std::ostringstream warning;
+          warning << "Bad boundary edge! cell " << cell << " edge " << v << " -- " << start
+                  << " -- " << vR << "\n";
+          chunk.Warnings.push_back(warning.str());
+          this->InsertContourEdge(chunk, start, vR);
+          start = -1;
+        }
+      }
+    } //for all points and edges
+
+    //Very important: have to find the right starting vertex. The vertex
+    //needs to be one where the contour values increase in both directions.
+    //Really should check whether the vertex is convex.
+    double minValue = VTK_DOUBLE_MAX;
+    for (i = 0; i < numFullPts; i++)
+    {
+      if (isOriginalVertex[i])
+      {
+        if (s[i] < minValue && s[i] <= s[(i + numFullPts - 1) % numFullPts] &&
+          s[i] <= s[(i + 1) % numFullPts])
+        {
+          idx = i;
+          minValue = s[i];
+        }
+      }
+    }
+
+    //Trivial output - completely in a contour band or a triangle
+    if (!intersectionPoint || numFullPts == 3)
+    {
+      this->InsertCell(chunk, npts, pts, s[idx]);
+      continue;
+    }
+
+    // Produce contour edges (if requested) that are along edges of the polygon
+    if (outputEdges)
+    {
+      for (i = 0; i < numFullPts; i++)
+      {
+        if (isContourValue[i] && isContourValue[(i + 1) % numFullPts] &&
+          s[i] == s[(i + 1) % numFullPts] && s[i] < clipValues[numberOfClipValues - 1] &&
+          s[i] > clipValues[0])
+        {
+          this->InsertContourEdge(chunk, fullPoly[i], fullPoly[(i + 1) % numFullPts]);
+        }
+      }
+    }
+
+    //Find the first intersection points in the polygons starting
+    //from this vertex and build a polygon.
+    numPointsToAdd = 1;
+    for (mR = idx, intersectionPoint = 0; !intersectionPoint;)
+    {
+      numPointsToAdd++;
+      mR = (mR + 1) % numFullPts;
+      if (isContourValue[mR] && s[mR] != s[idx])
+        intersectionPoint = 1;
+    }
+    for (mL = idx, intersectionPoint = 0; !intersectionPoint;)
+    {
+      numPointsToAdd++;
+      mL = (mL + numFullPts - 1) % numFullPts;
+      if (isContourValue[mL] && s[mL] != s[idx])
+        intersectionPoint = 1;
+    }
+    for (numPolyPoints = 0, i = 0; i < numPointsToAdd; i++)
+    {
+      newPolygon[numPolyPoints++] = fullPoly[(mL + i) % numFullPts];
+    }
+    if (numPolyPoints >= 3)
+    {
+      this->InsertCell(chunk, numPolyPoints, &newPolygon[0], s[idx]);
+    }
+    // Output the first contour edge (if requested) that cuts through the interior of the polygon
+    if (outputEdges && s[mR] < clipValues[numberOfClipValues - 1] && s[mR] > clipValues[0])
+    {
+      this->InsertContourEdge(chunk, fullPoly[mR], fullPoly[mL]);
+    }
+
+    //We've got an edge (mL,mR) that marks the edge of the region not yet
+    //clipped. We move this edge forward from intersection point to
+    //intersection point.
+    m2R = mR;
+    m2L = mL;
+    while (m2R != m2L)
+    {
+      numPointsToAdd = (mL > mR ? mL - mR + 1 : numFullPts - (mR - mL) + 1);
+      if (numPointsToAdd == 3)
+      { //just a triangle left
+        for (i = 0; i < numPointsToAdd; i++)
+        {
+          newPolygon[i] = fullPoly[(mR + i) % numFullPts];
+        }
+        this->InsertCell(chunk, numPointsToAdd, &newPolygon[0], s[mR]);
+        // Output any remaining contour edges (if requested) that cut through the interior of the polygon
+        if (outputEdges && s[mR] < clipValues[numberOfClipValues - 1] && s[mR] > clipValues[0])
+        {
+          this->InsertContourEdge(chunk, fullPoly[mR], fullPoly[mL]);
+        }
+        break;
+      }
+      else //find the next intersection points
+      {
+        numLeftPointsToAdd = 0;
+        numRightPointsToAdd = 0;
+        for (intersectionPoint = 0; !intersectionPoint && ((m2R + 1) % numFullPts) != m2L;)
+        {
+          numRightPointsToAdd++;
+          m2R = (m2R + 1) % numFullPts;
+          if (isContourValue[m2R])
+            intersectionPoint = 1;
+        }
+        for (intersectionPoint = 0;
+             !intersectionPoint && ((m2L + numFullPts - 1) % numFullPts) != m2R;)
+        {
+          numLeftPointsToAdd++;
+          m2L = (m2L + numFullPts - 1) % numFullPts;
+          if (isContourValue[m2L])
+            intersectionPoint = 1;
+        }
+
+        //specify the polygon vertices. From m2L to mL, then mR to m2R.
+        for (numPolyPoints = 0, i = 0; i < numLeftPointsToAdd; i++)
+        {
+          newPolygon[numPolyPoints++] = fullPoly[(m2L + i) % numFullPts];
+        }
+        newPolygon[numPolyPoints++] = fullPoly[mL];
+        newPolygon[numPolyPoints++] = fullPoly[mR];
+        for (i = 1; i <= numRightPointsToAdd; i++)
+        {
+          newPolygon[numPolyPoints++] = fullPoly[(mR + i) % numFullPts];
+        }
+
+        //add the polygon
+        if (numPolyPoints < 3)
+        {
+          break;
+        }
+        this->InsertCell(chunk, numPolyPoints, &newPolygon[0], s[mR]);
+        if (outputEdges && s[mR] < clipValues[numberOfClipValues - 1] && s[mR] > clipValues[0])
+        {
+          this->InsertContourEdge(chunk, fullPoly[mR], fullPoly[mL]);
+        }
+        mL = m2L;
+        mR = m2R;
+      } //add a polygon
+    }   //while still removing polygons
+  }     //for all polygons
+}
+
 // Create filled contours for polydata
 int vtkCMBBandedPolyDataContourFilter::RequestData(vtkInformation* vtkNotUsed(request),
   vtkInformationVector** inputVector, vtkInformationVector* outputVector)
@@ -349,8 +875,11 @@ int vtkCMBBandedPolyDataContourFilter::RequestData(vtkInformation* vtkNotUsed(re
     {
       for (i = 0; i < (npts - 1); i++)
       {
-        // FIXME: We may call ClipEdge multiple times with the same point IDs (or a swap).
-        // This will result in new output vertices each time where the input edges were sharing vertices.
+        // Clip a segment shared by several lines (in either direction) once
+        if (edgeTable->IsEdge(pts[i], pts[i + 1]) != -1)
+        {
+          continue;
+        }
         numNewPts = newPts->GetNumberOfPoints();
         reverse = this->ClipEdge(pts[i], pts[i + 1], newPts, inScalars, outScalars, pd, outPD);
         numEdgePts = newPts->GetNumberOfPoints() - numNewPts;
@@ -429,10 +958,8 @@ int vtkCMBBandedPolyDataContourFilter::RequestData(vtkInformation* vtkNotUsed(re
   // Polygons are assumed convex and chopped into filled, convex polygons.
   // Triangle strips are treated similarly.
 
-  vtkIdList* edgeNeighbors = 0;
   if (generateBoundary)
   {
-    edgeNeighbors = vtkIdList::New();
     input->BuildLinks();
   }
   int numPolys = input->GetPolys()->GetNumberOfCells();
@@ -444,10 +971,6 @@ int vtkCMBBandedPolyDataContourFilter::RequestData(vtkInformation* vtkNotUsed(re
     // to largest). These will later be connected into convex polygons
     // which represent a filled region in the cell.
     //
-    edgeTable->InitEdgeInsertion(
-      numPts, 1); //store attributes on edge // FIXME: No reuse of line segment vertices
-    intList->Reset();
-
     vtkCellArray* polys = input->GetPolys();
     vtkCellArray* tmpPolys = NULL;
 
@@ -456,7 +979,6 @@ int vtkCMBBandedPolyDataContourFilter::RequestData(vtkInformation* vtkNotUsed(re
     if (this->OutputEdges != NO_EDGES)
     {
       contourEdges = vtkCellArray::New();
-      contourEdges->Allocate(numCells);
       this->GetContourEdgesOutput()->SetLines(contourEdges);
       contourEdges->Delete();
       this->GetContourEdgesOutput()->SetPoints(newPts);
@@ -471,12 +993,6 @@ int vtkCMBBandedPolyDataContourFilter::RequestData(vtkInformation* vtkNotUsed(re
     }
     maxCellSize *= (1 + this->NumberOfClipValues);
 
-    vtkIdType* newPolygon = new vtkIdType[maxCellSize];
-    double* s = new double[maxCellSize]; //scalars at vertices
-    int* isContourValue = new int[maxCellSize];
-    int* isOriginalVertex = new int[maxCellSize];
-    vtkIdType* fullPoly = new vtkIdType[maxCellSize];
-
     // Lump strips and polygons together.
     // Decompose strips into triangles.
     if (numStrips > 0)
@@ -498,347 +1014,127 @@ int vtkCMBBandedPolyDataContourFilter::RequestData(vtkInformation* vtkNotUsed(re
       polys = tmpPolys;
     }
 
-    // Process polygons to produce edge intersections
-    //
+    // The polygons are processed in chunks, in parallel
+    vtkCMBBandedContourWorker worker;
+    worker.Filter = this;
+    worker.Input = input;
+    worker.Connectivity = polys->GetPointer();
+    worker.Points = newPts;
+    worker.Scalars = outScalars->GetPointer(0);
+    worker.MaxCellSize = maxCellSize;
+    worker.GenerateBoundary = generateBoundary != 0;
+    worker.SRange[0] = worker.SRange[1] = 0.0;
+    worker.PolysOut = NULL;
+    worker.ScalarsOut = NULL;
+    worker.ContourEdgesOut = NULL;
     numPolys = polys->GetNumberOfCells();
-    vtkIdType updateCount = numPolys / 20 + 1;
-    vtkIdType count = 0;
-    for (polys->InitTraversal(); polys->GetNextCell(npts, pts) && !abort;
-         abort = this->GetAbortExecute())
+    worker.CellLocations.resize(numPolys);
+    vtkIdType location = 0;
+    for (i = 0; i < numPolys; i++)
     {
-      if (!(++count % updateCount))
-      {
-        this->UpdateProgress(0.1 + 0.45 * (static_cast<double>(count) / numPolys));
-      }
+      worker.CellLocations[i] = location;
+      location += worker.Connectivity[location] + 1;
+    }
+    const vtkIdType chunkSize = 4096;
+    worker.Chunks.resize((numPolys + chunkSize - 1) / chunkSize);
+    for (size_t c = 0; c < worker.Chunks.size(); c++)
+    {
+      worker.Chunks[c].Begin = static_cast<vtkIdType>(c) * chunkSize;
+      worker.Chunks[c].End = std::min(worker.Chunks[c].Begin + chunkSize, vtkIdType(numPolys));
+    }
 
-      for (i = 0; i < npts; i++)
+    // Process polygons to produce edge intersections, each chunk for its
+    // own edges; then number them in chunk order, keeping the points of an
+    // edge seen by several chunks from the first one (as if the polygons
+    // were processed in order)
+    worker.Run(vtkCMBBandedContourWorker::CLIP_EDGES);
+    this->UpdateProgress(0.4);
+    for (size_t c = 0; c < worker.Chunks.size(); c++)
+    {
+      BandChunk& chunk = worker.Chunks[c];
+      for (size_t e = 0; e < chunk.Edges.size(); e++)
       {
-        v = pts[i];
-        vR = pts[(i + 1) % npts];
-        if (edgeTable->IsEdge(v, vR) == -1)
+        const BandChunkEdge& edge = chunk.Edges[e];
+        BandEdgeIntersections ints;
+        ints.FirstId = newPts->GetNumberOfPoints();
+        ints.Count = edge.Count;
+        ints.Reversed = edge.Reversed;
+        if (!worker.Intersections.insert(std::make_pair(BandEdgeKey(edge.V1, edge.V2), ints))
+               .second)
         {
-          numNewPts = newPts->GetNumberOfPoints();
-          reverse = this->ClipEdge(v, vR, newPts, inScalars, outScalars, pd, outPD);
-          numEdgePts = newPts->GetNumberOfPoints() - numNewPts;
-          if (numEdgePts > 0)
-          {
-            if (!reverse)
-            {
-              for (j = 0; j < numEdgePts; j++)
-                fullPoly[j] = numNewPts + j;
-            }
-            else
-            {
-              for (j = 0; j < numEdgePts; j++)
-                fullPoly[j] = numNewPts + numEdgePts - j - 1;
-            }
-            intList->InsertNextCell(numEdgePts, fullPoly);
-            edgeTable->InsertEdge(v, vR, //associate ints with edge
-              intList->GetInsertLocation(numEdgePts));
-          }
-          else //no intersection points along the edge
-          {
-            edgeTable->InsertEdge(v, vR, -1); //-1 means no points
-          }
-        } //if edge not processed yet
+          continue;
+        }
+        for (j = 0; j < edge.Count; j++)
+        {
+          const double* x = &chunk.Points[5 * (edge.First + j)];
+          vtkIdType ptId = newPts->InsertNextPoint(x);
+          outPD->InterpolateEdge(pd, ptId, edge.V1, edge.V2, x[3]);
+          outScalars->InsertTuple1(ptId, x[4]);
+        }
       }
-    } //for all polygons
+      std::vector<BandChunkEdge>().swap(chunk.Edges);
+      std::vector<double>().swap(chunk.Points);
+    }
+    this->UpdateProgress(0.55);
 
     // Process polygons to produce output triangles
     //
-    vtkCellArray* newPolys = vtkCellArray::New();
-    newPolys->Allocate(polys->GetSize());
-    int intersectionPoint;
-    int mL, mR, m2L, m2R;
-    int numPointsToAdd, numLeftPointsToAdd, numRightPointsToAdd;
-    int numPolyPoints, numFullPts;
-    count = 0;
-    double srange[2];
     if (generateBoundary)
     {
       if (this->Clipping)
       {
-        srange[0] = this->ClipValues[1];
-        srange[1] = this->ClipValues[this->NumberOfClipValues - 2];
+        worker.SRange[0] = this->ClipValues[1];
+        worker.SRange[1] = this->ClipValues[this->NumberOfClipValues - 2];
       }
       else
       {
-        srange[0] = this->ClipValues[0];
-        srange[1] = this->ClipValues[this->NumberOfClipValues - 1];
+        worker.SRange[0] = this->ClipValues[0];
+        worker.SRange[1] = this->ClipValues[this->NumberOfClipValues - 1];
       }
     }
-    for (polys->InitTraversal(); polys->GetNextCell(npts, pts) && !abort;
-         abort = this->GetAbortExecute())
-    {
-      if (!(++count % updateCount))
-      {
-        this->UpdateProgress(0.55 + 0.45 * (static_cast<double>(count) / numPolys));
-      }
+    worker.Scalars = outScalars->GetPointer(0);
+    worker.Run(vtkCMBBandedContourWorker::CLIP_POLYGONS);
+    this->UpdateProgress(0.9);
 
-      //Create a new polygon that includes all the points including the
-      //intersection vertices. This hugely simplifies the logic of the
-      //code.
-      bool onBdy = false;
-      for (intersectionPoint = 0, numFullPts = 0, i = 0; i < npts; i++)
-      {
-        v = pts[i];
-        vR = pts[(i + 1) % npts];
-        if (generateBoundary)
-        {
-          input->GetCellEdgeNeighbors(count - 1, v, vR, edgeNeighbors);
-          onBdy = (edgeNeighbors->GetNumberOfIds() == 0) &&
-            (!this->Clipping || this->NumberOfClipValues > 2);
-        }
-
-        s[numFullPts] = outScalars->GetTuple1(v);
-        isContourValue[numFullPts] = this->IsContourValue(s[numFullPts]);
-        isOriginalVertex[numFullPts] = 1;
-        vtkIdType start = -1;
-        double sval = s[numFullPts];
-        if (onBdy)
-        {
-          if (sval >= srange[0] && sval <= srange[1])
-          {
-            start = v;
-          }
-        }
-        fullPoly[numFullPts++] = v;
-
-        //see whether intersection points need to be added.
-        if ((intLoc = edgeTable->IsEdge(v, vR)) != -1)
-        {
-          intersectionPoint = 1;
-          intList->GetCell(intLoc, numIntPts, intPts);
-          if (v < vR)
-          {
-            intsIdx = 0;
-            intsInc = 1;
-          } //order of the edge
-          else
-          {
-            intsIdx = numIntPts - 1;
-            intsInc = (-1);
-          }
-          for (; intsIdx >= 0 && intsIdx < numIntPts; intsIdx += intsInc)
-          {
-            s[numFullPts] = outScalars->GetTuple1(intPts[intsIdx]);
-            isContourValue[numFullPts] = 1;
-            isOriginalVertex[numFullPts] = 0;
-            if (onBdy)
-            {
-              // Close any currently-open edge:
-              if (start >= 0)
-              {
-                contourEdges->InsertNextCell(2);
-                contourEdges->InsertCellPoint(start);
-                contourEdges->InsertCellPoint(intPts[intsIdx]);
-                start = -1;
-              }
-              // Possibly open a new boundary edge
-              if ((s[numFullPts] > srange[0] && s[numFullPts] < srange[1]) ||
-                (s[numFullPts] == srange[0] && sval < s[numFullPts]) ||
-                (s[numFullPts] == srange[1] && sval > s[numFullPts]))
-              {
-                start = intPts[intsIdx];
-              }
-            }
-            fullPoly[numFullPts++] = intPts[intsIdx];
-            sval = s[numFullPts];
-          }
-        }
-        // Close any open boundary edge segments:
-        if (onBdy)
-        {
-          double sR = outScalars->GetTuple1(vR);
-          if (sR >= srange[0] && sR <= srange[1])
-          {
-            if (start >= 0)
-            {
-              contourEdges->InsertNextCell(2);
-              contourEdges->InsertCellPoint(start);
-              contourEdges->InsertCellPoint(vR);
-              start = -1;
-            }
-            else
-            {
-              vtkWarningMacro(<< "Bad boundary edge! cell " << (count - 1) << " edge " << v << " s "
-                              << inScalars->GetTuple1(v) << " -- ??? -- " << vR << " sR " << sR
-                              << " intloc " << edgeTable->IsEdge(v, vR) << "\n");
-            }
-          }
-          else if (start >= 0)
-          {
-            vtkWarningMacro(<< "Bad boundary edge! cell " << (count - 1) << " edge " << v << " -- "
-                            << start << " -- " << vR << "\n");
-            contourEdges->InsertNextCell(2);
-            contourEdges->InsertCellPoint(start);
-            contourEdges->InsertCellPoint(vR);
-            start = -1;
-          }
-        }
-      } //for all points and edges
-
-      //Very important: have to find the right starting vertex. The vertex
-      //needs to be one where the contour values increase in both directions.
-      //Really should check whether the vertex is convex.
-      double minValue = VTK_DOUBLE_MAX;
-      for (i = 0; i < numFullPts; i++)
-      {
-        if (isOriginalVertex[i])
-        {
-          if (s[i] < minValue && s[i] <= s[(i + numFullPts - 1) % numFullPts] &&
-            s[i] <= s[(i + 1) % numFullPts])
-          {
-            idx = i;
-            minValue = s[i];
-          }
-        }
-      }
-
-      //Trivial output - completely in a contour band or a triangle
-      if (!intersectionPoint || numFullPts == 3)
-      {
-        cellId = this->InsertCell(newPolys, npts, pts, cellId, s[idx], newScalars);
-        continue;
-      }
-
-      // Produce contour edges (if requested) that are along edges of the polygon
-      if (this->OutputEdges != NO_EDGES)
-      {
-        for (i = 0; i < numFullPts; i++)
-        {
-          if (isContourValue[i] && isContourValue[(i + 1) % numFullPts] &&
-            s[i] == s[(i + 1) % numFullPts] &&
-            s[i] < this->ClipValues[this->NumberOfClipValues - 1] && s[i] > this->ClipValues[0])
-          {
-            contourEdges->InsertNextCell(2);
-            contourEdges->InsertCellPoint(fullPoly[i]);
-            contourEdges->InsertCellPoint(fullPoly[(i + 1) % numFullPts]);
-          }
-        }
-      }
-
-      //Find the first intersection points in the polygons starting
-      //from this vertex and build a polygon.
-      numPointsToAdd = 1;
-      for (mR = idx, intersectionPoint = 0; !intersectionPoint;)
-      {
-        numPointsToAdd++;
-        mR = (mR + 1) % numFullPts;
-        if (isContourValue[mR] && s[mR] != s[idx])
-          intersectionPoint = 1;
-      }
-      for (mL = idx, intersectionPoint = 0; !intersectionPoint;)
-      {
-        numPointsToAdd++;
-        mL = (mL + numFullPts - 1) % numFullPts;
-        if (isContourValue[mL] && s[mL] != s[idx])
-          intersectionPoint = 1;
-      }
-      for (numPolyPoints = 0, i = 0; i < numPointsToAdd; i++)
-      {
-        newPolygon[numPolyPoints++] = fullPoly[(mL + i) % numFullPts];
-      }
-      if (numPolyPoints >= 3)
-      {
-        cellId = this->InsertCell(newPolys, numPolyPoints, newPolygon, cellId, s[idx], newScalars);
-      }
-      // Output the first contour edge (if requested) that cuts through the interior of the polygon
-      if (this->OutputEdges != NO_EDGES && s[mR] < this->ClipValues[this->NumberOfClipValues - 1] &&
-        s[mR] > this->ClipValues[0])
+    // Gather the output of the chunks
+    vtkIdType polysSize = 0, numNewPolys = 0, contourEdgesSize = 0;
+    for (size_t c = 0; c < worker.Chunks.size(); c++)
+    {
+      BandChunk& chunk = worker.Chunks[c];
+      chunk.PolysOffset = polysSize;
+      chunk.CellOffset = cellId + numNewPolys;
+      chunk.ContourEdgesOffset = contourEdgesSize;
+      polysSize += static_cast<vtkIdType>(chunk.Polys.size());
+      numNewPolys += chunk.NumberOfPolys;
+      contourEdgesSize += static_cast<vtkIdType>(chunk.ContourEdges.size());
+      for (size_t w = 0; w < chunk.Warnings.size(); w++)
       {
-        contourEdges->InsertNextCell(2);
-        contourEdges->InsertCellPoint(fullPoly[mR]);
-        contourEdges->InsertCellPoint(fullPoly[mL]);
+        vtkWarningMacro(<< chunk.Warnings[w]);
       }
+    }
+    vtkNew<vtkIdTypeArray> newPolysData;
+    newPolysData->SetNumberOfValues(polysSize);
+    newScalars->SetNumberOfValues(cellId + numNewPolys);
+    vtkNew<vtkIdTypeArray> contourEdgesData;
+    worker.PolysOut = newPolysData->GetPointer(0);
+    worker.ScalarsOut = newScalars->GetPointer(0);
+    if (contourEdges)
+    {
+      contourEdgesData->SetNumberOfValues(contourEdgesSize);
+      worker.ContourEdgesOut = contourEdgesData->GetPointer(0);
+    }
+    worker.Run(vtkCMBBandedContourWorker::COPY_OUTPUT);
+    cellId += numNewPolys;
 
-      //We've got an edge (mL,mR) that marks the edge of the region not yet
-      //clipped. We move this edge forward from intersection point to
-      //intersection point.
-      m2R = mR;
-      m2L = mL;
-      while (m2R != m2L)
-      {
-        numPointsToAdd = (mL > mR ? mL - mR + 1 : numFullPts - (mR - mL) + 1);
-        if (numPointsToAdd == 3)
-        { //just a triangle left
-          for (i = 0; i < numPointsToAdd; i++)
-          {
-            newPolygon[i] = fullPoly[(mR + i) % numFullPts];
-          }
-          cellId =
-            this->InsertCell(newPolys, numPointsToAdd, newPolygon, cellId, s[mR], newScalars);
-          // Output any remaining contour edges (if requested) that cut through the interior of the polygon
-          if (this->OutputEdges != NO_EDGES &&
-            s[mR] < this->ClipValues[this->NumberOfClipValues - 1] && s[mR] > this->ClipValues[0])
-          {
-            contourEdges->InsertNextCell(2);
-            contourEdges->InsertCellPoint(fullPoly[mR]);
-            contourEdges->InsertCellPoint(fullPoly[mL]);
-          }
-          break;
-        }
-        else //find the next intersection points
-        {
-          numLeftPointsToAdd = 0;
-          numRightPointsToAdd = 0;
-          for (intersectionPoint = 0; !intersectionPoint && ((m2R + 1) % numFullPts) != m2L;)
-          {
-            numRightPointsToAdd++;
-            m2R = (m2R + 1) % numFullPts;
-            if (isContourValue[m2R])
-              intersectionPoint = 1;
-          }
-          for (intersectionPoint = 0;
-               !intersectionPoint && ((m2L + numFullPts - 1) % numFullPts) != m2R;)
-          {
-            numLeftPointsToAdd++;
-            m2L = (m2L + numFullPts - 1) % numFullPts;
-            if (isContourValue[m2L])
-              intersectionPoint = 1;
-          }
-
-          //specify the polygon vertices. From m2L to mL, then mR to m2R.
-          for (numPolyPoints = 0, i = 0; i < numLeftPointsToAdd; i++)
-          {
-            newPolygon[numPolyPoints++] = fullPoly[(m2L + i) % numFullPts];
-          }
-          newPolygon[numPolyPoints++] = fullPoly[mL];
-          newPolygon[numPolyPoints++] = fullPoly[mR];
-          for (i = 1; i <= numRightPointsToAdd; i++)
-          {
-            newPolygon[numPolyPoints++] = fullPoly[(mR + i) % numFullPts];
-          }
-
-          //add the polygon
-          if (numPolyPoints < 3)
-          {
-            break;
-          }
-          cellId = this->InsertCell(newPolys, numPolyPoints, newPolygon, cellId, s[mR], newScalars);
-          if (this->OutputEdges != NO_EDGES &&
-            s[mR] < this->ClipValues[this->NumberOfClipValues - 1] && s[mR] > this->ClipValues[0])
-          {
-            contourEdges->InsertNextCell(2);
-            contourEdges->InsertCellPoint(fullPoly[mR]);
-            contourEdges->InsertCellPoint(fullPoly[mL]);
-          }
-          mL = m2L;
-          mR = m2R;
-        } //add a polygon
-      }   //while still removing polygons
-    }     //for all polygons
-
-    delete[] s;
-    delete[] newPolygon;
-    delete[] isContourValue;
-    delete[] isOriginalVertex;
-    delete[] fullPoly;
+    vtkCellArray* newPolys = vtkCellArray::New();
+    newPolys->SetCells(numNewPolys, newPolysData.GetPointer());
+    if (contourEdges)
+    {
+      contourEdges->SetCells(contourEdgesSize / 3, contourEdgesData.GetPointer());
+    }
 
     output->SetPolys(newPolys);
     newPolys->Delete();
-    if (edgeNeighbors)
-      edgeNeighbors->Delete();
     if (tmpPolys)
     {
       tmpPolys->Delete();
@@ -26,6 +26,12 @@
 // range values. These extra contour bands can be prevented from being output
 // by turning clipping on.
 //
+// Polygons (and triangle strips) are clipped in parallel chunks: each chunk
+// computes the intersection points of the edges it sees first, those are
+// numbered in chunk order (so a shared edge gets its points once), and the
+// chunks then cut their polygons into bands in parallel.  The output is the
+// same as processing the polygons one after the other.
+//
 // .SECTION See Also
 // vtkClipDataSet vtkClipPolyData vtkClipVolume vtkContourFilter
 //
@@ -44,6 +50,10 @@ class vtkDataArray;
 class vtkFloatArray;
 class vtkDoubleArray;
 
+//BTX
+struct vtkCMBBandedContourWorker;
+//ETX
+
 #define VTK_SCALAR_MODE_INDEX 0
 #define VTK_SCALAR_MODE_VALUE 1
 
@@ -157,6 +167,10 @@ protected:
   int OutputEdges;
 
 private:
+  //BTX
+  friend struct vtkCMBBandedContourWorker;
+  //ETX
+
   vtkCMBBandedPolyDataContourFilter(const vtkCMBBandedPolyDataContourFilter&); // Not implemented.
   void operator=(const vtkCMBBandedPolyDataContourFilter&);                    // Not implemented.
 };
@@ -183,10 +183,20 @@ int vtkCMBInitialValueProblemSolver::ComputeNextStepWithTestLocations(double* xp
 
 bool vtkCMBInitialValueProblemSolver::InitializeTestLocations(double* xprev)
 {
-  this->TestLocations.clear();
+  // this is done for every step, so reuse the test locations of the
+  // previous one
+  while (this->TestLocations.size() > static_cast<size_t>(this->NumberOfTestLocations))
+  {
+    delete this->TestLocations.back();
+    this->TestLocations.pop_back();
+  }
+  while (this->TestLocations.size() < static_cast<size_t>(this->NumberOfTestLocations))
+  {
+    this->TestLocations.push_back(new TestLocation());
+  }
   for (int i = 0; i < this->NumberOfTestLocations; i++)
   {
-    TestLocation* testLoc = new TestLocation();
+    TestLocation* testLoc = this->TestLocations[i];
     for (int j = 0; j < 3; j++)
     {
       testLoc->seed[j] = xprev[j];
@@ -197,12 +207,34 @@ bool vtkCMBInitialValueProblemSolver::InitializeTestLocations(double* xprev)
     if (!this->GetTestLocationCellInfo(testLoc->pos, testLoc->velocity, testLoc->cellId))
     {
       // should be use some algorithm to find another test location ???
+      testLoc->velocity[0] = testLoc->velocity[1] = testLoc->velocity[2] = 0.0;
+      testLoc->cellId = -1;
     }
-    this->TestLocations.push_back(testLoc);
   }
   return true;
 }
 
+void vtkCMBInitialValueProblemSolver::CopyParameters(vtkCMBInitialValueProblemSolver* from)
+{
+  if (!from || from == this)
+  {
+    return;
+  }
+  this->ClearTestLocations();
+  this->NumberOfTestLocations = from->NumberOfTestLocations;
+  this->DefaultRelativeOffset = from->DefaultRelativeOffset;
+  for (std::vector<double*>::iterator iter = from->TestLocationOffsets.begin();
+       iter != from->TestLocationOffsets.end(); ++iter)
+  {
+    double* offset = new double[3];
+    offset[0] = (*iter)[0];
+    offset[1] = (*iter)[1];
+    offset[2] = (*iter)[2];
+    this->TestLocationOffsets.push_back(offset);
+  }
+  this->Modified();
+}
+
 void vtkCMBInitialValueProblemSolver::SetNumberOfTestLocations(int val)
 {
   if (this->NumberOfTestLocations != val)
@@ -126,6 +126,11 @@ public:
   virtual void GetRelativeOffsetOfTestLocation(int index, double* OffsetOfTestLocation);
   virtual void SetRelativeOffsetOfTestLocation(int index, double* OffsetOfTestLocation);
 
+  // Description:
+  // Copy the test location settings (number and offsets) of another solver,
+  // e.g. into the per thread instances created by vtkCMBStreamTracer.
+  virtual void CopyParameters(vtkCMBInitialValueProblemSolver* from);
+
   // Description:
   // Get the xyz-position of the test location given its index and relative offset
   virtual void GetTestLocationPosition(
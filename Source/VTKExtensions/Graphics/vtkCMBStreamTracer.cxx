@@ -13,9 +13,11 @@
 #include "vtkCMBInitialValueProblemSolver.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include "vtkCellLocatorInterpolatedVelocityField.h"
 #include "vtkCharArray.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataPipeline.h"
+#include "vtkCompositeInterpolatedVelocityField.h"
 #include "vtkDataSetAttributes.h"
 #include "vtkDoubleArray.h"
 #include "vtkDoubleArray.h"
@@ -23,11 +25,14 @@
 #include "vtkFloatArray.h"
 #include "vtkGenericCell.h"
 #include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkIntArray.h"
 #include "vtkMath.h"
 #include "vtkMultiBlockDataSet.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkOutputWindow.h"
 #include "vtkPointData.h"
@@ -35,11 +40,563 @@
 #include "vtkPolyData.h"
 #include "vtkPolyLine.h"
 #include "vtkSmartPointer.h"
+#include "vtkUnstructuredGrid.h"
 
 #include "vtkCMBInitialValueProblemSolver.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <vector>
+
+namespace
+{
+// A streamline traced from one seed
+struct vtkCMBStreamTrace
+{
+  vtkCMBStreamTrace()
+    : ReturnValue(vtkStreamTracer::OUT_OF_LENGTH)
+    , Propagation(0.0)
+    , NumberOfSteps(0)
+    , Finished(false)
+    , HasLastPoint(false)
+    , HasStepSize(false)
+    , LastUsedStepSize(0.0)
+  {
+  }
+
+  vtkIdType GetNumberOfPoints() const { return static_cast<vtkIdType>(this->Times.size()); }
+
+  void AddPoint(const double x[3], double time, vtkDataSet* input, vtkIdList* cellPointIds,
+    const double* weights)
+  {
+    this->Points.insert(this->Points.end(), x, x + 3);
+    this->Times.push_back(time);
+    this->DataSets.push_back(input);
+    if (this->CellOffsets.empty())
+    {
+      this->CellOffsets.push_back(0);
+    }
+    vtkIdType numCellPts = cellPointIds->GetNumberOfIds();
+    this->CellPointIds.insert(this->CellPointIds.end(), cellPointIds->GetPointer(0),
+      cellPointIds->GetPointer(0) + numCellPts);
+    this->Weights.insert(this->Weights.end(), weights, weights + numCellPts);
+    this->CellOffsets.push_back(static_cast<vtkIdType>(this->CellPointIds.size()));
+  }
+
+  std::vector<double> Points; // xyz
+  std::vector<double> Times;
+  // the point data of point i is interpolated from DataSets[i], with the
+  // ids and weights (of the points of its cell) CellOffsets[i] to
+  // CellOffsets[i + 1]
+  std::vector<vtkDataSet*> DataSets;
+  std::vector<vtkIdType> CellOffsets;
+  std::vector<vtkIdType> CellPointIds;
+  std::vector<double> Weights;
+  int ReturnValue;
+  double Propagation;
+  vtkIdType NumberOfSteps;
+  bool Finished; // false if the seed was skipped
+  bool HasLastPoint;
+  double LastPoint[3];
+  bool HasStepSize;
+  double LastUsedStepSize;
+};
+}
+
+// Traces chunks of seeds in parallel, each thread with its own interpolator
+// and integrator, into one vtkCMBStreamTrace per seed.
+struct vtkCMBStreamTracerWorker
+{
+  vtkCMBStreamTracerWorker()
+    : Abort(0)
+  {
+  }
+
+  vtkCMBStreamTracer* Tracer;
+  vtkDataArray* SeedSource;
+  vtkIdList* SeedIds;
+  vtkIntArray* IntegrationDirections;
+  vtkAbstractInterpolatedVelocityField* Function;
+  // the interpolator of each thread (Function, then clones of it), and its
+  // integrator
+  std::vector<vtkAbstractInterpolatedVelocityField*> Functions;
+  std::vector<vtkInitialValueProblemSolver*> Integrators;
+  int MaxCellSize;
+  // initial propagation and number of steps, of the first seed traced (the
+  // first one in the field)
+  double Propagation;
+  vtkIdType NumberOfSteps;
+  vtkIdType FirstLine;
+  std::vector<vtkCMBStreamTrace> Traces;
+  std::atomic<int> Abort;
+
+  static const vtkIdType ChunkSize = 16;
+
+  vtkIdType GetNumberOfChunks() const
+  {
+    return (static_cast<vtkIdType>(this->Traces.size()) + ChunkSize - 1) / ChunkSize;
+  }
+
+  void Run()
+  {
+    vtkIdType numberOfChunks = this->GetNumberOfChunks();
+    if (numberOfChunks == 0)
+    {
+      return;
+    }
+    vtkNew<vtkMultiThreader> threader;
+    int numberOfThreads = this->Tracer->NumberOfThreads > 0
+      ? this->Tracer->NumberOfThreads
+      : threader->GetGlobalDefaultNumberOfThreads();
+    // the other threads need a copy of the interpolator, with its datasets
+    if (!vtkCompositeInterpolatedVelocityField::SafeDownCast(this->Function))
+    {
+      numberOfThreads = 1;
+    }
+    if (numberOfChunks < numberOfThreads)
+    {
+      numberOfThreads = static_cast<int>(numberOfChunks);
+    }
+    threader->SetNumberOfThreads(numberOfThreads);
+
+    // what the threads would otherwise build lazily, and concurrently, is
+    // built here: the bounds, cells and links of the (shared) datasets, and
+    // the interpolators of the threads with their cell locators
+    this->Functions.assign(1, this->Function);
+    if (numberOfThreads > 1)
+    {
+      this->PrepareDataSets();
+      for (int i = 1; i < numberOfThreads; ++i)
+      {
+        this->Functions.push_back(this->CloneFunction());
+      }
+      for (int i = 0; i < numberOfThreads; ++i)
+      {
+        this->BuildLocators(this->Functions[i]);
+      }
+    }
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      this->Integrators.push_back(this->NewIntegrator(this->Functions[i]));
+    }
+
+    threader->SetSingleMethod(vtkCMBStreamTracerWorker::Execute, this);
+    threader->SingleMethodExecute();
+
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      this->Integrators[i]->Delete();
+      if (i > 0)
+      {
+        this->Functions[i]->Delete();
+      }
+    }
+    this->Functions.clear();
+    this->Integrators.clear();
+  }
+
+  static VTK_THREAD_RETURN_TYPE Execute(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    vtkCMBStreamTracerWorker* self = static_cast<vtkCMBStreamTracerWorker*>(info->UserData);
+
+    // the first thread uses the interpolator of the filter, the others a
+    // clone of it (the interpolator caches the last cell it found)
+    vtkAbstractInterpolatedVelocityField* func = self->Functions[info->ThreadID];
+    vtkInitialValueProblemSolver* integrator = self->Integrators[info->ThreadID];
+    vtkGenericCell* cell = vtkGenericCell::New();
+    std::vector<double> weights(std::max(self->MaxCellSize, 1));
+    bool reportProgress = info->ThreadID == 0;
+
+    vtkIdType numberOfSeeds = static_cast<vtkIdType>(self->Traces.size());
+    vtkIdType numberOfChunks = self->GetNumberOfChunks();
+    for (vtkIdType c = info->ThreadID; c < numberOfChunks && !self->Abort;
+         c += info->NumberOfThreads)
+    {
+      vtkIdType end = std::min((c + 1) * ChunkSize, numberOfSeeds);
+      for (vtkIdType currentLine = c * ChunkSize; currentLine < end; currentLine++)
+      {
+        if (!self->Trace(currentLine, func, integrator, cell, &weights[0], reportProgress))
+        {
+          break;
+        }
+      }
+    }
+
+    cell->Delete();
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  // Build the bounds, cells and (if the interpolator finds cells through
+  // the datasets rather than its own cell locators) the links and point
+  // locator of the input datasets
+  void PrepareDataSets()
+  {
+    bool usesCellLocators =
+      vtkCellLocatorInterpolatedVelocityField::SafeDownCast(this->Function) != 0;
+    vtkCompositeDataIterator* iter = this->Tracer->InputData->NewIterator();
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      vtkDataSet* input = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject());
+      if (!input)
+      {
+        continue;
+      }
+      input->ComputeBounds();
+      vtkPolyData* polyData = vtkPolyData::SafeDownCast(input);
+      if (polyData && polyData->NeedToBuildCells())
+      {
+        polyData->BuildCells();
+      }
+      if (usesCellLocators || input->GetNumberOfCells() == 0)
+      {
+        continue;
+      }
+      if (polyData)
+      {
+        polyData->BuildLinks();
+      }
+      else if (vtkUnstructuredGrid::SafeDownCast(input))
+      {
+        vtkUnstructuredGrid::SafeDownCast(input)->BuildLinks();
+      }
+      // the point locator of a point set is built by its first search
+      double x[3];
+      input->GetPoint(0, x);
+      input->FindPoint(x);
+    }
+    iter->Delete();
+  }
+
+  // Have func build its cell locators (built on the first search of each
+  // dataset), by finding a point of each dataset
+  void BuildLocators(vtkAbstractInterpolatedVelocityField* func)
+  {
+    vtkGenericCell* cell = vtkGenericCell::New();
+    std::vector<double> weights(std::max(this->MaxCellSize, 1));
+    vtkCompositeDataIterator* iter = this->Tracer->InputData->NewIterator();
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      vtkDataSet* input = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject());
+      if (!input || input->GetNumberOfCells() == 0)
+      {
+        continue;
+      }
+      double pcoords[3], x[3], velocity[3];
+      int subId = 0;
+      input->GetCell(0, cell);
+      cell->GetParametricCenter(pcoords);
+      cell->EvaluateLocation(subId, pcoords, x, &weights[0]);
+      func->FunctionValues(x, velocity);
+    }
+    iter->Delete();
+    func->ClearLastCellId();
+    cell->Delete();
+  }
+
+  // The first seed in the field, the one the serial loop started from the
+  // initial propagation and number of steps
+  vtkIdType FindFirstLine()
+  {
+    vtkIdType numLines = static_cast<vtkIdType>(this->Traces.size());
+    double point[3], velocity[3];
+    for (vtkIdType currentLine = 0; currentLine < numLines; currentLine++)
+    {
+      this->Function->ClearLastCellId();
+      this->SeedSource->GetTuple(this->SeedIds->GetId(currentLine), point);
+      if (this->Function->FunctionValues(point, velocity))
+      {
+        return currentLine;
+      }
+    }
+    return numLines;
+  }
+
+  vtkAbstractInterpolatedVelocityField* CloneFunction()
+  {
+    vtkAbstractInterpolatedVelocityField* func = this->Function->NewInstance();
+    func->CopyParameters(this->Function);
+    func->SetForceSurfaceTangentVector(this->Function->GetForceSurfaceTangentVector());
+    func->SetSurfaceDataset(this->Function->GetSurfaceDataset());
+    vtkCompositeInterpolatedVelocityField* composite =
+      vtkCompositeInterpolatedVelocityField::SafeDownCast(func);
+    vtkCompositeDataIterator* iter = this->Tracer->InputData->NewIterator();
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      vtkDataSet* input = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject());
+      if (input)
+      {
+        composite->AddDataSet(input);
+      }
+    }
+    iter->Delete();
+    func->SelectVectors(this->Function->GetVectorsType(), this->Function->GetVectorsSelection());
+    return func;
+  }
+
+  // Create a new integrator, the type (and test locations) is the same as
+  // the Integrator of the filter
+  vtkInitialValueProblemSolver* NewIntegrator(vtkAbstractInterpolatedVelocityField* func)
+  {
+    vtkInitialValueProblemSolver* integrator = this->Tracer->GetIntegrator()->NewInstance();
+    vtkCMBInitialValueProblemSolver* solver =
+      vtkCMBInitialValueProblemSolver::SafeDownCast(integrator);
+    if (solver)
+    {
+      solver->CopyParameters(
+        vtkCMBInitialValueProblemSolver::SafeDownCast(this->Tracer->GetIntegrator()));
+    }
+    integrator->SetFunctionSet(func);
+    return integrator;
+  }
+
+  // Integrate the streamline of a seed; false if the filter was aborted
+  bool Trace(vtkIdType currentLine, vtkAbstractInterpolatedVelocityField* func,
+    vtkInitialValueProblemSolver* integrator, vtkGenericCell* cell, double* weights,
+    bool reportProgress);
+};
+
+bool vtkCMBStreamTracerWorker::Trace(vtkIdType currentLine,
+  vtkAbstractInterpolatedVelocityField* func, vtkInitialValueProblemSolver* integrator,
+  vtkGenericCell* cell, double* weights, bool reportProgress)
+{
+  vtkCMBStreamTracer* tracer = this->Tracer;
+  vtkCMBStreamTrace& trace = this->Traces[currentLine];
+  vtkIdType numLines = static_cast<vtkIdType>(this->Traces.size());
+  // The initial propagation and number of steps are those of the first seed
+  // traced (the ones before it aren't in the field), and of all of them if
+  // they are already past the maximums, as they were carried over
+  bool carried = currentLine <= this->FirstLine ||
+    this->Propagation >= tracer->MaximumPropagation ||
+    this->NumberOfSteps > tracer->MaximumNumberOfSteps;
+  double propagation = carried ? this->Propagation : 0.0;
+  vtkIdType numSteps = carried ? this->NumberOfSteps : 0;
+  int i;
+
+  if (reportProgress)
+  {
+    tracer->UpdateProgress(static_cast<double>(currentLine) / numLines);
+  }
+
+  int direction = 1;
+  switch (this->IntegrationDirections->GetValue(currentLine))
+  {
+    case vtkStreamTracer::FORWARD:
+      direction = 1;
+      break;
+    case vtkStreamTracer::BACKWARD:
+      direction = -1;
+      break;
+  }
+
+  // temporary variables used in the integration
+  double point1[3], point2[3];
+  double velocity[3];
+
+  // Clear the last cell to avoid starting a search from
+  // the last point in the streamline
+  func->ClearLastCellId();
+
+  // Initial point
+  this->SeedSource->GetTuple(this->SeedIds->GetId(currentLine), point1);
+  memcpy(point2, point1, 3 * sizeof(double));
+  if (!func->FunctionValues(point1, velocity))
+  {
+    return true;
+  }
+
+  if (propagation >= tracer->MaximumPropagation || numSteps > tracer->MaximumNumberOfSteps)
+  {
+    return true;
+  }
+
+  // We will always pass an arc-length step size to the integrator.
+  // If the user specifies a step size in cell length unit, we will
+  // have to convert it to arc length.
+  vtkCMBStreamTracer::IntervalInformation stepSize; // either positive or negative
+  stepSize.Unit = vtkStreamTracer::LENGTH_UNIT;
+  stepSize.Interval = 0;
+  vtkCMBStreamTracer::IntervalInformation aStep; // always positive
+  aStep.Unit = vtkStreamTracer::LENGTH_UNIT;
+  double step, minStep = 0, maxStep = 0;
+  double stepTaken, accumTime = 0;
+  double speed;
+  double cellLength;
+  int retVal = vtkStreamTracer::OUT_OF_LENGTH, tmp;
+
+  // Make sure we use the dataset found by the vtkAbstractInterpolatedVelocityField
+  vtkDataSet* input = func->GetLastDataSet();
+
+  // Convert intervals to arc-length unit
+  input->GetCell(func->GetLastCellId(), cell);
+  cellLength = sqrt(static_cast<double>(cell->GetLength2()));
+  speed = vtkMath::Norm(velocity);
+  // Never call conversion methods if speed == 0
+  if (speed != 0.0)
+  {
+    tracer->ConvertIntervals(stepSize.Interval, minStep, maxStep, direction, cellLength);
+  }
+
+  // Always insert the first point, keeping what is needed to interpolate
+  // all point attributes on it
+  func->GetLastWeights(weights);
+  trace.AddPoint(point1, 0.0, input, cell->PointIds, weights);
+
+  double error = 0;
+  // Integrate until the maximum propagation length is reached,
+  // maximum number of steps is reached or until a boundary is encountered.
+  // Begin Integration
+  while (propagation < tracer->MaximumPropagation)
+  {
+
+    if (numSteps > tracer->MaximumNumberOfSteps)
+    {
+      retVal = vtkStreamTracer::OUT_OF_STEPS;
+      break;
+    }
+
+    if (numSteps++ % 1000 == 1)
+    {
+      if (reportProgress)
+      {
+        tracer->UpdateProgress(
+          (currentLine + propagation / tracer->MaximumPropagation) / numLines);
+      }
+
+      if (this->Abort || tracer->GetAbortExecute())
+      {
+        this->Abort = 1;
+        return false;
+      }
+    }
+
+    // Never call conversion methods if speed == 0
+    if ((speed == 0) || (speed <= tracer->TerminalSpeed))
+    {
+      retVal = vtkStreamTracer::STAGNATION;
+      break;
+    }
+
+    // If, with the next step, propagation will be larger than
+    // max, reduce it so that it is (approximately) equal to max.
+    aStep.Interval = fabs(stepSize.Interval);
+
+    if ((propagation + aStep.Interval) > tracer->MaximumPropagation)
+    {
+      aStep.Interval = tracer->MaximumPropagation - propagation;
+      if (stepSize.Interval >= 0)
+      {
+        stepSize.Interval = tracer->ConvertToLength(aStep, cellLength);
+      }
+      else
+      {
+        stepSize.Interval = tracer->ConvertToLength(aStep, cellLength) * (-1.0);
+      }
+      maxStep = stepSize.Interval;
+    }
+    trace.LastUsedStepSize = stepSize.Interval;
+    trace.HasStepSize = true;
+
+    // Calculate the next step using the integrator provided
+    // Break if the next point is out of bounds.
+    func->SetNormalizeVector(true);
+    tmp = integrator->ComputeNextStep(point1, point2, 0, stepSize.Interval, stepTaken, minStep,
+      maxStep, tracer->MaximumError, error);
+    func->SetNormalizeVector(false);
+    if (tmp != 0)
+    {
+      retVal = tmp;
+      memcpy(trace.LastPoint, point2, 3 * sizeof(double));
+      trace.HasLastPoint = true;
+      break;
+    }
+
+    // It is not enough to use the starting point for stagnation calculation
+    // Use delX/stepSize to calculate speed and check if it is below
+    // stagnation threshold
+    double disp[3];
+    for (i = 0; i < 3; i++)
+    {
+      disp[i] = point2[i] - point1[i];
+    }
+    if ((stepSize.Interval == 0) ||
+      (vtkMath::Norm(disp) / fabs(stepSize.Interval) <= tracer->TerminalSpeed))
+    {
+      retVal = vtkStreamTracer::STAGNATION;
+      break;
+    }
+
+    accumTime += stepTaken / speed;
+    // Calculate propagation (using the same units as MaximumPropagation
+    propagation += fabs(stepSize.Interval);
+
+    // This is the next starting point
+    for (i = 0; i < 3; i++)
+    {
+      point1[i] = point2[i];
+    }
+
+    // Interpolate the velocity at the next point
+    if (!func->FunctionValues(point2, velocity))
+    {
+      retVal = vtkStreamTracer::OUT_OF_DOMAIN;
+      memcpy(trace.LastPoint, point2, 3 * sizeof(double));
+      trace.HasLastPoint = true;
+      break;
+    }
+    // Make sure we use the dataset found by the vtkAbstractInterpolatedVelocityField
+    input = func->GetLastDataSet();
+
+    // Calculate cell length and speed to be used in unit conversions
+    input->GetCell(func->GetLastCellId(), cell);
+    cellLength = sqrt(static_cast<double>(cell->GetLength2()));
+    speed = vtkMath::Norm(velocity);
+
+    // Point is valid. Insert it.
+    func->GetLastWeights(weights);
+    trace.AddPoint(point1, accumTime, input, cell->PointIds, weights);
+
+    // Never call conversion methods if speed == 0
+    if ((speed == 0) || (speed <= tracer->TerminalSpeed))
+    {
+      retVal = vtkStreamTracer::STAGNATION;
+      break;
+    }
+
+    // Convert all intervals to arc length
+    tracer->ConvertIntervals(step, minStep, maxStep, direction, cellLength);
+
+    // If the solver is adaptive and the next step size (stepSize.Interval)
+    // that the solver wants to use is smaller than minStep or larger
+    // than maxStep, re-adjust it. This has to be done every step
+    // because minStep and maxStep can change depending on the cell
+    // size (unless it is specified in arc-length unit)
+    if (integrator->IsAdaptive())
+    {
+      if (fabs(stepSize.Interval) < fabs(minStep))
+      {
+        stepSize.Interval = fabs(minStep) * stepSize.Interval / fabs(stepSize.Interval);
+      }
+      else if (fabs(stepSize.Interval) > fabs(maxStep))
+      {
+        stepSize.Interval = fabs(maxStep) * stepSize.Interval / fabs(stepSize.Interval);
+      }
+    }
+    else
+    {
+      stepSize.Interval = step;
+    }
+
+    // End Integration
+  }
+
+  trace.ReturnValue = retVal;
+  trace.Propagation = propagation;
+  trace.NumberOfSteps = numSteps;
+  trace.Finished = true;
+  return true;
+}
 
 vtkStandardNewMacro(vtkCMBStreamTracer);
 
@@ -47,6 +604,7 @@ vtkCMBStreamTracer::vtkCMBStreamTracer()
 {
   this->SetInterpolatorTypeToCellLocator();
   this->SetComputeVorticity(false);
+  this->NumberOfThreads = 0;
 
   vtkCMBInitialValueProblemSolver* solver = vtkCMBInitialValueProblemSolver::New();
   this->SetIntegrator(solver);
@@ -136,25 +694,11 @@ void vtkCMBStreamTracer::Integrate(vtkDataSet* input0, vtkPolyData* output,
   double lastPoint[3], vtkAbstractInterpolatedVelocityField* func, int maxCellSize,
   const char* vecName, double& inPropagation, vtkIdType& inNumSteps)
 {
-  int i;
   vtkIdType numLines = seedIds->GetNumberOfIds();
-  double propagation = inPropagation;
-  vtkIdType numSteps = inNumSteps;
 
   // Useful pointers
   vtkDataSetAttributes* outputPD = output->GetPointData();
   vtkDataSetAttributes* outputCD = output->GetCellData();
-  vtkPointData* inputPD;
-  vtkDataSet* input;
-  vtkDataArray* inVectors;
-
-  int direction = 1;
-
-  double* weights = 0;
-  if (maxCellSize > 0)
-  {
-    weights = new double[maxCellSize];
-  }
 
   if (this->GetIntegrator() == 0)
   {
@@ -162,335 +706,136 @@ void vtkCMBStreamTracer::Integrate(vtkDataSet* input0, vtkPolyData* output,
     return;
   }
 
-  // Used in GetCell()
-  vtkGenericCell* cell = vtkGenericCell::New();
+  vtkCMBStreamTracerWorker worker;
+  worker.Tracer = this;
+  worker.SeedSource = seedSource;
+  worker.SeedIds = seedIds;
+  worker.IntegrationDirections = integrationDirections;
+  worker.Function = func;
+  worker.MaxCellSize = maxCellSize;
+  worker.Propagation = inPropagation;
+  worker.NumberOfSteps = inNumSteps;
+  worker.Traces.resize(numLines);
+  worker.FirstLine = inPropagation != 0.0 || inNumSteps != 0 ? worker.FindFirstLine() : 0;
+  worker.Run();
+
+  if (worker.Abort)
+  {
+    output->Squeeze();
+    return;
+  }
 
-  // Create a new integrator, the type is the same as Integrator
-  vtkInitialValueProblemSolver* integrator =
-    vtkInitialValueProblemSolver::SafeDownCast(this->GetIntegrator())->NewInstance();
-  integrator->SetFunctionSet(func);
+  // Copy the streamlines into the output in seed order, at offsets
+  // computed from their number of points
+  vtkIdType numPtsTotal = 0;
+  vtkIdType numOutputLines = 0;
+  vtkIdType connectivitySize = 0;
+  for (vtkIdType currentLine = 0; currentLine < numLines; currentLine++)
+  {
+    vtkIdType numPts = worker.Traces[currentLine].GetNumberOfPoints();
+    numPtsTotal += numPts;
+    if (numPts > 1)
+    {
+      numOutputLines++;
+      connectivitySize += numPts + 1;
+    }
+  }
 
-  // Since we do not know what the total number of points
-  // will be, we do not allocate any. This is important for
-  // cases where a lot of streamers are used at once. If we
-  // were to allocate any points here, potentially, we can
-  // waste a lot of memory if a lot of streamers are used.
-  // Always insert the first point
   vtkPoints* outputPoints = vtkPoints::New();
-  vtkCellArray* outputLines = vtkCellArray::New();
+  outputPoints->SetNumberOfPoints(numPtsTotal);
 
   // We will keep track of integration time in this array
   vtkDoubleArray* time = vtkDoubleArray::New();
   time->SetName("IntegrationTime");
+  time->SetNumberOfTuples(numPtsTotal);
 
   // This array explains why the integration stopped
   vtkIntArray* retVals = vtkIntArray::New();
   retVals->SetName("ReasonForTermination");
+  retVals->SetNumberOfTuples(numOutputLines);
+
+  vtkIdTypeArray* connectivity = vtkIdTypeArray::New();
+  connectivity->SetNumberOfTuples(connectivitySize);
+  vtkIdType* lineCells = connectivity->GetPointer(0);
 
   // We will interpolate all point attributes of the input on each point of
   // the output (unless they are turned off). Note that we are using only
   // the first input, if there are more than one, the attributes have to match.
-  //
-  // Note: We have to use a specific value (safe to employ the maximum number
-  //       of steps) as the size of the initial memory allocation here. The
-  //       use of the default argument might incur a crash problem (due to
-  //       "insufficient memory") in the parallel mode. This is the case when
-  //       a streamline intensely shuttles between two processes in an exactly
-  //       interleaving fashion --- only one point is produced on each process
-  //       (and actually two points, after point duplication, are saved to a
-  //       vtkPolyData in vtkDistributedStreamTracer::NoBlockProcessTask) and
-  //       as a consequence a large number of such small vtkPolyData objects
-  //       are needed to represent a streamline, consuming up the memory before
-  //       the intermediate memory is timely released.
-  outputPD->InterpolateAllocate(input0->GetPointData(), this->MaximumNumberOfSteps);
+  outputPD->InterpolateAllocate(input0->GetPointData(),
+    std::max(numPtsTotal, static_cast<vtkIdType>(this->MaximumNumberOfSteps)));
 
-  vtkIdType numPtsTotal = 0;
-  double velocity[3];
-
-  int shouldAbort = 0;
-
-  for (int currentLine = 0; currentLine < numLines; currentLine++)
+  vtkIdList* cellPointIds = vtkIdList::New();
+  vtkIdType nextPoint = 0;
+  vtkIdType nextLine = 0;
+  for (vtkIdType currentLine = 0; currentLine < numLines; currentLine++)
   {
-    double progress = static_cast<double>(currentLine) / numLines;
-    this->UpdateProgress(progress);
-
-    switch (integrationDirections->GetValue(currentLine))
+    vtkCMBStreamTrace& trace = worker.Traces[currentLine];
+    vtkIdType numPts = trace.GetNumberOfPoints();
+    if (numPts > 1)
     {
-      case FORWARD:
-        direction = 1;
-        break;
-      case BACKWARD:
-        direction = -1;
-        break;
+      *lineCells++ = numPts;
+      for (vtkIdType i = 0; i < numPts; i++)
+      {
+        *lineCells++ = nextPoint + i;
+      }
+      retVals->SetValue(nextLine++, trace.ReturnValue);
     }
-
-    // temporary variables used in the integration
-    double point1[3], point2[3];
-    vtkIdType numPts = 0;
-
-    // Clear the last cell to avoid starting a search from
-    // the last point in the streamline
-    func->ClearLastCellId();
-
-    // Initial point
-    seedSource->GetTuple(seedIds->GetId(currentLine), point1);
-    memcpy(point2, point1, 3 * sizeof(double));
-    if (!func->FunctionValues(point1, velocity))
+    for (vtkIdType i = 0; i < numPts; i++, nextPoint++)
     {
-      continue;
+      outputPoints->SetPoint(nextPoint, &trace.Points[3 * i]);
+      time->SetValue(nextPoint, trace.Times[i]);
+
+      // Interpolate all point attributes on the point
+      vtkIdType numCellPts = trace.CellOffsets[i + 1] - trace.CellOffsets[i];
+      cellPointIds->SetNumberOfIds(numCellPts);
+      std::copy(trace.CellPointIds.begin() + trace.CellOffsets[i],
+        trace.CellPointIds.begin() + trace.CellOffsets[i + 1], cellPointIds->GetPointer(0));
+      outputPD->InterpolatePoint(trace.DataSets[i]->GetPointData(), nextPoint, cellPointIds,
+        &trace.Weights[trace.CellOffsets[i]]);
     }
 
-    if (propagation >= this->MaximumPropagation || numSteps > this->MaximumNumberOfSteps)
+    // What is reported back is the state of the last traced seed
+    if (trace.Finished)
     {
-      continue;
+      inPropagation = trace.Propagation;
+      inNumSteps = trace.NumberOfSteps;
     }
-
-    numPts++;
-    numPtsTotal++;
-    vtkIdType nextPoint = outputPoints->InsertNextPoint(point1);
-    time->InsertNextValue(0.0);
-
-    // We will always pass an arc-length step size to the integrator.
-    // If the user specifies a step size in cell length unit, we will
-    // have to convert it to arc length.
-    IntervalInformation stepSize; // either positive or negative
-    stepSize.Unit = LENGTH_UNIT;
-    stepSize.Interval = 0;
-    IntervalInformation aStep; // always positive
-    aStep.Unit = LENGTH_UNIT;
-    double step, minStep = 0, maxStep = 0;
-    double stepTaken, accumTime = 0;
-    double speed;
-    double cellLength;
-    int retVal = OUT_OF_LENGTH, tmp;
-
-    // Make sure we use the dataset found by the vtkAbstractInterpolatedVelocityField
-    input = func->GetLastDataSet();
-    inputPD = input->GetPointData();
-    inVectors = inputPD->GetVectors(vecName);
-
-    // Convert intervals to arc-length unit
-    input->GetCell(func->GetLastCellId(), cell);
-    cellLength = sqrt(static_cast<double>(cell->GetLength2()));
-    speed = vtkMath::Norm(velocity);
-    // Never call conversion methods if speed == 0
-    if (speed != 0.0)
+    if (trace.HasLastPoint)
     {
-      this->ConvertIntervals(stepSize.Interval, minStep, maxStep, direction, cellLength);
+      memcpy(lastPoint, trace.LastPoint, 3 * sizeof(double));
     }
-
-    // Interpolate all point attributes on first point
-    func->GetLastWeights(weights);
-    outputPD->InterpolatePoint(inputPD, nextPoint, cell->PointIds, weights);
-
-    double error = 0;
-    // Integrate until the maximum propagation length is reached,
-    // maximum number of steps is reached or until a boundary is encountered.
-    // Begin Integration
-    while (propagation < this->MaximumPropagation)
+    if (trace.HasStepSize)
     {
-
-      if (numSteps > this->MaximumNumberOfSteps)
-      {
-        retVal = OUT_OF_STEPS;
-        break;
-      }
-
-      if (numSteps++ % 1000 == 1)
-      {
-        progress = (currentLine + propagation / this->MaximumPropagation) / numLines;
-        this->UpdateProgress(progress);
-
-        if (this->GetAbortExecute())
-        {
-          shouldAbort = 1;
-          break;
-        }
-      }
-
-      // Never call conversion methods if speed == 0
-      if ((speed == 0) || (speed <= this->TerminalSpeed))
-      {
-        retVal = STAGNATION;
-        break;
-      }
-
-      // If, with the next step, propagation will be larger than
-      // max, reduce it so that it is (approximately) equal to max.
-      aStep.Interval = fabs(stepSize.Interval);
-
-      if ((propagation + aStep.Interval) > this->MaximumPropagation)
-      {
-        aStep.Interval = this->MaximumPropagation - propagation;
-        if (stepSize.Interval >= 0)
-        {
-          stepSize.Interval = this->ConvertToLength(aStep, cellLength);
-        }
-        else
-        {
-          stepSize.Interval = this->ConvertToLength(aStep, cellLength) * (-1.0);
-        }
-        maxStep = stepSize.Interval;
-      }
-      this->LastUsedStepSize = stepSize.Interval;
-
-      // Calculate the next step using the integrator provided
-      // Break if the next point is out of bounds.
-      func->SetNormalizeVector(true);
-      tmp = integrator->ComputeNextStep(point1, point2, 0, stepSize.Interval, stepTaken, minStep,
-        maxStep, this->MaximumError, error);
-      func->SetNormalizeVector(false);
-      if (tmp != 0)
-      {
-        retVal = tmp;
-        memcpy(lastPoint, point2, 3 * sizeof(double));
-        break;
-      }
-
-      // It is not enough to use the starting point for stagnation calculation
-      // Use delX/stepSize to calculate speed and check if it is below
-      // stagnation threshold
-      double disp[3];
-      for (i = 0; i < 3; i++)
-      {
-        disp[i] = point2[i] - point1[i];
-      }
-      if ((stepSize.Interval == 0) ||
-        (vtkMath::Norm(disp) / fabs(stepSize.Interval) <= this->TerminalSpeed))
-      {
-        retVal = STAGNATION;
-        break;
-      }
-
-      accumTime += stepTaken / speed;
-      // Calculate propagation (using the same units as MaximumPropagation
-      propagation += fabs(stepSize.Interval);
-
-      // This is the next starting point
-      for (i = 0; i < 3; i++)
-      {
-        point1[i] = point2[i];
-      }
-
-      // Interpolate the velocity at the next point
-      if (!func->FunctionValues(point2, velocity))
-      {
-        retVal = OUT_OF_DOMAIN;
-        memcpy(lastPoint, point2, 3 * sizeof(double));
-        break;
-      }
-      // Make sure we use the dataset found by the vtkAbstractInterpolatedVelocityField
-      input = func->GetLastDataSet();
-      inputPD = input->GetPointData();
-      inVectors = inputPD->GetVectors(vecName);
-
-      // Point is valid. Insert it.
-      numPts++;
-      numPtsTotal++;
-      nextPoint = outputPoints->InsertNextPoint(point1);
-      time->InsertNextValue(accumTime);
-
-      // Calculate cell length and speed to be used in unit conversions
-      input->GetCell(func->GetLastCellId(), cell);
-      cellLength = sqrt(static_cast<double>(cell->GetLength2()));
-      speed = vtkMath::Norm(velocity);
-      // Interpolate all point attributes on current point
-      func->GetLastWeights(weights);
-      outputPD->InterpolatePoint(inputPD, nextPoint, cell->PointIds, weights);
-
-      // Never call conversion methods if speed == 0
-      if ((speed == 0) || (speed <= this->TerminalSpeed))
-      {
-        retVal = STAGNATION;
-        break;
-      }
-
-      // Convert all intervals to arc length
-      this->ConvertIntervals(step, minStep, maxStep, direction, cellLength);
-
-      // If the solver is adaptive and the next step size (stepSize.Interval)
-      // that the solver wants to use is smaller than minStep or larger
-      // than maxStep, re-adjust it. This has to be done every step
-      // because minStep and maxStep can change depending on the cell
-      // size (unless it is specified in arc-length unit)
-      if (integrator->IsAdaptive())
-      {
-        if (fabs(stepSize.Interval) < fabs(minStep))
-        {
-          stepSize.Interval = fabs(minStep) * stepSize.Interval / fabs(stepSize.Interval);
-        }
-        else if (fabs(stepSize.Interval) > fabs(maxStep))
-        {
-          stepSize.Interval = fabs(maxStep) * stepSize.Interval / fabs(stepSize.Interval);
-        }
-      }
-      else
-      {
-        stepSize.Interval = step;
-      }
-
-      // End Integration
-    }
-
-    if (shouldAbort)
-    {
-      break;
+      this->LastUsedStepSize = trace.LastUsedStepSize;
     }
-
-    if (numPts > 1)
-    {
-      outputLines->InsertNextCell(numPts);
-      for (i = numPtsTotal - numPts; i < numPtsTotal; i++)
-      {
-        outputLines->InsertCellPoint(i);
-      }
-      retVals->InsertNextValue(retVal);
-    }
-
-    // Initialize these to 0 before starting the next line.
-    // The values passed in the function call are only used
-    // for the first line.
-    inPropagation = propagation;
-    inNumSteps = numSteps;
-
-    propagation = 0;
-    numSteps = 0;
   }
+  cellPointIds->Delete();
 
-  if (!shouldAbort)
-  {
-    // Create the output polyline
-    output->SetPoints(outputPoints);
-    outputPD->AddArray(time);
+  // Create the output polyline
+  output->SetPoints(outputPoints);
+  outputPD->AddArray(time);
 
-    vtkIdType numPts = outputPoints->GetNumberOfPoints();
-    if (numPts > 1)
+  if (numPtsTotal > 1)
+  {
+    // Assign geometry and attributes
+    vtkCellArray* outputLines = vtkCellArray::New();
+    outputLines->SetCells(numOutputLines, connectivity);
+    output->SetLines(outputLines);
+    outputLines->Delete();
+    if (this->GenerateNormalsInIntegrate)
     {
-      // Assign geometry and attributes
-      output->SetLines(outputLines);
-      if (this->GenerateNormalsInIntegrate)
-      {
-        this->GenerateNormals(output, 0, vecName);
-      }
-
-      outputCD->AddArray(retVals);
+      this->GenerateNormals(output, 0, vecName);
     }
+
+    outputCD->AddArray(retVals);
   }
 
   retVals->Delete();
-
+  connectivity->Delete();
   outputPoints->Delete();
-  outputLines->Delete();
-
   time->Delete();
 
-  integrator->Delete();
-  cell->Delete();
-
-  delete[] weights;
-
   output->Squeeze();
-  return;
 }
 
 void vtkCMBStreamTracer::SetNumberOfTestLocations(int NumTests)
@@ -558,4 +903,5 @@ void vtkCMBStreamTracer::GetRelativeOffsetOfTestLocation(int index, double offse
 void vtkCMBStreamTracer::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << endl;
 }
@@ -9,6 +9,9 @@
 //=========================================================================
 // .NAME vtkCMBStreamTracer -
 // .SECTION Description
+// The seeds are traced in parallel: every thread integrates its own chunks
+// of seeds with a clone of the velocity field interpolator (and integrator),
+// and the streamlines are then copied into the output in seed order.
 //
 // .SECTION See Also
 // vtkStreamTracer
@@ -18,11 +21,16 @@
 
 #include "cmbSystemConfig.h"
 #include "vtkCMBGraphicsModule.h" // For export macro
+#include "vtkMultiThreader.h"     // For VTK_MAX_THREADS
 #include "vtkStreamTracer.h"
 class vtkIdList;
 class vtkIntArray;
 class vtkAbstractInterpolatedVelocityField;
 
+//BTX
+struct vtkCMBStreamTracerWorker;
+//ETX
+
 class VTKCMBGRAPHICS_EXPORT vtkCMBStreamTracer : public vtkStreamTracer
 {
 public:
@@ -53,6 +61,12 @@ public:
   virtual double GetSensorDefaultRelativeOffset();
   virtual void SetSensorDefaultRelativeOffset(double offset);
 
+  // Description:
+  // Set/Get the number of threads tracing the seeds.  If 0 (the default),
+  // vtkMultiThreader's global default number of threads is used.
+  vtkSetClampMacro(NumberOfThreads, int, 0, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
 protected:
   vtkCMBStreamTracer();
   ~vtkCMBStreamTracer() override;
@@ -68,7 +82,13 @@ protected:
     vtkAbstractInterpolatedVelocityField* func, int maxCellSize, const char* vecFieldName,
     double& propagation, vtkIdType& numSteps);
 
+  int NumberOfThreads;
+
 private:
+  //BTX
+  friend struct vtkCMBStreamTracerWorker;
+  //ETX
+
   vtkCMBStreamTracer(const vtkCMBStreamTracer&); // Not implemented.
   void operator=(const vtkCMBStreamTracer&);     // Not implemented.
 };
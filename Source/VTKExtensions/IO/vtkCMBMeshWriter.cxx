@@ -15,16 +15,24 @@
 #include "vtkCompositeDataSet.h"
 #include "vtkDataSetAttributes.h"
 #include "vtkInformation.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPolyData.h"
+#include "vtkStructuredData.h"
 #include "vtkStructuredGrid.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <sstream>
+#include <vector>
 #include <vtksys/SystemTools.hxx>
 
 #define SEPARATOR "  "
 #define INVISIBLE_ID -1
+// number of cells (or points) formatted as one piece by a thread
+#define CHUNK_SIZE 16384
 
 vtkStandardNewMacro(vtkCMBMeshWriter);
 
@@ -40,7 +48,8 @@ struct vtkCMBMeshWriterInternals
   vtkIdType nVisCells;                // valid only if cellVisArray is non-NULL
   vtkIdTypeArray* ptFileIdArray;      // non-NULL if invisible points included
   vtkIdType nVisPts;                  // valid only if ptFileIdArray is non-NULL
-  vtkIdList* cellPtList;
+  int dataDescription;
+  int dims[3];
 
   vtkCMBMeshWriterInternals()
     : input(NULL)
@@ -51,8 +60,9 @@ struct vtkCMBMeshWriterInternals
     , nVisCells(0)
     , ptFileIdArray(NULL)
     , nVisPts(0)
-    , cellPtList(NULL)
+    , dataDescription(VTK_EMPTY)
   {
+    this->dims[0] = this->dims[1] = this->dims[2] = 0;
   }
   ~vtkCMBMeshWriterInternals() {}
 
@@ -134,23 +144,73 @@ struct vtkCMBMeshWriterInternals
           cc, this->structured->IsPointVisible(cc) ? this->nVisPts++ : INVISIBLE_ID);
       }
     }
-    this->cellPtList = vtkIdList::New();
+    this->structured->GetDimensions(this->dims);
+    this->dataDescription = vtkStructuredData::GetDataDescription(this->dims);
   }
 
-  // cell id is incremented when invisible (blank) cells are skipped
-  bool GetNextStructuredCell(vtkIdType& cellId, vtkIdType& npts, vtkIdType*& pts)
+  // Same points (and order) as vtkStructuredGrid::GetCellPoints, but computed
+  // directly from the dimensions; safe to call from several threads
+  vtkIdType GetStructuredCellPoints(vtkIdType cellId, vtkIdType pts[8]) const
   {
-    if (!this->structured || cellId >= this->structured->GetNumberOfCells())
+    vtkIdType min[3] = { 0, 0, 0 }, max[3] = { 0, 0, 0 };
+    switch (this->dataDescription)
     {
-      return false;
+      case VTK_EMPTY:
+        return 0;
+      case VTK_SINGLE_POINT:
+        break;
+      case VTK_X_LINE:
+        min[0] = cellId;
+        max[0] = cellId + 1;
+        break;
+      case VTK_Y_LINE:
+        min[1] = cellId;
+        max[1] = cellId + 1;
+        break;
+      case VTK_Z_LINE:
+        min[2] = cellId;
+        max[2] = cellId + 1;
+        break;
+      case VTK_XY_PLANE:
+        min[0] = cellId % (this->dims[0] - 1);
+        max[0] = min[0] + 1;
+        min[1] = cellId / (this->dims[0] - 1);
+        max[1] = min[1] + 1;
+        break;
+      case VTK_YZ_PLANE:
+        min[1] = cellId % (this->dims[1] - 1);
+        max[1] = min[1] + 1;
+        min[2] = cellId / (this->dims[1] - 1);
+        max[2] = min[2] + 1;
+        break;
+      case VTK_XZ_PLANE:
+        min[0] = cellId % (this->dims[0] - 1);
+        max[0] = min[0] + 1;
+        min[2] = cellId / (this->dims[0] - 1);
+        max[2] = min[2] + 1;
+        break;
+      case VTK_XYZ_GRID:
+        min[0] = cellId % (this->dims[0] - 1);
+        max[0] = min[0] + 1;
+        min[1] = (cellId / (this->dims[0] - 1)) % (this->dims[1] - 1);
+        max[1] = min[1] + 1;
+        min[2] = cellId / ((this->dims[0] - 1) * (this->dims[1] - 1));
+        max[2] = min[2] + 1;
+        break;
+    }
+    vtkIdType npts = 0;
+    vtkIdType d01 = static_cast<vtkIdType>(this->dims[0]) * this->dims[1];
+    for (vtkIdType k = min[2]; k <= max[2]; ++k)
+    {
+      for (vtkIdType j = min[1]; j <= max[1]; ++j)
+      {
+        for (vtkIdType i = min[0]; i <= max[0]; ++i)
+        {
+          pts[npts++] = i + j * this->dims[0] + k * d01;
+        }
+      }
     }
-    // skip invisible (blank) cells with an empty for loop
-    for (; this->cellVisArray && !this->cellVisArray->GetValue(cellId); ++cellId)
-      ;
-    this->structured->GetCellPoints(cellId, cellPtList);
-    npts = cellPtList->GetNumberOfIds();
-    pts = cellPtList->GetPointer(0);
-    return true;
+    return npts;
   }
 
   void ClearStructured()
@@ -168,10 +228,7 @@ struct vtkCMBMeshWriterInternals
     }
     ptFileIdArray = NULL;
     this->nVisPts = 0;
-    if (this->cellPtList)
-    {
-      this->cellPtList->Delete();
-    }
+    this->dataDescription = VTK_EMPTY;
   }
 };
 
@@ -359,7 +416,37 @@ inline unsigned long vtkGetMaterial(vtkDataArray* array, vtkIdType cc)
   return 1;
 }
 
-bool vtkWriteCell(ostream& fp, vtkIdType npts, vtkIdType* ptIds, vtkIdTypeArray* fileIdArray)
+// Fast (compared to ostream) formatting of the values written to the file
+inline void vtkAppendId(std::string& buffer, unsigned long long value)
+{
+  char digits[24];
+  char* end = digits + sizeof(digits);
+  char* first = end;
+  do
+  {
+    *--first = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+  buffer.append(first, end - first);
+}
+
+inline void vtkAppendFloat(std::string& buffer, const char* format, int precision, double value)
+{
+  // formatted the same as ostream with showpoint and scientific (or fixed)
+  char text[64];
+  int n = snprintf(text, sizeof(text), format, precision, value);
+  if (n < static_cast<int>(sizeof(text)))
+  {
+    buffer.append(text, n);
+    return;
+  }
+  std::vector<char> largeText(n + 1);
+  snprintf(&largeText[0], largeText.size(), format, precision, value);
+  buffer.append(&largeText[0], n);
+}
+
+bool vtkWriteCell(
+  std::string& buffer, vtkIdType npts, vtkIdType* ptIds, vtkIdTypeArray* fileIdArray)
 {
   // Handle invisible nodes
   if (fileIdArray)
@@ -371,20 +458,22 @@ bool vtkWriteCell(ostream& fp, vtkIdType npts, vtkIdType* ptIds, vtkIdTypeArray*
       {
         return false;
       }
-      fp << SEPARATOR << id + 1;
+      buffer += SEPARATOR;
+      ::vtkAppendId(buffer, id + 1);
     }
   }
   else
   {
     for (vtkIdType cc = 0; cc < npts; ++cc)
     {
-      fp << SEPARATOR << ptIds[cc] + 1;
+      buffer += SEPARATOR;
+      ::vtkAppendId(buffer, ptIds[cc] + 1);
     }
   }
   return true;
 }
 
-std::string vtkGetCellCard(int cellType, vtkIdType npts, int fileFormat)
+const char* vtkGetCellCard(int cellType, vtkIdType npts, int fileFormat)
 {
   // If the cell type is not supported by the file format then return an empty string.
   // Check the number of points to ensure the cell type is correct.
@@ -461,68 +550,91 @@ std::string vtkGetCellCard(int cellType, vtkIdType npts, int fileFormat)
   return "";
 }
 
-bool vtkCMBMeshWriter::WriteCells(ostream& fp)
+// The cells (or points) are formatted in chunks by several threads, each
+// chunk into its own buffer; the buffers are then written out in order
+enum vtkCMBMeshChunkStatus
 {
-  vtkDataArray* materialArray = NULL;
-  if (this->FileFormat != PT123)
-  {
-    materialArray = this->GetInputArrayToProcess(0, this->Internals->input);
-    if (!materialArray)
-    {
-      vtkWarningMacro("Failed to locate material array. Using 1 for material id.");
-    }
-  }
+  CHUNK_OK = 0,
+  CHUNK_INCOMPATIBLE_CELL,
+  CHUNK_INVISIBLE_POINT
+};
 
-  vtkCellArray* cells = NULL;
-  vtkIdType cellOffset = 0, ncells = 0;
-  if (this->Internals->unstructured)
-  {
-    cells = this->Internals->unstructured->GetCells();
-    ncells = this->Internals->unstructured->GetNumberOfCells();
-  }
-  else if (this->Internals->poly)
-  {
-    cellOffset =
-      this->Internals->poly->GetNumberOfVerts() + this->Internals->poly->GetNumberOfLines();
-    cells = this->Internals->poly->GetPolys();
-    ncells = this->Internals->poly->GetNumberOfPolys();
-  }
-  else if (this->Internals->structured)
-  {
-    ncells = this->Internals->cellVisArray ? this->Internals->nVisCells
-                                           : this->Internals->structured->GetNumberOfCells();
-  }
-  if (ncells <= 0)
-  {
-    vtkErrorMacro("No compatiable cells are present for writing out mesh.");
-    return false;
-  }
+struct vtkCMBMeshWriterChunk
+{
+  vtkIdType Begin;       // 1st cell (or point) id of the chunk
+  vtkIdType End;         // one past the last
+  vtkIdType Location;    // of the 1st cell in the cell array
+  vtkIdType FirstFileId; // file ID of the 1st (visible) cell, zero-based
+  std::string Buffer;
+  int Status;
+  vtkIdType ErrorId;
+};
 
-  std::string card = "";
-  vtkIdType* ptIds = NULL;
-  vtkIdType cellId = 0, fileId = 0, npts = 0;
-  bool res = true;
-  int cellType;
+struct vtkCMBMeshWriterUserData
+{
+  vtkCMBMeshWriterInternals* Internals;
+  int FileFormat;
+  // cells
+  vtkIdType* Cells; // NULL for structured input
+  vtkIdType CellOffset;
+  vtkDataArray* MaterialArray;
+  // points
+  vtkPoints* Points;
+  const char* Card;
+  const char* FloatFormat;
+  int FloatPrecision;
 
-  if (cells)
-  {
-    cells->InitTraversal();
-  }
-  while (cells ? cells->GetNextCell(npts, ptIds)
-               : this->Internals->GetNextStructuredCell(cellId, npts, ptIds))
+  std::vector<vtkCMBMeshWriterChunk>* Chunks;
+  size_t NumberOfChunks;
+};
+
+static void vtkFormatCells(vtkCMBMeshWriterUserData* userData, vtkCMBMeshWriterChunk& chunk)
+{
+  vtkCMBMeshWriterInternals* internals = userData->Internals;
+  std::string& buffer = chunk.Buffer;
+  buffer.clear();
+  chunk.Status = CHUNK_OK;
+
+  vtkIdType* cellData = userData->Cells ? userData->Cells + chunk.Location : NULL;
+  vtkIdType structuredPts[8];
+  vtkIdType fileId = chunk.FirstFileId;
+  for (vtkIdType cellId = chunk.Begin; cellId < chunk.End; ++cellId)
   {
-    cellType = this->Internals->input->GetCellType(cellId + cellOffset);
-    card = ::vtkGetCellCard(cellType, npts, this->FileFormat);
-    if (card.empty())
+    vtkIdType npts;
+    vtkIdType* ptIds;
+    if (cellData)
     {
-      vtkErrorMacro(<< "Element " << cellId << " (cell ID) is incompatible.");
-      return false;
+      npts = *cellData++;
+      ptIds = cellData;
+      cellData += npts;
+    }
+    else
+    {
+      // skip invisible (blank) cells
+      if (internals->cellVisArray && !internals->cellVisArray->GetValue(cellId))
+      {
+        continue;
+      }
+      npts = internals->GetStructuredCellPoints(cellId, structuredPts);
+      ptIds = structuredPts;
+    }
+
+    int cellType = internals->input->GetCellType(cellId + userData->CellOffset);
+    const char* card = ::vtkGetCellCard(cellType, npts, userData->FileFormat);
+    if (!*card)
+    {
+      chunk.Status = CHUNK_INCOMPATIBLE_CELL;
+      chunk.ErrorId = cellId;
+      return;
     }
     // Write cell type card and cell's file ID (file format's IDs are one-based and
     // contiguous; cellId could have gaps due to invisible cells)
-    fp << card << SEPARATOR << ++fileId;
+    buffer += card;
+    buffer += SEPARATOR;
+    ::vtkAppendId(buffer, ++fileId);
     // The point ordering of VTK and some of the file format's cell types are different.
     // Re-order to match VTK's if necessary and then write points.
+    bool res;
     switch (cellType)
     {
       case VTK_PIXEL:
@@ -534,7 +646,7 @@ bool vtkCMBMeshWriter::WriteCells(ostream& fp)
         {
           outIds[indices[i]] = ptIds[i];
         }
-        res = ::vtkWriteCell(fp, npts, outIds, this->Internals->ptFileIdArray);
+        res = ::vtkWriteCell(buffer, npts, outIds, internals->ptFileIdArray);
       }
       break;
       case VTK_QUADRATIC_TRIANGLE:
@@ -545,7 +657,7 @@ bool vtkCMBMeshWriter::WriteCells(ostream& fp)
         {
           outIds[indices[i]] = ptIds[i];
         }
-        res = ::vtkWriteCell(fp, npts, outIds, this->Internals->ptFileIdArray);
+        res = ::vtkWriteCell(buffer, npts, outIds, internals->ptFileIdArray);
       }
       break;
       case VTK_QUADRATIC_QUAD:
@@ -557,27 +669,207 @@ bool vtkCMBMeshWriter::WriteCells(ostream& fp)
         {
           outIds[indices[i]] = ptIds[i];
         }
-        res = ::vtkWriteCell(fp, npts, outIds, this->Internals->ptFileIdArray);
+        res = ::vtkWriteCell(buffer, npts, outIds, internals->ptFileIdArray);
       }
       break;
       default:
-        res = ::vtkWriteCell(fp, npts, ptIds, this->Internals->ptFileIdArray);
+        res = ::vtkWriteCell(buffer, npts, ptIds, internals->ptFileIdArray);
         break;
     }
     if (!res)
     {
-      vtkErrorMacro("Visible cell includes invisible point; incompatiable with "
-                    "file format.");
-      return false;
+      chunk.Status = CHUNK_INVISIBLE_POINT;
+      chunk.ErrorId = cellId;
+      return;
     }
     // Write material
-    if (this->FileFormat != PT123)
+    if (userData->FileFormat != vtkCMBMeshWriter::PT123)
     {
-      fp << SEPARATOR << ::vtkGetMaterial(materialArray, cellId + cellOffset);
+      buffer += SEPARATOR;
+      ::vtkAppendId(
+        buffer, ::vtkGetMaterial(userData->MaterialArray, cellId + userData->CellOffset));
     }
-    fp << endl;
+    buffer += '\n';
+  }
+}
+
+static void vtkFormatPoints(vtkCMBMeshWriterUserData* userData, vtkCMBMeshWriterChunk& chunk)
+{
+  vtkIdTypeArray* ptFileIdArray = userData->Internals->ptFileIdArray;
+  std::string& buffer = chunk.Buffer;
+  buffer.clear();
+  chunk.Status = CHUNK_OK;
 
-    ++cellId;
+  double pts[3];
+  for (vtkIdType cc = chunk.Begin; cc < chunk.End; ++cc)
+  {
+    // Handle invisible nodes
+    vtkIdType id = ptFileIdArray ? ptFileIdArray->GetValue(cc) : cc;
+    if (id == INVISIBLE_ID)
+    {
+      continue;
+    }
+    userData->Points->GetPoint(cc, pts);
+    buffer += userData->Card;
+    buffer += SEPARATOR;
+    ::vtkAppendId(buffer, id + 1);
+    for (int i = 0; i < 3; ++i)
+    {
+      buffer += SEPARATOR;
+      ::vtkAppendFloat(buffer, userData->FloatFormat, userData->FloatPrecision, pts[i]);
+    }
+    buffer += '\n';
+  }
+}
+
+static VTK_THREAD_RETURN_TYPE vtkCMBMeshWriterFormatCells(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkCMBMeshWriterUserData* userData = static_cast<vtkCMBMeshWriterUserData*>(info->UserData);
+  for (size_t i = info->ThreadID; i < userData->NumberOfChunks; i += info->NumberOfThreads)
+  {
+    ::vtkFormatCells(userData, (*userData->Chunks)[i]);
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+static VTK_THREAD_RETURN_TYPE vtkCMBMeshWriterFormatPoints(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkCMBMeshWriterUserData* userData = static_cast<vtkCMBMeshWriterUserData*>(info->UserData);
+  for (size_t i = info->ThreadID; i < userData->NumberOfChunks; i += info->NumberOfThreads)
+  {
+    ::vtkFormatPoints(userData, (*userData->Chunks)[i]);
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+// Format the chunks set up in userData, and write them out in order. Returns
+// the first chunk that failed (its output up to the failure is written), or
+// NULL if all went well.
+static vtkCMBMeshWriterChunk* vtkWriteChunks(ostream& fp, vtkMultiThreader* threader,
+  vtkThreadFunctionType formatChunks, vtkCMBMeshWriterUserData& userData)
+{
+  int numberOfThreads = threader->GetNumberOfThreads();
+  if (static_cast<size_t>(numberOfThreads) > userData.NumberOfChunks)
+  {
+    threader->SetNumberOfThreads(static_cast<int>(userData.NumberOfChunks));
+  }
+  threader->SetSingleMethod(formatChunks, &userData);
+  threader->SingleMethodExecute();
+  threader->SetNumberOfThreads(numberOfThreads);
+
+  for (size_t i = 0; i < userData.NumberOfChunks; ++i)
+  {
+    vtkCMBMeshWriterChunk& chunk = (*userData.Chunks)[i];
+    fp.write(chunk.Buffer.data(), chunk.Buffer.size());
+    if (chunk.Status != CHUNK_OK)
+    {
+      return &chunk;
+    }
+  }
+  return NULL;
+}
+
+bool vtkCMBMeshWriter::WriteCells(ostream& fp)
+{
+  vtkDataArray* materialArray = NULL;
+  if (this->FileFormat != PT123)
+  {
+    materialArray = this->GetInputArrayToProcess(0, this->Internals->input);
+    if (!materialArray)
+    {
+      vtkWarningMacro("Failed to locate material array. Using 1 for material id.");
+    }
+  }
+
+  vtkCellArray* cells = NULL;
+  vtkIdType cellOffset = 0, ncells = 0, numberOfCellIds = 0;
+  if (this->Internals->unstructured)
+  {
+    cells = this->Internals->unstructured->GetCells();
+    ncells = this->Internals->unstructured->GetNumberOfCells();
+    numberOfCellIds = ncells;
+  }
+  else if (this->Internals->poly)
+  {
+    cellOffset =
+      this->Internals->poly->GetNumberOfVerts() + this->Internals->poly->GetNumberOfLines();
+    cells = this->Internals->poly->GetPolys();
+    ncells = this->Internals->poly->GetNumberOfPolys();
+    numberOfCellIds = ncells;
+  }
+  else if (this->Internals->structured)
+  {
+    ncells = this->Internals->cellVisArray ? this->Internals->nVisCells
+                                           : this->Internals->structured->GetNumberOfCells();
+    // includes the invisible cells, which are skipped while formatting
+    numberOfCellIds = this->Internals->structured->GetNumberOfCells();
+  }
+  if (ncells <= 0)
+  {
+    vtkErrorMacro("No compatiable cells are present for writing out mesh.");
+    return false;
+  }
+
+  vtkNew<vtkMultiThreader> threader;
+  std::vector<vtkCMBMeshWriterChunk> chunks(4 * threader->GetNumberOfThreads());
+
+  vtkCMBMeshWriterUserData userData;
+  userData.Internals = this->Internals;
+  userData.FileFormat = this->FileFormat;
+  userData.Cells = cells ? cells->GetPointer() : NULL;
+  userData.CellOffset = cellOffset;
+  userData.MaterialArray = materialArray;
+  userData.Chunks = &chunks;
+
+  // a batch of chunks at a time, to limit the memory used by the buffers
+  vtkIdType cellId = 0, location = 0, fileId = 0;
+  while (cellId < numberOfCellIds)
+  {
+    for (userData.NumberOfChunks = 0;
+         userData.NumberOfChunks < chunks.size() && cellId < numberOfCellIds;
+         ++userData.NumberOfChunks)
+    {
+      vtkCMBMeshWriterChunk& chunk = chunks[userData.NumberOfChunks];
+      chunk.Begin = cellId;
+      chunk.End = std::min<vtkIdType>(cellId + CHUNK_SIZE, numberOfCellIds);
+      chunk.Location = location;
+      chunk.FirstFileId = fileId;
+      if (userData.Cells)
+      {
+        for (; cellId < chunk.End; ++cellId)
+        {
+          location += userData.Cells[location] + 1;
+        }
+        fileId = cellId;
+      }
+      else if (this->Internals->cellVisArray)
+      {
+        for (; cellId < chunk.End; ++cellId)
+        {
+          fileId += this->Internals->cellVisArray->GetValue(cellId);
+        }
+      }
+      else
+      {
+        cellId = fileId = chunk.End;
+      }
+    }
+
+    vtkCMBMeshWriterChunk* failed =
+      ::vtkWriteChunks(fp, threader.GetPointer(), vtkCMBMeshWriterFormatCells, userData);
+    if (failed && failed->Status == CHUNK_INCOMPATIBLE_CELL)
+    {
+      vtkErrorMacro(<< "Element " << failed->ErrorId << " (cell ID) is incompatible.");
+      return false;
+    }
+    else if (failed)
+    {
+      vtkErrorMacro("Visible cell includes invisible point; incompatiable with "
+                    "file format.");
+      return false;
+    }
   }
 
   return true;
@@ -587,47 +879,43 @@ bool vtkCMBMeshWriter::WritePoints(ostream& fp)
 {
   vtkPoints* points = this->Internals->input->GetPoints();
   vtkIdType numPts = points->GetNumberOfPoints();
-  std::string card;
-  double pts[3];
 
+  vtkCMBMeshWriterUserData userData;
+  userData.Internals = this->Internals;
+  userData.FileFormat = this->FileFormat;
+  userData.Points = points;
   switch (this->FileFormat)
   {
     case WASH123D:
     case PT123:
-      card = "GN";
+      userData.Card = "GN";
       break;
     case ADH:
     case XMS:
     default:
-      card = "ND";
+      userData.Card = "ND";
       break;
   }
-  fp.precision(this->FloatPrecision);
-  fp.setf(ios::showpoint);
-  fp.setf(UseScientificNotation ? ios::scientific : ios::fixed, ios::floatfield);
-  // Handle invisible nodes
-  if (this->Internals->ptFileIdArray)
-  {
-    for (vtkIdType cc = 0, id = 0; cc < numPts; ++cc)
-    {
-      id = this->Internals->ptFileIdArray->GetValue(cc);
-      if (id == INVISIBLE_ID)
-      {
-        continue;
-      }
-      points->GetPoint(cc, pts);
-      fp << card << SEPARATOR << id + 1 << SEPARATOR << pts[0] << SEPARATOR << pts[1] << SEPARATOR
-         << pts[2] << endl;
-    }
-  }
-  else
+  // same as ostream's precision, showpoint and scientific (or fixed)
+  userData.FloatFormat = this->UseScientificNotation ? "%#.*e" : "%#.*f";
+  userData.FloatPrecision = this->FloatPrecision;
+
+  vtkNew<vtkMultiThreader> threader;
+  std::vector<vtkCMBMeshWriterChunk> chunks(4 * threader->GetNumberOfThreads());
+  userData.Chunks = &chunks;
+
+  // a batch of chunks at a time, to limit the memory used by the buffers
+  vtkIdType ptId = 0;
+  while (ptId < numPts)
   {
-    for (vtkIdType cc = 0; cc < numPts; ++cc)
+    for (userData.NumberOfChunks = 0; userData.NumberOfChunks < chunks.size() && ptId < numPts;
+         ++userData.NumberOfChunks)
     {
-      points->GetPoint(cc, pts);
-      fp << card << SEPARATOR << cc + 1 << SEPARATOR << pts[0] << SEPARATOR << pts[1] << SEPARATOR
-         << pts[2] << endl;
+      vtkCMBMeshWriterChunk& chunk = chunks[userData.NumberOfChunks];
+      chunk.Begin = ptId;
+      chunk.End = ptId = std::min<vtkIdType>(ptId + CHUNK_SIZE, numPts);
     }
+    ::vtkWriteChunks(fp, threader.GetPointer(), vtkCMBMeshWriterFormatPoints, userData);
   }
   return true;
 }
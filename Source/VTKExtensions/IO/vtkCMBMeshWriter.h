@@ -15,6 +15,8 @@
 // represented by the file format.
 // This can take a vtkMultiGroupDataSet as input, however in that case it
 // writes the first leaf vtkPointSet out.
+// The cells and nodes are formatted in chunks, in parallel, and the
+// formatted chunks written out in order.
 
 #ifndef __vtkCMBMeshWriter_h
 #define __vtkCMBMeshWriter_h
@@ -11,13 +11,16 @@
 
 #include "vtkAppendPolyData.h"
 #include "vtkCellArray.h"
+#include "vtkDoubleArray.h"
 #include "vtkExecutive.h"
 #include "vtkFloatArray.h"
 #include "vtkGeoSphereTransform.h"
+#include "vtkIdTypeArray.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
+#include "vtkMultiThreader.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
@@ -75,6 +78,29 @@ public:
   std::vector<RowCol> NoDataValueInstances;
 };
 
+// a band of (output) rows of one of the files, read by one thread
+struct RawDEMTileRead
+{
+  RawDEMReaderFileInfo* FileInfo;
+  // where the rows/columns read from the file start, and where they go in the output
+  vtkIdType InitialRowSkip;
+  vtkIdType InitialColumnSkip;
+  vtkIdType NumberOfColumns;
+  vtkIdType OutputRowOffset;
+  vtkIdType OutputColumnOffset;
+  double DataOrigin[2];
+  // rows of the file (after skipping) in this tile
+  vtkIdType FirstRow;
+  vtkIdType EndRow;
+
+  int Status;
+  vtkBoundingBox BBox;
+  // poly data output: the points kept
+  std::vector<double> Points;
+  // image output: the NoDataValue instances found in the tile
+  std::vector<RowCol> NoDataValueInstances;
+};
+
 bool SortPredicate(RawDEMReaderFileInfo elem1, RawDEMReaderFileInfo elem2)
 {
   if (elem1.LatitudeOrigin > elem2.LatitudeOrigin)
@@ -495,18 +521,81 @@ void vtkRawDEMReader::ReadPolyDataOutput(vtkPolyData* output)
   newPts->UnRegister(this);
   newVerts->UnRegister(this);
 
-  vtkIdType totalNumberOfPoints =
-    this->Internals->OutputNumberOfRows * this->Internals->OutputNumberOfColumns;
-  newPts->Allocate(totalNumberOfPoints);
-  newVerts->Allocate(2 * totalNumberOfPoints);
+  std::vector<RawDEMTileRead> tiles;
+  this->ReadTiles(0, tiles);
 
-  std::vector<RawDEMReaderFileInfo>::iterator file = this->Internals->FileInfo.begin();
-  for (; file != this->Internals->FileInfo.end(); file++)
+  // gather the points of the tiles, in file (and row) order
+  vtkIdType numberOfPoints = 0;
+  std::vector<RawDEMTileRead>::const_iterator tile;
+  for (tile = tiles.begin(); tile != tiles.end(); tile++)
   {
-    this->ReadData(*file, 0, newPts, newVerts);
+    numberOfPoints += static_cast<vtkIdType>(tile->Points.size() / 3);
+  }
+  newPts->SetNumberOfPoints(numberOfPoints);
+  vtkNew<vtkIdTypeArray> verts;
+  verts->SetNumberOfValues(2 * numberOfPoints);
+  vtkIdType* vertsPtr = verts->GetPointer(0);
+  vtkIdType ptId = 0;
+  for (tile = tiles.begin(); tile != tiles.end(); tile++)
+  {
+    vtkIdType numberOfTilePoints = static_cast<vtkIdType>(tile->Points.size() / 3);
+    if (numberOfTilePoints == 0)
+    {
+      continue;
+    }
+    if (this->OutputDataTypeIsDouble)
+    {
+      double* pts = static_cast<vtkDoubleArray*>(newPts->GetData())->GetPointer(3 * ptId);
+      std::copy(tile->Points.begin(), tile->Points.end(), pts);
+    }
+    else
+    {
+      float* pts = static_cast<vtkFloatArray*>(newPts->GetData())->GetPointer(3 * ptId);
+      for (size_t i = 0; i < tile->Points.size(); i++)
+      {
+        pts[i] = static_cast<float>(tile->Points[i]);
+      }
+    }
+    for (vtkIdType i = 0; i < numberOfTilePoints; i++, ptId++)
+    {
+      *vertsPtr++ = 1;
+      *vertsPtr++ = ptId;
+    }
+  }
+  newVerts->SetCells(numberOfPoints, verts.GetPointer());
+}
+
+// Description:
+// Replace the NoDataValue at rowCol by the average of its (valid) neighbors
+static void FillNoDataValue(float* scalars, vtkIdType numberOfRows, vtkIdType numberOfColumns,
+  const RowCol& rowCol, float noDataValue)
+{
+  double sum = 0;
+  vtkIdType sumCount = 0;
+  for (vtkIdType row = rowCol.Row - 1; row < rowCol.Row + 2; row++)
+  {
+    if (row < 0 || row >= numberOfRows)
+    {
+      continue;
+    }
+    for (vtkIdType col = rowCol.Column - 1; col < rowCol.Column + 2; col++)
+    {
+      if (col < 0 || col >= numberOfColumns || (col == rowCol.Column && row == rowCol.Row))
+      {
+        continue;
+      }
+      float value = scalars[row * numberOfColumns + col];
+      if (value != noDataValue)
+      {
+        sum += value;
+        sumCount++;
+      }
+    }
+  }
+  if (sumCount)
+  {
+    scalars[rowCol.Row * numberOfColumns + rowCol.Column] = static_cast<float>(sum / sumCount);
   }
-  newVerts->Squeeze();
-  newPts->Squeeze();
 }
 
 void vtkRawDEMReader::ReadImageDataOutput(vtkImageData* output)
@@ -514,12 +603,18 @@ void vtkRawDEMReader::ReadImageDataOutput(vtkImageData* output)
   vtkImageData* data = this->AllocateOutputData(output);
   vtkFloatArray* scalars = vtkFloatArray::SafeDownCast(data->GetPointData()->GetScalars());
 
-  this->Internals->NoDataValueInstances.clear();
+  // the NoDataValue instances are fixed up once all the tiles are in, in the
+  // order they are in the files (a fixed up value is used by its neighbors
+  // that come after it), so that the output is as if read serially
+  std::vector<RawDEMTileRead> tiles;
+  this->ReadTiles(scalars, tiles);
 
-  std::vector<RawDEMReaderFileInfo>::iterator file = this->Internals->FileInfo.begin();
-  for (; file != this->Internals->FileInfo.end(); file++)
+  this->Internals->NoDataValueInstances.clear();
+  std::vector<RawDEMTileRead>::const_iterator tile;
+  for (tile = tiles.begin(); tile != tiles.end(); tile++)
   {
-    this->ReadData(*file, scalars, 0, 0);
+    this->Internals->NoDataValueInstances.insert(this->Internals->NoDataValueInstances.end(),
+      tile->NoDataValueInstances.begin(), tile->NoDataValueInstances.end());
   }
 
   // fixup any "NoDataValue" instances
@@ -528,255 +623,310 @@ void vtkRawDEMReader::ReadImageDataOutput(vtkImageData* output)
   float noDataValue = this->Internals->FileInfo.front().NoDataValue;
   for (; noDataValueIter != this->Internals->NoDataValueInstances.end(); noDataValueIter++)
   {
-    double sum = 0;
-    vtkIdType sumCount = 0;
-    for (vtkIdType row = noDataValueIter->Row - 1; row < noDataValueIter->Row + 2; row++)
-    {
-      if (row < 0 || row >= this->Internals->OutputNumberOfRows)
-      {
-        continue;
-      }
-      for (vtkIdType col = noDataValueIter->Column - 1; col < noDataValueIter->Column + 2; col++)
-      {
-        if (col < 0 || col >= this->Internals->OutputNumberOfColumns ||
-          (col == noDataValueIter->Column && row == noDataValueIter->Row))
-        {
-          continue;
-        }
-        float value = scalars->GetValue(row * this->Internals->OutputNumberOfColumns + col);
-        if (value != noDataValue)
-        {
-          sum += value;
-          sumCount++;
-        }
-      }
-      if (sumCount)
-      {
-        scalars->SetValue(
-          noDataValueIter->Row * this->Internals->OutputNumberOfColumns + noDataValueIter->Column,
-          sum / sumCount);
-      }
-    }
+    FillNoDataValue(scalars->GetPointer(0), this->Internals->OutputNumberOfRows,
+      this->Internals->OutputNumberOfColumns, *noDataValueIter, noDataValue);
   }
 }
 
-void vtkRawDEMReader::ReadData(
-  RawDEMReaderFileInfo& fileInfo, vtkFloatArray* scalars, vtkPoints* pts, vtkCellArray* verts)
+struct RawDEMReadUserData
 {
-  ifstream fin;
-
-  // read the binary "FLT" file
-  std::string fileNameStr = vtksys::SystemTools::GetFilenamePath(fileInfo.FileName) + "/" +
-    vtksys::SystemTools::GetFilenameWithoutLastExtension(fileInfo.FileName) + ".FLT";
-
-  fin.open(fileNameStr.c_str(), ios::binary);
+  vtkRawDEMReader* Reader;
+  vtkFloatArray* Scalars;
+  std::vector<RawDEMTileRead>* Tiles;
+};
 
-  // is there even anything to read from this file
-  if (this->Internals->Extents[2] >= fileInfo.Offset[1] + fileInfo.NumberOfRows ||
-    this->Internals->Extents[3] < fileInfo.Offset[1] ||
-    this->Internals->Extents[0] >= fileInfo.Offset[0] + fileInfo.NumberOfColumns ||
-    this->Internals->Extents[1] < fileInfo.Offset[0])
+VTK_THREAD_RETURN_TYPE vtkRawDEMReader::ReadTilesExecute(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  RawDEMReadUserData* userData = static_cast<RawDEMReadUserData*>(info->UserData);
+  std::vector<RawDEMTileRead>& tiles = *userData->Tiles;
+
+  int numberOfTiles = static_cast<int>(tiles.size());
+  int numberOfThreadTiles = (numberOfTiles - info->ThreadID + info->NumberOfThreads - 1) /
+    info->NumberOfThreads;
+  int tilesDone = 0;
+  for (int i = info->ThreadID; i < numberOfTiles; i += info->NumberOfThreads)
   {
-    return;
+    userData->Reader->ReadData(tiles[i], userData->Scalars);
+    // thread 0 is the calling thread; it alone reports progress
+    if (info->ThreadID == 0)
+    {
+      userData->Reader->UpdateProgress(static_cast<double>(++tilesDone) / numberOfThreadTiles);
+    }
   }
+  return VTK_THREAD_RETURN_VALUE;
+}
 
-  // from onRatio and Row/Column offsets, determine if we need to skip at the
-  // beginning rows / columns
+void vtkRawDEMReader::ReadTiles(vtkFloatArray* scalars, std::vector<RawDEMTileRead>& tiles)
+{
+  // from onRatio and Row/Column offsets, determine (for each file) which rows
+  // and columns are read and where they go in the output; each file is then
+  // split into bands of rows ("tiles") that are read independently
+  const vtkIdType rowsPerTile = 128;
   vtkIdType onRatio =
     static_cast<vtkIdType>(floor(sqrt(static_cast<double>(this->Internals->OnRatio))));
-  vtkIdType topRowRelativeToExtent =
-    this->Internals->Extents[3] - (fileInfo.Offset[1] + fileInfo.NumberOfRows - 1);
-  vtkIdType initialRowSkip;
-  if (topRowRelativeToExtent > 0)
-  {
-    initialRowSkip =
-      topRowRelativeToExtent % onRatio == 0 ? 0 : onRatio - (topRowRelativeToExtent % onRatio);
-  }
-  else
+  tiles.clear();
+  std::vector<RawDEMReaderFileInfo>::iterator fileInfo = this->Internals->FileInfo.begin();
+  for (; fileInfo != this->Internals->FileInfo.end(); fileInfo++)
   {
-    initialRowSkip = (fileInfo.Offset[1] + fileInfo.NumberOfRows - 1) - this->Internals->Extents[3];
+    // is there even anything to read from this file
+    if (this->Internals->Extents[2] >= fileInfo->Offset[1] + fileInfo->NumberOfRows ||
+      this->Internals->Extents[3] < fileInfo->Offset[1] ||
+      this->Internals->Extents[0] >= fileInfo->Offset[0] + fileInfo->NumberOfColumns ||
+      this->Internals->Extents[1] < fileInfo->Offset[0])
+    {
+      continue;
+    }
+
+    RawDEMTileRead tile;
+    tile.FileInfo = &(*fileInfo);
+    vtkIdType topRowRelativeToExtent =
+      this->Internals->Extents[3] - (fileInfo->Offset[1] + fileInfo->NumberOfRows - 1);
+    if (topRowRelativeToExtent > 0)
+    {
+      tile.InitialRowSkip =
+        topRowRelativeToExtent % onRatio == 0 ? 0 : onRatio - (topRowRelativeToExtent % onRatio);
+    }
+    else
+    {
+      tile.InitialRowSkip =
+        (fileInfo->Offset[1] + fileInfo->NumberOfRows - 1) - this->Internals->Extents[3];
+    }
+    vtkIdType leftColumnRelativeToExtent = fileInfo->Offset[0] - this->Internals->Extents[0];
+    if (leftColumnRelativeToExtent > 0)
+    {
+      tile.InitialColumnSkip = leftColumnRelativeToExtent % onRatio == 0 ? 0 : onRatio -
+          (leftColumnRelativeToExtent % onRatio);
+    }
+    else
+    {
+      tile.InitialColumnSkip = this->Internals->Extents[0] - fileInfo->Offset[0];
+    }
+
+    // how many rows/ columns do we not read at the end
+    vtkIdType lastPossibleRow = fileInfo->NumberOfRows - 1;
+    if (this->Internals->Extents[2] > fileInfo->Offset[1])
+    {
+      lastPossibleRow -= this->Internals->Extents[2] - fileInfo->Offset[1];
+    }
+    vtkIdType numberOfRows = 1 + (lastPossibleRow - tile.InitialRowSkip) / onRatio;
+
+    vtkIdType lastPossibleColumn = fileInfo->NumberOfColumns - 1;
+    if (this->Internals->Extents[1] < fileInfo->Offset[0] + fileInfo->NumberOfColumns - 1)
+    {
+      lastPossibleColumn -=
+        (fileInfo->Offset[0] + fileInfo->NumberOfColumns - 1) - this->Internals->Extents[1];
+    }
+    tile.NumberOfColumns = 1 + (lastPossibleColumn - tile.InitialColumnSkip) / onRatio;
+
+    // should be integer (no remainder) results
+    tile.OutputRowOffset = ((fileInfo->Offset[1] + fileInfo->NumberOfRows - 1) -
+                             tile.InitialRowSkip - this->Internals->Extents[2]) /
+      onRatio;
+    tile.OutputColumnOffset =
+      (fileInfo->Offset[0] + tile.InitialColumnSkip - this->Internals->Extents[0]) / onRatio;
+
+    // since data comes in from upper-left, we start with 1st row for output
+    // as "top" row... thus, due to skipping, we might not output some # of
+    // bottom rows, and thus need to adjust origin accordingly
+    tile.DataOrigin[0] = fileInfo->LongitudeOrigin +
+      static_cast<double>(this->Internals->Extents[0]) * fileInfo->PointSpacing;
+    tile.DataOrigin[1] = fileInfo->LatitudeOrigin -
+      static_cast<double>(this->Internals->NumberOfRows - 1 - this->Internals->Extents[2]) *
+        fileInfo->PointSpacing;
+    tile.Status = READ_OK;
+
+    for (vtkIdType row = 0; row < numberOfRows; row += rowsPerTile)
+    {
+      tile.FirstRow = row;
+      tile.EndRow = std::min(row + rowsPerTile, numberOfRows);
+      tiles.push_back(tile);
+    }
   }
-  if (initialRowSkip)
+
+  if (tiles.empty())
   {
-    fin.seekg(4 * initialRowSkip * fileInfo.NumberOfColumns, ios::cur);
+    this->UpdateProgress(1.0);
+    return;
   }
-  vtkIdType leftColumnRelativeToExtent = fileInfo.Offset[0] - this->Internals->Extents[0];
-  vtkIdType initialColumnSkip;
-  if (leftColumnRelativeToExtent > 0)
+
+  // the transforms are shared by the threads; bring them up to date here
+  // so that only the (const) InternalTransformPoint is used while reading
+  if (!scalars)
   {
-    initialColumnSkip = leftColumnRelativeToExtent % onRatio == 0 ? 0 : onRatio -
-        (leftColumnRelativeToExtent % onRatio);
+    this->LatLongTransform1->Update();
+    this->LatLongTransform2->Update();
+    if (this->Transform)
+    {
+      this->Transform->Update();
+    }
   }
-  else
+
+  vtkNew<vtkMultiThreader> threader;
+  int numberOfThreads = threader->GetNumberOfThreads();
+  if (numberOfThreads > static_cast<int>(tiles.size()))
   {
-    initialColumnSkip = this->Internals->Extents[0] - fileInfo.Offset[0];
+    numberOfThreads = static_cast<int>(tiles.size());
   }
+  threader->SetNumberOfThreads(numberOfThreads);
+
+  RawDEMReadUserData userData;
+  userData.Reader = this;
+  userData.Scalars = scalars;
+  userData.Tiles = &tiles;
+  threader->SetSingleMethod(vtkRawDEMReader::ReadTilesExecute, &userData);
+  threader->SingleMethodExecute();
+  this->UpdateProgress(1.0);
 
-  // how many rows/ columns do we not read at the end
-  vtkIdType lastPossibleRow = fileInfo.NumberOfRows - 1;
-  if (this->Internals->Extents[2] > fileInfo.Offset[1])
+  //// set our DataBounds, and report the files (not tiles) that couldn't be read
+  vtkBoundingBox bbox;
+  std::string failedFiles;
+  const RawDEMReaderFileInfo* lastFailedFile = 0;
+  std::vector<RawDEMTileRead>::const_iterator tile;
+  for (tile = tiles.begin(); tile != tiles.end(); tile++)
   {
-    lastPossibleRow -= this->Internals->Extents[2] - fileInfo.Offset[1];
+    if (tile->Status == READ_ERROR && tile->FileInfo != lastFailedFile)
+    {
+      failedFiles += (lastFailedFile ? ", " : "") + tile->FileInfo->FileName;
+      lastFailedFile = tile->FileInfo;
+    }
+    if (tile->BBox.IsValid())
+    {
+      bbox.AddBox(tile->BBox);
+    }
   }
-  vtkIdType numberOfRows = 1 + (lastPossibleRow - initialRowSkip) / onRatio;
-
-  vtkIdType lastPossibleColumn = fileInfo.NumberOfColumns - 1;
-  if (this->Internals->Extents[1] < fileInfo.Offset[0] + fileInfo.NumberOfColumns - 1)
+  bbox.GetBounds(this->DataBounds);
+  if (lastFailedFile)
   {
-    lastPossibleColumn -=
-      (fileInfo.Offset[0] + fileInfo.NumberOfColumns - 1) - this->Internals->Extents[1];
+    vtkErrorMacro("Unable to read file(s): " << failedFiles);
   }
-  vtkIdType numberOfColumns = 1 + (lastPossibleColumn - initialColumnSkip) / onRatio;
+}
 
-  // how much do we skip at the end of each row
-  vtkIdType lastActualColumn = initialColumnSkip + (numberOfColumns - 1) * onRatio;
-  vtkIdType endRowSkip = (fileInfo.NumberOfColumns - 1) - lastActualColumn;
-  // should be integer (no remainder) results
-  vtkIdType outputRowOffset = ((fileInfo.Offset[1] + fileInfo.NumberOfRows - 1) - initialRowSkip -
-                                this->Internals->Extents[2]) /
-    onRatio;
-  vtkIdType outputColumnOffset =
-    (fileInfo.Offset[0] + initialColumnSkip - this->Internals->Extents[0]) / onRatio;
+void vtkRawDEMReader::ReadData(RawDEMTileRead& tile, vtkFloatArray* scalars)
+{
+  RawDEMReaderFileInfo& fileInfo = *tile.FileInfo;
+  ifstream fin;
 
-  // since data comes in from upper-left, we start with 1st row for output
-  // as "top" row... thus, due to skipping, we might not output some # of
-  // bottom rows, and thus need to adjust origin accordingly
-  double dataOrigin[3] = { /*this->Internals->LongitudeMidPoint + */ fileInfo.LongitudeOrigin +
-      static_cast<double>(this->Internals->Extents[0]) * fileInfo.PointSpacing,
-    /*this->Internals->LatitudeMidPoint + */ fileInfo.LatitudeOrigin -
-      static_cast<double>(this->Internals->NumberOfRows - 1 - this->Internals->Extents[2]) *
-        fileInfo.PointSpacing,
-    0 };
+  // read the binary "FLT" file
+  std::string fileNameStr = vtksys::SystemTools::GetFilenamePath(fileInfo.FileName) + "/" +
+    vtksys::SystemTools::GetFilenameWithoutLastExtension(fileInfo.FileName) + ".FLT";
 
-  double rowProgressDelta = static_cast<double>(numberOfColumns) /
-    (static_cast<double>(this->Internals->OutputNumberOfColumns) *
-                              static_cast<double>(this->Internals->OutputNumberOfRows));
+  fin.open(fileNameStr.c_str(), ios::binary);
+  if (!fin)
+  {
+    tile.Status = READ_ERROR;
+    return;
+  }
 
-  vtkBoundingBox bbox;
-  float rawData;
-  for (vtkIdType row = 0; row < numberOfRows; row++)
+  vtkIdType onRatio =
+    static_cast<vtkIdType>(floor(sqrt(static_cast<double>(this->Internals->OnRatio))));
+  vtkIdType outputNumberOfColumns = this->Internals->OutputNumberOfColumns;
+
+  // each row is read as a whole, from the 1st to the last column kept
+  std::vector<float> rowData((tile.NumberOfColumns - 1) * onRatio + 1);
+  for (vtkIdType row = tile.FirstRow; row < tile.EndRow; row++)
   {
-    vtkIdType outputImageOffset =
-      outputColumnOffset + (outputRowOffset - row) * this->Internals->OutputNumberOfColumns;
-    if (initialColumnSkip)
+    if (this->GetAbortExecute())
     {
-      fin.ignore(4 * initialColumnSkip);
+      tile.Status = READ_ABORT;
+      break;
     }
-    for (vtkIdType column = 0; column < numberOfColumns; column++)
+
+    std::streamoff rowStart = static_cast<std::streamoff>(4) *
+      ((tile.InitialRowSkip + row * onRatio) * fileInfo.NumberOfColumns + tile.InitialColumnSkip);
+    fin.seekg(rowStart, ios::beg);
+    fin.read(reinterpret_cast<char*>(&rowData[0]), 4 * rowData.size());
+    if (!fin)
     {
-      fin.read(reinterpret_cast<char*>(&rawData), 4);
+      tile.Status = READ_ERROR;
+      break;
+    }
 
-      if (scalars)
+    vtkIdType outputRow = tile.OutputRowOffset - row;
+    if (scalars)
+    {
+      // set, regardless of whether "NoDataValue", but if NoDataValue,
+      // save location to allow fixing
+      float* outputImage = scalars->GetPointer(0) + tile.OutputColumnOffset +
+        outputRow * outputNumberOfColumns;
+      for (vtkIdType column = 0; column < tile.NumberOfColumns; column++)
       {
-        // set, regardless of whether "NoDataValue", but if NoDataValue,
-        // save location to allow fixing
-        scalars->SetValue(outputImageOffset + column, rawData);
+        float rawData = rowData[column * onRatio];
+        outputImage[column] = rawData;
         if (rawData == fileInfo.NoDataValue)
         {
-          RowCol tmp(outputRowOffset - row, outputColumnOffset + column);
-          this->Internals->NoDataValueInstances.push_back(tmp);
+          tile.NoDataValueInstances.push_back(RowCol(outputRow, tile.OutputColumnOffset + column));
         }
       }
-      else
+      continue;
+    }
+
+    for (vtkIdType column = 0; column < tile.NumberOfColumns; column++)
+    {
+      float rawData = rowData[column * onRatio];
+      if (rawData == fileInfo.NoDataValue)
       {
-        double pt[3];
-        pt[0] = dataOrigin[0] +
-          fileInfo.PointSpacing * static_cast<double>(column * onRatio + initialColumnSkip);
-        pt[1] = dataOrigin[1] -
-          fileInfo.PointSpacing * static_cast<double>(row * onRatio + initialRowSkip);
-        pt[2] = rawData;
-
-        if (pt[2] != fileInfo.NoDataValue)
-        {
-          if (this->ConvertFromLatLongToXYZ)
-          {
-            this->LatLongTransform1->TransformPoint(pt, pt);
-            if (this->TransformForZUp)
-            {
-              this->LatLongTransform2->TransformPoint(pt, pt);
-              if (this->RemoveCurvature)
-              {
-                pt[2] = rawData;
-              }
-            }
-          }
-          pt[0] -= Origin[0];
-          pt[1] -= Origin[1];
-          pt[2] -= Origin[2];
-          bbox.AddPoint(pt[0], pt[1], pt[2]);
-
-          // add the point, but 1st make sure it is in the ReadBounds (if specified);
-          // consider the Transform if set (and "on")
-          double transformedPt[3];
-          bool addPt = true;
-          if (this->Transform)
-          {
-            // only need the transformed pt if we're limiting read based on bounds or
-            // we're transforming the output
-            if (this->LimitReadToBounds || this->TransformOutputData)
-            {
-              this->Transform->TransformPoint(pt, transformedPt);
-            }
-            if (this->LimitReadToBounds &&
-              !this->ReadBBox.ContainsPoint(transformedPt[0], transformedPt[1], transformedPt[2]))
-            {
-              addPt = false;
-            }
-          }
-          else // not transformed, use as read in
-          {
-            if (this->LimitReadToBounds && !this->ReadBBox.ContainsPoint(pt[0], pt[1], pt[2]))
-            {
-              addPt = false;
-            }
-          }
+        continue;
+      }
+
+      double pt[3];
+      pt[0] = tile.DataOrigin[0] +
+        fileInfo.PointSpacing * static_cast<double>(column * onRatio + tile.InitialColumnSkip);
+      pt[1] = tile.DataOrigin[1] -
+        fileInfo.PointSpacing * static_cast<double>(row * onRatio + tile.InitialRowSkip);
+      pt[2] = rawData;
 
-          if (addPt)
+      if (this->ConvertFromLatLongToXYZ)
+      {
+        this->LatLongTransform1->InternalTransformPoint(pt, pt);
+        if (this->TransformForZUp)
+        {
+          this->LatLongTransform2->InternalTransformPoint(pt, pt);
+          if (this->RemoveCurvature)
           {
-            vtkIdType outputIdx;
-            if (this->Transform && this->TransformOutputData)
-            {
-              outputIdx = pts->InsertNextPoint(transformedPt);
-            }
-            else
-            {
-              //double tmppts[3]={pt[0], pt[2], pt[1]};
-              outputIdx = pts->InsertNextPoint(pt);
-            }
-            verts->InsertNextCell(1, &outputIdx);
+            pt[2] = rawData;
           }
         }
       }
-
-      if (column == numberOfColumns - 1 && endRowSkip) // read the rest of the row
+      pt[0] -= Origin[0];
+      pt[1] -= Origin[1];
+      pt[2] -= Origin[2];
+      tile.BBox.AddPoint(pt[0], pt[1], pt[2]);
+
+      // add the point, but 1st make sure it is in the ReadBounds (if specified);
+      // consider the Transform if set (and "on")
+      double transformedPt[3];
+      bool addPt = true;
+      if (this->Transform)
       {
-        fin.ignore(4 * endRowSkip);
+        // only need the transformed pt if we're limiting read based on bounds or
+        // we're transforming the output
+        if (this->LimitReadToBounds || this->TransformOutputData)
+        {
+          this->Transform->InternalTransformPoint(pt, transformedPt);
+        }
+        if (this->LimitReadToBounds &&
+          !this->ReadBBox.ContainsPoint(transformedPt[0], transformedPt[1], transformedPt[2]))
+        {
+          addPt = false;
+        }
       }
-      else if (onRatio > 1)
+      else // not transformed, use as read in
       {
-        fin.ignore(4 * (onRatio - 1));
+        if (this->LimitReadToBounds && !this->ReadBBox.ContainsPoint(pt[0], pt[1], pt[2]))
+        {
+          addPt = false;
+        }
       }
-    }
-    this->UpdateProgress(this->GetProgress() + rowProgressDelta);
-    //    this->UpdateProgress( (double)(row + 1) / (double)numberOfRows );
-    if (this->GetAbortExecute())
-    {
-      break;
-    }
 
-    if (onRatio > 1)
-    {
-      if (row < numberOfRows - 1) // skip over appropriate # of rows
+      if (addPt)
       {
-        fin.seekg(4 * (onRatio - 1) * fileInfo.NumberOfColumns, ios::cur);
+        double* outputPt = (this->Transform && this->TransformOutputData) ? transformedPt : pt;
+        tile.Points.insert(tile.Points.end(), outputPt, outputPt + 3);
       }
     }
   }
   fin.close();
-  this->UpdateProgress(1.0);
-
-  //// set our DataBounds
-  bbox.GetBounds(this->DataBounds);
 }
 
 vtkIdType vtkRawDEMReader::GetTotalNumberOfPoints()
@@ -19,7 +19,9 @@
 #include "vtkSmartPointer.h"
 
 #include "vtkBoundingBox.h"
+#include "vtkMultiThreader.h" // For VTK_THREAD_RETURN_TYPE
 #include <string>
+#include <vector>
 
 class vtkCellArray;
 class vtkFloatArray;
@@ -27,6 +29,7 @@ class vtkPoints;
 class vtkTransform;
 class vtkGeoSphereTransform;
 class vtkRawDEMReaderInternals;
+struct RawDEMTileRead;
 
 #define VTK_ASCII 1
 #define VTK_BINARY 2
@@ -195,8 +198,14 @@ protected:
 
   void ReadImageDataOutput(vtkImageData* output);
 
-  void ReadData(
-    RawDEMReaderFileInfo& fileInfo, vtkFloatArray* scalars, vtkPoints* pts, vtkCellArray* verts);
+  // Description:
+  // Read the files in bands of rows ("tiles"), concurrently.  With image
+  // output, each tile is written directly into its part of scalars, and its
+  // NoDataValue instances collected in the tile; else the points of each
+  // tile are collected in the tile.
+  void ReadTiles(vtkFloatArray* scalars, std::vector<RawDEMTileRead>& tiles);
+  void ReadData(RawDEMTileRead& tile, vtkFloatArray* scalars);
+  static VTK_THREAD_RETURN_TYPE ReadTilesExecute(void* arg);
 
   void SetupReadExtents();
 
@@ -10,6 +10,7 @@
 #include "vtkCMBMeshTerrainWithArcs.h"
 
 #include "vtkAppendPolyData.h"
+#include "vtkCMBBathymetryInterpolator.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCellLocator.h"
@@ -17,7 +18,6 @@
 #include "vtkDoubleArray.h"
 #include "vtkFloatArray.h"
 #include "vtkGenericCell.h"
-#include "vtkIncrementalOctreePointLocator.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkNew.h"
@@ -60,30 +60,6 @@ struct PInfo
 };
 };
 
-class vtkCMBMeshTerrainWithArcs::vtkCmbInternalTerrainInfo
-{
-public:
-  vtkCmbInternalTerrainInfo(
-    vtkInformationVector* input, const double& radius, const double& groundElevation);
-  ~vtkCmbInternalTerrainInfo()
-  {
-    if (this->Locator)
-    {
-      this->Locator->Delete();
-    }
-  }
-  //returns the average elevation for a circle given the radius
-  template <class T>
-  T getElevation(T* point);
-  void setRadius(const double& r) { Radius = r; }
-  void setGroundElevation(const double& ge) { GroundElevation = ge; }
-protected:
-  double Radius;
-  double GroundElevation;
-  std::map<vtkIdType, double> IdToElevation;
-  vtkIncrementalOctreePointLocator* Locator;
-};
-
 class vtkCMBMeshTerrainWithArcs::vtkCmbPolygonInfo
 {
 public:
@@ -91,15 +67,39 @@ public:
   int GroundIndex;
 };
 
-vtkCMBMeshTerrainWithArcs::vtkCmbInternalTerrainInfo::vtkCmbInternalTerrainInfo(
-  vtkInformationVector* input, const double& radius, const double& groundElevation)
-  : Radius(radius)
-  , GroundElevation(groundElevation)
+vtkCMBMeshTerrainWithArcs::vtkCMBMeshTerrainWithArcs()
+{
+  this->PolygonInfo = new vtkCmbPolygonInfo();
+  this->TerrainInfo = vtkCMBBathymetryInterpolator::New();
+  this->SetNumberOfInputPorts(2);
+  this->ElevationRadius = 1.0;
+  this->VOIBounds[0] = 0.0;
+  this->VOIBounds[1] = 1.0;
+  this->VOIBounds[2] = 0.0;
+  this->VOIBounds[3] = 1.0;
+  this->VOIBounds[4] = 0.0;
+  this->VOIBounds[5] = 1.0;
+
+  this->NumberOfProgressSteps = 10;
+  this->StepIncrement = 0.1;
+
+  this->Mesher = vtkCMBTriangleMesher::New();
+  this->MesherMaxArea = 0.125;
+}
+
+vtkCMBMeshTerrainWithArcs::~vtkCMBMeshTerrainWithArcs()
+{
+  delete this->PolygonInfo;
+  this->TerrainInfo->Delete();
+  this->Mesher->Delete();
+}
+
+void vtkCMBMeshTerrainWithArcs::SetupTerrainInfo(vtkInformationVector* input)
 {
   //1. Go through all the input data objects and collect the size of all the point dataset
   //2. Create a super set of points while removing all the z values from the points
-  //and storing them in the map.
-  //3. Create locator of the resulting 2D point set
+  //and storing them as the elevation of the point.
+  //3. Bin the resulting 2D point set
 
   vtkIdType numPoints = 0;
   int numInputs = input->GetNumberOfInformationObjects();
@@ -113,11 +113,8 @@ vtkCMBMeshTerrainWithArcs::vtkCmbInternalTerrainInfo::vtkCmbInternalTerrainInfo(
     }
   }
 
-  //second iteration is building the point set and elevation mapping
-  vtkPoints* inputPoints = NULL;
-  vtkPoints* points = vtkPoints::New();
-  points->SetNumberOfPoints(numPoints);
-
+  //second iteration is building the point set and elevations
+  this->TerrainInfo->SetNumberOfSourcePoints(numPoints);
   vtkIdType index = 0;
   double p[3];
   for (int idx = 0; idx < numInputs; ++idx)
@@ -125,88 +122,19 @@ vtkCMBMeshTerrainWithArcs::vtkCmbInternalTerrainInfo::vtkCmbInternalTerrainInfo(
     pd = vtkPolyData::GetData(input, idx);
     if (pd)
     {
-      inputPoints = pd->GetPoints();
+      vtkPoints* inputPoints = pd->GetPoints();
       vtkIdType size = inputPoints->GetNumberOfPoints();
-      for (vtkIdType i = 0; i < size; ++i)
+      for (vtkIdType i = 0; i < size; ++i, ++index)
       {
-        //get the point
         inputPoints->GetPoint(i, p);
-
-        //store the z value & flatten
-        double elev = p[2];
-        p[2] = 0.0;
-        points->InsertPoint(index, p);
-        this->IdToElevation.insert(std::pair<vtkIdType, double>(index, elev));
-        ++index;
+        this->TerrainInfo->SetSourcePoint(index, p[0], p[1], p[2]);
       }
     }
   }
 
-  vtkPolyData* pointSet = vtkPolyData::New();
-  pointSet->SetPoints(points);
-  points->FastDelete();
-
-  this->Locator = vtkIncrementalOctreePointLocator::New();
-  this->Locator->AutomaticOn();
-  this->Locator->SetTolerance(0.0);
-  this->Locator->SetDataSet(pointSet);
-  this->Locator->BuildLocator();
-  pointSet->Delete();
-}
-
-template <class T>
-T vtkCMBMeshTerrainWithArcs::vtkCmbInternalTerrainInfo::getElevation(T* point)
-{
-  double dpoint[3];
-  dpoint[0] = static_cast<double>(point[0]);
-  dpoint[1] = static_cast<double>(point[1]);
-  dpoint[2] = static_cast<double>(point[2]);
-  vtkIdList* ids = vtkIdList::New();
-  this->Locator->FindPointsWithinRadius(this->Radius, dpoint, ids);
-  double sum = 0;
-  std::map<vtkIdType, double>::const_iterator it;
-  vtkIdType size = ids->GetNumberOfIds();
-  for (vtkIdType i = 0; i < size; ++i)
-  {
-    //average the elevation
-    it = this->IdToElevation.find(ids->GetId(i));
-    if (it != this->IdToElevation.end())
-    {
-      sum += it->second;
-    }
-  }
-  ids->Delete();
-
-  //handle the zero size use case
-  T elev = static_cast<T>((size == 0) ? this->GroundElevation : sum / size);
-  return elev;
-}
-
-vtkCMBMeshTerrainWithArcs::vtkCMBMeshTerrainWithArcs()
-{
-  this->PolygonInfo = new vtkCmbPolygonInfo();
-  this->TerrainInfo = NULL;
-  this->SetNumberOfInputPorts(2);
-  this->ElevationRadius = 1.0;
-  this->VOIBounds[0] = 0.0;
-  this->VOIBounds[1] = 1.0;
-  this->VOIBounds[2] = 0.0;
-  this->VOIBounds[3] = 1.0;
-  this->VOIBounds[4] = 0.0;
-  this->VOIBounds[5] = 1.0;
-
-  this->NumberOfProgressSteps = 10;
-  this->StepIncrement = 0.1;
-
-  this->Mesher = vtkCMBTriangleMesher::New();
-  this->MesherMaxArea = 0.125;
-}
-
-vtkCMBMeshTerrainWithArcs::~vtkCMBMeshTerrainWithArcs()
-{
-  delete this->PolygonInfo;
-  delete this->TerrainInfo;
-  this->Mesher->Delete();
+  this->TerrainInfo->SetElevationRadius(this->ElevationRadius);
+  this->TerrainInfo->SetInvalidValue(this->VOIBounds[4]);
+  this->TerrainInfo->BuildLocator();
 }
 
 int vtkCMBMeshTerrainWithArcs::FillInputPortInformation(int port, vtkInformation* info)
@@ -307,8 +235,7 @@ int vtkCMBMeshTerrainWithArcs::RequestData(
     //boundary that the ground plane generated.
 
     //Construct the TerrainInfo first
-    this->TerrainInfo =
-      new vtkCmbInternalTerrainInfo(inputVector[0], this->ElevationRadius, this->VOIBounds[4]);
+    this->SetupTerrainInfo(inputVector[0]);
 
     vtkPolyData* finalMesh = vtkPolyData::New();
     finalMesh->DeepCopy(mesherResult);
@@ -328,8 +255,8 @@ int vtkCMBMeshTerrainWithArcs::RequestData(
     }
     mesherResult->Delete();
 
-    delete this->TerrainInfo;
-    this->TerrainInfo = NULL;
+    // don't hold on to the (possibly huge) terrain
+    this->TerrainInfo->SetNumberOfSourcePoints(0);
 
     vtkPolyData* output = vtkPolyData::GetData(outputVector);
     output->ShallowCopy(finalMesh);
@@ -674,8 +601,7 @@ bool vtkCMBMeshTerrainWithArcs::ExtrudeArcMesh(vtkPolyData* mesh, const int& ind
       if (SidesBottomToTop.find(meshId) == SidesBottomToTop.end())
       {
         points->GetPoint(meshId, p);
-        p[2] = 0; //set it to zero so get the right info
-        p[2] = this->TerrainInfo->getElevation(p);
+        p[2] = this->TerrainInfo->GetElevation(p[0], p[1]);
         newGroundId = points->InsertNextPoint(p);
       }
       else
@@ -725,27 +651,8 @@ bool vtkCMBMeshTerrainWithArcs::UnFlattenMesh(vtkPoints* points, const double& h
 
 bool vtkCMBMeshTerrainWithArcs::ExtrudeMeshPoints(vtkPoints* points) const
 {
-  //get the point data void pointer
-  vtkDataArray* dataArray = points->GetData();
-  vtkIdType size = points->GetNumberOfPoints();
-  if (dataArray->GetDataType() == VTK_FLOAT)
-  {
-    vtkFloatArray* floatArray = static_cast<vtkFloatArray*>(dataArray);
-    float* pos = floatArray->GetPointer(0);
-    for (vtkIdType i = 0; i < size; ++i, pos += 3)
-    {
-      pos[2] = this->TerrainInfo->getElevation(pos);
-    }
-  }
-  else
-  {
-    vtkDoubleArray* doubleArray = static_cast<vtkDoubleArray*>(dataArray);
-    double* pos = doubleArray->GetPointer(0);
-    for (vtkIdType i = 0; i < size; ++i, pos += 3)
-    {
-      pos[2] = this->TerrainInfo->getElevation(pos);
-    }
-  }
+  // the points are independent of each other; done in parallel
+  this->TerrainInfo->InterpolateElevations(points);
   return true;
 }
 
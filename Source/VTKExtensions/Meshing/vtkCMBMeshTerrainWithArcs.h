@@ -19,6 +19,7 @@
 
 class vtkPoints;
 class vtkCellArray;
+class vtkCMBBathymetryInterpolator;
 class vtkCMBTriangleMesher;
 
 class VTKCMBMESHING_EXPORT vtkCMBMeshTerrainWithArcs : public vtkPolyDataAlgorithm
@@ -63,6 +64,9 @@ protected:
   bool FlattenMesh(vtkPoints*) const;
   void InsertGroundPlane(vtkPoints*, vtkCellArray*) const;
 
+  //methods for the terrain the mesh is extruded to
+  void SetupTerrainInfo(vtkInformationVector* input);
+
   //methods for ground mesh reconstruction
   bool GenerateGroundMesh(vtkPolyData* mesh);
   bool ExtrudeMeshPoints(vtkPoints* points) const;
@@ -85,10 +89,7 @@ protected:
   vtkCmbPolygonInfo* PolygonInfo;
   //ETX
 
-  //BTX
-  class vtkCmbInternalTerrainInfo;
-  vtkCmbInternalTerrainInfo* TerrainInfo;
-  //ETX
+  vtkCMBBathymetryInterpolator* TerrainInfo;
 
   vtkCMBTriangleMesher* Mesher;
   double MesherMaxArea;
@@ -16,23 +16,246 @@
 #include "vtkFloatArray.h"
 #include "vtkInformation.h"
 #include "vtkMultiBlockDataSet.h"
+#include "vtkMultiThreader.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
 
 #include "smtk/extension/vtk/meshing/cmbFaceMeshHelper.h"
 #include "smtk/extension/vtk/meshing/cmbFaceMesherInterface.h"
 #include "smtk/extension/vtk/meshing/vtkCMBMeshServerLauncher.h"
 #include "smtk/extension/vtk/meshing/vtkCMBPrepareForTriangleMesher.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <sstream>
+#include <vector>
 #include <vtksys/SystemTools.hxx>
 
 vtkStandardNewMacro(vtkCMBTriangleMultiBlockMesher);
 
 using namespace CmbFaceMesherClasses;
 
+namespace
+{
+typedef std::pair<double, double> Point2D;
+// the end points of an edge, the smallest first
+typedef std::pair<Point2D, Point2D> Edge2D;
+
+// Collect the edges of the mesh used by a single triangle
+void FindBoundaryEdges(vtkPolyData* mesh, std::vector<Edge2D>& boundary)
+{
+  boundary.clear();
+  vtkCellArray* polys = mesh->GetPolys();
+  if (!polys || polys->GetNumberOfCells() == 0)
+  {
+    return;
+  }
+  std::vector<std::pair<vtkIdType, vtkIdType> > edges;
+  edges.reserve(3 * polys->GetNumberOfCells());
+  vtkIdType npts;
+  vtkIdType* pts;
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts);)
+  {
+    for (vtkIdType i = 0; i < npts; i++)
+    {
+      vtkIdType a = pts[i];
+      vtkIdType b = pts[(i + 1) % npts];
+      edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+
+  double p[3], q[3];
+  for (std::size_t i = 0; i < edges.size();)
+  {
+    std::size_t j = i + 1;
+    while (j < edges.size() && edges[j] == edges[i])
+    {
+      j++;
+    }
+    if (j == i + 1)
+    {
+      mesh->GetPoint(edges[i].first, p);
+      mesh->GetPoint(edges[i].second, q);
+      Point2D a(p[0], p[1]);
+      Point2D b(q[0], q[1]);
+      boundary.push_back(a < b ? Edge2D(a, b) : Edge2D(b, a));
+    }
+    i = j;
+  }
+}
+
+// Whether v is inside the segment, away from its end points
+bool IsInsideEdge(const Edge2D& e, const Point2D& v)
+{
+  const double dx = e.second.first - e.first.first;
+  const double dy = e.second.second - e.first.second;
+  const double wx = v.first - e.first.first;
+  const double wy = v.second - e.first.second;
+  const double length2 = dx * dx + dy * dy;
+  const double t = wx * dx + wy * dy;
+  const double tolerance = 1e-9 * length2;
+  return length2 > 0.0 && t > tolerance && t < length2 - tolerance &&
+    std::fabs(wx * dy - wy * dx) <= tolerance;
+}
+}
+
+// Meshes each face into its own block on vtkMultiThreader threads; the
+// faces are handed out cyclically, and each thread also finds the boundary
+// of the meshes it made for the conformity check.
+//
+// A mesh server runs a single Triangle worker, which would run the jobs of
+// all the threads one after the other, so each thread submits its faces to
+// its own server.  cmbFaceMesherInterface::buildFaceMesh connects a new
+// remus client to the server for every face, so no remus client (or its
+// zmq context and socket) is shared between the threads.
+struct vtkCMBTriangleMultiBlockMesherWorker
+{
+  struct FaceJob
+  {
+    vtkIdType FaceId;
+    ModelFaceRep* Face;
+    double MaxArea;
+    vtkPolyData* Mesh;
+    std::vector<Edge2D> Boundary;
+  };
+
+  vtkCMBTriangleMultiBlockMesher* Mesher;
+  std::vector<FaceJob> Faces;
+  // one per thread
+  std::vector<vtkSmartPointer<vtkCMBMeshServerLauncher> > MeshServers;
+
+  // Returns false if not even one mesh server could be launched.
+  bool Run()
+  {
+    if (this->Faces.empty())
+    {
+      return true;
+    }
+    const int numberOfThreads =
+      std::min(this->Mesher->NumberOfThreads, static_cast<int>(this->Faces.size()));
+
+    // launch the servers before the threads start; if one fails to launch
+    // the faces are meshed by the servers that did
+    for (int i = 0; i < numberOfThreads; i++)
+    {
+      vtkSmartPointer<vtkCMBMeshServerLauncher> meshServer =
+        vtkSmartPointer<vtkCMBMeshServerLauncher>::New();
+      if (!meshServer->IsAlive())
+      {
+        break;
+      }
+      this->MeshServers.push_back(meshServer);
+    }
+    if (this->MeshServers.empty())
+    {
+      return false;
+    }
+    if (static_cast<int>(this->MeshServers.size()) < numberOfThreads)
+    {
+      vtkWarningWithObjectMacro(this->Mesher, << "Only " << this->MeshServers.size() << " of "
+                                              << numberOfThreads << " mesh servers launched");
+    }
+
+    vtkNew<vtkMultiThreader> threader;
+    threader->SetNumberOfThreads(static_cast<int>(this->MeshServers.size()));
+    threader->SetSingleMethod(vtkCMBTriangleMultiBlockMesherWorker::Execute, this);
+    threader->SingleMethodExecute();
+    this->MeshServers.clear();
+    return true;
+  }
+
+  static VTK_THREAD_RETURN_TYPE Execute(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    vtkCMBTriangleMultiBlockMesherWorker* self =
+      static_cast<vtkCMBTriangleMultiBlockMesherWorker*>(info->UserData);
+    for (std::size_t i = info->ThreadID; i < self->Faces.size(); i += info->NumberOfThreads)
+    {
+      self->MeshFace(self->Faces[i], self->MeshServers[info->ThreadID]);
+    }
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  void MeshFace(FaceJob& job, vtkCMBMeshServerLauncher* meshServer)
+  {
+    const vtkCMBTriangleMultiBlockMesher* m = this->Mesher;
+    ModelFaceRep* face = job.Face;
+    cmbFaceMesherInterface ti(
+      face->numberOfVertices(), face->numberOfEdges(), face->numberOfHoles(), m->PreserveEdges);
+    ti.setUseMaxArea(m->MaxAreaMode != vtkCMBTriangleMultiBlockMesher::NoMaxArea);
+    ti.setMaxArea(job.MaxArea);
+    ti.setUseMinAngle(m->UseMinAngle);
+    ti.setMinAngle(m->MinAngle);
+    ti.setPreserveBoundaries(m->PreserveBoundaries);
+    ti.setVerboseOutput(m->VerboseOutput);
+    ti.setOutputMesh(job.Mesh);
+    face->fillTriangleInterface(&ti);
+    ti.buildFaceMesh(meshServer, job.FaceId, 0);
+    FindBoundaryEdges(job.Mesh, job.Boundary);
+  }
+
+  // Count the boundary edges of a face mesh with a boundary point of
+  // another face mesh inside them: the other face split an edge they
+  // share, so the meshes don't match along it.
+  vtkIdType CountNonConformingEdges() const
+  {
+    // the edges that are not on the boundary of two face meshes are either
+    // on the boundary of the model, or split differently by two faces
+    std::map<Edge2D, int> edgeCounts;
+    for (std::size_t f = 0; f < this->Faces.size(); f++)
+    {
+      const std::vector<Edge2D>& boundary = this->Faces[f].Boundary;
+      for (std::size_t i = 0; i < boundary.size(); i++)
+      {
+        edgeCounts[boundary[i]]++;
+      }
+    }
+    std::vector<std::pair<Edge2D, std::size_t> > unmatched;
+    std::vector<std::pair<Point2D, std::size_t> > vertices;
+    for (std::size_t f = 0; f < this->Faces.size(); f++)
+    {
+      const std::vector<Edge2D>& boundary = this->Faces[f].Boundary;
+      for (std::size_t i = 0; i < boundary.size(); i++)
+      {
+        if (edgeCounts[boundary[i]] == 1)
+        {
+          unmatched.push_back(std::make_pair(boundary[i], f));
+          vertices.push_back(std::make_pair(boundary[i].first, f));
+          vertices.push_back(std::make_pair(boundary[i].second, f));
+        }
+      }
+    }
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+    // the vertices are sorted by x, so only those in the x range of the
+    // edge are tested
+    vtkIdType count = 0;
+    const double lowest = -std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < unmatched.size(); i++)
+    {
+      const Edge2D& e = unmatched[i].first;
+      const std::pair<Point2D, std::size_t> first(Point2D(e.first.first, lowest), 0);
+      std::vector<std::pair<Point2D, std::size_t> >::const_iterator v =
+        std::lower_bound(vertices.begin(), vertices.end(), first);
+      for (; v != vertices.end() && v->first.first <= e.second.first; ++v)
+      {
+        if (v->second != unmatched[i].second && IsInsideEdge(e, v->first))
+        {
+          count++;
+          break;
+        }
+      }
+    }
+    return count;
+  }
+};
+
 vtkCMBTriangleMultiBlockMesher::vtkCMBTriangleMultiBlockMesher()
 {
   MinAngle = 20.0f;
@@ -44,6 +267,8 @@ vtkCMBTriangleMultiBlockMesher::vtkCMBTriangleMultiBlockMesher()
   UseUniqueAreas = false;
   MaxAreaMode = RelativeToBoundsAndSegments;
   VerboseOutput = false;
+  NumberOfThreads = 1;
+  NumberOfNonConformingEdges = 0;
 
   this->SetNumberOfInputPorts(1);
   this->SetNumberOfOutputPorts(1);
@@ -76,6 +301,8 @@ void vtkCMBTriangleMultiBlockMesher::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "      Max Area Mode: " << areaModeType[MaxAreaMode] << endl;
   os << indent << "   Use Unique Areas: " << UseUniqueAreas << endl;
   os << indent << "     Verbose Output: " << VerboseOutput << endl;
+  os << indent << "  Number Of Threads: " << NumberOfThreads << endl;
+  os << indent << "Non Conforming Edges: " << NumberOfNonConformingEdges << endl;
   this->Superclass::PrintSelf(os, indent);
 }
 
@@ -102,9 +329,10 @@ int vtkCMBTriangleMultiBlockMesher::RequestData(vtkInformation* /*request*/,
 
   output->SetNumberOfBlocks(static_cast<unsigned>(pid2Face.size()));
   unsigned blocknum = 0;
-  // Mesh each polygon individually then append all their polydata together
-  typedef vtkCMBMeshServerLauncher vtkMeshServerLauncher;
-  vtkNew<vtkMeshServerLauncher> meshServer;
+  // Mesh each polygon individually, each into its own block
+  vtkCMBTriangleMultiBlockMesherWorker worker;
+  worker.Mesher = this;
+  worker.Faces.reserve(pid2Face.size());
   std::map<vtkIdType, ModelFaceRep*>::iterator faceIter = pid2Face.begin();
   for (; faceIter != pid2Face.end(); faceIter++)
   {
@@ -148,20 +376,29 @@ int vtkCMBTriangleMultiBlockMesher::RequestData(vtkInformation* /*request*/,
         break;
     }
 
-    cmbFaceMesherInterface ti(
-      face->numberOfVertices(), face->numberOfEdges(), face->numberOfHoles(), this->PreserveEdges);
-    ti.setUseMaxArea(this->MaxAreaMode != NoMaxArea);
-    ti.setMaxArea(this->ComputedMaxArea);
-    ti.setUseMinAngle(this->UseMinAngle);
-    ti.setMinAngle(this->MinAngle);
-    ti.setPreserveBoundaries(this->PreserveBoundaries);
-    ti.setVerboseOutput(this->VerboseOutput);
-    ti.setOutputMesh(outputMesh);
-    face->fillTriangleInterface(&ti);
-    ti.buildFaceMesh(meshServer.GetPointer(), faceId, 0);
+
+    vtkCMBTriangleMultiBlockMesherWorker::FaceJob job;
+    job.FaceId = faceId;
+    job.Face = face;
+    job.MaxArea = this->ComputedMaxArea;
+    job.Mesh = outputMesh;
+    worker.Faces.push_back(job);
     output->SetBlock(blocknum++, outputMesh);
     outputMesh->Delete();
   }
 
+  if (!worker.Run())
+  {
+    vtkErrorMacro("Unable to launch a mesh server");
+    return 0;
+  }
+
+  this->NumberOfNonConformingEdges = worker.CountNonConformingEdges();
+  if (this->NumberOfNonConformingEdges > 0)
+  {
+    vtkWarningMacro(<< this->NumberOfNonConformingEdges
+                    << " face mesh boundary edges are split differently by the neighboring face");
+  }
+
   return true;
 }
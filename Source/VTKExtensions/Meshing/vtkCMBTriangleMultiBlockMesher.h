@@ -25,6 +25,12 @@
 //   how the poly data will be meshed
 //
 //   See vtkCMBPrepareForTriangleMesher for how to format the input poly data
+//
+//   The faces are independent once their edges are discretized, so they
+//   are meshed on several threads, each face into its own block.  The
+//   boundaries of the face meshes are then checked against each other, an
+//   edge that a face split but its neighbor did not is counted in
+//   NumberOfNonConformingEdges.
 
 #ifndef __vtkCMBTriangleMultiBlockMesher_h
 #define __vtkCMBTriangleMultiBlockMesher_h
@@ -70,6 +76,24 @@ public:
   vtkSetClampMacro(MinAngle, double, 0, VTK_DOUBLE_MAX);
   vtkGetMacro(MinAngle, double);
 
+  // Description:
+  // Set/Get the number of threads meshing the faces, 1 by default.  Each
+  // thread launches its own mesh server (and Triangle worker process), so
+  // there are at most MaxNumberOfMeshServers of them, and never more than
+  // there are faces.
+  enum
+  {
+    MaxNumberOfMeshServers = 8
+  };
+  vtkSetClampMacro(NumberOfThreads, int, 1, MaxNumberOfMeshServers);
+  vtkGetMacro(NumberOfThreads, int);
+
+  // Description:
+  // The number of boundary edges of the last output that are split in one
+  // face mesh but not in the mesh of the neighboring face.  Always 0 when
+  // PreserveBoundaries is on.
+  vtkGetMacro(NumberOfNonConformingEdges, vtkIdType);
+
 protected:
   vtkCMBTriangleMultiBlockMesher();
   ~vtkCMBTriangleMultiBlockMesher() override;
@@ -87,10 +111,17 @@ protected:
   //Used to configure triangle's 'V' flag
   bool VerboseOutput;
 
+  int NumberOfThreads;
+  vtkIdType NumberOfNonConformingEdges;
+
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) override;
   int FillInputPortInformation(int port, vtkInformation* info) override;
 
 private:
+  //BTX
+  friend struct vtkCMBTriangleMultiBlockMesherWorker;
+  //ETX
+
   vtkCMBTriangleMultiBlockMesher(const vtkCMBTriangleMultiBlockMesher&); // Not implemented.
   void operator=(const vtkCMBTriangleMultiBlockMesher&);                 // Not implemented.
 };
@@ -0,0 +1,122 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Traces random sensor seeds (each with a few test locations around it)
+// through an ADH velocity field with vtkCMBStreamTracer, and reports the
+// wall time and speedup for an increasing number of threads.
+#include "smtk/extension/vtk/reader/vtkCMBMeshReader.h"
+#include "vtkCMBADHReader.h"
+#include "vtkCMBStreamTracer.h"
+#include "vtkDataObject.h"
+#include "vtkDataSet.h"
+#include "vtkMath.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkMultiThreader.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char* argv[])
+{
+  if (argc < 5 || argc > 7)
+  {
+    cerr << "usage:  StreamTracerBenchmark meshFileName adhFileName vectorsName "
+            "numberOfSeeds [numberOfTestLocations] [maxNumberOfThreads]\n";
+    return -1;
+  }
+  int numberOfSeeds = atoi(argv[4]);
+  int numberOfTestLocations = argc > 5 ? atoi(argv[5]) : 4;
+  int maxNumberOfThreads =
+    argc > 6 ? atoi(argv[6]) : vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  vtkSmartPointer<vtkCMBMeshReader> reader = vtkSmartPointer<vtkCMBMeshReader>::New();
+  reader->SetFileName(argv[1]);
+
+  vtkSmartPointer<vtkCMBADHReader> adh = vtkSmartPointer<vtkCMBADHReader>::New();
+  adh->SetFileName(argv[2]);
+  adh->SetInputConnection(reader->GetOutputPort());
+  adh->Update();
+  vtkDataSet* mesh = vtkDataSet::SafeDownCast(adh->GetOutputDataObject(0));
+  if (!mesh || mesh->GetNumberOfCells() == 0)
+  {
+    cerr << "Could not read the ADH mesh\n";
+    return 1;
+  }
+
+  // random seeds over the mesh
+  double bounds[6];
+  mesh->GetBounds(bounds);
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+  vtkSmartPointer<vtkPoints> seedPoints = vtkSmartPointer<vtkPoints>::New();
+  seedPoints->SetNumberOfPoints(numberOfSeeds);
+  for (int i = 0; i < numberOfSeeds; i++)
+  {
+    double seed[3];
+    for (int j = 0; j < 3; j++)
+    {
+      seed[j] = random->GetRangeValue(bounds[2 * j], bounds[2 * j + 1]);
+      random->Next();
+    }
+    seedPoints->SetPoint(i, seed);
+  }
+  vtkSmartPointer<vtkPolyData> seeds = vtkSmartPointer<vtkPolyData>::New();
+  seeds->SetPoints(seedPoints);
+
+  // the test locations, on a small circle around each seed
+  double minPoint[3] = { bounds[0], bounds[2], bounds[4] };
+  double maxPoint[3] = { bounds[1], bounds[3], bounds[5] };
+  double radius = 0.001 * sqrt(vtkMath::Distance2BetweenPoints(minPoint, maxPoint));
+  vtkSmartPointer<vtkCMBStreamTracer> tracer = vtkSmartPointer<vtkCMBStreamTracer>::New();
+  tracer->SetInputData(mesh);
+  tracer->SetSourceData(seeds);
+  tracer->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, argv[3]);
+  tracer->SetIntegrationDirectionToBoth();
+  tracer->SetNumberOfTestLocations(numberOfTestLocations);
+  for (int i = 0; i < numberOfTestLocations; i++)
+  {
+    double angle = 2.0 * vtkMath::Pi() * i / numberOfTestLocations;
+    tracer->SetRelativeOffsetOfTestLocation(i, radius * cos(angle), radius * sin(angle), 0.0);
+  }
+
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  double serialTime = 0.0;
+  vtkIdType serialNumberOfPoints = 0;
+  printf("%d seeds, %d test locations\n", numberOfSeeds, numberOfTestLocations);
+  printf("%8s %12s %10s %12s\n", "threads", "time (s)", "speedup", "points");
+  for (int numberOfThreads = 1; numberOfThreads <= maxNumberOfThreads; numberOfThreads *= 2)
+  {
+    tracer->SetNumberOfThreads(numberOfThreads);
+    tracer->Modified();
+    timer->StartTimer();
+    tracer->Update();
+    timer->StopTimer();
+    double time = timer->GetElapsedTime();
+    vtkIdType numberOfPoints = tracer->GetOutput()->GetNumberOfPoints();
+    if (numberOfThreads == 1)
+    {
+      serialTime = time;
+      serialNumberOfPoints = numberOfPoints;
+    }
+    else if (numberOfPoints != serialNumberOfPoints)
+    {
+      cerr << "The streamlines differ from the serial ones\n";
+      return 1;
+    }
+    printf("%8d %12.3f %10.2f %12lld\n", numberOfThreads, time,
+      time > 0.0 ? serialTime / time : 0.0, static_cast<long long>(numberOfPoints));
+  }
+
+  return 0;
+}
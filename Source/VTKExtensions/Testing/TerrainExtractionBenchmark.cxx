@@ -0,0 +1,76 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Runs the three phases of vtkTerrainExtractionFilter on a LIDAR file and
+// reports the wall time and core utilization of every extracted level.
+#include "smtk/extension/vtk/reader/vtkLIDARReader.h"
+#include "vtkSmartPointer.h"
+#include "vtkTerrainExtractionFilter.h"
+#include "vtkTimerLog.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3 || argc > 6)
+  {
+    cerr << "usage:  TerrainExtractionBenchmark inputFileName outputPath "
+            "[numberOfThreads] [minLevel] [maxLevel]\n";
+    return -1;
+  }
+  int numberOfThreads = argc > 3 ? atoi(argv[3]) : 0;
+
+  vtkSmartPointer<vtkLIDARReader> reader = vtkSmartPointer<vtkLIDARReader>::New();
+  reader->SetFileName(argv[1]);
+
+  vtkSmartPointer<vtkTerrainExtractionFilter> extraction =
+    vtkSmartPointer<vtkTerrainExtractionFilter>::New();
+  extraction->SetInputConnection(reader->GetOutputPort());
+  extraction->SetOutputPath(argv[2]);
+  extraction->SetIntermediateResultsPath(argv[2]);
+  extraction->SetWriteExtractionResultsToDisk(true);
+  extraction->SetNumberOfThreads(numberOfThreads);
+
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+
+  timer->StartTimer();
+  extraction->SetExecuteModeToSetupRefine();
+  extraction->Update();
+  extraction->SetExecuteModeToRefine();
+  extraction->Update();
+  timer->StopTimer();
+  int numberOfLevels = extraction->GetNumberOfLevels();
+  if (numberOfLevels < 1)
+  {
+    cerr << "Refine did not generate any levels\n";
+    return 1;
+  }
+  printf("Refine: %d levels in %.3f s\n", numberOfLevels, timer->GetElapsedTime());
+
+  int minLevel = argc > 4 ? atoi(argv[4]) : 0;
+  int maxLevel = argc > 5 ? atoi(argv[5]) : numberOfLevels - 1;
+  extraction->SetMinExtractLevel(minLevel);
+  extraction->SetMaxExtractLevel(maxLevel);
+
+  timer->StartTimer();
+  extraction->SetExecuteModeToExtract();
+  extraction->Update();
+  timer->StopTimer();
+
+  printf("Extract: %.3f s (threads: %d)\n", timer->GetElapsedTime(), numberOfThreads);
+  printf("%6s %12s %12s\n", "level", "time (s)", "utilization");
+  for (int level = maxLevel; level >= minLevel; level--)
+  {
+    printf("%6d %12.3f %11.1f%%\n", level, extraction->GetLevelExtractionTime(level),
+      100.0 * extraction->GetLevelCoreUtilization(level));
+  }
+
+  return 0;
+}
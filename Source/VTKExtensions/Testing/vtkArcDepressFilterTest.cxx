@@ -0,0 +1,278 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Depresses a wavy terrain along an open arc (relative wedges, interpolated
+// between its ends), a closed arc (an absolute manual profile) and a
+// levelling arc (an absolute wedge) with vtkArcDepressFilter.  The points
+// displaced using the segment grid of each arc, on several threads, are
+// checked against looking at every segment on one thread.  Then the arcs
+// are edited, reordered and removed one step at a time, and the points and
+// volumes re-evaluated around each edit are checked against a new filter
+// computing everything.
+#include "vtkArcDepressFilter.h"
+#include "vtkMultiThreader.h"
+#include "vtkPlaneSource.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTriangleFilter.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+
+enum
+{
+  Spline = 0,
+  Piecewise = 1
+};
+
+enum
+{
+  Dig = 0,
+  Raise = 1,
+  Level = 2
+};
+
+vtkSmartPointer<vtkPolyData> Terrain()
+{
+  vtkSmartPointer<vtkPlaneSource> plane = vtkSmartPointer<vtkPlaneSource>::New();
+  plane->SetOrigin(0, 0, 0);
+  plane->SetPoint1(100, 0, 0);
+  plane->SetPoint2(0, 100, 0);
+  plane->SetResolution(150, 150);
+  vtkSmartPointer<vtkTriangleFilter> triangles = vtkSmartPointer<vtkTriangleFilter>::New();
+  triangles->SetInputConnection(plane->GetOutputPort());
+  triangles->Update();
+  vtkSmartPointer<vtkPolyData> terrain = vtkSmartPointer<vtkPolyData>::New();
+  terrain->DeepCopy(triangles->GetOutput());
+  vtkPoints* points = terrain->GetPoints();
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); i++)
+  {
+    double pt[3];
+    points->GetPoint(i, pt);
+    pt[2] = 5.0 * sin(0.1 * pt[0]) * cos(0.07 * pt[1]);
+    points->SetPoint(i, pt);
+  }
+  return terrain;
+}
+
+void AddWedge(vtkArcDepressFilter* filter, int arc, int function, int mode, bool relative,
+  double width, double displacement, double slope)
+{
+  filter->CreateWedgeFunction(
+    arc, function, Piecewise, relative, mode, 0, width, displacement, slope, slope);
+  filter->AddWeightingFunPoint(arc, function, -1, 0, 0.5, 0);
+  filter->AddWeightingFunPoint(arc, function, 0, 1, 0.5, 0);
+  filter->AddWeightingFunPoint(arc, function, 1, 0, 0.5, 0);
+}
+
+// a channel dug (getting wider, and then raised) along a wave
+void AddOpenArc(vtkArcDepressFilter* filter, int arc, double offset)
+{
+  filter->AddArc(arc);
+  const int numberOfPoints = 60;
+  for (int i = 0; i < numberOfPoints; i++)
+  {
+    double x = 5 + 90.0 * i / (numberOfPoints - 1);
+    filter->AddPointToArc(arc, x, offset + 10 * sin(0.15 * x));
+  }
+  AddWedge(filter, arc, 0, Dig, true, 2, -2, 0.8);
+  AddWedge(filter, arc, 1, Raise, true, 4, 1.5, 0.4);
+  filter->SetFunctionToPoint(arc, 0, 0);
+  filter->SetFunctionToPoint(arc, numberOfPoints - 1, 1);
+}
+
+// a pit, with an absolute spline profile
+void AddClosedArc(vtkArcDepressFilter* filter, int arc, double cx, double cy, double radius)
+{
+  filter->AddArc(arc);
+  const int numberOfPoints = 24;
+  for (int i = 0; i < numberOfPoints; i++)
+  {
+    double angle = 2 * 3.14159265358979 * i / numberOfPoints;
+    filter->AddPointToArc(arc, cx + radius * cos(angle), cy + 0.7 * radius * sin(angle));
+  }
+  filter->SetArcAsClosed(arc);
+  filter->CreateManualFunction(arc, 0, Spline, Piecewise, 0, 1);
+  filter->SetManualControlRanges(arc, 0, -3, 0, 0, 6);
+  filter->AddWeightingFunPoint(arc, 0, 0, 1, 0.5, 0);
+  filter->AddWeightingFunPoint(arc, 0, 1, 0, 0.5, 0);
+  filter->AddManualDispFunPoint(arc, 0, 0, 0, 0, 0);
+  filter->AddManualDispFunPoint(arc, 0, 0.5, 0.3, 0, 0);
+  filter->AddManualDispFunPoint(arc, 0, 1, 1, 0, 0);
+  filter->SetFunctionToPoint(arc, 0, 0);
+}
+
+// a road levelled at a height, whose reach depends on the z range
+void AddLevelArc(vtkArcDepressFilter* filter, int arc, double y)
+{
+  filter->AddArc(arc);
+  filter->AddPointToArc(arc, 10, y);
+  filter->AddPointToArc(arc, 40, y + 15);
+  filter->AddPointToArc(arc, 70, y + 5);
+  filter->AddPointToArc(arc, 90, y + 20);
+  AddWedge(filter, arc, 0, Level, false, 3, 1, 1.5);
+  filter->SetFunctionToPoint(arc, 0, 0);
+}
+
+void AddArcs(vtkArcDepressFilter* filter)
+{
+  AddOpenArc(filter, 0, 30);
+  AddClosedArc(filter, 1, 60, 70, 12);
+  AddLevelArc(filter, 2, 50);
+  filter->ResizeOrder(3);
+  for (int i = 0; i < 3; i++)
+  {
+    filter->SetOrderValue(i, i);
+  }
+}
+
+const int NumberOfEdits = 7;
+
+// the edit-th edit of the arcs of AddArcs()
+void Edit(vtkArcDepressFilter* filter, int edit)
+{
+  switch (edit)
+  {
+    case 1: // a wider and deeper pit
+      filter->SetManualControlRanges(1, 0, -4, 0, 0, 8);
+      break;
+    case 2: // a longer channel
+      filter->AddPointToArc(0, 97, 35);
+      break;
+    case 3: // the road before the channel
+      filter->SetOrderValue(0, 2);
+      filter->SetOrderValue(2, 0);
+      break;
+    case 4: // no channel (the last arc applied)
+      filter->RemoveArc(0);
+      break;
+    case 5: // no pit (now the last arc applied)
+      filter->SetOrderValue(1, -1);
+      break;
+    case 6: // another road, applied last
+      AddLevelArc(filter, 3, 15);
+      filter->ResizeOrder(4);
+      filter->SetOrderValue(3, 3);
+      break;
+    case 7: // not any more
+      filter->ResizeOrder(3);
+      break;
+  }
+}
+
+vtkSmartPointer<vtkPolyData> Depress(vtkArcDepressFilter* filter)
+{
+  filter->Update();
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->DeepCopy(filter->GetOutput());
+  return output;
+}
+
+// the number of points displaced, or -1 if a point differs
+vtkIdType Compare(vtkPolyData* terrain, vtkPolyData* a, vtkPolyData* b)
+{
+  if (a->GetNumberOfPoints() != terrain->GetNumberOfPoints() ||
+    b->GetNumberOfPoints() != terrain->GetNumberOfPoints())
+  {
+    return -1;
+  }
+  vtkIdType displaced = 0;
+  for (vtkIdType i = 0; i < terrain->GetNumberOfPoints(); i++)
+  {
+    double pt[3], aPt[3], bPt[3];
+    terrain->GetPoint(i, pt);
+    a->GetPoint(i, aPt);
+    b->GetPoint(i, bPt);
+    if (aPt[0] != bPt[0] || aPt[1] != bPt[1] || aPt[2] != bPt[2])
+    {
+      cerr << "Point " << i << " is (" << aPt[0] << ", " << aPt[1] << ", " << aPt[2]
+           << ") instead of (" << bPt[0] << ", " << bPt[1] << ", " << bPt[2] << ")\n";
+      return -1;
+    }
+    displaced += pt[2] != aPt[2] ? 1 : 0;
+  }
+  return displaced;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  int numberOfThreads = argc > 1 ? atoi(argv[1]) : 4;
+  vtkSmartPointer<vtkPolyData> terrain = Terrain();
+  int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  int result = 0;
+
+  // every segment, on one thread
+  vtkSmartPointer<vtkArcDepressFilter> bruteForce = vtkSmartPointer<vtkArcDepressFilter>::New();
+  bruteForce->SetInputData(terrain);
+  bruteForce->UseSegmentIndexOff();
+  AddArcs(bruteForce);
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+  vtkSmartPointer<vtkPolyData> expected = Depress(bruteForce);
+
+  // the segment grid, on several threads
+  vtkSmartPointer<vtkArcDepressFilter> indexed = vtkSmartPointer<vtkArcDepressFilter>::New();
+  indexed->SetInputData(terrain);
+  AddArcs(indexed);
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+  vtkSmartPointer<vtkPolyData> output = Depress(indexed);
+
+  vtkIdType displaced = Compare(terrain, output, expected);
+  if (displaced <= 0 || displaced == terrain->GetNumberOfPoints())
+  {
+    cerr << "The segment grid: " << displaced << " points displaced\n";
+    result = 1;
+  }
+  if (indexed->GetAmountAdded() != bruteForce->GetAmountAdded() ||
+    indexed->GetAmountRemoved() != bruteForce->GetAmountRemoved())
+  {
+    cerr << "The segment grid: the volumes differ\n";
+    result = 1;
+  }
+
+  // each edit re-evaluated around the edited arcs, against everything
+  // computed by a new filter
+  for (int edit = 1; edit <= NumberOfEdits; edit++)
+  {
+    Edit(indexed, edit);
+    output = Depress(indexed);
+
+    vtkSmartPointer<vtkArcDepressFilter> fresh = vtkSmartPointer<vtkArcDepressFilter>::New();
+    fresh->SetInputData(terrain);
+    AddArcs(fresh);
+    for (int i = 1; i <= edit; i++)
+    {
+      Edit(fresh, i);
+    }
+    expected = Depress(fresh);
+
+    displaced = Compare(terrain, output, expected);
+    if (displaced <= 0)
+    {
+      cerr << "Edit " << edit << ": " << displaced << " points displaced\n";
+      result = 1;
+    }
+    if (indexed->GetAmountAdded() != fresh->GetAmountAdded() ||
+      indexed->GetAmountRemoved() != fresh->GetAmountRemoved())
+    {
+      cerr << "Edit " << edit << ": the volumes are " << indexed->GetAmountAdded() << " and "
+           << indexed->GetAmountRemoved() << " instead of " << fresh->GetAmountAdded() << " and "
+           << fresh->GetAmountRemoved() << "\n";
+      result = 1;
+    }
+  }
+
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+  return result;
+}
@@ -0,0 +1,151 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Computes the filled contours (and their edges) of a wavy scalar field on
+// a plane of quads, and of triangle strips, with
+// vtkCMBBandedPolyDataContourFilter on one thread and on several, and
+// checks that the outputs are the same.
+#include "vtkCMBBandedPolyDataContourFilter.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkMultiThreader.h"
+#include "vtkPlaneSource.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkStripper.h"
+#include "vtkTriangleFilter.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+
+vtkSmartPointer<vtkPolyData> Contour(vtkPolyData* input, int port)
+{
+  vtkSmartPointer<vtkCMBBandedPolyDataContourFilter> contour =
+    vtkSmartPointer<vtkCMBBandedPolyDataContourFilter>::New();
+  contour->SetInputData(input);
+  contour->GenerateValues(9, -1.5, 1.5);
+  contour->SetScalarModeToValue();
+  contour->SetOutputEdgesToBandAndBoundaryEdges();
+  contour->Update();
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(contour->GetOutput(port));
+  return output;
+}
+
+bool SameArrays(vtkDataArray* a, vtkDataArray* b)
+{
+  if (!a || !b)
+  {
+    return a == b;
+  }
+  if (a->GetNumberOfTuples() != b->GetNumberOfTuples() ||
+    a->GetNumberOfComponents() != b->GetNumberOfComponents())
+  {
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfTuples(); i++)
+  {
+    for (int j = 0; j < a->GetNumberOfComponents(); j++)
+    {
+      if (a->GetComponent(i, j) != b->GetComponent(i, j))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool SamePolyData(vtkPolyData* a, vtkPolyData* b)
+{
+  if (a->GetNumberOfPoints() != b->GetNumberOfPoints() ||
+    (a->GetNumberOfPoints() > 0 &&
+        !SameArrays(a->GetPoints()->GetData(), b->GetPoints()->GetData())))
+  {
+    return false;
+  }
+  vtkCellArray* aCells[4] = { a->GetVerts(), a->GetLines(), a->GetPolys(), a->GetStrips() };
+  vtkCellArray* bCells[4] = { b->GetVerts(), b->GetLines(), b->GetPolys(), b->GetStrips() };
+  for (int i = 0; i < 4; i++)
+  {
+    if (aCells[i]->GetNumberOfCells() != bCells[i]->GetNumberOfCells() ||
+      !SameArrays(aCells[i]->GetData(), bCells[i]->GetData()))
+    {
+      return false;
+    }
+  }
+  return SameArrays(a->GetPointData()->GetScalars(), b->GetPointData()->GetScalars()) &&
+    SameArrays(a->GetCellData()->GetScalars(), b->GetCellData()->GetScalars());
+}
+}
+
+int main(int argc, char* argv[])
+{
+  int numberOfThreads = argc > 1 ? atoi(argv[1]) : 4;
+
+  // enough polygons for several chunks
+  vtkSmartPointer<vtkPlaneSource> plane = vtkSmartPointer<vtkPlaneSource>::New();
+  plane->SetResolution(200, 150);
+  plane->Update();
+  vtkSmartPointer<vtkPolyData> quads = vtkSmartPointer<vtkPolyData>::New();
+  quads->ShallowCopy(plane->GetOutput());
+  vtkSmartPointer<vtkDoubleArray> scalars = vtkSmartPointer<vtkDoubleArray>::New();
+  scalars->SetName("Wave");
+  scalars->SetNumberOfTuples(quads->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < quads->GetNumberOfPoints(); i++)
+  {
+    double pt[3];
+    quads->GetPoint(i, pt);
+    scalars->SetValue(i, sin(20.0 * pt[0]) + cos(15.0 * pt[1]) * pt[0]);
+  }
+  quads->GetPointData()->SetScalars(scalars);
+
+  vtkSmartPointer<vtkTriangleFilter> triangles = vtkSmartPointer<vtkTriangleFilter>::New();
+  triangles->SetInputData(quads);
+  vtkSmartPointer<vtkStripper> stripper = vtkSmartPointer<vtkStripper>::New();
+  stripper->SetInputConnection(triangles->GetOutputPort());
+  stripper->Update();
+  vtkSmartPointer<vtkPolyData> strips = vtkSmartPointer<vtkPolyData>::New();
+  strips->ShallowCopy(stripper->GetOutput());
+
+  vtkPolyData* inputs[2] = { quads, strips };
+  int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  int result = 0;
+  for (int i = 0; i < 2; i++)
+  {
+    // the bands, and then their edges
+    for (int port = 0; port < 2; port++)
+    {
+      vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+      vtkSmartPointer<vtkPolyData> serial = Contour(inputs[i], port);
+      vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+      vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+      vtkSmartPointer<vtkPolyData> threaded = Contour(inputs[i], port);
+      vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+      if (serial->GetNumberOfCells() == 0)
+      {
+        cerr << "Input " << i << ": output " << port << " is empty\n";
+        result = 1;
+      }
+      else if (!SamePolyData(serial, threaded))
+      {
+        cerr << "Input " << i << ": output " << port << " differs from the serial one\n";
+        result = 1;
+      }
+    }
+  }
+
+  return result;
+}
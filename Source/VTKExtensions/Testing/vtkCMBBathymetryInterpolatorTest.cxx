@@ -0,0 +1,97 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Interpolates the elevation of random points from scattered source points
+// with vtkCMBBathymetryInterpolator, in parallel and one point at a time,
+// and checks that the elevations are the same for every mode.
+#include "vtkCMBBathymetryInterpolator.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkMultiThreader.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+
+#include <cmath>
+#include <cstdlib>
+
+int main(int argc, char* argv[])
+{
+  int numberOfThreads = argc > 1 ? atoi(argv[1]) : 4;
+  const vtkIdType numberOfSourcePoints = 20000;
+  // enough points for several chunks; some of them outside the source points
+  const vtkIdType numberOfPoints = 50000;
+
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+  vtkSmartPointer<vtkCMBBathymetryInterpolator> interpolator =
+    vtkSmartPointer<vtkCMBBathymetryInterpolator>::New();
+  interpolator->SetNumberOfSourcePoints(numberOfSourcePoints);
+  for (vtkIdType i = 0; i < numberOfSourcePoints; i++)
+  {
+    double x = random->GetRangeValue(0.0, 100.0);
+    random->Next();
+    double y = random->GetRangeValue(0.0, 100.0);
+    random->Next();
+    interpolator->SetSourcePoint(i, x, y, sin(x / 10.0) + cos(y / 10.0));
+  }
+  interpolator->SetElevationRadius(1.5);
+  interpolator->SetInvalidValue(-1000.0);
+  interpolator->BuildLocator();
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; i++)
+  {
+    double x = random->GetRangeValue(-10.0, 110.0);
+    random->Next();
+    double y = random->GetRangeValue(-10.0, 110.0);
+    random->Next();
+    points->SetPoint(i, x, y, 0.0);
+  }
+
+  int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+  int result = 0;
+  for (int mode = vtkCMBBathymetryInterpolator::AVERAGE;
+       mode <= vtkCMBBathymetryInterpolator::NEAREST; mode++)
+  {
+    interpolator->SetInterpolationMode(mode);
+    vtkSmartPointer<vtkPoints> interpolated = vtkSmartPointer<vtkPoints>::New();
+    interpolated->DeepCopy(points);
+    interpolator->InterpolateElevations(interpolated);
+
+    vtkIdType numberOfInvalidPoints = 0;
+    for (vtkIdType i = 0; i < numberOfPoints; i++)
+    {
+      double pt[3];
+      interpolated->GetPoint(i, pt);
+      double elevation = interpolator->GetElevation(pt[0], pt[1]);
+      if (pt[2] != elevation)
+      {
+        cerr << "Mode " << mode << ": the elevation of point " << i << " is " << pt[2]
+             << " instead of " << elevation << "\n";
+        result = 1;
+        break;
+      }
+      if (elevation == interpolator->GetInvalidValue())
+      {
+        numberOfInvalidPoints++;
+      }
+    }
+    if (numberOfInvalidPoints == 0 || numberOfInvalidPoints == numberOfPoints)
+    {
+      cerr << "Mode " << mode << ": only some of the points should be invalid\n";
+      result = 1;
+    }
+  }
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+
+  return result;
+}
@@ -0,0 +1,116 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Classifies random points against a tetrahedral mesh with
+// vtkCMBClassifyPointsFilter on one thread and on several, and checks that
+// the outputs are the same.
+#include "vtkCMBClassifyPointsFilter.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkMultiThreader.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+
+#include <cstdlib>
+
+namespace
+{
+
+vtkSmartPointer<vtkPolyData> Classify(vtkPolyData* input, vtkAlgorithmOutput* solid)
+{
+  vtkSmartPointer<vtkCMBClassifyPointsFilter> classify =
+    vtkSmartPointer<vtkCMBClassifyPointsFilter>::New();
+  classify->SetInputData(input);
+  classify->SetSolidConnection(solid);
+  classify->Update();
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(classify->GetOutput());
+  return output;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  int numberOfThreads = argc > 1 ? atoi(argv[1]) : 4;
+  // enough points for several blocks and chunks
+  const vtkIdType numberOfPoints = 150000;
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(20, 20, 20);
+  vtkSmartPointer<vtkDataSetTriangleFilter> tetrahedra =
+    vtkSmartPointer<vtkDataSetTriangleFilter>::New();
+  tetrahedra->SetInputData(image);
+
+  // the points overflow the mesh, so that some of them are dropped
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; i++)
+  {
+    double point[3];
+    for (int j = 0; j < 3; j++)
+    {
+      point[j] = random->GetRangeValue(-1.0, 20.0);
+      random->Next();
+    }
+    points->SetPoint(i, point);
+  }
+  vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+  input->SetPoints(points);
+
+  int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+  vtkSmartPointer<vtkPolyData> serial = Classify(input, tetrahedra->GetOutputPort());
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+  vtkSmartPointer<vtkPolyData> threaded = Classify(input, tetrahedra->GetOutputPort());
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+
+  vtkIdType numberOfClassifiedPoints = serial->GetNumberOfPoints();
+  if (numberOfClassifiedPoints == 0 || numberOfClassifiedPoints == numberOfPoints)
+  {
+    cerr << "Only some of the points should be inside the mesh\n";
+    return 1;
+  }
+  if (threaded->GetNumberOfPoints() != numberOfClassifiedPoints)
+  {
+    cerr << "The number of points differs from the serial one\n";
+    return 1;
+  }
+  vtkIdTypeArray* serialIds =
+    vtkIdTypeArray::SafeDownCast(serial->GetPointData()->GetArray("GridCellIds"));
+  vtkIdTypeArray* threadedIds =
+    vtkIdTypeArray::SafeDownCast(threaded->GetPointData()->GetArray("GridCellIds"));
+  if (!serialIds || !threadedIds)
+  {
+    cerr << "The GridCellIds are missing\n";
+    return 1;
+  }
+  for (vtkIdType i = 0; i < numberOfClassifiedPoints; i++)
+  {
+    double serialPoint[3], threadedPoint[3];
+    serial->GetPoint(i, serialPoint);
+    threaded->GetPoint(i, threadedPoint);
+    if (serialPoint[0] != threadedPoint[0] || serialPoint[1] != threadedPoint[1] ||
+      serialPoint[2] != threadedPoint[2] || serialIds->GetValue(i) != threadedIds->GetValue(i))
+    {
+      cerr << "Point " << i << " differs from the serial one\n";
+      return 1;
+    }
+  }
+
+  return 0;
+}
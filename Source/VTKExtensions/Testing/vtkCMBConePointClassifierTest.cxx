@@ -0,0 +1,312 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Classifies the cells of a tetrahedral mesh (with float and with double
+// points) against a transformed truncated cone with vtkCMBConeCellClassifier
+// and vtkCMBMeshConeSelector, in each of their modes, on one thread and on
+// several.  The cells are checked against testing the points of each cell,
+// one point at a time, as the filters did before they classified the points
+// once into a mask.
+#include "vtkCMBConeCellClassifier.h"
+#include "vtkCMBConePointClassifier.h"
+#include "vtkCMBConeSource.h"
+#include "vtkCMBMeshConeSelector.h"
+#include "vtkCellData.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkMath.h"
+#include "vtkMultiThreader.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSelection.h"
+#include "vtkSelectionNode.h"
+#include "vtkSmartPointer.h"
+#include "vtkTransform.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+
+// the cone, in its own coordinates
+const double BaseCenter[3] = { 0.0, 0.0, 0.0 };
+const double AxisDirection[3] = { 0.0, 0.0, -1.0 };
+const double Height = 1.0;
+const double BaseRadius = 0.5;
+const double TopRadius = 0.25;
+
+// and where it is in the mesh
+const double Translation[3] = { 20.2, 19.4, 33.8 };
+const double Orientation[3] = { 14.8, -4.64, 26.8 };
+const double Scaling[3] = { 24.0, 19.0, 27.0 };
+
+// the cells with this region are classified, the others left as they are
+const int OriginalCellValue = 1;
+const int NewCellValue = 10;
+
+// enough points for several chunks of the point classifier
+vtkSmartPointer<vtkUnstructuredGrid> Mesh(int dataType)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(41, 41, 41);
+  vtkSmartPointer<vtkDataSetTriangleFilter> tetrahedra =
+    vtkSmartPointer<vtkDataSetTriangleFilter>::New();
+  tetrahedra->SetInputData(image);
+  tetrahedra->Update();
+
+  vtkSmartPointer<vtkUnstructuredGrid> mesh = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  mesh->ShallowCopy(tetrahedra->GetOutput());
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataType(dataType);
+  points->SetNumberOfPoints(mesh->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < mesh->GetNumberOfPoints(); i++)
+  {
+    points->SetPoint(i, mesh->GetPoint(i));
+  }
+  mesh->SetPoints(points);
+
+  vtkIdType numberOfPoints = mesh->GetNumberOfPoints();
+  vtkIdType numberOfCells = mesh->GetNumberOfCells();
+  vtkSmartPointer<vtkIntArray> region = vtkSmartPointer<vtkIntArray>::New();
+  region->SetName("Region");
+  region->SetNumberOfTuples(numberOfCells);
+  vtkSmartPointer<vtkIdTypeArray> cellIds = vtkSmartPointer<vtkIdTypeArray>::New();
+  cellIds->SetName("Mesh Cell ID");
+  cellIds->SetNumberOfTuples(numberOfCells);
+  for (vtkIdType i = 0; i < numberOfCells; i++)
+  {
+    region->SetValue(i, i % 7 == 0 ? 2 : OriginalCellValue);
+    cellIds->SetValue(i, i);
+  }
+  vtkSmartPointer<vtkIdTypeArray> nodeIds = vtkSmartPointer<vtkIdTypeArray>::New();
+  nodeIds->SetName("Mesh Node ID");
+  nodeIds->SetNumberOfTuples(numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; i++)
+  {
+    nodeIds->SetValue(i, i);
+  }
+  mesh->GetCellData()->AddArray(region);
+  mesh->GetCellData()->AddArray(cellIds);
+  mesh->GetPointData()->AddArray(nodeIds);
+  return mesh;
+}
+
+// the transform of the points into the coordinates of the cone, as
+// vtkCMBConeCellClassifier builds it
+vtkSmartPointer<vtkTransform> PointTransform()
+{
+  vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
+  transform->Identity();
+  transform->PreMultiply();
+  transform->Translate(Translation);
+  transform->RotateZ(Orientation[2]);
+  transform->RotateX(Orientation[0]);
+  transform->RotateY(Orientation[1]);
+  transform->Scale(Scaling);
+  transform->Inverse();
+  transform->Update();
+  return transform;
+}
+
+// whether the cell is inside for the mode (one of
+// vtkCMBPointClassifier::CellModes), testing each of its points
+bool IsCellInside(vtkUnstructuredGrid* mesh, vtkIdType cell, vtkTransform* transform, int mode)
+{
+  double axisUnitDir[3] = { AxisDirection[0], AxisDirection[1], AxisDirection[2] };
+  vtkMath::Normalize(axisUnitDir);
+  vtkIdType npts, *pts;
+  mesh->GetCellPoints(cell, npts, pts);
+  vtkIdType numberInside = 0;
+  for (vtkIdType j = 0; j < npts; j++)
+  {
+    double p[3], tp[3];
+    mesh->GetPoint(pts[j], p);
+    transform->TransformPoint(p, tp);
+    if (vtkCMBConePointClassifier::IsInside(
+          tp, BaseCenter, axisUnitDir, Height, BaseRadius, TopRadius))
+    {
+      numberInside++;
+    }
+  }
+  switch (mode)
+  {
+    case vtkCMBPointClassifier::ALL_IN:
+      return numberInside == npts;
+    case vtkCMBPointClassifier::PARTIAL_OR_ALL_IN:
+      return numberInside > 0;
+    default:
+      return numberInside > 0 && numberInside < npts;
+  }
+}
+
+// the NewIds of vtkCMBConeCellClassifier
+vtkSmartPointer<vtkIntArray> ClassifyCells(vtkUnstructuredGrid* mesh, int classificationMode)
+{
+  vtkSmartPointer<vtkCMBConeCellClassifier> filter =
+    vtkSmartPointer<vtkCMBConeCellClassifier>::New();
+  filter->SetInputData(mesh);
+  filter->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_CELLS, "Region");
+  filter->SetBaseCenter(BaseCenter[0], BaseCenter[1], BaseCenter[2]);
+  filter->SetAxisDirection(AxisDirection[0], AxisDirection[1], AxisDirection[2]);
+  filter->SetHeight(Height);
+  filter->SetBaseRadius(BaseRadius);
+  filter->SetTopRadius(TopRadius);
+  filter->SetTranslation(Translation[0], Translation[1], Translation[2]);
+  filter->SetOrientation(Orientation[0], Orientation[1], Orientation[2]);
+  filter->SetScaling(Scaling[0], Scaling[1], Scaling[2]);
+  filter->SetOriginalCellValue(OriginalCellValue);
+  filter->SetNewCellValue(NewCellValue);
+  filter->SetClassificationMode(classificationMode);
+  filter->Update();
+  return vtkIntArray::SafeDownCast(filter->GetOutput()->GetCellData()->GetArray("NewIds"));
+}
+
+int TestCellClassifier(vtkUnstructuredGrid* mesh, int numberOfThreads)
+{
+  vtkSmartPointer<vtkTransform> transform = PointTransform();
+  vtkIntArray* region = vtkIntArray::SafeDownCast(mesh->GetCellData()->GetArray("Region"));
+  // the ClassificationMode of each of the CellModes
+  const int classificationModes[3] = { 1, 0, 2 };
+  int result = 0;
+  for (int mode = 0; mode < 3; mode++)
+  {
+    vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+    vtkSmartPointer<vtkIntArray> serial = ClassifyCells(mesh, classificationModes[mode]);
+    vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+    vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+    vtkSmartPointer<vtkIntArray> threaded = ClassifyCells(mesh, classificationModes[mode]);
+
+    vtkIdType numberOfCells = mesh->GetNumberOfCells();
+    if (!serial || !threaded || serial->GetNumberOfTuples() != numberOfCells ||
+      threaded->GetNumberOfTuples() != numberOfCells)
+    {
+      cerr << "Cell classifier mode " << mode << ": no NewIds for every cell\n";
+      result = 1;
+      continue;
+    }
+    vtkIdType numberChanged = 0;
+    for (vtkIdType i = 0; i < numberOfCells; i++)
+    {
+      int expected = region->GetValue(i);
+      if (expected == OriginalCellValue && IsCellInside(mesh, i, transform, mode))
+      {
+        expected = NewCellValue;
+        numberChanged++;
+      }
+      if (serial->GetValue(i) != expected || threaded->GetValue(i) != expected)
+      {
+        cerr << "Cell classifier mode " << mode << ": cell " << i << " is "
+             << serial->GetValue(i) << " (one thread) and " << threaded->GetValue(i)
+             << " instead of " << expected << "\n";
+        result = 1;
+        break;
+      }
+    }
+    if (numberChanged == 0)
+    {
+      cerr << "Cell classifier mode " << mode << ": no cell in the cone\n";
+      result = 1;
+    }
+  }
+  return result;
+}
+
+// the cells selected by vtkCMBMeshConeSelector
+std::vector<vtkIdType> SelectCells(vtkUnstructuredGrid* mesh, vtkTransform* transform, int mode)
+{
+  vtkSmartPointer<vtkCMBConeSource> cone = vtkSmartPointer<vtkCMBConeSource>::New();
+  cone->SetBaseCenter(BaseCenter[0], BaseCenter[1], BaseCenter[2]);
+  cone->SetDirection(AxisDirection[0], AxisDirection[1], AxisDirection[2]);
+  cone->SetHeight(Height);
+  cone->SetBaseRadius(BaseRadius);
+  cone->SetTopRadius(TopRadius);
+  vtkSmartPointer<vtkCMBMeshConeSelector> selector =
+    vtkSmartPointer<vtkCMBMeshConeSelector>::New();
+  selector->SetInputData(mesh);
+  selector->SetConeSource(cone);
+  selector->SetTransform(transform);
+  selector->SetSelectConeType(mode);
+  selector->Update();
+
+  std::vector<vtkIdType> cells;
+  vtkSelectionNode* node = selector->GetOutput()->GetNumberOfNodes() > 0
+    ? selector->GetOutput()->GetNode(0)
+    : NULL;
+  vtkIdTypeArray* list =
+    node ? vtkIdTypeArray::SafeDownCast(node->GetSelectionList()) : NULL;
+  for (vtkIdType i = 0; list && i < list->GetNumberOfTuples(); i++)
+  {
+    cells.push_back(list->GetValue(i));
+  }
+  return cells;
+}
+
+int TestSelector(vtkUnstructuredGrid* mesh, int numberOfThreads)
+{
+  vtkSmartPointer<vtkTransform> transform = PointTransform();
+  int result = 0;
+  for (int mode = vtkCMBMeshConeSelector::ALL_IN; mode <= vtkCMBMeshConeSelector::INTERSECT_ONLY;
+       mode++)
+  {
+    vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+    std::vector<vtkIdType> serial = SelectCells(mesh, transform, mode);
+    vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+    vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+    std::vector<vtkIdType> threaded = SelectCells(mesh, transform, mode);
+
+    std::vector<vtkIdType> expected;
+    for (vtkIdType i = 0; i < mesh->GetNumberOfCells(); i++)
+    {
+      if (IsCellInside(mesh, i, transform, mode))
+      {
+        expected.push_back(i);
+      }
+    }
+    if (expected.empty() || static_cast<vtkIdType>(expected.size()) == mesh->GetNumberOfCells())
+    {
+      cerr << "Selector mode " << mode << ": " << expected.size() << " cells in the cone\n";
+      result = 1;
+    }
+    if (serial != expected || threaded != expected)
+    {
+      cerr << "Selector mode " << mode << ": selected " << serial.size() << " (one thread) and "
+           << threaded.size() << " cells instead of " << expected.size() << "\n";
+      result = 1;
+    }
+  }
+  return result;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  int numberOfThreads = argc > 1 ? atoi(argv[1]) : 4;
+  int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  int result = 0;
+
+  const int dataTypes[2] = { VTK_FLOAT, VTK_DOUBLE };
+  for (int i = 0; i < 2; i++)
+  {
+    vtkSmartPointer<vtkUnstructuredGrid> mesh = Mesh(dataTypes[i]);
+    int failed = TestCellClassifier(mesh, numberOfThreads);
+    failed |= TestSelector(mesh, numberOfThreads);
+    if (failed)
+    {
+      cerr << "with " << (dataTypes[i] == VTK_FLOAT ? "float" : "double") << " points\n";
+      result = 1;
+    }
+  }
+
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+  return result;
+}
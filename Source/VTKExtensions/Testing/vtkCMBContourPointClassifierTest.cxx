@@ -0,0 +1,339 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Classifies the points of a tetrahedral mesh against a (non convex, tilted)
+// selection loop with vtkCMBContourPointClassifier, and selects the cells of
+// the mesh through the loop, and the cells and points of a selection on a
+// triangulated surface within the loop, with vtkCMBMeshContourSelector in
+// each of its modes, on one thread and on several.  Everything is checked
+// against vtkImplicitSelectionLoop::FunctionValue (inside where it is
+// negative), which the selector evaluated for each point of each cell before
+// it classified the points once.
+#include "vtkCMBContourPointClassifier.h"
+#include "vtkCMBMeshContourSelector.h"
+#include "vtkCellData.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkImplicitSelectionLoop.h"
+#include "vtkInformation.h"
+#include "vtkMultiThreader.h"
+#include "vtkPlaneSource.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSelection.h"
+#include "vtkSelectionNode.h"
+#include "vtkSmartPointer.h"
+#include "vtkTriangleFilter.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+
+// a star in a plane tilted along x
+vtkSmartPointer<vtkImplicitSelectionLoop> Loop()
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  const int numberOfPoints = 14;
+  for (int i = 0; i < numberOfPoints; i++)
+  {
+    double angle = 0.1 + 2 * 3.14159265358979 * i / numberOfPoints;
+    double radius = i % 2 ? 6.13 : 14.71;
+    double x = 20.3 + radius * cos(angle);
+    double y = 19.7 + radius * sin(angle);
+    points->InsertNextPoint(x, y, 20.0 + 0.3 * x);
+  }
+  vtkSmartPointer<vtkImplicitSelectionLoop> loop = vtkSmartPointer<vtkImplicitSelectionLoop>::New();
+  loop->SetLoop(points);
+  return loop;
+}
+
+void AddIdArrays(vtkUnstructuredGrid* mesh)
+{
+  vtkSmartPointer<vtkIdTypeArray> cellIds = vtkSmartPointer<vtkIdTypeArray>::New();
+  cellIds->SetName("Mesh Cell ID");
+  cellIds->SetNumberOfTuples(mesh->GetNumberOfCells());
+  for (vtkIdType i = 0; i < mesh->GetNumberOfCells(); i++)
+  {
+    cellIds->SetValue(i, i);
+  }
+  vtkSmartPointer<vtkIdTypeArray> nodeIds = vtkSmartPointer<vtkIdTypeArray>::New();
+  nodeIds->SetName("Mesh Node ID");
+  nodeIds->SetNumberOfTuples(mesh->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < mesh->GetNumberOfPoints(); i++)
+  {
+    nodeIds->SetValue(i, i);
+  }
+  mesh->GetCellData()->AddArray(cellIds);
+  mesh->GetPointData()->AddArray(nodeIds);
+}
+
+// enough points for several chunks of the point classifier, and cells for
+// several chunks of the selector
+vtkSmartPointer<vtkUnstructuredGrid> VolumeMesh()
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(41, 41, 41);
+  vtkSmartPointer<vtkDataSetTriangleFilter> tetrahedra =
+    vtkSmartPointer<vtkDataSetTriangleFilter>::New();
+  tetrahedra->SetInputData(image);
+  tetrahedra->Update();
+  vtkSmartPointer<vtkUnstructuredGrid> mesh = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  mesh->ShallowCopy(tetrahedra->GetOutput());
+  AddIdArrays(mesh);
+  return mesh;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> SurfaceMesh()
+{
+  vtkSmartPointer<vtkPlaneSource> plane = vtkSmartPointer<vtkPlaneSource>::New();
+  plane->SetOrigin(0, 0, 0);
+  plane->SetPoint1(40, 0, 0);
+  plane->SetPoint2(0, 40, 0);
+  plane->SetResolution(150, 150);
+  vtkSmartPointer<vtkTriangleFilter> triangles = vtkSmartPointer<vtkTriangleFilter>::New();
+  triangles->SetInputConnection(plane->GetOutputPort());
+  triangles->Update();
+  vtkPolyData* surface = triangles->GetOutput();
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(surface->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < surface->GetNumberOfPoints(); i++)
+  {
+    double pt[3];
+    surface->GetPoint(i, pt);
+    pt[2] = 20.0 + 3.0 * sin(0.3 * pt[0]) * cos(0.2 * pt[1]);
+    points->SetPoint(i, pt);
+  }
+  vtkSmartPointer<vtkUnstructuredGrid> mesh = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  mesh->SetPoints(points);
+  mesh->SetCells(VTK_TRIANGLE, surface->GetPolys());
+  AddIdArrays(mesh);
+  return mesh;
+}
+
+// whether the cell with these points is selected in the mode, from the
+// value of the loop function at each of its points
+bool IsCellInside(vtkUnstructuredGrid* mesh, vtkIdType npts, vtkIdType* pts,
+  vtkImplicitSelectionLoop* loop, int mode)
+{
+  vtkIdType numberInside = 0;
+  for (vtkIdType j = 0; j < npts; j++)
+  {
+    double p[3];
+    mesh->GetPoint(pts[j], p);
+    if (loop->FunctionValue(p) < 0)
+    {
+      numberInside++;
+    }
+  }
+  switch (mode)
+  {
+    case vtkCMBMeshContourSelector::ALL_IN:
+      return numberInside == npts;
+    case vtkCMBMeshContourSelector::PARTIAL_OR_ALL_IN:
+      return numberInside > 0;
+    default:
+      return numberInside > 0 && numberInside < npts;
+  }
+}
+
+int TestClassifier(vtkUnstructuredGrid* mesh, vtkImplicitSelectionLoop* loop, int numberOfThreads)
+{
+  vtkSmartPointer<vtkCMBContourPointClassifier> serial =
+    vtkSmartPointer<vtkCMBContourPointClassifier>::New();
+  serial->SetContour(loop);
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+  serial->ClassifyPoints(mesh->GetPoints());
+
+  vtkSmartPointer<vtkCMBContourPointClassifier> threaded =
+    vtkSmartPointer<vtkCMBContourPointClassifier>::New();
+  threaded->SetContour(loop);
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+  threaded->ClassifyPoints(mesh->GetPoints());
+
+  vtkIdType numberInside = 0;
+  for (vtkIdType i = 0; i < mesh->GetNumberOfPoints(); i++)
+  {
+    double p[3];
+    mesh->GetPoint(i, p);
+    bool expected = loop->FunctionValue(p) < 0;
+    numberInside += expected ? 1 : 0;
+    if (serial->IsPointInside(i) != expected || threaded->IsPointInside(i) != expected ||
+      serial->IsInside(p) != expected)
+    {
+      cerr << "Point " << i << " (" << p[0] << ", " << p[1] << ", " << p[2] << ") is "
+           << (expected ? "inside" : "outside") << " the loop\n";
+      return 1;
+    }
+  }
+  if (numberInside == 0 || numberInside == mesh->GetNumberOfPoints())
+  {
+    cerr << numberInside << " points inside the loop\n";
+    return 1;
+  }
+  return 0;
+}
+
+// the ids selected by vtkCMBMeshContourSelector, through the mesh if
+// selection is NULL
+std::vector<vtkIdType> Select(
+  vtkUnstructuredGrid* mesh, vtkImplicitSelectionLoop* loop, int mode, vtkSelection* selection)
+{
+  vtkSmartPointer<vtkCMBMeshContourSelector> selector =
+    vtkSmartPointer<vtkCMBMeshContourSelector>::New();
+  selector->SetInputData(0, mesh);
+  if (selection)
+  {
+    selector->SetInputData(1, selection);
+  }
+  selector->SetContour(loop);
+  selector->SetSelectCellThrough(selection ? 0 : 1);
+  selector->SetSelectContourType(mode);
+  selector->Update();
+
+  std::vector<vtkIdType> ids;
+  vtkSelection* output = selector->GetOutput();
+  vtkSelectionNode* node = output->GetNumberOfNodes() > 0 ? output->GetNode(0) : NULL;
+  vtkIdTypeArray* list = node ? vtkIdTypeArray::SafeDownCast(node->GetSelectionList()) : NULL;
+  for (vtkIdType i = 0; list && i < list->GetNumberOfTuples(); i++)
+  {
+    ids.push_back(list->GetValue(i));
+  }
+  return ids;
+}
+
+// every third cell (or point) of the mesh
+vtkSmartPointer<vtkSelection> InputSelection(vtkIdType numberOfIds, int fieldType)
+{
+  vtkSmartPointer<vtkIdTypeArray> list = vtkSmartPointer<vtkIdTypeArray>::New();
+  for (vtkIdType i = 0; i < numberOfIds; i += 3)
+  {
+    list->InsertNextValue(i);
+  }
+  vtkSmartPointer<vtkSelectionNode> node = vtkSmartPointer<vtkSelectionNode>::New();
+  node->GetProperties()->Set(vtkSelectionNode::CONTENT_TYPE(), vtkSelectionNode::INDICES);
+  node->GetProperties()->Set(vtkSelectionNode::FIELD_TYPE(), fieldType);
+  node->SetSelectionList(list);
+  vtkSmartPointer<vtkSelection> selection = vtkSmartPointer<vtkSelection>::New();
+  selection->AddNode(node);
+  return selection;
+}
+
+int Compare(const char* what, int mode, const std::vector<vtkIdType>& serial,
+  const std::vector<vtkIdType>& threaded, const std::vector<vtkIdType>& expected,
+  vtkIdType numberOfIds)
+{
+  if (expected.empty() || static_cast<vtkIdType>(expected.size()) == numberOfIds)
+  {
+    cerr << what << " mode " << mode << ": " << expected.size() << " ids expected\n";
+    return 1;
+  }
+  if (serial != expected || threaded != expected)
+  {
+    cerr << what << " mode " << mode << ": selected " << serial.size() << " (one thread) and "
+         << threaded.size() << " ids instead of " << expected.size() << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+int TestSelector(vtkUnstructuredGrid* volume, vtkUnstructuredGrid* surface,
+  vtkImplicitSelectionLoop* loop, int numberOfThreads)
+{
+  vtkSmartPointer<vtkSelection> cellSelection =
+    InputSelection(surface->GetNumberOfCells(), vtkSelectionNode::CELL);
+  vtkSmartPointer<vtkSelection> pointSelection =
+    InputSelection(surface->GetNumberOfPoints(), vtkSelectionNode::POINT);
+  int result = 0;
+  for (int mode = vtkCMBMeshContourSelector::ALL_IN;
+       mode <= vtkCMBMeshContourSelector::INTERSECT_ONLY; mode++)
+  {
+    vtkIdType npts, *pts;
+
+    // through the volume mesh
+    vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+    std::vector<vtkIdType> serial = Select(volume, loop, mode, NULL);
+    vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+    vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+    std::vector<vtkIdType> threaded = Select(volume, loop, mode, NULL);
+    std::vector<vtkIdType> expected;
+    for (vtkIdType i = 0; i < volume->GetNumberOfCells(); i++)
+    {
+      volume->GetCellPoints(i, npts, pts);
+      if (IsCellInside(volume, npts, pts, loop, mode))
+      {
+        expected.push_back(i);
+      }
+    }
+    result |= Compare("Through", mode, serial, threaded, expected, volume->GetNumberOfCells());
+
+    // the selected cells of the surface
+    vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+    serial = Select(surface, loop, mode, cellSelection);
+    vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+    vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+    threaded = Select(surface, loop, mode, cellSelection);
+    expected.clear();
+    for (vtkIdType i = 0; i < surface->GetNumberOfCells(); i += 3)
+    {
+      surface->GetCellPoints(i, npts, pts);
+      if (IsCellInside(surface, npts, pts, loop, mode))
+      {
+        expected.push_back(i);
+      }
+    }
+    result |=
+      Compare("Surface cells", mode, serial, threaded, expected, surface->GetNumberOfCells());
+  }
+
+  // the selected points of the surface (in any mode)
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+  std::vector<vtkIdType> serial =
+    Select(surface, loop, vtkCMBMeshContourSelector::ALL_IN, pointSelection);
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+  std::vector<vtkIdType> threaded =
+    Select(surface, loop, vtkCMBMeshContourSelector::ALL_IN, pointSelection);
+  std::vector<vtkIdType> expected;
+  for (vtkIdType i = 0; i < surface->GetNumberOfPoints(); i += 3)
+  {
+    double p[3];
+    surface->GetPoint(i, p);
+    if (loop->FunctionValue(p) < 0)
+    {
+      expected.push_back(i);
+    }
+  }
+  result |= Compare("Surface points", 0, serial, threaded, expected, surface->GetNumberOfPoints());
+  return result;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  int numberOfThreads = argc > 1 ? atoi(argv[1]) : 4;
+  int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  vtkSmartPointer<vtkImplicitSelectionLoop> loop = Loop();
+  vtkSmartPointer<vtkUnstructuredGrid> volume = VolumeMesh();
+  vtkSmartPointer<vtkUnstructuredGrid> surface = SurfaceMesh();
+  int result = TestClassifier(volume, loop, numberOfThreads);
+  result |= TestSelector(volume, surface, loop, numberOfThreads);
+
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+  return result;
+}
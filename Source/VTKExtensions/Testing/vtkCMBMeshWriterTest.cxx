@@ -0,0 +1,282 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Writes triangle, tetrahedral and (blanked) structured meshes with
+// vtkCMBMeshWriter on one thread and on several, and checks that the files
+// are the same, and the same as the files written value by value to a
+// stream, as the writer did before it formatted in parallel chunks.
+#include "vtkCMBMeshWriter.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkIdList.h"
+#include "vtkMultiThreader.h"
+#include "vtkPlaneSource.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkStructuredGrid.h"
+#include "vtkTriangleFilter.h"
+#include "vtkUnstructuredGrid.h"
+#include <vtksys/SystemTools.hxx>
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// a material id per cell, so that the material column varies
+void AddMaterials(vtkDataSet* mesh)
+{
+  vtkSmartPointer<vtkIntArray> materials = vtkSmartPointer<vtkIntArray>::New();
+  materials->SetName("Material");
+  materials->SetNumberOfTuples(mesh->GetNumberOfCells());
+  for (vtkIdType i = 0; i < mesh->GetNumberOfCells(); i++)
+  {
+    materials->SetValue(i, static_cast<int>(i % 7) + 1);
+  }
+  mesh->GetCellData()->SetScalars(materials);
+}
+
+struct MeshCase
+{
+  vtkDataSet* Mesh;
+  int Dimension;
+  int Format;
+  bool Scientific;
+  int Precision;
+  const char* FileName;
+};
+
+bool Write(const MeshCase& meshCase, const std::string& fileName)
+{
+  vtkSmartPointer<vtkCMBMeshWriter> writer = vtkSmartPointer<vtkCMBMeshWriter>::New();
+  writer->SetInputData(meshCase.Mesh);
+  writer->SetFileName(fileName.c_str());
+  writer->SetMeshDimension(meshCase.Dimension);
+  writer->SetFileFormat(meshCase.Format);
+  writer->SetUseScientificNotation(meshCase.Scientific);
+  writer->SetFloatPrecision(meshCase.Precision);
+  writer->WriteMetaInfoOn();
+  return writer->Write() != 0;
+}
+
+const char* CellCard(int format, int cellType)
+{
+  bool adh = format == vtkCMBMeshWriter::ADH;
+  switch (cellType)
+  {
+    case VTK_TRIANGLE:
+      return adh ? "E3T" : "GE3";
+    case VTK_TETRA:
+      return adh ? "E4T" : "GE4";
+    case VTK_QUAD:
+      return "GE4";
+    case VTK_HEXAHEDRON:
+      return "GE8";
+  }
+  return "";
+}
+
+// the file as the writer wrote it to the stream, a value at a time (for the
+// cell types of these meshes, none of which has its points reordered); the
+// cells and points of a structured grid come from vtkDataSet, and its
+// blanked cells and points are skipped
+void WriteReference(const MeshCase& meshCase, const std::string& fileName)
+{
+  vtkDataSet* mesh = meshCase.Mesh;
+  vtkStructuredGrid* structured = vtkStructuredGrid::SafeDownCast(mesh);
+  std::vector<vtkIdType> pointFileIds(mesh->GetNumberOfPoints());
+  vtkIdType numberOfPoints = 0, numberOfCells = 0;
+  for (vtkIdType i = 0; i < mesh->GetNumberOfPoints(); i++)
+  {
+    pointFileIds[i] = structured && !structured->IsPointVisible(i) ? -1 : numberOfPoints++;
+  }
+  for (vtkIdType i = 0; i < mesh->GetNumberOfCells(); i++)
+  {
+    numberOfCells += structured && !structured->IsCellVisible(i) ? 0 : 1;
+  }
+
+  ofstream fp(fileName.c_str());
+  if (meshCase.Format == vtkCMBMeshWriter::WASH123D)
+  {
+    fp << "WMS" << meshCase.Dimension << "DM" << endl;
+    fp << "T1" << endl << "T2" << endl << "T3" << endl;
+  }
+  else
+  {
+    fp << "MESH" << meshCase.Dimension << "D" << endl;
+  }
+  fp << "#NELEM  " << numberOfCells << endl;
+  fp << "#NNODE  " << numberOfPoints << endl;
+
+  vtkDataArray* materials = mesh->GetCellData()->GetScalars();
+  vtkSmartPointer<vtkIdList> cellPoints = vtkSmartPointer<vtkIdList>::New();
+  vtkIdType fileId = 0;
+  for (vtkIdType i = 0; i < mesh->GetNumberOfCells(); i++)
+  {
+    if (structured && !structured->IsCellVisible(i))
+    {
+      continue;
+    }
+    mesh->GetCellPoints(i, cellPoints);
+    fp << CellCard(meshCase.Format, mesh->GetCellType(i)) << "  " << ++fileId;
+    for (vtkIdType j = 0; j < cellPoints->GetNumberOfIds(); j++)
+    {
+      fp << "  " << pointFileIds[cellPoints->GetId(j)] + 1;
+    }
+    if (meshCase.Format != vtkCMBMeshWriter::PT123)
+    {
+      fp << "  " << static_cast<unsigned long>(materials->GetComponent(i, 0));
+    }
+    fp << endl;
+  }
+
+  const char* card = meshCase.Format == vtkCMBMeshWriter::ADH ? "ND" : "GN";
+  fp.precision(meshCase.Precision);
+  fp.setf(ios::showpoint);
+  fp.setf(meshCase.Scientific ? ios::scientific : ios::fixed, ios::floatfield);
+  for (vtkIdType i = 0; i < mesh->GetNumberOfPoints(); i++)
+  {
+    if (pointFileIds[i] < 0)
+    {
+      continue;
+    }
+    double pt[3];
+    mesh->GetPoint(i, pt);
+    fp << card << "  " << pointFileIds[i] + 1 << "  " << pt[0] << "  " << pt[1] << "  " << pt[2]
+       << endl;
+  }
+
+  if (meshCase.Format == vtkCMBMeshWriter::PT123)
+  {
+    fp << "ENDR" << endl;
+  }
+  else if (meshCase.Format == vtkCMBMeshWriter::WASH123D)
+  {
+    fp << "END" << endl;
+  }
+}
+
+// a curvilinear grid of the given dimensions, with some cells and points
+// blanked
+vtkSmartPointer<vtkStructuredGrid> StructuredMesh(int nx, int ny, int nz)
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToDouble();
+  for (int k = 0; k < nz; k++)
+  {
+    for (int j = 0; j < ny; j++)
+    {
+      for (int i = 0; i < nx; i++)
+      {
+        points->InsertNextPoint(i + 0.1 * sin(0.7 * j), j + 0.1 * cos(0.3 * k), 0.5 * k + 0.01 * i);
+      }
+    }
+  }
+  vtkSmartPointer<vtkStructuredGrid> mesh = vtkSmartPointer<vtkStructuredGrid>::New();
+  mesh->SetDimensions(nx, ny, nz);
+  mesh->SetPoints(points);
+  for (vtkIdType i = 0; i < mesh->GetNumberOfCells(); i += 11)
+  {
+    mesh->BlankCell(i);
+  }
+  for (vtkIdType i = 5; i < mesh->GetNumberOfPoints(); i += 97)
+  {
+    mesh->BlankPoint(i);
+  }
+  AddMaterials(mesh);
+  return mesh;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 3)
+  {
+    cerr << "usage:  vtkCMBMeshWriterTest outputPath [numberOfThreads]\n";
+    return -1;
+  }
+  std::string outputPath = argv[1];
+  int numberOfThreads = argc > 2 ? atoi(argv[2]) : 4;
+
+  // enough cells and points for several batches of chunks
+  vtkSmartPointer<vtkPlaneSource> plane = vtkSmartPointer<vtkPlaneSource>::New();
+  plane->SetResolution(200, 200);
+  vtkSmartPointer<vtkTriangleFilter> triangles = vtkSmartPointer<vtkTriangleFilter>::New();
+  triangles->SetInputConnection(plane->GetOutputPort());
+  triangles->Update();
+  vtkSmartPointer<vtkPolyData> mesh2D = vtkSmartPointer<vtkPolyData>::New();
+  mesh2D->ShallowCopy(triangles->GetOutput());
+  AddMaterials(mesh2D);
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(30, 30, 30);
+  image->SetSpacing(0.1, 0.2, 0.3);
+  vtkSmartPointer<vtkDataSetTriangleFilter> tetrahedra =
+    vtkSmartPointer<vtkDataSetTriangleFilter>::New();
+  tetrahedra->SetInputData(image);
+  tetrahedra->Update();
+  vtkSmartPointer<vtkUnstructuredGrid> mesh3D = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  mesh3D->ShallowCopy(tetrahedra->GetOutput());
+  AddMaterials(mesh3D);
+
+  vtkSmartPointer<vtkStructuredGrid> hexahedra = StructuredMesh(24, 18, 12);
+  vtkSmartPointer<vtkStructuredGrid> quads = StructuredMesh(40, 1, 30);
+
+  const MeshCase cases[5] = {
+    { mesh2D, vtkCMBMeshWriter::MESH2D, vtkCMBMeshWriter::ADH, true, 6, "MeshWriterTest.2dm" },
+    { mesh3D, vtkCMBMeshWriter::MESH3D, vtkCMBMeshWriter::WASH123D, true, 6,
+      "MeshWriterTest.3dm" },
+    { mesh3D, vtkCMBMeshWriter::MESH3D, vtkCMBMeshWriter::PT123, false, 9,
+      "MeshWriterTest.pt123" },
+    { hexahedra, vtkCMBMeshWriter::MESH3D, vtkCMBMeshWriter::WASH123D, true, 6,
+      "MeshWriterTestStructured.3dm" },
+    { quads, vtkCMBMeshWriter::MESH2D, vtkCMBMeshWriter::PT123, false, 3,
+      "MeshWriterTestStructured.pt123" },
+  };
+
+  int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  int result = 0;
+  for (int i = 0; i < 5; i++)
+  {
+    std::string referenceFileName = outputPath + "/reference" + cases[i].FileName;
+    std::string serialFileName = outputPath + "/serial" + cases[i].FileName;
+    std::string threadedFileName = outputPath + "/threaded" + cases[i].FileName;
+    WriteReference(cases[i], referenceFileName);
+    vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+    bool serial = Write(cases[i], serialFileName);
+    vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+    vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+    bool threaded = Write(cases[i], threadedFileName);
+    vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+    if (!serial || !threaded)
+    {
+      cerr << "Could not write " << cases[i].FileName << "\n";
+      result = 1;
+    }
+    else if (vtksys::SystemTools::FilesDiffer(referenceFileName, serialFileName))
+    {
+      cerr << cases[i].FileName << " differs from the one written to a stream\n";
+      result = 1;
+    }
+    else if (vtksys::SystemTools::FilesDiffer(serialFileName, threadedFileName))
+    {
+      cerr << cases[i].FileName << " differs from the serial one\n";
+      result = 1;
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,166 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Traces random seeds (each with a few test locations around it) through a
+// swirling velocity field on a tetrahedral mesh with vtkCMBStreamTracer on
+// one thread and on several, and checks that the streamlines are the same.
+#include "vtkCMBStreamTracer.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+
+bool SameArrays(vtkDataArray* a, vtkDataArray* b)
+{
+  if (!a || !b || a->GetNumberOfTuples() != b->GetNumberOfTuples() ||
+    a->GetNumberOfComponents() != b->GetNumberOfComponents())
+  {
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfTuples(); i++)
+  {
+    for (int j = 0; j < a->GetNumberOfComponents(); j++)
+    {
+      if (a->GetComponent(i, j) != b->GetComponent(i, j))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// every array of a, the same in b
+bool SameAttributes(vtkDataSetAttributes* a, vtkDataSetAttributes* b)
+{
+  if (a->GetNumberOfArrays() != b->GetNumberOfArrays())
+  {
+    return false;
+  }
+  for (int i = 0; i < a->GetNumberOfArrays(); i++)
+  {
+    vtkDataArray* array = a->GetArray(i);
+    if (array && !SameArrays(array, b->GetArray(array->GetName())))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  int numberOfThreads = argc > 1 ? atoi(argv[1]) : 4;
+  int numberOfSeeds = argc > 2 ? atoi(argv[2]) : 500;
+  const int numberOfTestLocations = 4;
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(21, 21, 21);
+  image->SetSpacing(0.05, 0.05, 0.05);
+  vtkSmartPointer<vtkDataSetTriangleFilter> tetrahedra =
+    vtkSmartPointer<vtkDataSetTriangleFilter>::New();
+  tetrahedra->SetInputData(image);
+  tetrahedra->Update();
+  vtkSmartPointer<vtkUnstructuredGrid> mesh = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  mesh->ShallowCopy(tetrahedra->GetOutput());
+
+  // a swirl around the center of the mesh, slowly rising
+  vtkSmartPointer<vtkDoubleArray> velocity = vtkSmartPointer<vtkDoubleArray>::New();
+  velocity->SetName("Velocity");
+  velocity->SetNumberOfComponents(3);
+  velocity->SetNumberOfTuples(mesh->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < mesh->GetNumberOfPoints(); i++)
+  {
+    double pt[3];
+    mesh->GetPoint(i, pt);
+    velocity->SetTuple3(i, 0.5 - pt[1], pt[0] - 0.5, 0.1);
+  }
+  mesh->GetPointData()->AddArray(velocity);
+
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+  vtkSmartPointer<vtkPoints> seedPoints = vtkSmartPointer<vtkPoints>::New();
+  seedPoints->SetNumberOfPoints(numberOfSeeds);
+  for (int i = 0; i < numberOfSeeds; i++)
+  {
+    double seed[3];
+    for (int j = 0; j < 3; j++)
+    {
+      seed[j] = random->GetRangeValue(0.05, 0.95);
+      random->Next();
+    }
+    seedPoints->SetPoint(i, seed);
+  }
+  vtkSmartPointer<vtkPolyData> seeds = vtkSmartPointer<vtkPolyData>::New();
+  seeds->SetPoints(seedPoints);
+
+  vtkSmartPointer<vtkCMBStreamTracer> tracer = vtkSmartPointer<vtkCMBStreamTracer>::New();
+  tracer->SetInputData(mesh);
+  tracer->SetSourceData(seeds);
+  tracer->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "Velocity");
+  tracer->SetIntegrationDirectionToBoth();
+  tracer->SetMaximumPropagation(2.0);
+  tracer->SetNumberOfTestLocations(numberOfTestLocations);
+  for (int i = 0; i < numberOfTestLocations; i++)
+  {
+    double angle = 2.0 * vtkMath::Pi() * i / numberOfTestLocations;
+    tracer->SetRelativeOffsetOfTestLocation(i, 0.01 * cos(angle), 0.01 * sin(angle), 0.0);
+  }
+
+  tracer->SetNumberOfThreads(1);
+  tracer->Update();
+  vtkSmartPointer<vtkPolyData> serial = vtkSmartPointer<vtkPolyData>::New();
+  serial->DeepCopy(tracer->GetOutput());
+  tracer->SetNumberOfThreads(numberOfThreads);
+  tracer->Update();
+  vtkPolyData* threaded = tracer->GetOutput();
+
+  if (serial->GetNumberOfLines() == 0)
+  {
+    cerr << "No streamlines were traced\n";
+    return 1;
+  }
+  if (serial->GetNumberOfPoints() != threaded->GetNumberOfPoints() ||
+    !SameArrays(serial->GetPoints()->GetData(), threaded->GetPoints()->GetData()))
+  {
+    cerr << "The streamline points differ from the serial ones\n";
+    return 1;
+  }
+  if (serial->GetNumberOfLines() != threaded->GetNumberOfLines() ||
+    !SameArrays(serial->GetLines()->GetData(), threaded->GetLines()->GetData()))
+  {
+    cerr << "The streamlines differ from the serial ones\n";
+    return 1;
+  }
+  if (!SameAttributes(serial->GetPointData(), threaded->GetPointData()) ||
+    !SameAttributes(serial->GetCellData(), threaded->GetCellData()))
+  {
+    cerr << "The streamline attributes differ from the serial ones\n";
+    return 1;
+  }
+
+  return 0;
+}
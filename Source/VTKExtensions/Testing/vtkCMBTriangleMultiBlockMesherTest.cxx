@@ -0,0 +1,114 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Meshes the faces of a map file with vtkCMBTriangleMultiBlockMesher on a
+// single thread and on several, and checks that the face meshes are the
+// same and that they conform along the shared edges when the boundaries
+// are preserved.
+#include "smtk/extension/vtk/reader/vtkCMBMapReader.h"
+#include "vtkCMBTriangleMultiBlockMesher.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+vtkSmartPointer<vtkMultiBlockDataSet> meshFaces(
+  vtkCMBMapReader* reader, int numberOfThreads, vtkIdType& nonConformingEdges)
+{
+  vtkNew<vtkCMBTriangleMultiBlockMesher> mesher;
+  mesher->SetInputConnection(reader->GetOutputPort());
+  mesher->SetPreserveBoundaries(true);
+  mesher->SetMaxAreaMode(vtkCMBTriangleMultiBlockMesher::RelativeToBounds);
+  mesher->SetMaxArea(0.001);
+  mesher->SetNumberOfThreads(numberOfThreads);
+  mesher->Update();
+  nonConformingEdges = mesher->GetNumberOfNonConformingEdges();
+  vtkSmartPointer<vtkMultiBlockDataSet> output = vtkSmartPointer<vtkMultiBlockDataSet>::New();
+  output->ShallowCopy(mesher->GetOutput());
+  return output;
+}
+
+bool sameMesh(vtkPolyData* a, vtkPolyData* b)
+{
+  if (!a || !b || a->GetNumberOfPoints() != b->GetNumberOfPoints() ||
+    a->GetNumberOfPolys() != b->GetNumberOfPolys())
+  {
+    return false;
+  }
+  double p[3], q[3];
+  for (vtkIdType i = 0; i < a->GetNumberOfPoints(); i++)
+  {
+    a->GetPoint(i, p);
+    b->GetPoint(i, q);
+    if (p[0] != q[0] || p[1] != q[1] || p[2] != q[2])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "usage: vtkCMBTriangleMultiBlockMesherTest file.map [numberOfThreads]\n";
+    return 1;
+  }
+  int numberOfThreads = argc > 2 ? atoi(argv[2]) : 4;
+
+  vtkNew<vtkCMBMapReader> reader;
+  reader->SetFileName(argv[1]);
+  reader->Update();
+
+  vtkIdType serialNonConforming = 0;
+  vtkIdType parallelNonConforming = 0;
+  vtkSmartPointer<vtkMultiBlockDataSet> serial =
+    meshFaces(reader.GetPointer(), 1, serialNonConforming);
+  vtkSmartPointer<vtkMultiBlockDataSet> parallel =
+    meshFaces(reader.GetPointer(), numberOfThreads, parallelNonConforming);
+
+  int result = 0;
+  if (serial->GetNumberOfBlocks() < 2)
+  {
+    std::cerr << "Expected several faces, got " << serial->GetNumberOfBlocks() << "\n";
+    result = 1;
+  }
+  if (serialNonConforming != 0 || parallelNonConforming != 0)
+  {
+    std::cerr << "Non conforming edges with the boundaries preserved: " << serialNonConforming
+              << " on one thread, " << parallelNonConforming << " on " << numberOfThreads
+              << "\n";
+    result = 1;
+  }
+  if (parallel->GetNumberOfBlocks() != serial->GetNumberOfBlocks())
+  {
+    std::cerr << "Different number of faces: " << serial->GetNumberOfBlocks() << " on one thread, "
+              << parallel->GetNumberOfBlocks() << " on " << numberOfThreads << "\n";
+    return 1;
+  }
+  for (unsigned int i = 0; i < serial->GetNumberOfBlocks(); i++)
+  {
+    if (!sameMesh(vtkPolyData::SafeDownCast(serial->GetBlock(i)),
+          vtkPolyData::SafeDownCast(parallel->GetBlock(i))))
+    {
+      std::cerr << "The mesh of face " << i << " depends on the number of threads\n";
+      result = 1;
+    }
+  }
+  return result;
+}
@@ -0,0 +1,158 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Thresholds a cloud of random colored points with vtkPointThresholdFilter
+// on one thread and on several, and checks that the outputs are the same.
+#include "vtkCellArray.h"
+#include "vtkFloatArray.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkMultiThreader.h"
+#include "vtkPointData.h"
+#include "vtkPointThresholdFilter.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTransform.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <cstdlib>
+
+namespace
+{
+
+vtkSmartPointer<vtkPolyData> Threshold(vtkPolyData* input, vtkTransform* transform)
+{
+  vtkSmartPointer<vtkPointThresholdFilter> threshold =
+    vtkSmartPointer<vtkPointThresholdFilter>::New();
+  threshold->SetInputData(input);
+  threshold->SetTransform(transform);
+  threshold->TransformOutputDataOn();
+
+  // a slab in x...
+  threshold->AddFilter();
+  threshold->SetActiveFilterIndex(0);
+  threshold->SetUseFilter(0, 1);
+  threshold->SetMinX(0.2);
+  threshold->SetUseMinX(true);
+  threshold->SetMaxX(0.6);
+  threshold->SetUseMaxX(true);
+
+  // ...or the points that are not reddish
+  threshold->AddFilter();
+  threshold->SetActiveFilterIndex(1);
+  threshold->SetUseFilter(1, 1);
+  threshold->SetMinRGB(128, 0, 0);
+  threshold->SetUseMinRGB(true);
+  threshold->SetMaxRGB(255, 128, 128);
+  threshold->SetUseMaxRGB(true);
+  threshold->SetInvert(true);
+
+  threshold->Update();
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(threshold->GetOutput());
+  return output;
+}
+
+bool SameArrays(vtkDataArray* a, vtkDataArray* b)
+{
+  if (!a || !b || a->GetNumberOfTuples() != b->GetNumberOfTuples() ||
+    a->GetNumberOfComponents() != b->GetNumberOfComponents())
+  {
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfTuples(); i++)
+  {
+    for (int j = 0; j < a->GetNumberOfComponents(); j++)
+    {
+      if (a->GetComponent(i, j) != b->GetComponent(i, j))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  int numberOfThreads = argc > 1 ? atoi(argv[1]) : 4;
+  // enough points for several chunks
+  vtkIdType numberOfPoints = argc > 2 ? atoi(argv[2]) : 300000;
+
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(numberOfPoints);
+  vtkSmartPointer<vtkUnsignedCharArray> color = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  color->SetName("Color");
+  color->SetNumberOfComponents(3);
+  color->SetNumberOfTuples(numberOfPoints);
+  vtkSmartPointer<vtkFloatArray> intensity = vtkSmartPointer<vtkFloatArray>::New();
+  intensity->SetName("Intensity");
+  intensity->SetNumberOfTuples(numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; i++)
+  {
+    double point[3];
+    for (int j = 0; j < 3; j++)
+    {
+      point[j] = random->GetValue();
+      random->Next();
+      color->SetComponent(i, j, static_cast<int>(255 * point[j]));
+    }
+    points->SetPoint(i, point);
+    intensity->SetValue(i, static_cast<float>(point[0] + point[1]));
+  }
+  vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+  input->SetPoints(points);
+  input->GetPointData()->SetScalars(color);
+  input->GetPointData()->AddArray(intensity);
+
+  vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
+  transform->Translate(0.5, 0.0, 1.0);
+  transform->RotateZ(30.0);
+
+  int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(1);
+  vtkSmartPointer<vtkPolyData> serial = Threshold(input, transform);
+  vtkMultiThreader::SetGlobalMaximumNumberOfThreads(0);
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+  vtkSmartPointer<vtkPolyData> threaded = Threshold(input, transform);
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+
+  if (serial->GetNumberOfPoints() == 0 || serial->GetNumberOfPoints() == numberOfPoints)
+  {
+    cerr << "The thresholds should keep some of the points\n";
+    return 1;
+  }
+  if (!SameArrays(serial->GetPoints()->GetData(), threaded->GetPoints()->GetData()))
+  {
+    cerr << "The points differ from the serial ones\n";
+    return 1;
+  }
+  if (serial->GetNumberOfVerts() != threaded->GetNumberOfVerts() ||
+    !SameArrays(serial->GetVerts()->GetData(), threaded->GetVerts()->GetData()))
+  {
+    cerr << "The vertices differ from the serial ones\n";
+    return 1;
+  }
+  const char* arrays[2] = { "Color", "Intensity" };
+  for (int i = 0; i < 2; i++)
+  {
+    if (!SameArrays(serial->GetPointData()->GetArray(arrays[i]),
+          threaded->GetPointData()->GetArray(arrays[i])))
+    {
+      cerr << "The " << arrays[i] << " differs from the serial one\n";
+      return 1;
+    }
+  }
+
+  return 0;
+}
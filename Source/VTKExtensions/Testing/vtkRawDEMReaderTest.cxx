@@ -0,0 +1,290 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Writes a set of 2 x 2 raw DEM files (each read in several tiles), with
+// NoDataValue cells scattered and in a cluster across the file boundaries,
+// and reads the set with vtkRawDEMReader.  The image output (at full and at
+// reduced resolution) is checked against the files read one value at a time
+// and the NoDataValue cells filled in file order, as the reader did before
+// it read in tiles; the points output, and its bounds, against the points
+// of all the files.
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkMultiThreader.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkRawDEMReader.h"
+#include "vtkSmartPointer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// the files are (north/south) x (west/east), each of FileColumns x FileRows
+const int FileColumns = 150;
+const int FileRows = 140;
+const int NumberOfColumns = 2 * FileColumns;
+const int NumberOfRows = 2 * FileRows;
+const double Spacing = 1.0 / 128.0;
+const double Longitude = -100.0;
+const double Latitude = 40.0;
+const float NoDataValue = -9999.0f;
+
+// row is counted from the south
+bool IsNoData(int row, int column)
+{
+  bool cluster = row >= FileRows - 2 && row < FileRows + 3 && column >= FileColumns - 3 &&
+    column < FileColumns + 2;
+  return cluster || (row * 7 + column * 13) % 97 == 0;
+}
+
+float Elevation(int row, int column)
+{
+  return IsNoData(row, column) ? NoDataValue : 100.0f + 0.5f * row + 0.25f * column;
+}
+
+bool WriteFiles(const std::string& prefix)
+{
+  for (int i = 0; i < 2; i++)
+  {
+    for (int j = 0; j < 2; j++)
+    {
+      char name[32];
+      sprintf(name, "%d%d", i, j);
+      FILE* hdr = fopen((prefix + name + ".hdr").c_str(), "w");
+      FILE* flt = fopen((prefix + name + ".FLT").c_str(), "wb");
+      if (!hdr || !flt)
+      {
+        return false;
+      }
+      fprintf(hdr, "ncols %d\nnrows %d\n", FileColumns, FileRows);
+      fprintf(hdr, "xllcorner %.17g\nyllcorner %.17g\n", Longitude + j * FileColumns * Spacing,
+        Latitude + i * FileRows * Spacing);
+      fprintf(hdr, "cellsize %.17g\nNODATA_value %g\nbyteorder LSBFIRST\n", Spacing, NoDataValue);
+      // from the upper-left, a row at a time
+      std::vector<float> row(FileColumns);
+      for (int r = FileRows - 1; r >= 0; r--)
+      {
+        for (int c = 0; c < FileColumns; c++)
+        {
+          row[c] = Elevation(i * FileRows + r, j * FileColumns + c);
+        }
+        fwrite(&row[0], sizeof(float), FileColumns, flt);
+      }
+      if (fclose(hdr) != 0 || fclose(flt) != 0)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// the image read with an on ratio of step, each value as the serial reader
+// did, and the NoDataValue cells filled in file order: north to south, west
+// to east, and then top to bottom and left to right in the file
+std::vector<float> ExpectedImage(int step, int& outputColumns, int& outputRows)
+{
+  outputColumns = 1 + (NumberOfColumns - 1) / step;
+  outputRows = 1 + (NumberOfRows - 1) / step;
+  int firstRow = (NumberOfRows - 1) - (outputRows - 1) * step;
+  std::vector<float> image(outputColumns * outputRows);
+  std::vector<int> noData;
+  for (int i = 1; i >= 0; i--)
+  {
+    for (int j = 0; j < 2; j++)
+    {
+      for (int r = (i + 1) * FileRows - 1; r >= i * FileRows; r--)
+      {
+        for (int c = j * FileColumns; c < (j + 1) * FileColumns; c++)
+        {
+          if ((r - firstRow) % step != 0 || c % step != 0)
+          {
+            continue;
+          }
+          int id = ((r - firstRow) / step) * outputColumns + c / step;
+          image[id] = Elevation(r, c);
+          if (image[id] == NoDataValue)
+          {
+            noData.push_back(id);
+          }
+        }
+      }
+    }
+  }
+  for (size_t n = 0; n < noData.size(); n++)
+  {
+    int row = noData[n] / outputColumns, column = noData[n] % outputColumns;
+    double sum = 0;
+    int sumCount = 0;
+    for (int r = row - 1; r < row + 2; r++)
+    {
+      for (int c = column - 1; c < column + 2; c++)
+      {
+        if (r < 0 || r >= outputRows || c < 0 || c >= outputColumns || (r == row && c == column))
+        {
+          continue;
+        }
+        if (image[r * outputColumns + c] != NoDataValue)
+        {
+          sum += image[r * outputColumns + c];
+          sumCount++;
+        }
+      }
+    }
+    if (sumCount)
+    {
+      image[noData[n]] = static_cast<float>(sum / sumCount);
+    }
+  }
+  return image;
+}
+
+int TestImage(const std::string& fileName, int onRatio)
+{
+  vtkSmartPointer<vtkRawDEMReader> reader = vtkSmartPointer<vtkRawDEMReader>::New();
+  reader->SetFileName(fileName.c_str());
+  reader->ReadSetOfFilesOn();
+  reader->SetOnRatio(onRatio);
+  reader->Update();
+  vtkImageData* output = vtkImageData::SafeDownCast(reader->GetOutputDataObject(0));
+
+  int step = 1;
+  while ((step + 1) * (step + 1) <= onRatio)
+  {
+    step++;
+  }
+  int outputColumns, outputRows;
+  std::vector<float> expected = ExpectedImage(step, outputColumns, outputRows);
+  int* dimensions = output ? output->GetDimensions() : 0;
+  vtkDataArray* scalars = output ? output->GetPointData()->GetScalars() : 0;
+  if (!scalars || dimensions[0] != outputColumns || dimensions[1] != outputRows)
+  {
+    cerr << "OnRatio " << onRatio << ": the image isn't " << outputColumns << " x " << outputRows
+         << "\n";
+    return 1;
+  }
+  for (vtkIdType i = 0; i < static_cast<vtkIdType>(expected.size()); i++)
+  {
+    if (static_cast<float>(scalars->GetComponent(i, 0)) != expected[i])
+    {
+      cerr << "OnRatio " << onRatio << ": value " << i << " is " << scalars->GetComponent(i, 0)
+           << " instead of " << expected[i] << "\n";
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int TestPoints(const std::string& fileName)
+{
+  vtkSmartPointer<vtkRawDEMReader> reader = vtkSmartPointer<vtkRawDEMReader>::New();
+  reader->SetFileName(fileName.c_str());
+  reader->ReadSetOfFilesOn();
+  reader->OutputImageDataOff();
+  reader->ConvertFromLatLongToXYZOff();
+  reader->OutputDataTypeIsDoubleOn();
+  reader->SetOnRatio(1);
+  reader->Update();
+  vtkPolyData* output = vtkPolyData::SafeDownCast(reader->GetOutputDataObject(0));
+
+  // the points of the files in file order, placed as the serial reader did
+  // (relative to the upper-left of each file)
+  std::vector<double> expected;
+  for (int i = 1; i >= 0; i--)
+  {
+    double upperLatitude = Latitude + ((i + 1) * FileRows - 1) * Spacing;
+    for (int j = 0; j < 2; j++)
+    {
+      double fileLongitude = Longitude + j * FileColumns * Spacing;
+      for (int r = 0; r < FileRows; r++)
+      {
+        for (int c = 0; c < FileColumns; c++)
+        {
+          float z = Elevation((i + 1) * FileRows - 1 - r, j * FileColumns + c);
+          if (z != NoDataValue)
+          {
+            expected.push_back(fileLongitude + Spacing * c);
+            expected.push_back(upperLatitude - (NumberOfRows - 1) * Spacing - Spacing * r);
+            expected.push_back(z);
+          }
+        }
+      }
+    }
+  }
+
+  vtkIdType numberOfPoints = static_cast<vtkIdType>(expected.size() / 3);
+  if (!output || output->GetNumberOfPoints() != numberOfPoints ||
+    output->GetNumberOfVerts() != numberOfPoints)
+  {
+    cerr << "Read " << (output ? output->GetNumberOfPoints() : 0) << " points instead of "
+         << numberOfPoints << "\n";
+    return 1;
+  }
+  for (vtkIdType i = 0; i < numberOfPoints; i++)
+  {
+    double pt[3];
+    output->GetPoint(i, pt);
+    if (pt[0] != expected[3 * i] || pt[1] != expected[3 * i + 1] || pt[2] != expected[3 * i + 2])
+    {
+      cerr << "Point " << i << " differs from the serial read\n";
+      return 1;
+    }
+  }
+
+  // the bounds are of all the files (not just the last one read)
+  double bounds[6];
+  output->GetBounds(bounds);
+  double* dataBounds = reader->GetDataBounds();
+  for (int i = 0; i < 6; i++)
+  {
+    if (dataBounds[i] != bounds[i])
+    {
+      cerr << "The DataBounds aren't the bounds of the points of all the files\n";
+      return 1;
+    }
+  }
+  if (bounds[0] != Longitude || bounds[1] != Longitude + (NumberOfColumns - 1) * Spacing)
+  {
+    cerr << "The points aren't of all the files\n";
+    return 1;
+  }
+  return 0;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 3)
+  {
+    cerr << "usage:  vtkRawDEMReaderTest outputPath [numberOfThreads]\n";
+    return -1;
+  }
+  std::string prefix = std::string(argv[1]) + "/RawDEMTest_";
+  int numberOfThreads = argc > 2 ? atoi(argv[2]) : 4;
+  if (!WriteFiles(prefix))
+  {
+    cerr << "Could not write the files " << prefix << "*\n";
+    return 1;
+  }
+
+  int defaultNumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+  std::string fileName = prefix + "00.hdr";
+  int result = TestImage(fileName, 1);
+  result |= TestImage(fileName, 4);
+  result |= TestPoints(fileName);
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(defaultNumberOfThreads);
+
+  return result;
+}
@@ -0,0 +1,123 @@
+//=========================================================================
+//  Copyright (c) Kitware, Inc.
+//  All rights reserved.
+//  See LICENSE.txt for details.
+//
+//  This software is distributed WITHOUT ANY WARRANTY; without even
+//  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+//  PURPOSE.  See the above copyright notice for more information.
+//=========================================================================
+// Extracts the terrain of a synthetic (noisy) height field with
+// vtkTerrainExtractionFilter on one thread and on several, and checks that
+// the levels written are the same.
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTerrainExtractionFilter.h"
+#include <vtksys/SystemTools.hxx>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+
+// extracts all the levels of input to outputPath; returns the number of levels
+int Extract(vtkPolyData* input, const std::string& outputPath, int numberOfThreads)
+{
+  vtksys::SystemTools::MakeDirectory(outputPath.c_str());
+  vtkSmartPointer<vtkTerrainExtractionFilter> extraction =
+    vtkSmartPointer<vtkTerrainExtractionFilter>::New();
+  extraction->SetInputData(input);
+  extraction->SetOutputPath(outputPath.c_str());
+  extraction->SetIntermediateResultsPath(outputPath.c_str());
+  extraction->SetOutputPtsFormatToBinaryPts();
+  extraction->SetNumberOfThreads(numberOfThreads);
+
+  extraction->SetExecuteModeToSetupRefine();
+  extraction->Update();
+  extraction->SetExecuteModeToRefine();
+  extraction->Update();
+  int numberOfLevels = extraction->GetNumberOfLevels();
+  if (numberOfLevels < 1)
+  {
+    return 0;
+  }
+  extraction->SetMinExtractLevel(0);
+  extraction->SetMaxExtractLevel(numberOfLevels - 1);
+  extraction->SetExecuteModeToExtract();
+  extraction->Update();
+  return numberOfLevels;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argc > 3)
+  {
+    cerr << "usage:  vtkTerrainExtractionFilterTest outputPath [numberOfThreads]\n";
+    return -1;
+  }
+  std::string outputPath = argv[1];
+  int numberOfThreads = argc > 2 ? atoi(argv[2]) : 4;
+
+  // rolling hills, sampled with a bit of noise
+  const int dimension = 64;
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(dimension * dimension);
+  for (int j = 0; j < dimension; j++)
+  {
+    for (int i = 0; i < dimension; i++)
+    {
+      double x = i + random->GetRangeValue(-0.25, 0.25);
+      random->Next();
+      double y = j + random->GetRangeValue(-0.25, 0.25);
+      random->Next();
+      double z = 4.0 * sin(x / 8.0) * cos(y / 8.0) + random->GetRangeValue(-0.1, 0.1);
+      random->Next();
+      points->SetPoint(j * dimension + i, x, y, z);
+    }
+  }
+  vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+  input->SetPoints(points);
+
+  std::string serialPath = outputPath + "/TerrainExtractionSerial";
+  std::string threadedPath = outputPath + "/TerrainExtractionThreaded";
+  int numberOfLevels = Extract(input, serialPath, 1);
+  if (numberOfLevels < 1)
+  {
+    cerr << "Refine did not generate any levels\n";
+    return 1;
+  }
+  if (Extract(input, threadedPath, numberOfThreads) != numberOfLevels)
+  {
+    cerr << "The number of levels differs from the serial one\n";
+    return 1;
+  }
+
+  int result = 0;
+  for (int level = 0; level < numberOfLevels; level++)
+  {
+    char fileName[64];
+    sprintf(fileName, "/TerrainExtract_%02d.bin.pts", level);
+    std::string serialFileName = serialPath + fileName;
+    if (!vtksys::SystemTools::FileExists(serialFileName.c_str(), true))
+    {
+      cerr << "Level " << level << " was not written\n";
+      result = 1;
+    }
+    else if (vtksys::SystemTools::FilesDiffer(serialFileName, threadedPath + fileName))
+    {
+      cerr << "Level " << level << " differs from the serial one\n";
+      result = 1;
+    }
+  }
+
+  return result;
+}